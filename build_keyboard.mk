@@ -121,7 +121,8 @@ SRC += $(KEYBOARD_C) \
     $(QUANTUM_DIR)/quantum.c \
     $(QUANTUM_DIR)/keymap_common.c \
     $(QUANTUM_DIR)/keycode_config.c \
-    $(QUANTUM_DIR)/process_keycode/process_leader.c
+    $(QUANTUM_DIR)/process_keycode/process_leader.c \
+    $(QUANTUM_DIR)/sequence_trie.c
 
 ifneq ($(SUBPROJECT),)
     SRC += $(SUBPROJECT_C)
@@ -129,6 +130,17 @@ endif
 
 ifndef CUSTOM_MATRIX
     SRC += $(QUANTUM_DIR)/matrix.c
+    DEBOUNCE_TYPE ?= sym_g
+endif
+
+# Custom matrices can also use the debounce algorithms by setting DEBOUNCE_TYPE
+# and calling debounce() from matrix_scan
+VALID_DEBOUNCE_TYPES := sym_g sym_pk eager_pk eager_pr
+ifneq ($(strip $(DEBOUNCE_TYPE)),)
+    ifeq ($(filter $(strip $(DEBOUNCE_TYPE)),$(VALID_DEBOUNCE_TYPES)),)
+        $(error DEBOUNCE_TYPE="$(DEBOUNCE_TYPE)" is not a valid debounce algorithm)
+    endif
+    SRC += $(QUANTUM_DIR)/debounce/$(strip $(DEBOUNCE_TYPE)).c
 endif
 
 ifeq ($(strip $(API_SYSEX_ENABLE)), yes)
@@ -193,6 +205,7 @@ ifeq ($(strip $(UNICODE_ENABLE)), yes)
 endif
 
 ifeq ($(strip $(UNICODE_COMMON)), yes)
+    OPT_DEFS += -DUNICODE_COMMON_ENABLE
     SRC += $(QUANTUM_DIR)/process_keycode/process_unicode_common.c
 endif
 
@@ -251,6 +264,21 @@ ifeq ($(strip $(LED_TABLES)), yes)
     SRC += $(QUANTUM_DIR)/led_tables.c
 endif
 
+ifeq ($(strip $(DYNAMIC_KEYMAP_ENABLE)), yes)
+    ifeq ($(strip $(COMPILED_KEYMAP_ENABLE)), yes)
+        $(error DYNAMIC_KEYMAP_ENABLE and COMPILED_KEYMAP_ENABLE can't be used together)
+    endif
+    OPT_DEFS += -DDYNAMIC_KEYMAP_ENABLE
+    SRC += $(QUANTUM_DIR)/dynamic_keymap.c
+endif
+
+ifeq ($(strip $(COMPILED_KEYMAP_ENABLE)), yes)
+    OPT_DEFS += -DCOMPILED_KEYMAP
+    COMPILED_KEYMAP_C := $(KEYMAP_OUTPUT)/keymap_compiled.c
+    COMPILED_KEYMAP_OBJ := $(KEYMAP_OUTPUT)/$(KEYMAP_C:.c=.o) $(KEYMAP_OUTPUT)/$(QUANTUM_DIR)/keymap_common.o
+    SRC += $(COMPILED_KEYMAP_C)
+endif
+
 # Optimize size but this may cause error "relocation truncated to fit"
 #EXTRALDFLAGS = -Wl,--relax
 
@@ -305,3 +333,7 @@ build: elf hex
 
 include $(TMK_PATH)/rules.mk
 
+ifeq ($(strip $(COMPILED_KEYMAP_ENABLE)), yes)
+    include $(QUANTUM_PATH)/keymap_compiled.mk
+endif
+
@@ -43,13 +43,35 @@ VPATH += $(COMMON_VPATH)
 
 include $(TMK_PATH)/common.mk
 include $(QUANTUM_PATH)/serial_link/tests/rules.mk
+include $(TOP_DIR)/keyboards/lets_split/tests/rules.mk
+include $(TEST_PATH)/rules.mk
+
+# <test>_bench is <test> with its benchmarks, see BENCH_LIST in testlist.mk
+ifneq ($(filter %_bench,$(TEST)),)
+    BENCH_OF := $(patsubst %_bench,%,$(TEST))
+    $(TEST)_SRC := $($(BENCH_OF)_SRC)
+    $(TEST)_DEFS := $($(BENCH_OF)_DEFS) -DBENCHMARK
+    $(TEST)_INC := $($(BENCH_OF)_INC)
+    $(TEST)_CONFIG := $($(BENCH_OF)_CONFIG)
+endif
+
+# tests of the keymap compiler compile their keymap.c
+ifneq ($(filter -DCOMPILED_KEYMAP,$($(TEST)_DEFS)),)
+    COMPILED_KEYMAP_C := $(TEST_OBJ)/$(TEST)/keymap_compiled.c
+    COMPILED_KEYMAP_OBJ := $(patsubst %.c,$(TEST_OBJ)/$(TEST)/%.o,$(filter %/keymap.c,$($(TEST)_SRC)) $(QUANTUM_PATH)/keymap_common.c)
+    $(TEST)_SRC += $(COMPILED_KEYMAP_C)
+endif
 
 $(TEST_OBJ)/$(TEST)_SRC := $($(TEST)_SRC)
 $(TEST_OBJ)/$(TEST)_INC := $($(TEST)_INC) $(VPATH) $(GTEST_INC)
 $(TEST_OBJ)/$(TEST)_DEFS := $($(TEST)_DEFS)
+$(TEST_OBJ)/$(TEST)_CONFIG := $($(TEST)_CONFIG)
 
 include $(TMK_PATH)/native.mk
 include $(TMK_PATH)/rules.mk
+ifdef COMPILED_KEYMAP_C
+    include $(QUANTUM_PATH)/keymap_compiled.mk
+endif
 
 
 $(shell mkdir -p $(BUILD_DIR)/test 2>/dev/null)
@@ -11,6 +11,8 @@ QUANTUM_PATH = $(TOP_DIR)/$(QUANTUM_DIR)
 
 BUILD_DIR := $(TOP_DIR)/.build
 
+TEST_PATH := $(TOP_DIR)/tests
+
 SERIAL_DIR := $(QUANTUM_DIR)/serial_link
 SERIAL_PATH := $(QUANTUM_PATH)/serial_link
 SERIAL_SRC := $(wildcard $(SERIAL_PATH)/protocol/*.c)
@@ -35,6 +35,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef USE_I2C
 #  include "i2c.h"
 #else // USE_SERIAL
+#  include <util/atomic.h>
 #  include "serial.h"
 #endif
 
@@ -187,8 +188,9 @@ i2c_error: // the cable is disconnceted, or something else went wrong
 int serial_transaction(void) {
     int slaveOffset = (isLeftHand) ? (ROWS_PER_HAND) : 0;
 
-    if (serial_update_buffers()) {
-        return 1;
+    int ret = serial_update_buffers();
+    if (ret) {
+        return ret;
     }
 
     for (int i = 0; i < ROWS_PER_HAND; ++i) {
@@ -204,11 +206,13 @@ uint8_t matrix_scan(void)
 
 
 
+    // Negative while the transaction is still running in the background
 #ifdef USE_I2C
-    if( i2c_transaction() ) {
+    int err = i2c_transaction();
 #else // USE_SERIAL
-    if( serial_transaction() ) {
+    int err = serial_transaction();
 #endif
+    if( err > 0 ) {
         // turn on the indicator led when halves are disconnected
         TXLED1;
 
@@ -221,7 +225,7 @@ uint8_t matrix_scan(void)
                 matrix[slaveOffset+i] = 0;
             }
         }
-    } else {
+    } else if( err == 0 ) {
         // turn off the indicator led on no error
         TXLED0;
         error_count = 0;
@@ -241,8 +245,11 @@ void matrix_slave_scan(void) {
         i2c_slave_buffer[i] = matrix[offset+i];
     }
 #else // USE_SERIAL
-    for (int i = 0; i < ROWS_PER_HAND; ++i) {
-        serial_slave_buffer[i] = matrix[offset+i];
+    // All rows at once, a transaction starting in between would send a mix
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for (int i = 0; i < ROWS_PER_HAND; ++i) {
+            serial_slave_buffer[i] = matrix[offset+i];
+        }
     }
 #endif
 }
@@ -2,6 +2,7 @@ SRC += matrix.c \
 	   i2c.c \
 	   split_util.c \
 	   serial.c \
+	   serial_protocol.c \
 	   ssd1306.c
 
 # MCU name
@@ -1,5 +1,8 @@
 /*
- * WARNING: be careful changing this code, it is very timing dependent
+ * The transactions run in the background from a timer compare interrupt,
+ * once per bit, and the INT0 interrupt synchronizes the receiver to the start
+ * bits. The timer only runs during a transaction. See serial_protocol.h for
+ * the protocol itself.
  */
 
 #ifndef F_CPU
@@ -8,26 +11,62 @@
 
 #include <avr/io.h>
 #include <avr/interrupt.h>
-#include <util/delay.h>
 #include <stdbool.h>
 #include "serial.h"
+#include "serial_protocol.h"
 
 #ifdef USE_SERIAL
 
-// Serial pulse period in microseconds. Its probably a bad idea to lower this
-// value.
+// Timer1, unless the backlight or the sleep LED use it, then Timer3 like audio
+#if defined(BACKLIGHT_ENABLE) || defined(SLEEP_LED_ENABLE)
+#  ifdef AUDIO_ENABLE
+#    error "The serial communication needs Timer1 or Timer3, but the backlight or sleep LED and audio use both"
+#  endif
+#  define SERIAL_TCCRA   TCCR3A
+#  define SERIAL_TCCRB   TCCR3B
+#  define SERIAL_WGM2    WGM32
+#  define SERIAL_CS0     CS30
+#  define SERIAL_TCNT    TCNT3
+#  define SERIAL_OCRA    OCR3A
+#  define SERIAL_TIFR    TIFR3
+#  define SERIAL_OCFA    OCF3A
+#  define SERIAL_TIMSK   TIMSK3
+#  define SERIAL_OCIEA   OCIE3A
+#  define SERIAL_TIMER_vect TIMER3_COMPA_vect
+#else
+#  define SERIAL_TCCRA   TCCR1A
+#  define SERIAL_TCCRB   TCCR1B
+#  define SERIAL_WGM2    WGM12
+#  define SERIAL_CS0     CS10
+#  define SERIAL_TCNT    TCNT1
+#  define SERIAL_OCRA    OCR1A
+#  define SERIAL_TIFR    TIFR1
+#  define SERIAL_OCFA    OCF1A
+#  define SERIAL_TIMSK   TIMSK1
+#  define SERIAL_OCIEA   OCIE1A
+#  define SERIAL_TIMER_vect TIMER1_COMPA_vect
+#endif
+
+// Serial bit period in microseconds. The timer interrupt runs once per bit,
+// so lowering this increases the CPU load during a transaction.
+#ifndef SERIAL_DELAY
 #define SERIAL_DELAY 24
+#endif
+
+#define SERIAL_TIMER_TOP ((F_CPU / 1000000) * SERIAL_DELAY - 1)
 
 uint8_t volatile serial_slave_buffer[SERIAL_SLAVE_BUFFER_LENGTH] = {0};
 uint8_t volatile serial_master_buffer[SERIAL_MASTER_BUFFER_LENGTH] = {0};
 
-#define SLAVE_DATA_CORRUPT (1<<0)
-volatile uint8_t status = 0;
+#if SERIAL_SLAVE_BUFFER_LENGTH > SERIAL_MASTER_BUFFER_LENGTH
+static uint8_t recv_scratch[SERIAL_SLAVE_BUFFER_LENGTH];
+static uint8_t send_latch[SERIAL_SLAVE_BUFFER_LENGTH];
+#else
+static uint8_t recv_scratch[SERIAL_MASTER_BUFFER_LENGTH];
+static uint8_t send_latch[SERIAL_MASTER_BUFFER_LENGTH];
+#endif
 
-inline static
-void serial_delay(void) {
-  _delay_us(SERIAL_DELAY);
-}
+static serial_protocol_t protocol;
 
 inline static
 void serial_output(void) {
@@ -56,173 +95,118 @@ void serial_high(void) {
   SERIAL_PIN_PORT |= SERIAL_PIN_MASK;
 }
 
-void serial_master_init(void) {
-  serial_output();
-  serial_high();
-}
-
-void serial_slave_init(void) {
-  serial_input();
-
-  // Enable INT0
-  EIMSK |= _BV(INT0);
-  // Trigger on falling edge of INT0
-  EICRA &= ~(_BV(ISC00) | _BV(ISC01));
+inline static
+void timer_start(uint16_t count) {
+  SERIAL_TCNT = count;
+  SERIAL_TIFR = _BV(SERIAL_OCFA);
+  SERIAL_TCCRB = _BV(SERIAL_WGM2) | _BV(SERIAL_CS0);
 }
 
-// Used by the master to synchronize timing with the slave.
-static
-void sync_recv(void) {
-  serial_input();
-  // This shouldn't hang if the slave disconnects because the
-  // serial line will float to high if the slave does disconnect.
-  while (!serial_read_pin());
-  serial_delay();
+inline static
+void timer_stop(void) {
+  SERIAL_TCCRB = _BV(SERIAL_WGM2);
 }
 
-// Used by the slave to send a synchronization signal to the master.
 static
-void sync_send(void) {
-  serial_output();
-
-  serial_low();
-  serial_delay();
-
-  serial_high();
-}
+void serial_apply(uint8_t action) {
+  switch (action & SERIAL_LINE_MASK) {
+    case SERIAL_LINE_LOW:
+      serial_low();
+      serial_output();
+      break;
+    case SERIAL_LINE_HIGH:
+      serial_high();
+      serial_output();
+      break;
+    default:
+      serial_input();
+      break;
+  }
 
-// Reads a byte from the serial line
-static
-uint8_t serial_read_byte(void) {
-  uint8_t byte = 0;
-  serial_input();
-  for ( uint8_t i = 0; i < 8; ++i) {
-    byte = (byte << 1) | serial_read_pin();
-    serial_delay();
-    _delay_us(1);
+  if (action & SERIAL_WAIT_EDGE) {
+    // Only forget old edges when starting to wait, not on every bit
+    if (!(EIMSK & _BV(INT0))) {
+      EIFR = _BV(INTF0);
+      EIMSK |= _BV(INT0);
+    }
+  } else {
+    EIMSK &= ~_BV(INT0);
   }
 
-  return byte;
+  if (action & SERIAL_STOP) {
+    timer_stop();
+  }
 }
 
-// Sends a byte with MSB ordering
 static
-void serial_write_byte(uint8_t data) {
-  uint8_t b = 8;
-  serial_output();
-  while( b-- ) {
-    if(data & (1 << b)) {
-      serial_high();
-    } else {
-      serial_low();
-    }
-    serial_delay();
+void serial_init(bool master) {
+  protocol.master = master;
+  if (master) {
+    protocol.send_buffer = serial_master_buffer;
+    protocol.send_length = SERIAL_MASTER_BUFFER_LENGTH;
+    protocol.recv_buffer = serial_slave_buffer;
+    protocol.recv_length = SERIAL_SLAVE_BUFFER_LENGTH;
+  } else {
+    protocol.send_buffer = serial_slave_buffer;
+    protocol.send_length = SERIAL_SLAVE_BUFFER_LENGTH;
+    protocol.recv_buffer = serial_master_buffer;
+    protocol.recv_length = SERIAL_MASTER_BUFFER_LENGTH;
   }
-}
+  protocol.send_latch = send_latch;
+  protocol.recv_scratch = recv_scratch;
 
-// interrupt handle to be used by the slave device
-ISR(SERIAL_PIN_INTERRUPT) {
-  sync_send();
+  // CTC mode with the clock stopped
+  SERIAL_TCCRA = 0;
+  SERIAL_TCCRB = _BV(SERIAL_WGM2);
+  SERIAL_OCRA = SERIAL_TIMER_TOP;
+  SERIAL_TIMSK |= _BV(SERIAL_OCIEA);
 
-  uint8_t checksum = 0;
-  for (int i = 0; i < SERIAL_SLAVE_BUFFER_LENGTH; ++i) {
-    serial_write_byte(serial_slave_buffer[i]);
-    sync_send();
-    checksum += serial_slave_buffer[i];
-  }
-  serial_write_byte(checksum);
-  sync_send();
+  // Trigger INT0 on the falling edge
+  EICRA = (EICRA & ~_BV(ISC00)) | _BV(ISC01);
 
-  // wait for the sync to finish sending
-  serial_delay();
+  serial_apply(serial_protocol_init(&protocol));
+}
 
-  // read the middle of pulses
-  _delay_us(SERIAL_DELAY/2);
+void serial_master_init(void) {
+  serial_init(true);
+}
 
-  uint8_t checksum_computed = 0;
-  for (int i = 0; i < SERIAL_MASTER_BUFFER_LENGTH; ++i) {
-    serial_master_buffer[i] = serial_read_byte();
-    sync_send();
-    checksum_computed += serial_master_buffer[i];
-  }
-  uint8_t checksum_received = serial_read_byte();
-  sync_send();
+void serial_slave_init(void) {
+  serial_init(false);
+}
 
-  serial_input(); // end transaction
+ISR(SERIAL_TIMER_vect) {
+  serial_apply(serial_protocol_tick(&protocol, serial_read_pin()));
+}
 
-  if ( checksum_computed != checksum_received ) {
-    status |= SLAVE_DATA_CORRUPT;
-  } else {
-    status &= ~SLAVE_DATA_CORRUPT;
-  }
+ISR(SERIAL_PIN_INTERRUPT) {
+  // Sample in the middle of the bits
+  timer_start(SERIAL_TIMER_TOP / 2);
+  serial_apply(serial_protocol_edge(&protocol));
 }
 
-inline
-bool serial_slave_DATA_CORRUPT(void) {
-  return status & SLAVE_DATA_CORRUPT;
+bool serial_slave_data_corrupt(void) {
+  return !protocol.recv_ok;
 }
 
-// Copies the serial_slave_buffer to the master and sends the
-// serial_master_buffer to the slave.
+// Starts a new transaction, which copies the serial_slave_buffer to the
+// master and sends the serial_master_buffer to the slave, unless the
+// previous one is still running.
 //
 // Returns:
-// 0 => no error
-// 1 => slave did not respond
+// SERIAL_BUSY  => the previous transaction is still running
+// SERIAL_OK    => the previous transaction finished without errors
+// SERIAL_ERROR => slave did not respond or the data was corrupt
 int serial_update_buffers(void) {
-  // this code is very time dependent, so we need to disable interrupts
-  cli();
-
-  // signal to the slave that we want to start a transaction
-  serial_output();
-  serial_low();
-  _delay_us(1);
-
-  // wait for the slaves response
-  serial_input();
-  serial_high();
-  _delay_us(SERIAL_DELAY);
-
-  // check if the slave is present
-  if (serial_read_pin()) {
-    // slave failed to pull the line low, assume not present
-    sei();
-    return 1;
+  // The timer is stopped when idle, so there's no race with the interrupts
+  if (!serial_protocol_idle(&protocol)) {
+    return SERIAL_BUSY;
   }
-
-  // if the slave is present syncronize with it
-  sync_recv();
-
-  uint8_t checksum_computed = 0;
-  // receive data from the slave
-  for (int i = 0; i < SERIAL_SLAVE_BUFFER_LENGTH; ++i) {
-    serial_slave_buffer[i] = serial_read_byte();
-    sync_recv();
-    checksum_computed += serial_slave_buffer[i];
-  }
-  uint8_t checksum_received = serial_read_byte();
-  sync_recv();
-
-  if (checksum_computed != checksum_received) {
-    sei();
-    return 1;
-  }
-
-  uint8_t checksum = 0;
-  // send data to the slave
-  for (int i = 0; i < SERIAL_MASTER_BUFFER_LENGTH; ++i) {
-    serial_write_byte(serial_master_buffer[i]);
-    sync_recv();
-    checksum += serial_master_buffer[i];
-  }
-  serial_write_byte(checksum);
-  sync_recv();
-
-  // always, release the line when not in use
-  serial_output();
+  int result = serial_protocol_start(&protocol);
   serial_high();
-
-  sei();
-  return 0;
+  serial_output();
+  timer_start(0);
+  return result;
 }
 
 #endif
@@ -3,6 +3,7 @@
 
 #include "config.h"
 #include <stdbool.h>
+#include "serial_protocol.h"
 
 /* TODO:  some defines for interrupt setup */
 #define SERIAL_PIN_DDR DDRD
@@ -20,6 +21,7 @@ extern volatile uint8_t serial_master_buffer[SERIAL_MASTER_BUFFER_LENGTH];
 
 void serial_master_init(void);
 void serial_slave_init(void);
+// Non-blocking, see serial.c for the return values
 int serial_update_buffers(void);
 bool serial_slave_data_corrupt(void);
 
@@ -0,0 +1,205 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "serial_protocol.h"
+
+enum {
+  STATE_IDLE,
+  STATE_SEND,
+  STATE_SEND_DONE,
+  STATE_RECV_WAIT,
+  STATE_RECV,
+  // The slave waits a bit for the master to release the line
+  STATE_TURNAROUND,
+  // Waits for the line to be idle before the next transaction
+  STATE_SYNC,
+};
+
+static uint8_t idle_action(serial_protocol_t* protocol) {
+  protocol->state = STATE_IDLE;
+  if (protocol->master) {
+    return SERIAL_LINE_RELEASE | SERIAL_STOP;
+  }
+  return SERIAL_LINE_RELEASE | SERIAL_WAIT_EDGE | SERIAL_STOP;
+}
+
+// The line is only driven while sending, and the other half can still be
+// sending after an error, so always wait for it to be quiet
+static uint8_t sync(serial_protocol_t* protocol) {
+  protocol->state = STATE_SYNC;
+  protocol->counter = 0;
+  protocol->sync_ticks = 0;
+  return SERIAL_LINE_RELEASE;
+}
+
+static uint8_t start_send(serial_protocol_t* protocol) {
+  protocol->state = STATE_SEND;
+  protocol->bit = 0;
+  protocol->index = 0;
+  protocol->checksum = 0;
+  for (uint8_t i = 0; i < protocol->send_length; i++) {
+    protocol->send_latch[i] = protocol->send_buffer[i];
+  }
+  return SERIAL_LINE_HIGH;
+}
+
+static uint8_t start_recv(serial_protocol_t* protocol, uint8_t timeout) {
+  protocol->state = STATE_RECV_WAIT;
+  protocol->index = 0;
+  protocol->checksum = 0;
+  protocol->counter = timeout;
+  return SERIAL_LINE_RELEASE | SERIAL_WAIT_EDGE;
+}
+
+// Ends the transaction, the master with the result, the slave by replying
+static uint8_t finish(serial_protocol_t* protocol, bool ok) {
+  if (protocol->master) {
+    protocol->result = ok ? SERIAL_OK : SERIAL_ERROR;
+    return sync(protocol);
+  }
+  protocol->recv_ok = ok;
+  protocol->state = STATE_TURNAROUND;
+  return SERIAL_LINE_RELEASE;
+}
+
+// The transaction was not received correctly
+static uint8_t fail(serial_protocol_t* protocol) {
+  if (protocol->master) {
+    return finish(protocol, false);
+  }
+  protocol->recv_ok = false;
+  return sync(protocol);
+}
+
+uint8_t serial_protocol_init(serial_protocol_t* protocol) {
+  protocol->result = SERIAL_BUSY;
+  protocol->recv_ok = false;
+  return idle_action(protocol);
+}
+
+bool serial_protocol_idle(serial_protocol_t* protocol) {
+  return protocol->state == STATE_IDLE;
+}
+
+int8_t serial_protocol_start(serial_protocol_t* protocol) {
+  int8_t result = protocol->result;
+  protocol->result = SERIAL_BUSY;
+  start_send(protocol);
+  return result;
+}
+
+static uint8_t tick_send(serial_protocol_t* protocol) {
+  uint8_t bit = protocol->bit++;
+  if (bit == 0) {
+    if (protocol->index < protocol->send_length) {
+      protocol->data = protocol->send_latch[protocol->index];
+      protocol->checksum += protocol->data;
+    } else {
+      protocol->data = protocol->checksum;
+    }
+    return SERIAL_LINE_LOW;
+  } else if (bit <= 8) {
+    uint8_t line = protocol->data & 1 ? SERIAL_LINE_HIGH : SERIAL_LINE_LOW;
+    protocol->data >>= 1;
+    return line;
+  } else {
+    protocol->bit = 0;
+    if (protocol->index++ == protocol->send_length) {
+      protocol->state = STATE_SEND_DONE;
+    }
+    return SERIAL_LINE_HIGH;
+  }
+}
+
+static uint8_t tick_recv(serial_protocol_t* protocol, bool line) {
+  uint8_t bit = protocol->bit++;
+  if (bit == 0) {
+    if (line) {
+      // Just a glitch, not a start bit
+      protocol->state = STATE_RECV_WAIT;
+      protocol->counter = SERIAL_BYTE_TIMEOUT;
+      return SERIAL_LINE_RELEASE | SERIAL_WAIT_EDGE;
+    }
+    return SERIAL_LINE_RELEASE;
+  } else if (bit <= 8) {
+    protocol->data = (protocol->data >> 1) | (line ? 0x80 : 0);
+    return SERIAL_LINE_RELEASE;
+  }
+  if (!line) {
+    // No stop bit, so the framing is wrong
+    return fail(protocol);
+  }
+  if (protocol->index < protocol->recv_length) {
+    protocol->recv_scratch[protocol->index++] = protocol->data;
+    protocol->checksum += protocol->data;
+    protocol->state = STATE_RECV_WAIT;
+    protocol->counter = SERIAL_BYTE_TIMEOUT;
+    return SERIAL_LINE_RELEASE | SERIAL_WAIT_EDGE;
+  }
+  if (protocol->data != protocol->checksum) {
+    return finish(protocol, false);
+  }
+  for (uint8_t i = 0; i < protocol->recv_length; i++) {
+    protocol->recv_buffer[i] = protocol->recv_scratch[i];
+  }
+  return finish(protocol, true);
+}
+
+uint8_t serial_protocol_tick(serial_protocol_t* protocol, bool line) {
+  switch (protocol->state) {
+    case STATE_SEND:
+      return tick_send(protocol);
+    case STATE_SEND_DONE:
+      if (protocol->master) {
+        return start_recv(protocol, SERIAL_REPLY_TIMEOUT);
+      }
+      return idle_action(protocol);
+    case STATE_RECV_WAIT:
+      if (--protocol->counter == 0) {
+        if (!protocol->master && protocol->index == 0) {
+          return idle_action(protocol);
+        }
+        return fail(protocol);
+      }
+      return SERIAL_LINE_RELEASE | SERIAL_WAIT_EDGE;
+    case STATE_RECV:
+      return tick_recv(protocol, line);
+    case STATE_TURNAROUND:
+      return start_send(protocol);
+    case STATE_SYNC:
+      protocol->counter = line ? protocol->counter + 1 : 0;
+      if (protocol->counter >= SERIAL_IDLE_BITS ||
+          ++protocol->sync_ticks >= SERIAL_SYNC_TIMEOUT) {
+        return idle_action(protocol);
+      }
+      return SERIAL_LINE_RELEASE;
+    default:
+      return idle_action(protocol);
+  }
+}
+
+uint8_t serial_protocol_edge(serial_protocol_t* protocol) {
+  if (protocol->state == STATE_IDLE && !protocol->master) {
+    // The start of a transaction
+    protocol->index = 0;
+    protocol->checksum = 0;
+  } else if (protocol->state != STATE_RECV_WAIT) {
+    return SERIAL_LINE_RELEASE;
+  }
+  protocol->state = STATE_RECV;
+  protocol->bit = 0;
+  return SERIAL_LINE_RELEASE;
+}
@@ -0,0 +1,98 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERIAL_PROTOCOL_H
+#define SERIAL_PROTOCOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * The hardware independent part of the split keyboard serial protocol.
+ *
+ * The bytes are sent like on a UART, a low start bit, 8 data bits LSB first,
+ * and a high stop bit. A transaction starts with the master sending its
+ * buffer followed by a checksum, the slave then replies with its own buffer
+ * and checksum. The receiver synchronizes to the falling edge of every start
+ * bit, so only the bit period needs to match between the halves.
+ *
+ * The hardware calls serial_protocol_tick once per bit period, and
+ * serial_protocol_edge on a falling edge of the line, after restarting the
+ * bit timer so that the next tick is in the middle of the bit. It then applies
+ * the returned action.
+ */
+
+// The line state, released means an input with pull-up
+#define SERIAL_LINE_RELEASE 0
+#define SERIAL_LINE_LOW     1
+#define SERIAL_LINE_HIGH    2
+#define SERIAL_LINE_MASK    3
+// Report the next falling edge of the line, the ticks continue for timeouts
+#define SERIAL_WAIT_EDGE    4
+// Stop the ticks until the next transaction, or edge if waiting for one
+#define SERIAL_STOP         8
+
+// Bit periods the master waits for the slave to reply
+#define SERIAL_REPLY_TIMEOUT 4
+// Bit periods a receiver waits for the next byte of a transaction
+#define SERIAL_BYTE_TIMEOUT 3
+// Bit periods the line has to be idle between transactions, more than a byte,
+// so that a half that lost track of the framing can find the next transaction
+#define SERIAL_IDLE_BITS 12
+// Bit periods to wait for the idle line before giving up, so that the ticks
+// stop when the line is stuck low, e.g. by an unpowered other half
+#define SERIAL_SYNC_TIMEOUT 200
+
+#define SERIAL_BUSY (-1)
+#define SERIAL_OK 0
+#define SERIAL_ERROR 1
+
+typedef struct {
+  bool master;
+  volatile uint8_t* send_buffer;
+  uint8_t send_length;
+  volatile uint8_t* recv_buffer;
+  uint8_t recv_length;
+  // The send buffer as it was at the start of the transaction, so that
+  // the other half gets one snapshot and not bytes from different updates
+  uint8_t* send_latch;
+  // Holds the received data until the checksum has been verified
+  uint8_t* recv_scratch;
+
+  uint8_t state;
+  uint8_t bit;
+  uint8_t data;
+  uint8_t index;
+  uint8_t checksum;
+  uint8_t counter;
+  uint8_t sync_ticks;
+  // The result of the last finished transaction, SERIAL_BUSY if none
+  int8_t result;
+  // The master data was received without errors by the slave
+  bool recv_ok;
+} serial_protocol_t;
+
+// Returns the action for the idle line
+uint8_t serial_protocol_init(serial_protocol_t* protocol);
+bool serial_protocol_idle(serial_protocol_t* protocol);
+// Starts a master transaction, which must be idle. The first tick, a full
+// bit period later, sends the start bit.
+// Returns the result of the previous transaction since the last call.
+int8_t serial_protocol_start(serial_protocol_t* protocol);
+uint8_t serial_protocol_tick(serial_protocol_t* protocol, bool line);
+uint8_t serial_protocol_edge(serial_protocol_t* protocol);
+
+#endif
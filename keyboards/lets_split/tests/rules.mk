@@ -0,0 +1,5 @@
+LETS_SPLIT_PATH := $(TOP_DIR)/keyboards/lets_split
+
+lets_split_serial_SRC := \
+	$(LETS_SPLIT_PATH)/tests/serial_protocol_tests.cpp \
+	$(LETS_SPLIT_PATH)/serial_protocol.c
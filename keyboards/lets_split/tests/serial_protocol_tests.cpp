@@ -0,0 +1,360 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <iostream>
+#include <random>
+#include <vector>
+extern "C" {
+#include "keyboards/lets_split/serial_protocol.h"
+}
+
+// Simulates the single wire between the halves. Each half has its own bit
+// timer, an edge interrupt with some latency, and the line is pulled high
+// when neither half drives it.
+
+static const double BIT_TIME = 24.0;
+static const double EDGE_LATENCY = 3.0;
+
+struct Half {
+    serial_protocol_t protocol;
+    uint8_t drive;
+    bool connected;
+    bool ticking;
+    double period;
+    double next_tick;
+    bool edge_armed;
+    bool edge_pending;
+    double edge_time;
+    int interrupts;
+    // Inverts the samples of the line with this probability
+    double noise;
+    std::vector<uint8_t> send;
+    std::vector<uint8_t> recv;
+    std::vector<uint8_t> latch;
+    std::vector<uint8_t> scratch;
+};
+
+class LetsSplitSerial : public testing::Test {
+public:
+    LetsSplitSerial() :
+        random(42),
+        now(0),
+        contention(false),
+        stuck_low(false)
+    {
+        init_half(master, true, 1, 4);
+        init_half(slave, false, 4, 1);
+        for (uint8_t i = 0; i < 4; i++) {
+            slave.send[i] = 0x10 + i;
+        }
+        master.send[0] = 0x5A;
+    }
+
+    void init_half(Half& half, bool is_master, uint8_t send_length, uint8_t recv_length) {
+        half.send.assign(send_length, 0);
+        half.recv.assign(recv_length, 0);
+        half.latch.assign(send_length, 0);
+        half.scratch.assign(recv_length, 0);
+        half.protocol.master = is_master;
+        half.protocol.send_buffer = half.send.data();
+        half.protocol.send_length = send_length;
+        half.protocol.recv_buffer = half.recv.data();
+        half.protocol.recv_length = recv_length;
+        half.protocol.send_latch = half.latch.data();
+        half.protocol.recv_scratch = half.scratch.data();
+        half.connected = true;
+        half.ticking = false;
+        half.period = BIT_TIME;
+        half.edge_armed = false;
+        half.edge_pending = false;
+        half.interrupts = 0;
+        half.noise = 0;
+        apply(half, serial_protocol_init(&half.protocol));
+    }
+
+    bool line() {
+        bool high = false;
+        bool low = false;
+        for (Half* half : {&master, &slave}) {
+            if (half->connected) {
+                high |= half->drive == SERIAL_LINE_HIGH;
+                low |= half->drive == SERIAL_LINE_LOW;
+            }
+        }
+        contention |= high && low;
+        return !low && !stuck_low;
+    }
+
+    void apply(Half& half, uint8_t action) {
+        half.drive = action & SERIAL_LINE_MASK;
+        bool armed = action & SERIAL_WAIT_EDGE;
+        if (!armed) {
+            half.edge_pending = false;
+        }
+        half.edge_armed = armed;
+        if (action & SERIAL_STOP) {
+            half.ticking = false;
+        }
+    }
+
+    // The equivalent of serial_update_buffers
+    int update() {
+        if (!serial_protocol_idle(&master.protocol)) {
+            return SERIAL_BUSY;
+        }
+        int result = serial_protocol_start(&master.protocol);
+        master.drive = SERIAL_LINE_HIGH;
+        master.ticking = true;
+        master.next_tick = now + master.period;
+        return result;
+    }
+
+    void run_until(double end) {
+        while (true) {
+            Half* next = nullptr;
+            bool edge = false;
+            double time = end;
+            for (Half* half : {&master, &slave}) {
+                if (!half->connected) {
+                    continue;
+                }
+                if (half->edge_pending && half->edge_time <= time) {
+                    next = half;
+                    edge = true;
+                    time = half->edge_time;
+                }
+                if (half->ticking && half->next_tick < time) {
+                    next = half;
+                    edge = false;
+                    time = half->next_tick;
+                }
+            }
+            if (!next) {
+                now = end;
+                return;
+            }
+            now = time;
+            bool before = line();
+            next->interrupts++;
+            if (edge) {
+                next->edge_pending = false;
+                next->ticking = true;
+                next->next_tick = now + next->period / 2;
+                apply(*next, serial_protocol_edge(&next->protocol));
+            }
+            else {
+                next->next_tick += next->period;
+                bool sample = line();
+                std::uniform_real_distribution<double> chance(0, 1);
+                if (next->noise > 0 && chance(random) < next->noise) {
+                    sample = !sample;
+                }
+                apply(*next, serial_protocol_tick(&next->protocol, sample));
+            }
+            if (before && !line()) {
+                for (Half* half : {&master, &slave}) {
+                    if (half->connected && half->edge_armed && !half->edge_pending) {
+                        half->edge_pending = true;
+                        half->edge_time = now + EDGE_LATENCY;
+                    }
+                }
+            }
+        }
+    }
+
+    // Lets the running transaction finish, the data changed since it started
+    // goes out with the next one
+    void finish_running() {
+        for (int i = 0; i < 100 && !serial_protocol_idle(&master.protocol); i++) {
+            run_until(now + 250);
+        }
+    }
+
+    // Runs scans until a transaction finishes, and returns its result
+    int transaction() {
+        finish_running();
+        update();
+        for (int i = 0; i < 100; i++) {
+            run_until(now + 250);
+            int result = update();
+            if (result != SERIAL_BUSY) {
+                return result;
+            }
+        }
+        return SERIAL_BUSY;
+    }
+
+    void randomize_data() {
+        for (auto& byte : slave.send) {
+            byte = random();
+        }
+        master.send[0] = random();
+    }
+
+    std::mt19937 random;
+    Half master;
+    Half slave;
+    double now;
+    bool contention;
+    // Something else holds the line low, like an unpowered other half
+    bool stuck_low;
+};
+
+TEST_F(LetsSplitSerial, first_update_starts_a_transaction) {
+    EXPECT_EQ(update(), SERIAL_BUSY);
+    EXPECT_EQ(update(), SERIAL_BUSY);
+    run_until(5000);
+    EXPECT_EQ(update(), SERIAL_OK);
+    EXPECT_EQ(slave.send, master.recv);
+    EXPECT_EQ(master.send, slave.recv);
+    EXPECT_TRUE(slave.protocol.recv_ok);
+    EXPECT_FALSE(contention);
+}
+
+TEST_F(LetsSplitSerial, transfers_random_data) {
+    transaction();
+    for (int i = 0; i < 200; i++) {
+        randomize_data();
+        ASSERT_EQ(transaction(), SERIAL_OK);
+        ASSERT_EQ(slave.send, master.recv);
+        ASSERT_EQ(master.send, slave.recv);
+    }
+    EXPECT_FALSE(contention);
+}
+
+TEST_F(LetsSplitSerial, tolerates_clock_difference) {
+    for (double difference : {-0.03, 0.03}) {
+        slave.period = BIT_TIME * (1 + difference);
+        for (int i = 0; i < 50; i++) {
+            randomize_data();
+            ASSERT_EQ(transaction(), SERIAL_OK) << "with difference " << difference;
+            ASSERT_EQ(slave.send, master.recv);
+        }
+    }
+    EXPECT_FALSE(contention);
+}
+
+TEST_F(LetsSplitSerial, reports_missing_slave) {
+    slave.connected = false;
+    EXPECT_EQ(transaction(), SERIAL_ERROR);
+    EXPECT_EQ(transaction(), SERIAL_ERROR);
+    std::vector<uint8_t> zeros(4, 0);
+    EXPECT_EQ(master.recv, zeros);
+}
+
+TEST_F(LetsSplitSerial, never_accepts_corrupt_data) {
+    slave.noise = 0.002;
+    master.noise = 0.002;
+    int errors = 0;
+    for (int i = 0; i < 1000; i++) {
+        randomize_data();
+        finish_running();
+        std::vector<uint8_t> old_recv = master.recv;
+        int result = transaction();
+        ASSERT_NE(result, SERIAL_BUSY);
+        if (result == SERIAL_OK) {
+            ASSERT_EQ(slave.send, master.recv);
+        }
+        else {
+            errors++;
+            ASSERT_EQ(old_recv, master.recv);
+        }
+    }
+    EXPECT_GT(errors, 0);
+    // And everything works again when the noise stops
+    slave.noise = 0;
+    master.noise = 0;
+    transaction();
+    for (int i = 0; i < 20; i++) {
+        randomize_data();
+        ASSERT_EQ(transaction(), SERIAL_OK);
+        ASSERT_EQ(slave.send, master.recv);
+    }
+    EXPECT_FALSE(contention);
+}
+
+TEST_F(LetsSplitSerial, slave_connected_during_transaction_synchronizes) {
+    for (int offset = 0; offset < 2000; offset += 37) {
+        init_half(slave, false, 4, 1);
+        slave.connected = false;
+        update();
+        run_until(now + offset);
+        slave.connected = true;
+        int ok = 0;
+        for (int i = 0; i < 5; i++) {
+            randomize_data();
+            if (transaction() == SERIAL_OK) {
+                ASSERT_EQ(slave.send, master.recv);
+                ok++;
+            }
+        }
+        ASSERT_GE(ok, 3) << "at offset " << offset;
+        run_until(now + 1000);
+    }
+    EXPECT_FALSE(contention);
+}
+
+TEST_F(LetsSplitSerial, timers_stop_between_transactions) {
+    EXPECT_EQ(transaction(), SERIAL_OK);
+    finish_running();
+    run_until(now + 1000);
+    EXPECT_TRUE(serial_protocol_idle(&master.protocol));
+    EXPECT_FALSE(master.ticking);
+    EXPECT_FALSE(slave.ticking);
+}
+
+TEST_F(LetsSplitSerial, timers_stop_when_the_line_is_stuck_low) {
+    stuck_low = true;
+    EXPECT_EQ(transaction(), SERIAL_ERROR);
+    run_until(now + 2 * SERIAL_SYNC_TIMEOUT * BIT_TIME);
+    EXPECT_FALSE(master.ticking);
+    EXPECT_FALSE(slave.ticking);
+    stuck_low = false;
+    transaction();
+    EXPECT_EQ(transaction(), SERIAL_OK);
+}
+
+TEST_F(LetsSplitSerial, slave_sends_the_buffer_from_the_start_of_its_reply) {
+    transaction();
+    finish_running();
+    std::vector<uint8_t> sent = slave.send;
+    update();
+    // The master byte and checksum, the turnaround and two bytes of the reply
+    run_until(now + 33 * BIT_TIME);
+    for (auto& byte : slave.send) {
+        byte = ~byte;
+    }
+    finish_running();
+    EXPECT_EQ(update(), SERIAL_OK);
+    EXPECT_EQ(master.recv, sent);
+}
+
+#ifdef BENCHMARK
+TEST_F(LetsSplitSerial, benchmark_transaction) {
+    transaction();
+    finish_running();
+    double start = now;
+    int interrupts = master.interrupts;
+    update();
+    while (!serial_protocol_idle(&master.protocol)) {
+        run_until(now + 1);
+    }
+    std::cout << "[ BENCH    ] transaction of " << master.send.size() << "+" << slave.send.size()
+        << " bytes: " << now - start << " us in the background, "
+        << master.interrupts - interrupts << " master interrupts" << std::endl;
+}
+#endif
@@ -0,0 +1,6 @@
+TEST_LIST +=\
+	lets_split_serial
+
+# Opt-in, the same tests with the benchmarks, which print their measurements
+BENCH_LIST +=\
+	lets_split_serial_bench
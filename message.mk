@@ -52,6 +52,7 @@ MSG_LINKING = Linking:
 MSG_COMPILING = Compiling:
 MSG_COMPILING_CPP = Compiling:
 MSG_ASSEMBLING = Assembling:
+MSG_COMPILING_KEYMAP = Compiling keymap:
 MSG_CLEANING = Cleaning project:
 MSG_CREATING_LIBRARY = Creating library:
 MSG_SUBMODULE_DIRTY = $(WARN_COLOR)WARNING:$(NO_COLOR)\n \
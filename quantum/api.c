@@ -43,6 +43,9 @@ bool process_api_user(uint8_t length, uint8_t * data) {
     return true;
 }
 
+/* keycodes in one DT_KEYMAP message */
+#define API_KEYMAP_KEYCODES 16
+
 void process_api(uint16_t length, uint8_t * data) {
     // SEND_STRING("\nRX: ");
     // for (uint8_t i = 0; i < length; i++) {
@@ -71,6 +74,21 @@ void process_api(uint16_t length, uint8_t * data) {
                     #endif
                     break;
                 }
+                case DT_KEYMAP: {
+                    // answered with the keycodes read back, by MT_GET_DATA below
+                    #ifdef DYNAMIC_KEYMAP_ENABLE
+                        uint16_t offset = (data[2] << 8) | data[3];
+                        uint16_t keycodes[API_KEYMAP_KEYCODES];
+                        uint8_t count = data[4] < API_KEYMAP_KEYCODES ? data[4] : API_KEYMAP_KEYCODES;
+                        if (length < 5 + 2 * count)
+                            break;
+                        for (uint8_t i = 0; i < count; i++) {
+                            keycodes[i] = (data[5 + 2 * i] << 8) | data[5 + 2 * i + 1];
+                        }
+                        dynamic_keymap_write(offset, count, keycodes);
+                    #endif
+                    break;
+                }
             }
         case MT_GET_DATA:
             switch (data[1]) {
@@ -79,12 +97,12 @@ void process_api(uint16_t length, uint8_t * data) {
                     break;
                 }
                 case DT_DEBUG: {
-                    uint8_t debug_bytes[1] = { eeprom_read_byte(EECONFIG_DEBUG) };
+                    uint8_t debug_bytes[1] = { eeconfig_read_debug() };
                     MT_GET_DATA_ACK(DT_DEBUG, debug_bytes, 1);
                     break;
                 }
                 case DT_DEFAULT_LAYER: {
-                    uint8_t default_bytes[1] = { eeprom_read_byte(EECONFIG_DEFAULT_LAYER) };
+                    uint8_t default_bytes[1] = { eeconfig_read_default_layer() };
                     MT_GET_DATA_ACK(DT_DEFAULT_LAYER, default_bytes, 1);
                     break;
                 }
@@ -96,7 +114,7 @@ void process_api(uint16_t length, uint8_t * data) {
                 }
                 case DT_AUDIO: {
                     #ifdef AUDIO_ENABLE
-                        uint8_t audio_bytes[1] = { eeprom_read_byte(EECONFIG_AUDIO) };
+                        uint8_t audio_bytes[1] = { eeconfig_read_audio() };
                         MT_GET_DATA_ACK(DT_AUDIO, audio_bytes, 1);
                     #else
                         MT_GET_DATA_ACK(DT_AUDIO, NULL, 0);
@@ -105,7 +123,7 @@ void process_api(uint16_t length, uint8_t * data) {
                 }
                 case DT_BACKLIGHT: {
                     #ifdef BACKLIGHT_ENABLE
-                        uint8_t backlight_bytes[1] = { eeprom_read_byte(EECONFIG_BACKLIGHT) };
+                        uint8_t backlight_bytes[1] = { eeconfig_read_backlight() };
                         MT_GET_DATA_ACK(DT_BACKLIGHT, backlight_bytes, 1);
                     #else
                         MT_GET_DATA_ACK(DT_BACKLIGHT, NULL, 0);
@@ -132,29 +150,26 @@ void process_api(uint16_t length, uint8_t * data) {
                     MT_GET_DATA_ACK(DT_KEYMAP_SIZE, keymap_size, 2);
                     break;
                 }
-                // This may be too much
-                // case DT_KEYMAP: {
-                //     uint8_t keymap_data[MATRIX_ROWS * MATRIX_COLS * 4 + 3];
-                //     keymap_data[0] = data[2];
-                //     keymap_data[1] = MATRIX_ROWS;
-                //     keymap_data[2] = MATRIX_COLS;
-                //     for (int i = 0; i < MATRIX_ROWS; i++) {
-                //         for (int j = 0; j < MATRIX_COLS; j++) {
-                //             keymap_data[3 + (i*MATRIX_COLS*2) + (j*2)] = pgm_read_word(&keymaps[data[2]][i][j]) >> 8;
-                //             keymap_data[3 + (i*MATRIX_COLS*2) + (j*2) + 1] = pgm_read_word(&keymaps[data[2]][i][j]) & 0xFF;
-                //         }
-                //     }
-                //     MT_GET_DATA_ACK(DT_KEYMAP, keymap_data, MATRIX_ROWS * MATRIX_COLS * 4 + 3);
-                //     // uint8_t keymap_data[5];
-                //     // keymap_data[0] = data[2];
-                //     // keymap_data[1] = data[3];
-                //     // keymap_data[2] = data[4];
-                //     // keymap_data[3] = pgm_read_word(&keymaps[data[2]][data[3]][data[4]]) >> 8;
-                //     // keymap_data[4] = pgm_read_word(&keymaps[data[2]][data[3]][data[4]]) & 0xFF;
-
-                //     // MT_GET_DATA_ACK(DT_KEYMAP, keymap_data, 5);
-                //     break;
-                // }
+                case DT_KEYMAP: {
+                    #ifdef DYNAMIC_KEYMAP_ENABLE
+                        // offset and count of the keycodes, then the keycodes
+                        uint16_t offset = (data[2] << 8) | data[3];
+                        uint16_t keycodes[API_KEYMAP_KEYCODES];
+                        uint8_t keymap_bytes[3 + 2 * API_KEYMAP_KEYCODES];
+                        uint8_t count = dynamic_keymap_read(offset, data[4] < API_KEYMAP_KEYCODES ? data[4] : API_KEYMAP_KEYCODES, keycodes);
+                        keymap_bytes[0] = data[2];
+                        keymap_bytes[1] = data[3];
+                        keymap_bytes[2] = count;
+                        for (uint8_t i = 0; i < count; i++) {
+                            keymap_bytes[3 + 2 * i] = keycodes[i] >> 8;
+                            keymap_bytes[3 + 2 * i + 1] = keycodes[i] & 0xFF;
+                        }
+                        MT_GET_DATA_ACK(DT_KEYMAP, keymap_bytes, 3 + 2 * count);
+                    #else
+                        MT_GET_DATA_ACK(DT_KEYMAP, NULL, 0);
+                    #endif
+                    break;
+                }
                 default:
                     break;
             }
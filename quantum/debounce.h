@@ -0,0 +1,54 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The debounce algorithm is selected in rules.mk with DEBOUNCE_TYPE:
+ *   sym_g    - (default) symmetric, global. The whole matrix is updated once
+ *              no key has changed for DEBOUNCING_DELAY ms.
+ *   sym_pk   - symmetric, per key. A key is updated once it alone has been
+ *              stable for DEBOUNCING_DELAY ms.
+ *   eager_pk - eager press, deferred release, per key. Presses are reported on
+ *              the first scan that sees them, releases only after the key has
+ *              been released for DEBOUNCING_DELAY ms.
+ *   eager_pr - eager, per row. Changes are reported immediately, after which
+ *              the row ignores further changes for DEBOUNCING_DELAY ms.
+ */
+
+/* Reset the debounce state, call before the first debounce() */
+void debounce_init(uint8_t num_rows);
+
+/* Update cooked from raw. changed should be true if raw differs from the
+ * previous scan, but the per key algorithms also work if it's always true. */
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed);
+
+/* true while some change in raw is still waiting to be applied to cooked */
+bool debounce_active(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
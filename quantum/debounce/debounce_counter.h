@@ -0,0 +1,115 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEBOUNCE_COUNTER_H
+#define DEBOUNCE_COUNTER_H
+
+/* Per key down counters stored as bit planes.
+ *
+ * Instead of one counter variable per key, bit n of the counters of all
+ * the keys of a row is stored in plane[n][row]. This way a whole row of
+ * counters is reset, tested and decremented with a few word operations,
+ * and the state only costs DEBOUNCE_PLANES * MATRIX_ROWS words.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix.h"
+#include "timer.h"
+
+#ifndef DEBOUNCING_DELAY
+#   define DEBOUNCING_DELAY 5
+#endif
+
+#if DEBOUNCING_DELAY < 2
+#   define DEBOUNCE_PLANES 1
+#elif DEBOUNCING_DELAY < 4
+#   define DEBOUNCE_PLANES 2
+#elif DEBOUNCING_DELAY < 8
+#   define DEBOUNCE_PLANES 3
+#elif DEBOUNCING_DELAY < 16
+#   define DEBOUNCE_PLANES 4
+#elif DEBOUNCING_DELAY < 32
+#   define DEBOUNCE_PLANES 5
+#elif DEBOUNCING_DELAY < 64
+#   define DEBOUNCE_PLANES 6
+#elif DEBOUNCING_DELAY < 128
+#   define DEBOUNCE_PLANES 7
+#elif DEBOUNCING_DELAY < 256
+#   define DEBOUNCE_PLANES 8
+#else
+#   error "DEBOUNCING_DELAY can't be larger than 255 with per key debouncing"
+#endif
+
+typedef struct {
+    matrix_row_t plane[DEBOUNCE_PLANES][MATRIX_ROWS];
+} debounce_counters_t;
+
+static inline void debounce_counters_init(debounce_counters_t* c) {
+    for (uint8_t p = 0; p < DEBOUNCE_PLANES; p++) {
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            c->plane[p][r] = 0;
+        }
+    }
+}
+
+/* Mask of the keys of the row that have a running counter */
+static inline matrix_row_t debounce_counters_active(debounce_counters_t* c, uint8_t row) {
+    matrix_row_t active = 0;
+    for (uint8_t p = 0; p < DEBOUNCE_PLANES; p++) {
+        active |= c->plane[p][row];
+    }
+    return active;
+}
+
+/* (Re)start the counters of the keys in mask at DEBOUNCING_DELAY */
+static inline void debounce_counters_start(debounce_counters_t* c, uint8_t row, matrix_row_t mask) {
+    for (uint8_t p = 0; p < DEBOUNCE_PLANES; p++) {
+        if (DEBOUNCING_DELAY & (1 << p)) {
+            c->plane[p][row] |= mask;
+        } else {
+            c->plane[p][row] &= ~mask;
+        }
+    }
+}
+
+/* Stop the counters of the keys in mask */
+static inline void debounce_counters_stop(debounce_counters_t* c, uint8_t row, matrix_row_t mask) {
+    for (uint8_t p = 0; p < DEBOUNCE_PLANES; p++) {
+        c->plane[p][row] &= ~mask;
+    }
+}
+
+/* Subtract one from every running counter of the row */
+static inline void debounce_counters_decrement(debounce_counters_t* c, uint8_t row) {
+    matrix_row_t borrow = debounce_counters_active(c, row);
+    for (uint8_t p = 0; p < DEBOUNCE_PLANES && borrow; p++) {
+        matrix_row_t bits = c->plane[p][row];
+        c->plane[p][row] = bits ^ borrow;
+        borrow &= ~bits;
+    }
+}
+
+/* Returns the number of milliseconds the counters should be advanced by
+ * since the last call, capped to DEBOUNCING_DELAY */
+static inline uint8_t debounce_elapsed(uint16_t* last_tick) {
+    uint16_t now = timer_read();
+    uint16_t elapsed = now - *last_tick;
+    *last_tick = now;
+    return elapsed > DEBOUNCING_DELAY ? DEBOUNCING_DELAY : elapsed;
+}
+
+#endif
@@ -0,0 +1,77 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Eager press, deferred release, per key debouncing. A press is reported on
+ * the first scan that sees it, so a clean key press has no added latency.
+ * A release is only reported once the key has stayed released for
+ * DEBOUNCING_DELAY ms, which also hides the bounces that follow a press.
+ */
+
+#include "debounce.h"
+#include "debounce_counter.h"
+
+#if (DEBOUNCING_DELAY > 0)
+/* Only the pending releases have a running counter */
+static debounce_counters_t counters;
+static uint16_t last_tick;
+#endif
+
+void debounce_init(uint8_t num_rows) {
+#if (DEBOUNCING_DELAY > 0)
+    debounce_counters_init(&counters);
+    last_tick = timer_read();
+#endif
+}
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+#if (DEBOUNCING_DELAY > 0)
+    uint8_t elapsed = debounce_elapsed(&last_tick);
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t running = debounce_counters_active(&counters, row);
+        matrix_row_t expired = 0;
+        if (running) {
+            for (uint8_t i = 0; i < elapsed; i++) {
+                debounce_counters_decrement(&counters, row);
+            }
+            expired = running & ~debounce_counters_active(&counters, row);
+            running &= ~expired;
+            // These have been released for long enough
+            cooked[row] &= ~expired;
+        }
+        // A key pressed again in the same scan as its release expired is
+        // reported on the next scan, so that the release isn't lost
+        cooked[row] |= raw[row] & ~expired;
+        // Pressed again before the release was accepted, it was a bounce
+        debounce_counters_stop(&counters, row, running & raw[row]);
+        debounce_counters_start(&counters, row, cooked[row] & ~raw[row] & ~running);
+    }
+#else
+    for (uint8_t row = 0; row < num_rows; row++) {
+        cooked[row] = raw[row];
+    }
+#endif
+}
+
+bool debounce_active(void) {
+#if (DEBOUNCING_DELAY > 0)
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        if (debounce_counters_active(&counters, row)) {
+            return true;
+        }
+    }
+#endif
+    return false;
+}
@@ -0,0 +1,71 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Eager, per row debouncing. A change is reported on the first scan that
+ * sees it, after which the row ignores any further changes for
+ * DEBOUNCING_DELAY ms. Cheaper than per key debouncing, but keys on the
+ * same row can delay each other.
+ */
+
+#include "debounce.h"
+#include "debounce_counter.h"
+
+#if (DEBOUNCING_DELAY > 0)
+static uint8_t row_lockout[MATRIX_ROWS];
+static uint16_t last_tick;
+static bool pending = false;
+#endif
+
+void debounce_init(uint8_t num_rows) {
+#if (DEBOUNCING_DELAY > 0)
+    for (uint8_t row = 0; row < num_rows; row++) {
+        row_lockout[row] = 0;
+    }
+    last_tick = timer_read();
+    pending = false;
+#endif
+}
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+#if (DEBOUNCING_DELAY > 0)
+    uint8_t elapsed = debounce_elapsed(&last_tick);
+    pending = false;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        if (row_lockout[row] > elapsed) {
+            row_lockout[row] -= elapsed;
+            pending |= raw[row] != cooked[row];
+            continue;
+        }
+        row_lockout[row] = 0;
+        if (raw[row] != cooked[row]) {
+            cooked[row] = raw[row];
+            row_lockout[row] = DEBOUNCING_DELAY;
+        }
+    }
+#else
+    for (uint8_t row = 0; row < num_rows; row++) {
+        cooked[row] = raw[row];
+    }
+#endif
+}
+
+bool debounce_active(void) {
+#if (DEBOUNCING_DELAY > 0)
+    return pending;
+#else
+    return false;
+#endif
+}
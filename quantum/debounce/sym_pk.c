@@ -0,0 +1,76 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Symmetric, per key debouncing. Each key has its own counter, which is
+ * restarted every time the key changes. The key is updated when the counter
+ * runs out, so a bouncing key doesn't delay any of the other keys.
+ */
+
+#include "debounce.h"
+#include "debounce_counter.h"
+
+#if (DEBOUNCING_DELAY > 0)
+static debounce_counters_t counters;
+static matrix_row_t last_raw[MATRIX_ROWS];
+static uint16_t last_tick;
+#endif
+
+void debounce_init(uint8_t num_rows) {
+#if (DEBOUNCING_DELAY > 0)
+    debounce_counters_init(&counters);
+    for (uint8_t row = 0; row < num_rows; row++) {
+        last_raw[row] = 0;
+    }
+    last_tick = timer_read();
+#endif
+}
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+#if (DEBOUNCING_DELAY > 0)
+    uint8_t elapsed = debounce_elapsed(&last_tick);
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t running = debounce_counters_active(&counters, row);
+        if (running) {
+            for (uint8_t i = 0; i < elapsed; i++) {
+                debounce_counters_decrement(&counters, row);
+            }
+            // The keys that have been stable for long enough take the value they settled on
+            matrix_row_t expired = running & ~debounce_counters_active(&counters, row);
+            cooked[row] = (cooked[row] & ~expired) | (last_raw[row] & expired);
+        }
+        matrix_row_t bounced = raw[row] ^ last_raw[row];
+        if (bounced) {
+            debounce_counters_start(&counters, row, bounced);
+            last_raw[row] = raw[row];
+        }
+    }
+#else
+    for (uint8_t row = 0; row < num_rows; row++) {
+        cooked[row] = raw[row];
+    }
+#endif
+}
+
+bool debounce_active(void) {
+#if (DEBOUNCING_DELAY > 0)
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        if (debounce_counters_active(&counters, row)) {
+            return true;
+        }
+    }
+#endif
+    return false;
+}
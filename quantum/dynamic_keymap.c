@@ -0,0 +1,220 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "keymap.h"
+#include "eeprom.h"
+#include "action_layer.h"
+#include "dynamic_keymap.h"
+#ifdef RAW_ENABLE
+#   include "raw_hid.h"
+#endif
+
+/* A header with the size the keymap was stored with, then the keycodes */
+#define DYNAMIC_KEYMAP_MAGIC 0xD4E5
+#define EEPROM_MAGIC ((uint16_t *)DYNAMIC_KEYMAP_EEPROM_ADDR)
+#define EEPROM_SIZE_INFO ((uint8_t *)DYNAMIC_KEYMAP_EEPROM_ADDR + 2)
+#define EEPROM_KEYCODES ((uint16_t *)(DYNAMIC_KEYMAP_EEPROM_ADDR + 6))
+
+/* E2END is from avr-libc, or eeprom_size.h on ChibiOS */
+#if defined(E2END) && DYNAMIC_KEYMAP_EEPROM_ADDR + 6 + 2 * DYNAMIC_KEYMAP_KEYCODES > E2END + 1
+#   error "the dynamic keymap doesn't fit in the EEPROM, lower DYNAMIC_KEYMAP_LAYER_COUNT or raise EEPROM_SIZE on a Teensy 3"
+#endif
+
+#define KEYCODE_INDEX(layer, row, col) (((uint16_t)(layer) * MATRIX_ROWS + (row)) * MATRIX_COLS + (col))
+
+#if DYNAMIC_KEYMAP_CACHED_LAYERS > 0
+#define CACHE_EMPTY 0xFF
+static uint16_t cache[DYNAMIC_KEYMAP_CACHED_LAYERS][MATRIX_ROWS][MATRIX_COLS];
+static uint8_t cache_layer[DYNAMIC_KEYMAP_CACHED_LAYERS];
+/* slots from the most to the least recently used */
+static uint8_t cache_order[DYNAMIC_KEYMAP_CACHED_LAYERS];
+
+static void cache_clear(void)
+{
+    for (uint8_t i = 0; i < DYNAMIC_KEYMAP_CACHED_LAYERS; i++) {
+        cache_layer[i] = CACHE_EMPTY;
+        cache_order[i] = i;
+    }
+}
+
+static uint16_t (*cache_get(uint8_t layer))[MATRIX_COLS]
+{
+    if (cache_layer[cache_order[0]] == layer) {
+        return cache[cache_order[0]];
+    }
+    uint8_t i = 0;
+    while (i < DYNAMIC_KEYMAP_CACHED_LAYERS - 1 && cache_layer[cache_order[i]] != layer) {
+        i++;
+    }
+    uint8_t slot = cache_order[i];
+    if (cache_layer[slot] != layer) {
+        // the least recently used slot
+        eeprom_read_block(cache[slot], EEPROM_KEYCODES + KEYCODE_INDEX(layer, 0, 0), sizeof(cache[slot]));
+        cache_layer[slot] = layer;
+    }
+    memmove(cache_order + 1, cache_order, i);
+    cache_order[0] = slot;
+    return cache[slot];
+}
+
+static void cache_update(uint16_t index, uint16_t keycode)
+{
+    uint8_t layer = index / (MATRIX_ROWS * MATRIX_COLS);
+    for (uint8_t i = 0; i < DYNAMIC_KEYMAP_CACHED_LAYERS; i++) {
+        if (cache_layer[i] == layer) {
+            cache[i][index / MATRIX_COLS % MATRIX_ROWS][index % MATRIX_COLS] = keycode;
+        }
+    }
+}
+#else
+#define cache_clear()
+#define cache_update(index, keycode)
+#endif
+
+void dynamic_keymap_reset(void)
+{
+    for (uint8_t layer = 0; layer < DYNAMIC_KEYMAP_LAYER_COUNT; layer++) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                eeprom_update_word(EEPROM_KEYCODES + KEYCODE_INDEX(layer, row, col),
+                                   pgm_read_word(&keymaps[layer][row][col]));
+            }
+        }
+    }
+    eeprom_update_byte(EEPROM_SIZE_INFO, DYNAMIC_KEYMAP_LAYER_COUNT);
+    eeprom_update_byte(EEPROM_SIZE_INFO + 1, MATRIX_ROWS);
+    eeprom_update_byte(EEPROM_SIZE_INFO + 2, MATRIX_COLS);
+    eeprom_update_word(EEPROM_MAGIC, DYNAMIC_KEYMAP_MAGIC);
+    cache_clear();
+    layer_cache_invalidate();
+}
+
+void dynamic_keymap_init(void)
+{
+    if (eeprom_read_word(EEPROM_MAGIC) != DYNAMIC_KEYMAP_MAGIC ||
+        eeprom_read_byte(EEPROM_SIZE_INFO) != DYNAMIC_KEYMAP_LAYER_COUNT ||
+        eeprom_read_byte(EEPROM_SIZE_INFO + 1) != MATRIX_ROWS ||
+        eeprom_read_byte(EEPROM_SIZE_INFO + 2) != MATRIX_COLS) {
+        dynamic_keymap_reset();
+    }
+    cache_clear();
+    layer_cache_invalidate();
+}
+
+uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t col)
+{
+    if (row >= MATRIX_ROWS || col >= MATRIX_COLS) {
+        return KC_NO;
+    }
+    if (layer >= DYNAMIC_KEYMAP_LAYER_COUNT) {
+        return KC_TRNS;
+    }
+#if DYNAMIC_KEYMAP_CACHED_LAYERS > 0
+    return cache_get(layer)[row][col];
+#else
+    return eeprom_read_word(EEPROM_KEYCODES + KEYCODE_INDEX(layer, row, col));
+#endif
+}
+
+void dynamic_keymap_set_keycode(uint8_t layer, uint8_t row, uint8_t col, uint16_t keycode)
+{
+    if (layer >= DYNAMIC_KEYMAP_LAYER_COUNT || row >= MATRIX_ROWS || col >= MATRIX_COLS) {
+        return;
+    }
+    uint16_t index = KEYCODE_INDEX(layer, row, col);
+    eeprom_update_word(EEPROM_KEYCODES + index, keycode);
+    cache_update(index, keycode);
+    layer_cache_invalidate();
+}
+
+static uint16_t clip(uint16_t offset, uint16_t count)
+{
+    if (offset >= DYNAMIC_KEYMAP_KEYCODES) {
+        return 0;
+    }
+    return count < DYNAMIC_KEYMAP_KEYCODES - offset ? count : DYNAMIC_KEYMAP_KEYCODES - offset;
+}
+
+uint16_t dynamic_keymap_read(uint16_t offset, uint16_t count, uint16_t *keycodes)
+{
+    count = clip(offset, count);
+    eeprom_read_block(keycodes, EEPROM_KEYCODES + offset, count * 2);
+    return count;
+}
+
+uint16_t dynamic_keymap_write(uint16_t offset, uint16_t count, const uint16_t *keycodes)
+{
+    count = clip(offset, count);
+    for (uint16_t i = 0; i < count; i++) {
+        eeprom_update_word(EEPROM_KEYCODES + offset + i, keycodes[i]);
+        cache_update(offset + i, keycodes[i]);
+    }
+    layer_cache_invalidate();
+    return count;
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static void put_u16(uint8_t *p, uint16_t value)
+{
+    p[0] = value & 0xFF;
+    p[1] = value >> 8;
+}
+
+bool dynamic_keymap_raw_hid_receive(uint8_t *data, uint8_t length)
+{
+    if (length < 5 || data[0] != DYNAMIC_KEYMAP_RAW_HID_ID) {
+        return false;
+    }
+    uint16_t offset = get_u16(data + 2);
+    uint8_t fit = (length - 5) / 2;
+    uint8_t count = clip(offset, data[4] < fit ? data[4] : fit);
+    uint16_t keycode;
+    uint8_t i;
+    switch (data[1]) {
+        case DYNAMIC_KEYMAP_RAW_HID_INFO:
+            data[2] = DYNAMIC_KEYMAP_LAYER_COUNT;
+            data[3] = MATRIX_ROWS;
+            data[4] = MATRIX_COLS;
+            break;
+        case DYNAMIC_KEYMAP_RAW_HID_READ:
+            memset(data + 5, 0, length - 5);
+            for (i = 0; i < count; i++) {
+                dynamic_keymap_read(offset + i, 1, &keycode);
+                put_u16(data + 5 + 2 * i, keycode);
+            }
+            data[4] = count;
+            break;
+        case DYNAMIC_KEYMAP_RAW_HID_WRITE:
+            for (i = 0; i < count; i++) {
+                keycode = get_u16(data + 5 + 2 * i);
+                dynamic_keymap_write(offset + i, 1, &keycode);
+            }
+            data[4] = count;
+            break;
+        case DYNAMIC_KEYMAP_RAW_HID_RESET:
+            dynamic_keymap_reset();
+            break;
+    }
+#ifdef RAW_ENABLE
+    raw_hid_send(data, length);
+#endif
+    return true;
+}
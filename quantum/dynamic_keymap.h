@@ -0,0 +1,84 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DYNAMIC_KEYMAP_H
+#define DYNAMIC_KEYMAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * With DYNAMIC_KEYMAP_ENABLE = yes the first DYNAMIC_KEYMAP_LAYER_COUNT
+ * layers of keymaps[] are copied to EEPROM on the first boot, and
+ * keymap_key_to_keycode reads them from there, so they can be changed
+ * over raw HID or the API without flashing. keymaps[] must have at least
+ * that many layers. The DYNAMIC_KEYMAP_CACHED_LAYERS most recently used
+ * layers are kept in RAM, MATRIX_ROWS * MATRIX_COLS * 2 bytes each.
+ *
+ * On ChibiOS the keymap goes to the emulated EEPROM, which has to be made
+ * big enough for it, e.g. with EEPROM_SIZE 512 on a Teensy 3. The build
+ * stops when it doesn't fit, as on AVR.
+ */
+
+#ifndef DYNAMIC_KEYMAP_LAYER_COUNT
+#   define DYNAMIC_KEYMAP_LAYER_COUNT 4
+#endif
+
+/* after the eeconfig bytes */
+#ifndef DYNAMIC_KEYMAP_EEPROM_ADDR
+#   define DYNAMIC_KEYMAP_EEPROM_ADDR 32
+#endif
+
+#ifndef DYNAMIC_KEYMAP_CACHED_LAYERS
+#   define DYNAMIC_KEYMAP_CACHED_LAYERS 2
+#endif
+
+/* keycodes stored, the layers one after the other, row by row */
+#define DYNAMIC_KEYMAP_KEYCODES (DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS)
+
+#ifdef COMPILED_KEYMAP
+#   error "DYNAMIC_KEYMAP_ENABLE can't be used with COMPILED_KEYMAP_ENABLE"
+#endif
+
+/* Copies keymaps[] to EEPROM unless it already holds a keymap of this size */
+void dynamic_keymap_init(void);
+/* Copies keymaps[] to EEPROM */
+void dynamic_keymap_reset(void);
+
+/* KC_TRNS on layers that aren't stored, KC_NO outside the matrix */
+uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t col);
+void dynamic_keymap_set_keycode(uint8_t layer, uint8_t row, uint8_t col, uint16_t keycode);
+
+/* Bulk access to count keycodes from offset in DYNAMIC_KEYMAP_KEYCODES order,
+ * returns how many were in range */
+uint16_t dynamic_keymap_read(uint16_t offset, uint16_t count, uint16_t *keycodes);
+uint16_t dynamic_keymap_write(uint16_t offset, uint16_t count, const uint16_t *keycodes);
+
+/* Answers a raw HID request with DYNAMIC_KEYMAP_RAW_HID_ID in data[0] and
+ * the command in data[1]. The reply is the request with:
+ *   INFO:  data[2] layers, data[3] rows, data[4] cols
+ *   READ:  data[2..3] little endian offset, data[4] count of the keycodes
+ *          that follow from data[5], little endian, as many as fit
+ *   WRITE: the same as READ in the request, data[4] is the count written
+ *   RESET: keymaps[] copied back */
+#define DYNAMIC_KEYMAP_RAW_HID_ID 0xF2
+#define DYNAMIC_KEYMAP_RAW_HID_INFO 0
+#define DYNAMIC_KEYMAP_RAW_HID_READ 1
+#define DYNAMIC_KEYMAP_RAW_HID_WRITE 2
+#define DYNAMIC_KEYMAP_RAW_HID_RESET 3
+bool dynamic_keymap_raw_hid_receive(uint8_t *data, uint8_t length);
+
+#endif
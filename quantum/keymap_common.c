@@ -28,6 +28,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "debug.h"
 #include "backlight.h"
 #include "quantum.h"
+#ifdef COMPILED_KEYMAP
+#include "keymap_compiled.h"
+#endif
+#ifdef DYNAMIC_KEYMAP_ENABLE
+#include "dynamic_keymap.h"
+#endif
 
 #ifdef MIDI_ENABLE
 	#include "process_midi.h"
@@ -37,15 +43,42 @@ extern keymap_config_t keymap_config;
 
 #include <inttypes.h>
 
+#ifdef COMPILED_KEYMAP
+/* read by util/compile_keymap.py */
+const uint8_t PROGMEM keymap_matrix_size[] = { MATRIX_ROWS, MATRIX_COLS };
+
+/* the compiled actions are for keycodes without the magic remaps */
+static const keymap_config_t keycode_config_remaps = {
+    .swap_control_capslock = true,
+    .capslock_to_control = true,
+    .swap_lalt_lgui = true,
+    .swap_ralt_rgui = true,
+    .no_gui = true,
+    .swap_grave_esc = true,
+    .swap_backslash_backspace = true,
+};
+#endif
+
 /* converts key to action */
 action_t action_for_key(uint8_t layer, keypos_t key)
 {
+#ifdef COMPILED_KEYMAP
+    if (!(keymap_config.raw & keycode_config_remaps.raw)) {
+        action_t action;
+        action.code = keymap_compiled_action(layer, key);
+        return action;
+    }
+#endif
     // 16bit keycodes - important
     uint16_t keycode = keymap_key_to_keycode(layer, key);
 
     // keycode remapping
-    keycode = keycode_config(keycode);
+    return action_for_keycode(keycode_config(keycode));
+}
 
+/* converts keycode to action */
+action_t action_for_keycode(uint16_t keycode)
+{
     action_t action;
     uint8_t action_layer, when, mod;
 
@@ -171,8 +204,14 @@ void action_function(keyrecord_t *record, uint8_t id, uint8_t opt)
 __attribute__ ((weak))
 uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key)
 {
+#if defined(DYNAMIC_KEYMAP_ENABLE)
+    return dynamic_keymap_get_keycode(layer, key.row, key.col);
+#elif defined(COMPILED_KEYMAP)
+    return keymap_compiled_keycode(layer, key);
+#else
     // Read entire word (16bits)
     return pgm_read_word(&keymaps[(layer)][(key.row)][(key.col)]);
+#endif
 }
 
 // translates function id to action
@@ -0,0 +1,78 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEYMAP_COMPILED_H
+#define KEYMAP_COMPILED_H
+
+#include <stdint.h>
+#include "keymap.h"
+#include "action_layer.h"
+
+/*
+ * With COMPILED_KEYMAP_ENABLE = yes, util/compile_keymap.py turns the
+ * keymaps[] of the built keymap.c into keymap_compiled.c: every key already
+ * translated to its action, the layers each key is not transparent on, and
+ * rows that repeat across layers stored once. action_for_key and
+ * layer_switch_get_layer then read these tables instead of translating the
+ * keycode on every lookup.
+ *
+ * Keymaps that override keymap_key_to_keycode or keymap_function_id_to_action,
+ * or change keymaps[] at runtime, can't be compiled.
+ */
+
+uint16_t keymap_compiled_keycode(uint8_t layer, keypos_t key);
+uint16_t keymap_compiled_action(uint8_t layer, keypos_t key);
+/* the number of layers in keymaps[] */
+uint8_t keymap_compiled_layer_count(void);
+
+/* action_for_keycode as a constant expression, for the generated tables.
+ * FN keys are resolved from fn_actions by the generator and left out here. */
+#define KEYCODE_IN(kc, first, last) ((kc) >= (first) && (kc) <= (last))
+
+#ifdef BACKLIGHT_ENABLE
+#define KEYCODE_ACTION_BACKLIGHT(kc) \
+    (KEYCODE_IN(kc, BL_0, BL_15) ? ACTION_BACKLIGHT_LEVEL((kc) - BL_0) : \
+    (kc) == BL_DEC ? ACTION_BACKLIGHT_DECREASE() : \
+    (kc) == BL_INC ? ACTION_BACKLIGHT_INCREASE() : \
+    (kc) == BL_TOGG ? ACTION_BACKLIGHT_TOGGLE() : \
+    (kc) == BL_STEP ? ACTION_BACKLIGHT_STEP() : \
+    ACTION_NO)
+#else
+#define KEYCODE_ACTION_BACKLIGHT(kc) ACTION_NO
+#endif
+
+#define KEYCODE_ACTION(kc) ((uint16_t)( \
+    KEYCODE_IN(kc, KC_A, KC_EXSEL) ? ACTION_KEY(kc) : \
+    KEYCODE_IN(kc, KC_LCTRL, KC_RGUI) ? ACTION_KEY(kc) : \
+    KEYCODE_IN(kc, KC_SYSTEM_POWER, KC_SYSTEM_WAKE) ? ACTION_USAGE_SYSTEM(KEYCODE2SYSTEM(kc)) : \
+    KEYCODE_IN(kc, KC_AUDIO_MUTE, KC_MEDIA_REWIND) ? ACTION_USAGE_CONSUMER(KEYCODE2CONSUMER(kc)) : \
+    KEYCODE_IN(kc, KC_MS_UP, KC_MS_ACCEL2) ? ACTION_MOUSEKEY(kc) : \
+    (kc) == KC_TRNS ? ACTION_TRANSPARENT : \
+    KEYCODE_IN(kc, QK_MODS, QK_MODS_MAX) ? ACTION_MODS_KEY((kc) >> 8, (kc) & 0xFF) : \
+    KEYCODE_IN(kc, QK_MACRO, QK_MACRO_MAX) ? \
+        ((kc) & 0x800 ? ACTION_MACRO_TAP((kc) & 0xFF) : ACTION_MACRO((kc) & 0xFF)) : \
+    KEYCODE_IN(kc, QK_LAYER_TAP, QK_LAYER_TAP_MAX) ? ACTION_LAYER_TAP_KEY(((kc) >> 0x8) & 0xF, (kc) & 0xFF) : \
+    KEYCODE_IN(kc, QK_TO, QK_TO_MAX) ? ACTION_LAYER_SET((kc) & 0xF, ((kc) >> 0x4) & 0x3) : \
+    KEYCODE_IN(kc, QK_MOMENTARY, QK_MOMENTARY_MAX) ? ACTION_LAYER_MOMENTARY((kc) & 0xFF) : \
+    KEYCODE_IN(kc, QK_DEF_LAYER, QK_DEF_LAYER_MAX) ? ACTION_DEFAULT_LAYER_SET((kc) & 0xFF) : \
+    KEYCODE_IN(kc, QK_TOGGLE_LAYER, QK_TOGGLE_LAYER_MAX) ? ACTION_LAYER_TOGGLE((kc) & 0xFF) : \
+    KEYCODE_IN(kc, QK_ONE_SHOT_LAYER, QK_ONE_SHOT_LAYER_MAX) ? ACTION_LAYER_ONESHOT((kc) & 0xFF) : \
+    KEYCODE_IN(kc, QK_ONE_SHOT_MOD, QK_ONE_SHOT_MOD_MAX) ? ACTION_MODS_ONESHOT((kc) & 0xFF) : \
+    KEYCODE_IN(kc, QK_LAYER_TAP_TOGGLE, QK_LAYER_TAP_TOGGLE_MAX) ? ACTION_LAYER_TAP_TOGGLE((kc) & 0xFF) : \
+    KEYCODE_IN(kc, QK_MOD_TAP, QK_MOD_TAP_MAX) ? ACTION_MODS_TAP_KEY(((kc) >> 0x8) & 0x1F, (kc) & 0xFF) : \
+    KEYCODE_ACTION_BACKLIGHT(kc)))
+
+#endif
@@ -0,0 +1,9 @@
+# Generate $(COMPILED_KEYMAP_C) from $(COMPILED_KEYMAP_OBJ), the objects of
+# keymap.c and keymap_common.c, see quantum/keymap_compiled.h
+COMPILE_KEYMAP := python3 $(TOP_DIR)/util/compile_keymap.py
+
+$(COMPILED_KEYMAP_C): $(COMPILED_KEYMAP_OBJ) $(TOP_DIR)/util/compile_keymap.py | $(BEGIN)
+	@mkdir -p $(@D)
+	@$(SILENT) || printf "$(MSG_COMPILING_KEYMAP) $@" | $(AWK_CMD)
+	$(eval CMD=$(COMPILE_KEYMAP) -o $@ $(COMPILED_KEYMAP_OBJ))
+	@$(BUILD_CMD)
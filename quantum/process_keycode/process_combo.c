@@ -14,15 +14,17 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
 #include "process_combo.h"
 #include "print.h"
+#include "deadline.h"
 
 
-#define COMBO_TIMER_ELAPSED -1
+#define COMBO_TIMER_ELAPSED UINT16_MAX
 
 
 __attribute__ ((weak))
-combo_t key_combos[] = {
+combo_t key_combos[COMBO_COUNT] = {
 
 };
 
@@ -46,23 +48,136 @@ static inline void send_combo(uint16_t action, bool pressed)
     }
 }
 
+#if COMBO_COUNT > 255
+typedef uint16_t combo_index_t;
+#else
+typedef uint8_t combo_index_t;
+#endif
+
+/* Combos whose timer is running, so that matrix_scan_combo only has to look
+ * at them, and only once the oldest of them can have reached COMBO_TERM.
+ * Every combo has the same term, so a single deadline does for all. */
+static uint8_t pending_combos[(COMBO_COUNT + 7) / 8];
+static combo_index_t pending_count = 0;
+static uint16_t pending_oldest;
+
+static void combo_timeout(deadline_t *deadline)
+{
+    matrix_scan_combo();
+}
+
+static deadline_t combo_deadline = DEADLINE(combo_timeout);
+
+static void start_combo_timer(combo_index_t index, combo_t *combo)
+{
+    /* 0 means that the timer isn't running, COMBO_TIMER_ELAPSED that it ran out */
+    uint16_t now = timer_read();
+    combo->timer = (now == 0 || now == COMBO_TIMER_ELAPSED) ? 1 : now;
+    if (!(pending_combos[index / 8] & (1 << (index % 8)))) {
+        pending_combos[index / 8] |= (1 << (index % 8));
+        if (!pending_count++) {
+            pending_oldest = combo->timer;
+            deadline_in(&combo_deadline, COMBO_TERM + 1);
+        }
+    }
+}
+
+static void stop_combo_timer(combo_index_t index, combo_t *combo, uint16_t timer)
+{
+    combo->timer = timer;
+    if (pending_combos[index / 8] & (1 << (index % 8))) {
+        pending_combos[index / 8] &= ~(1 << (index % 8));
+        if (!--pending_count) {
+            deadline_cancel(&combo_deadline);
+        }
+    }
+}
+
+#if COMBO_INDEX_SIZE > 0
+/* All combo keys sorted by keycode, so that a key event only visits the
+ * combos it is part of. Built on the first key event, if the keys of all
+ * combos don't fit, every event falls back to checking every combo. An
+ * entry only points at the key, its keycode is read from the combo. */
+typedef struct {
+    combo_index_t combo;
+    uint8_t key;
+} combo_key_t;
+
+static combo_key_t combo_index[COMBO_INDEX_SIZE];
+static uint16_t combo_index_length = 0;
+static enum { INDEX_NOT_BUILT, INDEX_BUILT, INDEX_OVERFLOW } combo_index_state = INDEX_NOT_BUILT;
+
+static inline uint16_t combo_key_keycode(const combo_key_t *entry)
+{
+    return pgm_read_word(&key_combos[entry->combo].keys[entry->key]);
+}
+
+static uint8_t combo_size(combo_index_t combo)
+{
+    uint8_t count = 0;
+    while (pgm_read_word(&key_combos[combo].keys[count]) != COMBO_END) count++;
+    return count;
+}
+
+/* first entry of the index with keycode */
+static uint16_t find_combo_key(uint16_t keycode)
+{
+    uint16_t low = 0, high = combo_index_length;
+    while (low < high) {
+        uint16_t mid = (low + high) / 2;
+        if (combo_key_keycode(&combo_index[mid]) < keycode) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+static bool add_combo_key(uint16_t keycode, combo_index_t combo, uint8_t key)
+{
+    /* insert after the keys with the same keycode, which keeps them in
+     * combo order */
+    uint16_t i = keycode == UINT16_MAX ? combo_index_length : find_combo_key(keycode + 1);
+    /* Combos are added in order, so an earlier key of the same combo is
+     * the last one with that keycode. Like the linear search, the last
+     * occurrence of a repeated key wins. */
+    if (i > 0 && combo_index[i - 1].combo == combo && combo_key_keycode(&combo_index[i - 1]) == keycode) {
+        combo_index[i - 1].key = key;
+        return true;
+    }
+    if (combo_index_length == COMBO_INDEX_SIZE) return false;
+    memmove(&combo_index[i + 1], &combo_index[i], (combo_index_length - i) * sizeof(combo_key_t));
+    combo_index[i] = (combo_key_t){ .combo = combo, .key = key };
+    combo_index_length++;
+    return true;
+}
+
+static void build_combo_index(void)
+{
+    combo_index_state = INDEX_BUILT;
+    for (combo_index_t c = 0; c < COMBO_COUNT; c++) {
+        for (uint8_t count = 0; ; ++count) {
+            uint16_t key = pgm_read_word(&key_combos[c].keys[count]);
+            if (COMBO_END == key) break;
+            if (!add_combo_key(key, c, count)) {
+                combo_index_state = INDEX_OVERFLOW;
+                dprintf("combo: COMBO_INDEX_SIZE %u is too small, falling back to checking every combo\n", COMBO_INDEX_SIZE);
+                return;
+            }
+        }
+    }
+}
+
+#endif
+
 #define ALL_COMBO_KEYS_ARE_DOWN     (((1<<count)-1) == combo->state)
 #define NO_COMBO_KEYS_ARE_DOWN      (0 == combo->state)
 #define KEY_STATE_DOWN(key)         do{ combo->state |= (1<<key); } while(0)
 #define KEY_STATE_UP(key)           do{ combo->state &= ~(1<<key); } while(0)
-static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *record) 
+static bool process_single_combo(combo_index_t combo_index, uint8_t index, uint8_t count, uint16_t keycode, keyrecord_t *record)
 {
-    uint8_t count = 0;
-    uint8_t index = -1;
-    /* Find index of keycode and number of combo keys */
-    for (const uint16_t *keys = combo->keys; ;++count) {
-        uint16_t key = pgm_read_word(&keys[count]);
-        if (keycode == key) index = count;
-        if (COMBO_END == key) break;
-    }
-
-    /* Return if not a combo key */
-    if (-1 == (int8_t)index) return false;
+    combo_t *combo = &key_combos[combo_index];
 
     /* The combos timer is used to signal whether the combo is active */
     bool is_combo_active = COMBO_TIMER_ELAPSED == combo->timer ? false : true;
@@ -73,9 +188,9 @@ static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *
         if (is_combo_active) {
             if (ALL_COMBO_KEYS_ARE_DOWN) { /* Combo was pressed */
                 send_combo(combo->keycode, true);
-                combo->timer = COMBO_TIMER_ELAPSED;
+                stop_combo_timer(combo_index, combo, COMBO_TIMER_ELAPSED);
             } else { /* Combo key was pressed */
-                combo->timer = timer_read();
+                start_combo_timer(combo_index, combo);
 #ifdef COMBO_ALLOW_ACTION_KEYS
                 combo->prev_record = *record;
 #else
@@ -99,14 +214,14 @@ static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *
             send_keyboard_report();
             unregister_code16(keycode);
 #endif
-            combo->timer = 0;            
+            stop_combo_timer(combo_index, combo, 0);
         }
 
         KEY_STATE_UP(index);        
     }
 
     if (NO_COMBO_KEYS_ARE_DOWN) {
-        combo->timer = 0;
+        stop_combo_timer(combo_index, combo, 0);
     }
 
     return is_combo_active;
@@ -116,26 +231,59 @@ bool process_combo(uint16_t keycode, keyrecord_t *record)
 {
     bool is_combo_key = false;
 
-    for (current_combo_index = 0; current_combo_index < COMBO_COUNT; ++current_combo_index) {
-        combo_t *combo = &key_combos[current_combo_index];
-        is_combo_key |= process_single_combo(combo, keycode, record);
-    }    
+#if COMBO_INDEX_SIZE > 0
+    if (combo_index_state == INDEX_NOT_BUILT) {
+        build_combo_index();
+    }
+    if (combo_index_state == INDEX_BUILT) {
+        for (uint16_t i = find_combo_key(keycode); i < combo_index_length && combo_key_keycode(&combo_index[i]) == keycode; i++) {
+            combo_key_t *entry = &combo_index[i];
+            current_combo_index = entry->combo;
+            is_combo_key |= process_single_combo(entry->combo, entry->key, combo_size(entry->combo), keycode, record);
+        }
+        return !is_combo_key;
+    }
+#endif
+
+    for (combo_index_t c = 0; c < COMBO_COUNT; ++c) {
+        uint8_t count = 0;
+        uint8_t index = -1;
+        /* Find index of keycode and number of combo keys */
+        for (const uint16_t *keys = key_combos[c].keys; ;++count) {
+            uint16_t key = pgm_read_word(&keys[count]);
+            if (keycode == key) index = count;
+            if (COMBO_END == key) break;
+        }
+
+        /* Skip if not a combo key */
+        if (-1 == (int8_t)index) continue;
+
+        current_combo_index = c;
+        is_combo_key |= process_single_combo(c, index, count, keycode, record);
+    }
 
     return !is_combo_key;
 }
 
 void matrix_scan_combo(void)
 {
-    for (int i = 0; i < COMBO_COUNT; ++i) {
+    if (!pending_count || timer_elapsed(pending_oldest) <= COMBO_TERM) return;
+
+    bool first = true;
+    for (uint16_t i = 0; i < COMBO_COUNT; ++i) {
+        if (!pending_combos[i / 8]) {
+            i |= 7;
+            continue;
+        }
+        if (!(pending_combos[i / 8] & (1 << (i % 8)))) continue;
+
         combo_t *combo = &key_combos[i];
-        if (combo->timer && 
-            combo->timer != COMBO_TIMER_ELAPSED && 
-            timer_elapsed(combo->timer) > COMBO_TERM) {
+        if (timer_elapsed(combo->timer) > COMBO_TERM) {
             
             /* This disables the combo, meaning key events for this
              * combo will be handled by the next processors in the chain 
              */
-            combo->timer = COMBO_TIMER_ELAPSED;
+            stop_combo_timer(i, combo, COMBO_TIMER_ELAPSED);
 
 #ifdef COMBO_ALLOW_ACTION_KEYS
             process_action(&combo->prev_record, 
@@ -145,6 +293,13 @@ void matrix_scan_combo(void)
             unregister_code16(combo->prev_key);
             register_code16(combo->prev_key);
 #endif
+        } else if (first || timer_elapsed(combo->timer) > timer_elapsed(pending_oldest)) {
+            pending_oldest = combo->timer;
+            first = false;
         }
     }
+
+    if (pending_count) {
+        deadline_in(&combo_deadline, COMBO_TERM + 1 - timer_elapsed(pending_oldest));
+    }
 }
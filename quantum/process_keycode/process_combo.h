@@ -20,6 +20,7 @@
 #include <stdint.h>
 #include "progmem.h"
 #include "quantum.h"
+#include "action_tapping.h"
 
 typedef struct
 {
@@ -51,6 +52,13 @@ typedef struct
 #ifndef COMBO_TERM
 #define COMBO_TERM TAPPING_TERM
 #endif
+/* Number of combo keys, over all combos, that can be indexed by keycode.
+ * Takes 2 bytes of RAM each (more above 255 combos), 0 disables the index.
+ * The default fits two keys per combo, set it to the number of keys of all
+ * combos if some have more, or they are all checked on every key event. */
+#ifndef COMBO_INDEX_SIZE
+#define COMBO_INDEX_SIZE (COMBO_COUNT * 2)
+#endif
 
 bool process_combo(uint16_t keycode, keyrecord_t *record);
 void matrix_scan_combo(void);
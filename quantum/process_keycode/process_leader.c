@@ -15,6 +15,10 @@
  */
 
 #include "process_leader.h"
+#ifdef LEADER_SEQUENCE_TABLE
+#   include "sequence_trie.h"
+#   include "deadline.h"
+#endif
 
 __attribute__ ((weak))
 void leader_start(void) {}
@@ -29,6 +33,55 @@ uint16_t leader_time = 0;
 uint16_t leader_sequence[5] = {0, 0, 0, 0, 0};
 uint8_t leader_sequence_size = 0;
 
+#ifdef LEADER_SEQUENCE_TABLE
+__attribute__ ((weak))
+void leader_sequence_user(uint16_t id) {}
+
+static uint16_t leader_key(uint16_t index, uint8_t depth) {
+  if (depth >= LEADER_MAX_LENGTH) return 0;
+  return pgm_read_word(&leader_sequences[index].keys[depth]);
+}
+
+static seq_trie_t leader_trie = { leader_key, 0 };
+static seq_cursor_t leader_cursor;
+// unknown until the first sequence
+static int8_t leader_sorted = -1;
+
+// for an unsorted table, one more than fits in it to see it overflow
+static uint16_t leader_keys[LEADER_MAX_LENGTH + 1];
+static uint8_t leader_keys_size = 0;
+
+static uint16_t leader_find(void) {
+  if (leader_sorted) {
+    return seq_cursor_match(&leader_trie, &leader_cursor);
+  }
+  for (uint16_t i = 0; i < leader_sequences_size; i++) {
+    uint8_t depth = 0;
+    while (depth < leader_keys_size && leader_key(i, depth) == leader_keys[depth]) depth++;
+    if (depth == leader_keys_size && !leader_key(i, depth)) return i;
+  }
+  return SEQ_NO_MATCH;
+}
+
+static void leader_timeout(deadline_t *deadline);
+static deadline_t leader_deadline = DEADLINE(leader_timeout);
+
+static void leader_finish(uint16_t index) {
+  leading = false;
+  deadline_cancel(&leader_deadline);
+  if (index != SEQ_NO_MATCH) {
+    leader_sequence_user(pgm_read_word(&leader_sequences[index].id));
+  }
+  leader_end();
+}
+
+static void leader_timeout(deadline_t *deadline) {
+  if (leading) {
+    leader_finish(leader_find());
+  }
+}
+#endif
+
 bool process_leader(uint16_t keycode, keyrecord_t *record) {
   // Leader key set-up
   if (record->event.pressed) {
@@ -42,11 +95,34 @@ bool process_leader(uint16_t keycode, keyrecord_t *record) {
       leader_sequence[2] = 0;
       leader_sequence[3] = 0;
       leader_sequence[4] = 0;
+#ifdef LEADER_SEQUENCE_TABLE
+      if (leader_sorted < 0) {
+        leader_trie.size = leader_sequences_size;
+        leader_sorted = seq_trie_sorted(&leader_trie);
+      }
+      seq_cursor_init(&leader_trie, &leader_cursor);
+      leader_keys_size = 0;
+      deadline_in(&leader_deadline, LEADER_TIMEOUT + 1);
+#endif
       return false;
     }
     if (leading && timer_elapsed(leader_time) < LEADER_TIMEOUT) {
-      leader_sequence[leader_sequence_size] = keycode;
-      leader_sequence_size++;
+      if (leader_sequence_size < sizeof(leader_sequence) / sizeof(leader_sequence[0])) {
+        leader_sequence[leader_sequence_size] = keycode;
+        leader_sequence_size++;
+      }
+#ifdef LEADER_SEQUENCE_TABLE
+      if (leader_sorted) {
+        // done as soon as the sequence can't go on, or can't match
+        if (!seq_cursor_next(&leader_trie, &leader_cursor, keycode)) {
+          leader_finish(SEQ_NO_MATCH);
+        } else if (seq_cursor_complete(&leader_trie, &leader_cursor)) {
+          leader_finish(leader_cursor.lo);
+        }
+      } else if (leader_keys_size < sizeof(leader_keys) / sizeof(leader_keys[0])) {
+        leader_keys[leader_keys_size++] = keycode;
+      }
+#endif
       return false;
     }
   }
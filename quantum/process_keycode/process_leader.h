@@ -24,6 +24,9 @@ bool process_leader(uint16_t keycode, keyrecord_t *record);
 void leader_start(void);
 void leader_end(void);
 
+/* true from the leader key to the end of the sequence */
+extern bool leading;
+
 #ifndef LEADER_TIMEOUT
   #define LEADER_TIMEOUT 200
 #endif
@@ -36,4 +39,40 @@ void leader_end(void);
 #define LEADER_EXTERNS() extern bool leading; extern uint16_t leader_time; extern uint16_t leader_sequence[5]; extern uint8_t leader_sequence_size
 #define LEADER_DICTIONARY() if (leading && timer_elapsed(leader_time) > LEADER_TIMEOUT)
 
+#ifdef LEADER_SEQUENCE_TABLE
+/* Instead of LEADER_DICTIONARY, the keymap can list its sequences in a
+ * table, sorted by their keys:
+ *
+ *   LEADER_SEQUENCES(
+ *     LEADER_SEQ(L_EMAIL, KC_E, KC_M),
+ *     LEADER_SEQ(L_SAVE, KC_S),
+ *     LEADER_SEQ(L_SAVE_ALL, KC_S, KC_A),
+ *   );
+ *
+ * and is called back with the id of the sequence typed. A sequence that no
+ * other one continues is done as soon as its last key is typed, the others
+ * after LEADER_TIMEOUT. The table is searched a key at a time, so it can
+ * have thousands of entries; an unsorted one is searched linearly, and only
+ * after LEADER_TIMEOUT.
+ */
+#ifndef LEADER_MAX_LENGTH
+  #define LEADER_MAX_LENGTH 5
+#endif
+
+typedef struct {
+  uint16_t keys[LEADER_MAX_LENGTH];
+  uint16_t id;
+} leader_seq_t;
+
+#define LEADER_SEQ(id, ...) { { __VA_ARGS__ }, (id) }
+#define LEADER_SEQUENCES(...) \
+  const leader_seq_t PROGMEM leader_sequences[] = { __VA_ARGS__ }; \
+  const uint16_t leader_sequences_size = sizeof(leader_sequences) / sizeof(leader_sequences[0])
+
+extern const leader_seq_t leader_sequences[];
+extern const uint16_t leader_sequences_size;
+
+void leader_sequence_user(uint16_t id);
+#endif
+
 #endif
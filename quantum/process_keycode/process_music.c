@@ -14,6 +14,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "process_music.h"
+#include "deadline.h"
 
 #ifdef AUDIO_ENABLE
 #include "process_audio.h"
@@ -36,9 +37,12 @@ static uint8_t music_sequence[16] = {0};
 static uint8_t music_sequence_count = 0;
 static uint8_t music_sequence_position = 0;
 
-static uint16_t music_sequence_timer = 0;
 static uint16_t music_sequence_interval = 100;
 
+// plays the next note of the sequence
+static void music_sequence_callback(deadline_t *deadline);
+static deadline_t music_sequence_deadline = DEADLINE(music_sequence_callback);
+
 static void music_noteon(uint8_t note) {
     #ifdef AUDIO_ENABLE
     process_audio_noteon(note);
@@ -116,7 +120,7 @@ bool process_music(uint16_t keycode, keyrecord_t *record) {
         music_sequence_recording = false;
         music_sequence_playing = true;
         music_sequence_position = 0;
-        music_sequence_timer = 0;
+        deadline_in(&music_sequence_deadline, 0);
         return false;
       }
 
@@ -183,16 +187,15 @@ void music_off(void) {
     music_all_notes_off();
 }
 
-void matrix_scan_music(void) {
+static void music_sequence_callback(deadline_t *deadline) {
+  // stopping or recording only clears the flag
   if (music_sequence_playing) {
-    if ((music_sequence_timer == 0) || (timer_elapsed(music_sequence_timer) > music_sequence_interval)) {
-      music_sequence_timer = timer_read();
-      uint8_t prev_note = music_sequence[(music_sequence_position - 1 < 0)?(music_sequence_position - 1 + music_sequence_count):(music_sequence_position - 1)];
-      uint8_t next_note = music_sequence[music_sequence_position];
-      music_noteoff(prev_note);
-      music_noteon(next_note);
-      music_sequence_position = (music_sequence_position + 1) % music_sequence_count;
-    }
+    uint8_t prev_note = music_sequence[(music_sequence_position - 1 < 0)?(music_sequence_position - 1 + music_sequence_count):(music_sequence_position - 1)];
+    uint8_t next_note = music_sequence[music_sequence_position];
+    music_noteoff(prev_note);
+    music_noteon(next_note);
+    music_sequence_position = (music_sequence_position + 1) % music_sequence_count;
+    deadline_in(deadline, music_sequence_interval);
   }
 }
 
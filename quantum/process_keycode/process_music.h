@@ -32,8 +32,6 @@ void music_on_user(void);
 void music_scale_user(void);
 void music_all_notes_off(void);
 
-void matrix_scan_music(void);
-
 #ifndef SCALE
 #define SCALE (int8_t []){ 0 + (12*0), 2 + (12*0), 4 + (12*0), 5 + (12*0), 7 + (12*0), 9 + (12*0), 11 + (12*0), \
                            0 + (12*1), 2 + (12*1), 4 + (12*1), 5 + (12*1), 7 + (12*1), 9 + (12*1), 11 + (12*1), \
@@ -15,12 +15,49 @@
  */
 #include "quantum.h"
 #include "action_tapping.h"
+#include "deadline.h"
 
 uint8_t get_oneshot_mods(void);
 
 static uint16_t last_td;
 static int8_t highest_td = -1;
 
+static void tap_dance_timeout(deadline_t *deadline) {
+  matrix_scan_tap_dance();
+}
+
+static deadline_t tap_dance_deadline = DEADLINE(tap_dance_timeout);
+
+/* For the first dance to reach TAPPING_TERM, or to be reset once its key
+ * is released, as matrix_scan_tap_dance would find it. */
+static void arm_tap_dance_deadline(void) {
+  bool armed = false;
+  uint16_t wait = 0;
+
+  for (int i = 0; i <= highest_td; i++) {
+    qk_tap_dance_state_t *state = &tap_dance_actions[i].state;
+    uint16_t left = 0;
+
+    if (state->count == 0 || (state->finished && state->pressed))
+      continue;
+    if (!state->finished) {
+      uint16_t elapsed = timer_elapsed (state->timer);
+      if (elapsed <= TAPPING_TERM)
+        left = TAPPING_TERM + 1 - elapsed;
+    }
+    if (!armed || left < wait) {
+      wait = left;
+      armed = true;
+    }
+  }
+
+  if (armed) {
+    deadline_in (&tap_dance_deadline, wait);
+  } else {
+    deadline_cancel (&tap_dance_deadline);
+  }
+}
+
 void qk_tap_dance_pair_finished (qk_tap_dance_state_t *state, void *user_data) {
   qk_tap_dance_pair_t *pair = (qk_tap_dance_pair_t *)user_data;
 
@@ -124,6 +161,7 @@ bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
     break;
   }
 
+  arm_tap_dance_deadline ();
   return true;
 }
 
@@ -139,6 +177,8 @@ for (int i = 0; i <= highest_td; i++) {
       reset_tap_dance (&action->state);
     }
   }
+
+  arm_tap_dance_deadline ();
 }
 
 void reset_tap_dance (qk_tap_dance_state_t *state) {
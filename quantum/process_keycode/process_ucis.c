@@ -18,45 +18,90 @@
 
 qk_ucis_state_t qk_ucis_state;
 
+static uint16_t ucis_key(uint16_t index, uint8_t depth) {
+  return (uint8_t)ucis_symbol_table[index].symbol[depth];
+}
+
+/* the symbol character a key types, or one no symbol has */
+static uint16_t ucis_char(uint16_t keycode) {
+  switch (keycode) {
+  case KC_A ... KC_Z:
+    return keycode - KC_A + 'a';
+  case KC_1 ... KC_9:
+    return keycode - KC_1 + '1';
+  case KC_0:
+    return '0';
+  }
+  return 0x100;
+}
+
+static seq_trie_t ucis_trie = { ucis_key, 0 };
+static seq_cursor_t ucis_cursor;
+// unknown until the first symbol
+static int8_t ucis_sorted = -1;
+
+/* move the cursor to the keys typed so far */
+static void ucis_seek(void) {
+  seq_cursor_init(&ucis_trie, &ucis_cursor);
+  for (uint8_t i = 0; i < qk_ucis_state.count; i++) {
+    seq_cursor_next(&ucis_trie, &ucis_cursor, ucis_char(qk_ucis_state.codes[i]));
+  }
+}
+
+/* the symbol typed before the ending key, or SEQ_NO_MATCH */
+static uint16_t ucis_find(void) {
+  uint8_t length = qk_ucis_state.count - 1;
+
+  if (ucis_sorted) {
+    return seq_cursor_match(&ucis_trie, &ucis_cursor);
+  }
+  for (uint16_t i = 0; i < ucis_trie.size; i++) {
+    uint8_t depth = 0;
+    while (depth < length && ucis_key(i, depth) == ucis_char(qk_ucis_state.codes[depth])) depth++;
+    if (depth == length && !ucis_key(i, depth)) return i;
+  }
+  return SEQ_NO_MATCH;
+}
+
 void qk_ucis_start(void) {
   qk_ucis_state.count = 0;
   qk_ucis_state.in_progress = true;
 
+  if (ucis_sorted < 0) {
+    while (ucis_symbol_table[ucis_trie.size].symbol) ucis_trie.size++;
+    ucis_sorted = seq_trie_sorted(&ucis_trie);
+  }
+  seq_cursor_init(&ucis_trie, &ucis_cursor);
+
   qk_ucis_start_user();
 }
 
 __attribute__((weak))
 void qk_ucis_start_user(void) {
+#ifdef UNICODE_ASYNC
+  if (unicode_queue(0x2328)) return;
+  // the queue is full, type it the blocking way after the queued ones
+  unicode_flush();
+#endif
   unicode_input_start();
   register_hex(0x2328);
   unicode_input_finish();
 }
 
-static bool is_uni_seq(char *seq) {
-  uint8_t i;
-
-  for (i = 0; seq[i]; i++) {
-    uint16_t code;
-    if (('1' <= seq[i]) && (seq[i] <= '0'))
-      code = seq[i] - '1' + KC_1;
-    else
-      code = seq[i] - 'a' + KC_A;
-
-    if (i > qk_ucis_state.count || qk_ucis_state.codes[i] != code)
-      return false;
-  }
-
-  return (qk_ucis_state.codes[i] == KC_ENT ||
-          qk_ucis_state.codes[i] == KC_SPC);
+static void ucis_tap(uint8_t code) {
+#ifdef UNICODE_ASYNC
+  if (unicode_queue_tap(code)) return;
+  unicode_flush();
+#endif
+  register_code(code);
+  unregister_code(code);
+  wait_ms(UNICODE_TYPE_DELAY);
 }
 
 __attribute__((weak))
 void qk_ucis_symbol_fallback (void) {
   for (uint8_t i = 0; i < qk_ucis_state.count - 1; i++) {
-    uint8_t code = qk_ucis_state.codes[i];
-    register_code(code);
-    unregister_code(code);
-    wait_ms(UNICODE_TYPE_DELAY);
+    ucis_tap(qk_ucis_state.codes[i]);
   }
 }
 
@@ -88,9 +133,32 @@ void register_ucis(const char *hex) {
   }
 }
 
+#ifdef UNICODE_ASYNC
+/* the codepoint of a UCIS_SYM code, without its 0x */
+static uint32_t ucis_code(const char *hex) {
+  uint32_t code = 0;
+
+  for (; *hex; hex++) {
+    char c = *hex;
+    if (c >= '0' && c <= '9') {
+      code = (code << 4) | (c - '0');
+    } else if (c >= 'a' && c <= 'f') {
+      code = (code << 4) | (c - 'a' + 0xA);
+    } else if (c >= 'A' && c <= 'F') {
+      code = (code << 4) | (c - 'A' + 0xA);
+    }
+  }
+  return code;
+}
+#endif
+
 bool process_ucis (uint16_t keycode, keyrecord_t *record) {
   uint8_t i;
 
+#ifdef UNICODE_ASYNC
+  unicode_record_mods(keycode, record);
+#endif
+
   if (!qk_ucis_state.in_progress)
     return true;
 
@@ -108,6 +176,7 @@ bool process_ucis (uint16_t keycode, keyrecord_t *record) {
   if (keycode == KC_BSPC) {
     if (qk_ucis_state.count >= 2) {
       qk_ucis_state.count -= 2;
+      if (ucis_sorted) ucis_seek();
       return true;
     } else {
       qk_ucis_state.count--;
@@ -116,12 +185,10 @@ bool process_ucis (uint16_t keycode, keyrecord_t *record) {
   }
 
   if (keycode == KC_ENT || keycode == KC_SPC || keycode == KC_ESC) {
-    bool symbol_found = false;
+    uint16_t symbol = ucis_find();
 
     for (i = qk_ucis_state.count; i > 0; i--) {
-      register_code (KC_BSPC);
-      unregister_code (KC_BSPC);
-      wait_ms(UNICODE_TYPE_DELAY);
+      ucis_tap(KC_BSPC);
     }
 
     if (keycode == KC_ESC) {
@@ -129,21 +196,32 @@ bool process_ucis (uint16_t keycode, keyrecord_t *record) {
       return false;
     }
 
-    unicode_input_start();
-    for (i = 0; ucis_symbol_table[i].symbol; i++) {
-      if (is_uni_seq (ucis_symbol_table[i].symbol)) {
-        symbol_found = true;
-        register_ucis(ucis_symbol_table[i].code + 2);
-        break;
-      }
+#ifdef UNICODE_ASYNC
+    if (symbol == SEQ_NO_MATCH) {
+      qk_ucis_symbol_fallback();
+    } else if (!unicode_queue(ucis_code(ucis_symbol_table[symbol].code + 2))) {
+      // the queue is full, type it the blocking way after the queued ones
+      unicode_flush();
+      unicode_input_start();
+      register_ucis(ucis_symbol_table[symbol].code + 2);
+      unicode_input_finish();
     }
-    if (!symbol_found) {
+#else
+    unicode_input_start();
+    if (symbol != SEQ_NO_MATCH) {
+      register_ucis(ucis_symbol_table[symbol].code + 2);
+    } else {
       qk_ucis_symbol_fallback();
     }
     unicode_input_finish();
+#endif
 
     qk_ucis_state.in_progress = false;
     return false;
   }
+
+  if (ucis_sorted) {
+    seq_cursor_next(&ucis_trie, &ucis_cursor, ucis_char(keycode));
+  }
   return true;
 }
@@ -19,6 +19,7 @@
 
 #include "quantum.h"
 #include "process_unicode_common.h"
+#include "sequence_trie.h"
 
 #ifndef UCIS_MAX_SYMBOL_LENGTH
 #define UCIS_MAX_SYMBOL_LENGTH 32
@@ -31,12 +32,15 @@ typedef struct {
 
 typedef struct {
   uint8_t count;
-  uint16_t codes[UCIS_MAX_SYMBOL_LENGTH];
+  // and the key that ends it
+  uint16_t codes[UCIS_MAX_SYMBOL_LENGTH + 1];
   bool in_progress:1;
 } qk_ucis_state_t;
 
 extern qk_ucis_state_t qk_ucis_state;
 
+/* Sorted by symbol, the table is searched a key at a time as the symbol is
+ * typed, otherwise it is searched linearly at the end */
 #define UCIS_TABLE(...) {__VA_ARGS__, {NULL, NULL}}
 #define UCIS_SYM(name, code) {name, #code}
 
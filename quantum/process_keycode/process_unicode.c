@@ -20,12 +20,20 @@
 static uint8_t first_flag = 0;
 
 bool process_unicode(uint16_t keycode, keyrecord_t *record) {
+#ifdef UNICODE_ASYNC
+  unicode_record_mods(keycode, record);
+#endif
   if (keycode > QK_UNICODE && record->event.pressed) {
     if (first_flag == 0) {
-      set_unicode_input_mode(eeprom_read_byte(EECONFIG_UNICODEMODE));
+      set_unicode_input_mode(eeconfig_read_byte(EECONFIG_UNICODEMODE));
       first_flag = 1;
     }
     uint16_t unicode = keycode & 0x7FFF;
+#ifdef UNICODE_ASYNC
+    if (unicode_queue(unicode)) return true;
+    // the queue is full, type it the blocking way after the queued ones
+    unicode_flush();
+#endif
     unicode_input_start();
     register_hex(unicode);
     unicode_input_finish();
@@ -23,14 +23,18 @@ uint8_t mods;
 void set_unicode_input_mode(uint8_t os_target)
 {
   input_mode = os_target;
-  eeprom_update_byte(EECONFIG_UNICODEMODE, os_target);
+  eeconfig_update_byte(EECONFIG_UNICODEMODE, os_target);
 }
 
 uint8_t get_unicode_input_mode(void) {
   return input_mode;
 }
 
+/* With UNICODE_ASYNC the queue types the same keys itself, so these two
+ * can't be overridden: a keymap that does fails to link */
+#ifndef UNICODE_ASYNC
 __attribute__((weak))
+#endif
 void unicode_input_start (void) {
   // save current mods
   mods = keyboard_report->mods;
@@ -71,7 +75,9 @@ void unicode_input_start (void) {
   wait_ms(UNICODE_TYPE_DELAY);
 }
 
+#ifndef UNICODE_ASYNC
 __attribute__((weak))
+#endif
 void unicode_input_finish (void) {
   switch(input_mode) {
     case UC_OSX:
@@ -114,3 +120,201 @@ void register_hex(uint16_t hex) {
     unregister_code(hex_to_keycode(digit));
   }
 }
+
+#ifdef UNICODE_ASYNC
+/* a queued key tap, rather than a codepoint */
+#define UNICODE_TAP 0x80000000UL
+
+enum unicode_step_type {
+  UNICODE_STEP_DOWN,
+  UNICODE_STEP_UP,
+  UNICODE_STEP_WAIT
+};
+
+typedef struct {
+  uint8_t type;
+  uint8_t code;
+} unicode_step_t;
+
+static uint32_t queue[UNICODE_QUEUE_SIZE];
+static uint8_t queue_head = 0;
+static uint8_t queue_count = 0;
+
+/* The key changes for the next codepoint, at most 25 in UC_LNX: 6 to start,
+ * a wait, 8 digits and 2 to finish */
+static unicode_step_t steps[25];
+static uint8_t step_index = 0;
+static uint8_t step_count = 0;
+static uint16_t step_timer = 0;
+static uint16_t step_delay = 0;
+
+static bool in_batch = false;
+static uint8_t batch_mods = 0;
+
+/* in the order unicode_input_start releases them */
+static const uint8_t mod_keys[] = {
+  KC_LSFT, KC_RSFT, KC_LCTL, KC_RCTL, KC_LALT, KC_RALT, KC_LGUI, KC_RGUI
+};
+
+static bool queue_push(uint32_t item) {
+  if (queue_count == UNICODE_QUEUE_SIZE) {
+    return false;
+  }
+  queue[(queue_head + queue_count++) % UNICODE_QUEUE_SIZE] = item;
+  return true;
+}
+
+bool unicode_queue(uint32_t code) {
+  return queue_push(code);
+}
+
+bool unicode_queue_tap(uint8_t keycode) {
+  return queue_push(UNICODE_TAP | keycode);
+}
+
+bool unicode_busy(void) {
+  return queue_count || in_batch || step_index < step_count;
+}
+
+void unicode_flush(void) {
+  while (unicode_busy()) {
+    wait_ms(UNICODE_STEP_MS);
+    unicode_task();
+  }
+}
+
+void unicode_record_mods(uint16_t keycode, keyrecord_t *record) {
+  // a modifier let go of during the batch isn't restored after it
+  if (IS_MOD(keycode) && !record->event.pressed) {
+    batch_mods &= ~MOD_BIT(keycode);
+  }
+}
+
+static void plan(uint8_t type, uint8_t code) {
+  steps[step_count].type = type;
+  steps[step_count].code = code;
+  step_count++;
+}
+
+static void plan_tap(uint8_t code) {
+  plan(UNICODE_STEP_DOWN, code);
+  plan(UNICODE_STEP_UP, code);
+}
+
+/* the same keys as unicode_input_start, without the modifiers */
+static void plan_input_start(void) {
+  switch(input_mode) {
+  case UC_OSX:
+    plan(UNICODE_STEP_DOWN, KC_LALT);
+    break;
+  case UC_LNX:
+    plan(UNICODE_STEP_DOWN, KC_LCTL);
+    plan(UNICODE_STEP_DOWN, KC_LSFT);
+    plan_tap(KC_U);
+    plan(UNICODE_STEP_UP, KC_LSFT);
+    plan(UNICODE_STEP_UP, KC_LCTL);
+    break;
+  case UC_WIN:
+    plan(UNICODE_STEP_DOWN, KC_LALT);
+    plan_tap(KC_PPLS);
+    break;
+  case UC_WINC:
+    plan_tap(KC_RALT);
+    plan_tap(KC_U);
+  }
+  plan(UNICODE_STEP_WAIT, UNICODE_TYPE_DELAY);
+}
+
+static void plan_input_finish(void) {
+  switch(input_mode) {
+    case UC_OSX:
+    case UC_WIN:
+      plan(UNICODE_STEP_UP, KC_LALT);
+      break;
+    case UC_LNX:
+      plan_tap(KC_SPC);
+      break;
+  }
+}
+
+/* at least 4 digits, like register_hex32 */
+static void plan_hex(uint32_t hex) {
+  int8_t i = 7;
+  while (i > 3 && !((hex >> (i*4)) & 0xF)) i--;
+  for (; i >= 0; i--) {
+    plan_tap(hex_to_keycode((hex >> (i*4)) & 0xF));
+  }
+}
+
+/* Plan the key changes for the next item in the queue. Returns false when
+ * there is nothing left to do.
+ */
+static bool unicode_plan(void) {
+  uint32_t item;
+
+  step_index = step_count = 0;
+  if (in_batch && (!queue_count || (queue[queue_head] & UNICODE_TAP))) {
+    // end of the batch
+    if (input_mode == UC_OSX) plan_input_finish();
+    for (uint8_t i = 0; i < sizeof(mod_keys); i++) {
+      if (batch_mods & MOD_BIT(mod_keys[i])) plan(UNICODE_STEP_DOWN, mod_keys[i]);
+    }
+    in_batch = false;
+    return true;
+  }
+  if (!queue_count) return false;
+
+  item = queue[queue_head];
+  if (item & UNICODE_TAP) {
+    plan_tap(item & 0xFF);
+    plan(UNICODE_STEP_WAIT, UNICODE_TYPE_DELAY);
+  } else if (!in_batch) {
+    // start of the batch, the codepoint stays queued
+    batch_mods = keyboard_report->mods;
+    for (uint8_t i = 0; i < sizeof(mod_keys); i++) {
+      if (batch_mods & MOD_BIT(mod_keys[i])) plan(UNICODE_STEP_UP, mod_keys[i]);
+    }
+    // Unicode Hex Input takes a whole batch with alt held
+    if (input_mode == UC_OSX) plan_input_start();
+    in_batch = true;
+    return true;
+  } else if (input_mode == UC_OSX) {
+    if (item > 0xFFFF) {
+      // as a UTF-16 surrogate pair
+      item -= 0x10000;
+      plan_hex(0xD800 + (item >> 10));
+      plan_hex(0xDC00 + (item & 0x3FF));
+    } else {
+      plan_hex(item);
+    }
+  } else {
+    plan_input_start();
+    plan_hex(item);
+    plan_input_finish();
+  }
+  queue_head = (queue_head + 1) % UNICODE_QUEUE_SIZE;
+  queue_count--;
+  return true;
+}
+
+void unicode_task(void) {
+  unicode_step_t *step;
+
+  if (timer_elapsed(step_timer) < step_delay) return;
+  while (step_index == step_count) {
+    if (!unicode_plan()) return;
+  }
+
+  step = &steps[step_index++];
+  switch (step->type) {
+    case UNICODE_STEP_DOWN:
+      register_code(step->code);
+      break;
+    case UNICODE_STEP_UP:
+      unregister_code(step->code);
+      break;
+  }
+  step_timer = timer_read();
+  step_delay = step->type == UNICODE_STEP_WAIT ? step->code : UNICODE_STEP_MS;
+}
+#endif
@@ -32,6 +32,30 @@ void unicode_input_start(void);
 void unicode_input_finish(void);
 void register_hex(uint16_t hex);
 
+#ifdef UNICODE_ASYNC
+#ifndef UNICODE_QUEUE_SIZE
+#define UNICODE_QUEUE_SIZE 16
+#endif
+#ifndef UNICODE_STEP_MS
+#define UNICODE_STEP_MS 1
+#endif
+
+/* Queue a codepoint to be typed by unicode_task, one key change every
+ * UNICODE_STEP_MS. Consecutive codepoints are typed as one batch, that
+ * releases and restores the held modifiers only once. False if the queue
+ * is full: unicode_flush, then type it the blocking way.
+ * unicode_input_start and unicode_input_finish can't be overridden. */
+bool unicode_queue(uint32_t code);
+/* Queue a plain key tap, typed after the codepoints before it */
+bool unicode_queue_tap(uint8_t keycode);
+bool unicode_busy(void);
+/* Type everything queued right away, blocking */
+void unicode_flush(void);
+void unicode_task(void);
+/* Keep track of the modifiers released while a batch is typed */
+void unicode_record_mods(uint16_t keycode, keyrecord_t *record);
+#endif
+
 #define UC_OSX 0  // Mac OS X
 #define UC_LNX 1  // Linux
 #define UC_WIN 2  // Windows 'HexNumpad'
@@ -17,8 +17,10 @@
 #include "process_unicodemap.h"
 #include "process_unicode_common.h"
 
+// not empty, so the compiler can't prove every lookup out of bounds
 __attribute__((weak))
 const uint32_t PROGMEM unicode_map[] = {
+  0
 };
 
 void register_hex32(uint32_t hex) {
@@ -46,11 +48,25 @@ void unicode_map_input_error() {}
 
 bool process_unicode_map(uint16_t keycode, keyrecord_t *record) {
   uint8_t input_mode = get_unicode_input_mode();
+#ifdef UNICODE_ASYNC
+  unicode_record_mods(keycode, record);
+#endif
   if ((keycode & QK_UNICODE_MAP) == QK_UNICODE_MAP && record->event.pressed) {
     const uint32_t* map = unicode_map;
     uint16_t index = keycode - QK_UNICODE_MAP;
     uint32_t code = pgm_read_dword_far(&map[index]);
-    if (code > 0xFFFF && code <= 0x10ffff && input_mode == UC_OSX) {
+    if ((code > 0x10ffff && input_mode == UC_OSX) || (code > 0xFFFFF && input_mode == UC_LNX)) {
+      // when character is out of range supported by the OS
+      unicode_map_input_error();
+      return true;
+    }
+#ifdef UNICODE_ASYNC
+    // the emitter makes the surrogate pair for UC_OSX
+    if (unicode_queue(code)) return true;
+    // the queue is full, type it the blocking way after the queued ones
+    unicode_flush();
+#endif
+    if (code > 0xFFFF && input_mode == UC_OSX) {
       // Convert to UTF-16 surrogate pair
       code -= 0x10000;
       uint32_t lo = code & 0x3ff;
@@ -59,9 +75,6 @@ bool process_unicode_map(uint16_t keycode, keyrecord_t *record) {
       register_hex32(hi + 0xd800);
       register_hex32(lo + 0xdc00);
       unicode_input_finish();
-    } else if ((code > 0x10ffff && input_mode == UC_OSX) || (code > 0xFFFFF && input_mode == UC_LNX)) {
-      // when character is out of range supported by the OS
-      unicode_map_input_error();
     } else {
       unicode_input_start();
       register_hex32(code);
@@ -24,12 +24,20 @@
 #endif
 
 #include "backlight.h"
+#include "scheduler.h"
 extern backlight_config_t backlight_config;
 
 #ifdef FAUXCLICKY_ENABLE
 #include "fauxclicky.h"
 #endif
 
+#if defined(PROFILE_ENABLE) && defined(PROFILE_PROCESS_HOOKS)
+#include "profile.h"
+#define PROFILE_HOOK(stat, call) PROFILE_CALL(stat, call)
+#else
+#define PROFILE_HOOK(stat, call) (call)
+#endif
+
 static void do_code16 (uint16_t code, void (*f) (uint8_t)) {
   switch (code) {
   case QK_MODS ... QK_MODS_MAX:
@@ -122,6 +130,7 @@ void reset_keyboard(void) {
 #ifdef CATERINA_BOOTLOADER
   *(uint16_t *)0x0800 = 0x7777; // these two are a-star-specific
 #endif
+  eeconfig_flush();
   bootloader_jump();
 }
 
@@ -137,6 +146,75 @@ void reset_keyboard(void) {
 static bool shift_interrupted[2] = {0, 0};
 static uint16_t scs_timer[2] = {0, 0};
 
+/* The process_* hooks of process_record_quantum, in the order they see an
+ * event. Most only act on their own keycodes and are registered with that
+ * range, outside of which they are not called at all; the ones that watch
+ * every key, to interrupt a tap dance or play music, are PROCESS_OBSERVERs,
+ * and the ones that only do while they are active, like a leader sequence,
+ * PROCESS_HOOK_WHILE or PROCESS_WHILE. The first to return false stops the
+ * event. */
+#define PROCESS_OBSERVER(stat, process) PROFILE_HOOK(stat, process(keycode, record))
+#define PROCESS_HOOK(first, last, stat, process) \
+  (keycode < (first) || keycode > (last) || PROCESS_OBSERVER(stat, process))
+#define PROCESS_HOOK_FROM(first, stat, process) \
+  (keycode < (first) || PROCESS_OBSERVER(stat, process))
+#define PROCESS_HOOK_WHILE(first, last, active, stat, process) \
+  (((keycode < (first) || keycode > (last)) && !(active)) || PROCESS_OBSERVER(stat, process))
+#define PROCESS_WHILE(active, stat, process) \
+  (!(active) || PROCESS_OBSERVER(stat, process))
+
+#ifdef UNICODE_ASYNC
+// the unicode hooks note the mods of every key for the queued input
+#define PROCESS_UNICODE_HOOK(first, stat, process) PROCESS_OBSERVER(stat, process)
+#else
+#define PROCESS_UNICODE_HOOK PROCESS_HOOK_FROM
+#endif
+
+bool process_record_hooks(uint16_t keycode, keyrecord_t *record) {
+  return
+    PROCESS_OBSERVER(PROFILE_PROCESS_KB, process_record_kb) &&
+  #if defined(MIDI_ENABLE) && defined(MIDI_ADVANCED)
+    PROCESS_HOOK(MIDI_TONE_MIN, MI_MODSU, PROFILE_PROCESS_MIDI, process_midi) &&
+  #endif
+  #ifdef AUDIO_ENABLE
+    PROCESS_HOOK(AU_ON, MUV_DE, PROFILE_PROCESS_AUDIO, process_audio) &&
+  #endif
+  #if defined(AUDIO_ENABLE) || (defined(MIDI_ENABLE) && defined(MIDI_BASIC))
+    // plays any key while music mode is on
+    PROCESS_OBSERVER(PROFILE_PROCESS_MUSIC, process_music) &&
+  #endif
+  #ifdef TAP_DANCE_ENABLE
+    // any other key interrupts the dance
+    PROCESS_OBSERVER(PROFILE_PROCESS_TAP_DANCE, process_tap_dance) &&
+  #endif
+  #ifndef DISABLE_LEADER
+    PROCESS_HOOK_WHILE(KC_LEAD, KC_LEAD, leading, PROFILE_PROCESS_LEADER, process_leader) &&
+  #endif
+  #ifndef DISABLE_CHORDING
+    PROCESS_HOOK(QK_CHORDING, QK_CHORDING_MAX, PROFILE_PROCESS_CHORDING, process_chording) &&
+  #endif
+  #ifdef COMBO_ENABLE
+    PROCESS_OBSERVER(PROFILE_PROCESS_COMBO, process_combo) &&
+  #endif
+  #ifdef UNICODE_ENABLE
+    PROCESS_UNICODE_HOOK(QK_UNICODE, PROFILE_PROCESS_UNICODE, process_unicode) &&
+  #endif
+  #if defined(UCIS_ENABLE) && defined(UNICODE_ASYNC)
+    PROCESS_OBSERVER(PROFILE_PROCESS_UCIS, process_ucis) &&
+  #elif defined(UCIS_ENABLE)
+    // qk_ucis_start() begins the symbol, there is no key for it
+    PROCESS_WHILE(qk_ucis_state.in_progress, PROFILE_PROCESS_UCIS, process_ucis) &&
+  #endif
+  #ifdef PRINTING_ENABLE
+    PROCESS_OBSERVER(PROFILE_PROCESS_PRINTER, process_printer) &&
+  #endif
+  #ifdef UNICODEMAP_ENABLE
+    // every keycode from 0x8000 up indexes the map
+    PROCESS_UNICODE_HOOK(QK_UNICODE_MAP, PROFILE_PROCESS_UNICODEMAP, process_unicode_map) &&
+  #endif
+    true;
+}
+
 bool process_record_quantum(keyrecord_t *record) {
 
   /* This gets the keycode from the key pressed */
@@ -167,42 +245,7 @@ bool process_record_quantum(keyrecord_t *record) {
     //   return false;
     // }
 
-  if (!(
-    process_record_kb(keycode, record) &&
-  #if defined(MIDI_ENABLE) && defined(MIDI_ADVANCED)
-    process_midi(keycode, record) &&
-  #endif
-  #ifdef AUDIO_ENABLE
-    process_audio(keycode, record) &&
-  #endif
-  #if defined(AUDIO_ENABLE) || (defined(MIDI_ENABLE) && defined(MIDI_BASIC))
-    process_music(keycode, record) &&
-  #endif
-  #ifdef TAP_DANCE_ENABLE
-    process_tap_dance(keycode, record) &&
-  #endif
-  #ifndef DISABLE_LEADER
-    process_leader(keycode, record) &&
-  #endif
-  #ifndef DISABLE_CHORDING
-    process_chording(keycode, record) &&
-  #endif
-  #ifdef COMBO_ENABLE
-    process_combo(keycode, record) &&
-  #endif
-  #ifdef UNICODE_ENABLE
-    process_unicode(keycode, record) &&
-  #endif
-  #ifdef UCIS_ENABLE
-    process_ucis(keycode, record) &&
-  #endif
-  #ifdef PRINTING_ENABLE
-    process_printer(keycode, record) &&
-  #endif
-  #ifdef UNICODEMAP_ENABLE
-    process_unicode_map(keycode, record) &&
-  #endif
-      true)) {
+  if (!process_record_hooks(keycode, record)) {
     return false;
   }
 
@@ -529,6 +572,21 @@ const uint8_t ascii_to_colemak_keycode_lut[0x80] PROGMEM = {
 
 #endif
 
+#ifdef ASYNC_MACRO
+uint8_t action_macro_ascii_keycode(uint8_t ascii) {
+    if (ascii & 0x80) return KC_NO;
+    uint8_t keycode = pgm_read_byte(&ascii_to_qwerty_keycode_lut[ascii]);
+    if (keycode != KC_NO && pgm_read_byte(&ascii_to_qwerty_shift_lut[ascii])) {
+        keycode |= MACRO_ASCII_SHIFT;
+    }
+    return keycode;
+}
+
+void send_string(const char *str) {
+    // typed by action_macro_task
+    action_macro_type(str);
+}
+#else
 void send_string(const char *str) {
     while (1) {
         uint8_t keycode;
@@ -549,6 +607,7 @@ void send_string(const char *str) {
         ++str;
     }
 }
+#endif
 
 void update_tri_layer(uint8_t layer1, uint8_t layer2, uint8_t layer3) {
   if (IS_LAYER_ON(layer1) && IS_LAYER_ON(layer2)) {
@@ -596,33 +655,47 @@ void tap_random_base64(void) {
   }
 }
 
+// run by keyboard_task, see scheduler.h
+#if defined(UNICODE_COMMON_ENABLE) && defined(UNICODE_ASYNC)
+static scheduled_task_t unicode_scheduled = SCHEDULED_TASK(unicode_task, 0, TASK_PRIORITY_HIGH);
+#endif
+#if defined(BACKLIGHT_ENABLE) && defined(BACKLIGHT_PIN)
+static scheduled_task_t backlight_scheduled = SCHEDULED_TASK(backlight_task, 0, TASK_PRIORITY_LOW);
+#endif
+
 void matrix_init_quantum() {
   #ifdef BACKLIGHT_ENABLE
     backlight_init_ports();
   #endif
-  matrix_init_kb();
-}
 
-void matrix_scan_quantum() {
-  #ifdef AUDIO_ENABLE
-    matrix_scan_music();
+  #if defined(UNICODE_COMMON_ENABLE) && defined(UNICODE_ASYNC)
+    scheduler_add(&unicode_scheduled);
   #endif
 
-  #ifdef TAP_DANCE_ENABLE
-    matrix_scan_tap_dance();
+  #if defined(BACKLIGHT_ENABLE) && defined(BACKLIGHT_PIN)
+    scheduler_add(&backlight_scheduled);
   #endif
 
-  #ifdef COMBO_ENABLE
-    matrix_scan_combo();
+  #ifdef DYNAMIC_KEYMAP_ENABLE
+    dynamic_keymap_init();
   #endif
 
-  #if defined(BACKLIGHT_ENABLE) && defined(BACKLIGHT_PIN)
-    backlight_task();
-  #endif
+  matrix_init_kb();
+}
 
+void matrix_scan_quantum() {
+#ifndef MATRIX_SCAN_THREAD
   matrix_scan_kb();
+#endif
 }
 
+#ifdef MATRIX_SCAN_THREAD
+// matrix_scan() runs on the scan thread, the hooks that act on keys mustn't
+void matrix_scan_hooks(void) {
+  matrix_scan_kb();
+}
+#endif
+
 #if defined(BACKLIGHT_ENABLE) && defined(BACKLIGHT_PIN)
 
 static const uint8_t backlight_pin = BACKLIGHT_PIN;
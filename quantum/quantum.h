@@ -94,6 +94,10 @@ extern uint32_t default_layer_state;
 	#include "process_combo.h"
 #endif
 
+#ifdef DYNAMIC_KEYMAP_ENABLE
+	#include "dynamic_keymap.h"
+#endif
+
 #define SEND_STRING(str) send_string(PSTR(str))
 void send_string(const char *str);
 
@@ -112,6 +116,8 @@ void matrix_scan_user(void);
 bool process_action_kb(keyrecord_t *record);
 bool process_record_kb(uint16_t keycode, keyrecord_t *record);
 bool process_record_user(uint16_t keycode, keyrecord_t *record);
+/* the process_* hooks of the enabled features, for the keycodes they handle */
+bool process_record_hooks(uint16_t keycode, keyrecord_t *record);
 
 void reset_keyboard(void);
 
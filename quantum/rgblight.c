@@ -17,7 +17,7 @@
 #include <avr/interrupt.h>
 #include <util/delay.h>
 #include "progmem.h"
-#include "timer.h"
+#include "deadline.h"
 #include "rgblight.h"
 #include "debug.h"
 #include "led_tables.h"
@@ -102,10 +102,10 @@ void setrgb(uint8_t r, uint8_t g, uint8_t b, LED_TYPE *led1) {
 
 
 uint32_t eeconfig_read_rgblight(void) {
-  return eeprom_read_dword(EECONFIG_RGBLIGHT);
+  return eeconfig_read_dword(EECONFIG_RGBLIGHT);
 }
 void eeconfig_update_rgblight(uint32_t val) {
-  eeprom_update_dword(EECONFIG_RGBLIGHT, val);
+  eeconfig_update_dword(EECONFIG_RGBLIGHT, val);
 }
 void eeconfig_update_rgblight_default(void) {
   dprintf("eeconfig_update_rgblight_default\n");
@@ -388,7 +388,10 @@ void rgblight_set(void) {
 
 #ifdef RGBLIGHT_ANIMATIONS
 
-// Animation timer -- AVR Timer3
+// Animation timer -- the next step of the effect
+static void rgblight_effect_callback(deadline_t *deadline);
+static deadline_t rgblight_effect_deadline = DEADLINE(rgblight_effect_callback);
+
 void rgblight_timer_init(void) {
   // static uint8_t rgblight_timer_is_init = 0;
   // if (rgblight_timer_is_init) {
@@ -405,18 +408,28 @@ void rgblight_timer_init(void) {
   // OCR3AL = RGBLED_TIMER_TOP & 0xff;
   // SREG = sreg;
 
-  rgblight_timer_enabled = true;
+  rgblight_timer_enable();
 }
 void rgblight_timer_enable(void) {
   rgblight_timer_enabled = true;
+  // a running effect keeps its pace when the mode changes
+  if (!deadline_pending(&rgblight_effect_deadline)) {
+    deadline_in(&rgblight_effect_deadline, 0);
+  }
   dprintf("TIMER3 enabled.\n");
 }
 void rgblight_timer_disable(void) {
   rgblight_timer_enabled = false;
+  deadline_cancel(&rgblight_effect_deadline);
   dprintf("TIMER3 disabled.\n");
 }
 void rgblight_timer_toggle(void) {
-  rgblight_timer_enabled ^= rgblight_timer_enabled;
+  rgblight_timer_enabled = !rgblight_timer_enabled;
+  if (rgblight_timer_enabled) {
+    deadline_in(&rgblight_effect_deadline, 0);
+  } else {
+    deadline_cancel(&rgblight_effect_deadline);
+  }
   dprintf("TIMER3 toggled.\n");
 }
 
@@ -426,64 +439,59 @@ void rgblight_show_solid_color(uint8_t r, uint8_t g, uint8_t b) {
   rgblight_setrgb(r, g, b);
 }
 
-void rgblight_task(void) {
-  if (rgblight_timer_enabled) {
-    // mode = 1, static light, do nothing here
-    if (rgblight_config.mode >= 2 && rgblight_config.mode <= 5) {
-      // mode = 2 to 5, breathing mode
-      rgblight_effect_breathing(rgblight_config.mode - 2);
-    } else if (rgblight_config.mode >= 6 && rgblight_config.mode <= 8) {
-      // mode = 6 to 8, rainbow mood mod
-      rgblight_effect_rainbow_mood(rgblight_config.mode - 6);
-    } else if (rgblight_config.mode >= 9 && rgblight_config.mode <= 14) {
-      // mode = 9 to 14, rainbow swirl mode
-      rgblight_effect_rainbow_swirl(rgblight_config.mode - 9);
-    } else if (rgblight_config.mode >= 15 && rgblight_config.mode <= 20) {
-      // mode = 15 to 20, snake mode
-      rgblight_effect_snake(rgblight_config.mode - 15);
-    } else if (rgblight_config.mode >= 21 && rgblight_config.mode <= 23) {
-      // mode = 21 to 23, knight mode
-      rgblight_effect_knight(rgblight_config.mode - 21);
-    } else if (rgblight_config.mode == 24) {
-      // mode = 24, christmas mode
-      rgblight_effect_christmas();
-    }
+// Steps the effect and arms the next step after its interval
+static void rgblight_effect_callback(deadline_t *deadline) {
+  uint16_t interval;
+
+  if (rgblight_config.mode >= 2 && rgblight_config.mode <= 5) {
+    // mode = 2 to 5, breathing mode
+    rgblight_effect_breathing(rgblight_config.mode - 2);
+    interval = pgm_read_byte(&RGBLED_BREATHING_INTERVALS[rgblight_config.mode - 2]);
+  } else if (rgblight_config.mode >= 6 && rgblight_config.mode <= 8) {
+    // mode = 6 to 8, rainbow mood mod
+    rgblight_effect_rainbow_mood(rgblight_config.mode - 6);
+    interval = pgm_read_byte(&RGBLED_RAINBOW_MOOD_INTERVALS[rgblight_config.mode - 6]);
+  } else if (rgblight_config.mode >= 9 && rgblight_config.mode <= 14) {
+    // mode = 9 to 14, rainbow swirl mode
+    rgblight_effect_rainbow_swirl(rgblight_config.mode - 9);
+    interval = pgm_read_byte(&RGBLED_RAINBOW_MOOD_INTERVALS[(rgblight_config.mode - 9) / 2]);
+  } else if (rgblight_config.mode >= 15 && rgblight_config.mode <= 20) {
+    // mode = 15 to 20, snake mode
+    rgblight_effect_snake(rgblight_config.mode - 15);
+    interval = pgm_read_byte(&RGBLED_SNAKE_INTERVALS[(rgblight_config.mode - 15) / 2]);
+  } else if (rgblight_config.mode >= 21 && rgblight_config.mode <= 23) {
+    // mode = 21 to 23, knight mode
+    rgblight_effect_knight(rgblight_config.mode - 21);
+    interval = pgm_read_byte(&RGBLED_KNIGHT_INTERVALS[rgblight_config.mode - 21]);
+  } else if (rgblight_config.mode == 24) {
+    // mode = 24, christmas mode
+    rgblight_effect_christmas();
+    interval = RGBLIGHT_EFFECT_CHRISTMAS_INTERVAL;
+  } else {
+    // static modes, armed again by rgblight_timer_enable
+    return;
   }
+  deadline_in(deadline, interval);
 }
 
 // Effects
 void rgblight_effect_breathing(uint8_t interval) {
   static uint8_t pos = 0;
-  static uint16_t last_timer = 0;
 
-  if (timer_elapsed(last_timer) < pgm_read_byte(&RGBLED_BREATHING_INTERVALS[interval])) {
-    return;
-  }
-  last_timer = timer_read();
 
   rgblight_sethsv_noeeprom(rgblight_config.hue, rgblight_config.sat, pgm_read_byte(&LED_BREATHING_TABLE[pos]));
   pos = (pos + 1) % 256;
 }
 void rgblight_effect_rainbow_mood(uint8_t interval) {
   static uint16_t current_hue = 0;
-  static uint16_t last_timer = 0;
 
-  if (timer_elapsed(last_timer) < pgm_read_byte(&RGBLED_RAINBOW_MOOD_INTERVALS[interval])) {
-    return;
-  }
-  last_timer = timer_read();
   rgblight_sethsv_noeeprom(current_hue, rgblight_config.sat, rgblight_config.val);
   current_hue = (current_hue + 1) % 360;
 }
 void rgblight_effect_rainbow_swirl(uint8_t interval) {
   static uint16_t current_hue = 0;
-  static uint16_t last_timer = 0;
   uint16_t hue;
   uint8_t i;
-  if (timer_elapsed(last_timer) < pgm_read_byte(&RGBLED_RAINBOW_MOOD_INTERVALS[interval / 2])) {
-    return;
-  }
-  last_timer = timer_read();
   for (i = 0; i < RGBLED_NUM; i++) {
     hue = (360 / RGBLED_NUM * i + current_hue) % 360;
     sethsv(hue, rgblight_config.sat, rgblight_config.val, (LED_TYPE *)&led[i]);
@@ -502,17 +510,12 @@ void rgblight_effect_rainbow_swirl(uint8_t interval) {
 }
 void rgblight_effect_snake(uint8_t interval) {
   static uint8_t pos = 0;
-  static uint16_t last_timer = 0;
   uint8_t i, j;
   int8_t k;
   int8_t increment = 1;
   if (interval % 2) {
     increment = -1;
   }
-  if (timer_elapsed(last_timer) < pgm_read_byte(&RGBLED_SNAKE_INTERVALS[interval / 2])) {
-    return;
-  }
-  last_timer = timer_read();
   for (i = 0; i < RGBLED_NUM; i++) {
     led[i].r = 0;
     led[i].g = 0;
@@ -540,15 +543,10 @@ void rgblight_effect_snake(uint8_t interval) {
 }
 void rgblight_effect_knight(uint8_t interval) {
   static int8_t pos = 0;
-  static uint16_t last_timer = 0;
   uint8_t i, j, cur;
   int8_t k;
   LED_TYPE preled[RGBLED_NUM];
   static int8_t increment = -1;
-  if (timer_elapsed(last_timer) < pgm_read_byte(&RGBLED_KNIGHT_INTERVALS[interval])) {
-    return;
-  }
-  last_timer = timer_read();
   for (i = 0; i < RGBLED_NUM; i++) {
     preled[i].r = 0;
     preled[i].g = 0;
@@ -595,13 +593,8 @@ void rgblight_effect_knight(uint8_t interval) {
 
 void rgblight_effect_christmas(void) {
   static uint16_t current_offset = 0;
-  static uint16_t last_timer = 0;
   uint16_t hue;
   uint8_t i;
-  if (timer_elapsed(last_timer) < RGBLIGHT_EFFECT_CHRISTMAS_INTERVAL) {
-    return;
-  }
-  last_timer = timer_read();
   current_offset = (current_offset + 1) % 2;
   for (i = 0; i < RGBLED_NUM; i++) {
     hue = 0 + ((i/RGBLIGHT_EFFECT_CHRISTMAS_STEP + current_offset) % 2) * 120;
@@ -0,0 +1,75 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sequence_trie.h"
+
+bool seq_trie_sorted(const seq_trie_t *trie) {
+    for (uint16_t i = 1; i < trie->size; i++) {
+        for (uint8_t depth = 0; ; depth++) {
+            uint16_t prev = trie->key(i - 1, depth);
+            uint16_t key = trie->key(i, depth);
+            if (prev < key) break;
+            if (prev > key) return false;
+            // the same sequence twice, the first one wins
+            if (!key) break;
+        }
+    }
+    return true;
+}
+
+void seq_cursor_init(const seq_trie_t *trie, seq_cursor_t *cursor) {
+    cursor->lo = 0;
+    cursor->hi = trie->size;
+    cursor->depth = 0;
+}
+
+/* the first entry in [lo, hi) whose key at depth is above key, or above or
+ * equal to it when inclusive */
+static uint16_t seq_search(const seq_trie_t *trie, uint16_t lo, uint16_t hi, uint8_t depth, uint16_t key, bool inclusive) {
+    while (lo < hi) {
+        uint16_t mid = lo + (hi - lo) / 2;
+        uint16_t mid_key = trie->key(mid, depth);
+        if (mid_key < key || (!inclusive && mid_key == key)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+bool seq_cursor_next(const seq_trie_t *trie, seq_cursor_t *cursor, uint16_t key) {
+    if (cursor->lo < cursor->hi && key) {
+        cursor->lo = seq_search(trie, cursor->lo, cursor->hi, cursor->depth, key, true);
+        cursor->hi = seq_search(trie, cursor->lo, cursor->hi, cursor->depth, key, false);
+    } else {
+        cursor->hi = cursor->lo;
+    }
+    cursor->depth++;
+    return cursor->lo < cursor->hi;
+}
+
+uint16_t seq_cursor_match(const seq_trie_t *trie, const seq_cursor_t *cursor) {
+    // an entry that ends here sorts first
+    if (cursor->lo < cursor->hi && !trie->key(cursor->lo, cursor->depth)) {
+        return cursor->lo;
+    }
+    return SEQ_NO_MATCH;
+}
+
+bool seq_cursor_complete(const seq_trie_t *trie, const seq_cursor_t *cursor) {
+    return cursor->hi - cursor->lo == 1 && seq_cursor_match(trie, cursor) != SEQ_NO_MATCH;
+}
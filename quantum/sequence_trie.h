@@ -0,0 +1,60 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SEQUENCE_TRIE_H
+#define SEQUENCE_TRIE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* A table of key sequences, sorted by their keys, is a trie laid out flat:
+ * the entries that start with the keys typed so far are a contiguous range,
+ * and each new key narrows it down with two binary searches. That gives
+ * UCIS and the leader key an O(log n) lookup per key, from a table that
+ * stays in PROGMEM (or wherever the user put it), with no index in RAM.
+ */
+
+#define SEQ_NO_MATCH 0xFFFF
+
+typedef struct {
+    /* The key at depth of the entry at index, 0 past the end of the
+     * sequence. Only called for depths the entry gets to. */
+    uint16_t (*key)(uint16_t index, uint8_t depth);
+    uint16_t size;
+} seq_trie_t;
+
+typedef struct {
+    /* the entries [lo, hi) start with the keys so far */
+    uint16_t lo;
+    uint16_t hi;
+    uint8_t depth;
+} seq_cursor_t;
+
+/* Is the table in the order the cursor needs: by the first key, then by
+ * the second, and so on, with a sequence before the longer ones it starts */
+bool seq_trie_sorted(const seq_trie_t *trie);
+
+void seq_cursor_init(const seq_trie_t *trie, seq_cursor_t *cursor);
+/* Narrow the cursor down to the entries with key next. Returns false when
+ * none are left. */
+bool seq_cursor_next(const seq_trie_t *trie, seq_cursor_t *cursor, uint16_t key);
+/* The entry that is exactly the keys so far, or SEQ_NO_MATCH */
+uint16_t seq_cursor_match(const seq_trie_t *trie, const seq_cursor_t *cursor);
+/* True when the keys so far are an entry that no other entry continues, so
+ * there is no point in waiting for more keys */
+bool seq_cursor_complete(const seq_trie_t *trie, const seq_cursor_t *cursor);
+
+#endif
@@ -25,6 +25,8 @@ SOFTWARE.
 #include "serial_link/protocol/byte_stuffer.h"
 #include "serial_link/protocol/frame_validator.h"
 #include "serial_link/protocol/physical.h"
+#include "serial_link/protocol/frame_queue.h"
+#include "serial_link/protocol/crc32.h"
 #include <stdbool.h>
 
 // This implements the "Consistent overhead byte stuffing protocol"
@@ -35,6 +37,8 @@ typedef struct byte_stuffer_state {
     uint16_t next_zero;
     uint16_t data_pos;
     bool long_frame;
+    // The CRC of the decoded data so far
+    uint32_t crc;
     uint8_t data[MAX_FRAME_SIZE];
 }byte_stuffer_state_t;
 
@@ -44,6 +48,7 @@ void init_byte_stuffer_state(byte_stuffer_state_t* state) {
     state->next_zero = 0;
     state->data_pos = 0;
     state->long_frame = false;
+    state->crc = CRC32_INIT;
 }
 
 void init_byte_stuffer(void) {
@@ -51,6 +56,7 @@ void init_byte_stuffer(void) {
     for (i=0;i<NUM_LINKS;i++) {
         init_byte_stuffer_state(&states[i]);
     }
+    frame_queue_init();
 }
 
 void byte_stuffer_recv_byte(uint8_t link, uint8_t data) {
@@ -60,6 +66,7 @@ void byte_stuffer_recv_byte(uint8_t link, uint8_t data) {
         state->next_zero = data;
         state->long_frame = data == 0xFF;
         state->data_pos = 0;
+        state->crc = CRC32_INIT;
         return;
     }
 
@@ -68,7 +75,7 @@ void byte_stuffer_recv_byte(uint8_t link, uint8_t data) {
         if (state->next_zero == 0) {
             // The frame is completed
             if (state->data_pos > 0) {
-                validator_recv_frame(link, state->data, state->data_pos);
+                validator_recv_frame_crc(link, state->data, state->data_pos, state->crc);
             }
         }
         else {
@@ -83,6 +90,7 @@ void byte_stuffer_recv_byte(uint8_t link, uint8_t data) {
             state->next_zero = data;
             state->long_frame = data == 0xFF;
             state->data_pos = 0;
+            state->crc = CRC32_INIT;
         }
         else if (state->next_zero == 0) {
             if (state->long_frame) {
@@ -94,49 +102,58 @@ void byte_stuffer_recv_byte(uint8_t link, uint8_t data) {
                 // Special case for zeroes
                 state->next_zero = data;
                 state->data[state->data_pos++] = 0;
+                state->crc = crc32_update_byte(state->crc, 0);
             }
         }
         else {
             state->data[state->data_pos++] = data;
+            state->crc = crc32_update_byte(state->crc, data);
         }
     }
 }
 
-static void send_block(uint8_t link, uint8_t* start, uint8_t* end, uint8_t num_non_zero) {
-    send_data(link, &num_non_zero, 1);
-    if (end > start) {
-        send_data(link, start, end-start);
+uint16_t byte_stuffer_encode(const uint8_t* data, uint16_t size, uint8_t* out) {
+    if (size == 0) {
+        return 0;
     }
-}
-
-void byte_stuffer_send_frame(uint8_t link, uint8_t* data, uint16_t size) {
-    const uint8_t zero = 0;
-    if (size > 0) {
-        uint16_t num_non_zero = 1;
-        uint8_t* end = data + size;
-        uint8_t* start = data;
-        while (data < end) {
-            if (num_non_zero == 0xFF) {
-                // There's more data after big non-zero block
-                // So send it, and start a new block
-                send_block(link, start, data, num_non_zero);
-                start = data;
+    uint8_t* code = out;
+    uint8_t* dst = out + 1;
+    uint8_t num_non_zero = 1;
+    const uint8_t* end = data + size;
+    while (data < end) {
+        if (num_non_zero == 0xFF) {
+            // There's more data after big non-zero block
+            // So end it, and start a new block
+            *code = num_non_zero;
+            code = dst++;
+            num_non_zero = 1;
+        }
+        else {
+            if (*data == 0) {
+                // A zero encountered, so end the block
+                *code = num_non_zero;
+                code = dst++;
                 num_non_zero = 1;
             }
             else {
-                if (*data == 0) {
-                    // A zero encountered, so send the block
-                    send_block(link, start, data, num_non_zero);
-                    start = data + 1;
-                    num_non_zero = 1;
-                }
-                else {
-                    num_non_zero++;
-                }
-                ++data;
+                *dst++ = *data;
+                num_non_zero++;
             }
+            ++data;
+        }
+    }
+    *code = num_non_zero;
+    *dst++ = 0;
+    return dst - out;
+}
+
+void byte_stuffer_send_frame(uint8_t link, uint8_t* data, uint16_t size) {
+    if (size > 0) {
+        // Encode straight into the transmit queue
+        uint8_t* out = frame_queue_begin_write(link, BYTE_STUFFER_MAX_ENCODED_SIZE(size));
+        if (out) {
+            frame_queue_end_write(link, byte_stuffer_encode(data, size, out));
+            signal_frame_queued(link);
         }
-        send_block(link, start, data, num_non_zero);
-        send_data(link, &zero, 1);
     }
 }
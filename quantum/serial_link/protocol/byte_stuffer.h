@@ -32,6 +32,13 @@ SOFTWARE.
 
 void init_byte_stuffer(void);
 void byte_stuffer_recv_byte(uint8_t link, uint8_t data);
+// Encodes the frame into the transmit queue of the link, see frame_queue.h.
+// When the queue is full the frame is dropped.
 void byte_stuffer_send_frame(uint8_t link, uint8_t* data, uint16_t size);
 
+// The most bytes a frame of size bytes can be encoded into
+#define BYTE_STUFFER_MAX_ENCODED_SIZE(size) ((size) + (size) / 254 + 2)
+// Encodes a whole frame, including the terminating zero, and returns its size
+uint16_t byte_stuffer_encode(const uint8_t* data, uint16_t size, uint8_t* out);
+
 #endif
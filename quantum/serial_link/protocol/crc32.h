@@ -0,0 +1,66 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2017 QMK contributors
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SERIAL_LINK_CRC32_H
+#define SERIAL_LINK_CRC32_H
+
+#include <stdint.h>
+
+// The standard reflected CRC-32 (polynomial 0xEDB88320), computed either
+// incrementally a byte at a time, or over whole buffers with a table driven
+// slicing-by-4 or slicing-by-8 loop, picked with CRC32_SLICES (1, 4 or 8).
+//
+// MCUs with a CRC unit can define CRC32_HARDWARE and implement
+// crc32_hardware_update, which is then used for whole buffers.
+
+#ifndef CRC32_SLICES
+#define CRC32_SLICES 4
+#endif
+
+#define CRC32_INIT 0xFFFFFFFF
+// The CRC state after a frame followed by its own little endian CRC
+#define CRC32_RESIDUE 0xDEBB20E3
+
+extern const uint32_t crc32_table0[256];
+
+static inline uint32_t crc32_update_byte(uint32_t crc, uint8_t data) {
+    return crc32_table0[(uint8_t)crc ^ data] ^ (crc >> 8);
+}
+
+static inline uint32_t crc32_final(uint32_t crc) {
+    return crc ^ 0xFFFFFFFF;
+}
+
+uint32_t crc32_update(uint32_t crc, const uint8_t* data, uint16_t size);
+// The CRC of a whole buffer
+uint32_t crc32(const uint8_t* data, uint16_t size);
+
+uint32_t crc32_update_bytewise(uint32_t crc, const uint8_t* data, uint16_t size);
+uint32_t crc32_update_slicing4(uint32_t crc, const uint8_t* data, uint16_t size);
+uint32_t crc32_update_slicing8(uint32_t crc, const uint8_t* data, uint16_t size);
+#ifdef CRC32_HARDWARE
+uint32_t crc32_hardware_update(uint32_t crc, const uint8_t* data, uint16_t size);
+#endif
+
+#endif
@@ -0,0 +1,160 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2017 QMK contributors
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "serial_link/protocol/frame_queue.h"
+#include "serial_link/protocol/byte_stuffer.h"
+#include "serial_link/protocol/physical.h"
+#include <stddef.h>
+
+// Every frame starts with a 4 byte header holding its size, so that the
+// data stays aligned. A frame never wraps around the end of the buffer,
+// when it doesn't fit there it's written at the start, and a header with
+// WRAP_MARKER tells the consumer to follow it.
+#define HEADER_SIZE 4
+#define WRAP_MARKER 0xFFFF
+#define ALIGN(size) (((size) + 3) & ~3)
+
+#if SERIAL_LINK_TX_QUEUE_SIZE % 4 != 0
+#error "SERIAL_LINK_TX_QUEUE_SIZE must be a multiple of 4"
+#endif
+
+typedef struct {
+    uint8_t buffer[SERIAL_LINK_TX_QUEUE_SIZE] __attribute__((aligned(4)));
+    // Written only by the producer
+    volatile uint16_t head;
+    uint16_t write_pos;
+    uint16_t dropped;
+    // Written only by the consumer
+    volatile uint16_t tail;
+} frame_queue_t;
+
+static frame_queue_t queues[NUM_LINKS];
+
+#define memory_barrier() __sync_synchronize()
+
+static inline uint16_t read_header(frame_queue_t* queue, uint16_t pos) {
+    return *(uint16_t*)&queue->buffer[pos];
+}
+
+static inline void write_header(frame_queue_t* queue, uint16_t pos, uint16_t size) {
+    *(uint16_t*)&queue->buffer[pos] = size;
+}
+
+void frame_queue_init(void) {
+    int i;
+    for (i=0;i<NUM_LINKS;i++) {
+        queues[i].head = 0;
+        queues[i].tail = 0;
+        queues[i].write_pos = 0;
+        queues[i].dropped = 0;
+    }
+}
+
+uint8_t* frame_queue_begin_write(uint8_t link, uint16_t max_size) {
+    frame_queue_t* queue = &queues[link];
+    uint32_t needed = HEADER_SIZE + ALIGN((uint32_t)max_size);
+    uint16_t head = queue->head;
+    uint16_t tail = queue->tail;
+    // The head never catches up with the tail, as that would look empty
+    if (head >= tail) {
+        uint16_t at_end = SERIAL_LINK_TX_QUEUE_SIZE - head;
+        if (needed < at_end || (needed == at_end && tail != 0)) {
+            queue->write_pos = head;
+            return &queue->buffer[head + HEADER_SIZE];
+        }
+        if (needed < tail) {
+            queue->write_pos = 0;
+            return &queue->buffer[HEADER_SIZE];
+        }
+    }
+    else if (needed < (uint16_t)(tail - head)) {
+        queue->write_pos = head;
+        return &queue->buffer[head + HEADER_SIZE];
+    }
+    queue->dropped++;
+    return NULL;
+}
+
+void frame_queue_end_write(uint8_t link, uint16_t size) {
+    frame_queue_t* queue = &queues[link];
+    uint16_t head = queue->head;
+    if (queue->write_pos != head) {
+        write_header(queue, head, WRAP_MARKER);
+    }
+    write_header(queue, queue->write_pos, size);
+    head = queue->write_pos + HEADER_SIZE + ALIGN(size);
+    if (head == SERIAL_LINK_TX_QUEUE_SIZE) {
+        head = 0;
+    }
+    // Publish the frame only once it's completely written
+    memory_barrier();
+    queue->head = head;
+}
+
+uint16_t frame_queue_dropped(uint8_t link) {
+    return queues[link].dropped;
+}
+
+const uint8_t* frame_queue_peek(uint8_t link, uint16_t* size) {
+    frame_queue_t* queue = &queues[link];
+    uint16_t tail = queue->tail;
+    if (tail == queue->head) {
+        return NULL;
+    }
+    memory_barrier();
+    if (read_header(queue, tail) == WRAP_MARKER) {
+        tail = 0;
+        queue->tail = tail;
+    }
+    *size = read_header(queue, tail);
+    return &queue->buffer[tail + HEADER_SIZE];
+}
+
+void frame_queue_pop(uint8_t link) {
+    frame_queue_t* queue = &queues[link];
+    uint16_t size;
+    if (!frame_queue_peek(link, &size)) {
+        return;
+    }
+    uint16_t tail = queue->tail + HEADER_SIZE + ALIGN(size);
+    if (tail == SERIAL_LINK_TX_QUEUE_SIZE) {
+        tail = 0;
+    }
+    // Don't let the producer reuse the frame before we are done with it
+    memory_barrier();
+    queue->tail = tail;
+}
+
+bool frame_queue_empty(uint8_t link) {
+    return queues[link].head == queues[link].tail;
+}
+
+void frame_queue_drain(uint8_t link) {
+    const uint8_t* frame;
+    uint16_t size;
+    while ((frame = frame_queue_peek(link, &size))) {
+        send_data(link, frame, size);
+        frame_queue_pop(link);
+    }
+}
@@ -0,0 +1,61 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2017 QMK contributors
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SERIAL_LINK_FRAME_QUEUE_H
+#define SERIAL_LINK_FRAME_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Encoded frames waiting to be sent, in one single producer single consumer
+// ring buffer per link. The byte stuffer encodes straight into the ring, and
+// every frame is contiguous and 4 byte aligned, so that the physical layer
+// can hand it to the UART or a DMA channel as it is. Only the head and tail
+// indices are shared, so the producer and the consumer can run in different
+// threads, or the consumer in an interrupt, without any locking.
+
+#ifndef SERIAL_LINK_TX_QUEUE_SIZE
+#define SERIAL_LINK_TX_QUEUE_SIZE 512
+#endif
+
+void frame_queue_init(void);
+
+// Producer side
+// Returns room for a frame of up to max_size bytes, or NULL when the queue
+// is full, in which case the frame counts as dropped
+uint8_t* frame_queue_begin_write(uint8_t link, uint16_t max_size);
+// Queues the first size bytes written since frame_queue_begin_write
+void frame_queue_end_write(uint8_t link, uint16_t size);
+uint16_t frame_queue_dropped(uint8_t link);
+
+// Consumer side
+// Returns the oldest frame, which stays valid until frame_queue_pop, or NULL
+const uint8_t* frame_queue_peek(uint8_t link, uint16_t* size);
+void frame_queue_pop(uint8_t link);
+bool frame_queue_empty(uint8_t link);
+// Sends all queued frames with send_data, for physical layers without
+// asynchronous writes
+void frame_queue_drain(uint8_t link);
+
+#endif
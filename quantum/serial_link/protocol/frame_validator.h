@@ -28,6 +28,9 @@ SOFTWARE.
 #include <stdint.h>
 
 void validator_recv_frame(uint8_t link, uint8_t* data, uint16_t size);
+// Same as above, but with the CRC state already computed incrementally over
+// the whole frame, starting from CRC32_INIT
+void validator_recv_frame_crc(uint8_t link, uint8_t* data, uint16_t size, uint32_t crc);
 // The buffer pointed to by the data needs 4 additional bytes
 void validator_send_frame(uint8_t link, uint8_t* data, uint16_t size);
 
@@ -25,6 +25,11 @@ SOFTWARE.
 #ifndef SERIAL_LINK_PHYSICAL_H
 #define SERIAL_LINK_PHYSICAL_H
 
+// Writes the data to the link, used by frame_queue_drain
 void send_data(uint8_t link, const uint8_t* data, uint16_t size);
+// Called after a frame has been added to the transmit queue of the link.
+// It can be sent from any thread, or from the transmit interrupt, with
+// frame_queue_peek and frame_queue_pop.
+void signal_frame_queued(uint8_t link);
 
 #endif
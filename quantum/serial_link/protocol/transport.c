@@ -26,11 +26,147 @@ SOFTWARE.
 #include "serial_link/protocol/frame_router.h"
 #include "serial_link/protocol/triple_buffered_object.h"
 #include <string.h>
+#include <stdbool.h>
 
 #define MAX_REMOTE_OBJECTS 16
 static remote_object_t* remote_objects[MAX_REMOTE_OBJECTS];
 static uint32_t num_remote_objects = 0;
 
+#ifdef SERIAL_LINK_DELTA_OBJECTS
+// A frame is the object or delta, followed by a header byte and the object id
+#define KEYFRAME_FLAG 0x80
+#define SEQUENCE_MASK 0x7F
+
+static uint8_t delta_buffer[SERIAL_LINK_DELTA_BUFFER_SIZE];
+
+static delta_object_t* get_delta_object(uint8_t* start, uint16_t slot_size, uint16_t object_size) {
+    return (delta_object_t*)(start + slot_size - DELTA_OBJECT_SIZE(object_size));
+}
+
+// The changed bytes are encoded as a sequence of
+// [unchanged bytes to skip] [number of changed bytes] [changed bytes]
+// runs, with the unchanged bytes at the end left out
+static bool delta_encode(const uint8_t* data, const uint8_t* base, uint16_t size,
+        uint8_t* out, uint16_t max_size, uint16_t* out_size) {
+    uint16_t pos = 0;
+    uint16_t out_pos = 0;
+    while (true) {
+        uint8_t skip = 0;
+        while (pos < size && data[pos] == base[pos] && skip < 255) {
+            pos++;
+            skip++;
+        }
+        if (pos == size) {
+            break;
+        }
+        uint8_t len = 0;
+        while (pos + len < size && data[pos + len] != base[pos + len] && len < 255) {
+            len++;
+        }
+        if (out_pos + 2 + len > max_size) {
+            return false;
+        }
+        out[out_pos++] = skip;
+        out[out_pos++] = len;
+        memcpy(out + out_pos, data + pos, len);
+        out_pos += len;
+        pos += len;
+    }
+    *out_size = out_pos;
+    return true;
+}
+
+static bool delta_decode(const uint8_t* in, uint16_t in_size, uint8_t* base, uint16_t size) {
+    uint16_t pos = 0;
+    uint16_t i = 0;
+    while (i < in_size) {
+        if (in_size - i < 2) {
+            return false;
+        }
+        pos += in[i];
+        uint8_t len = in[i + 1];
+        i += 2;
+        if (len > in_size - i || pos + len > size) {
+            return false;
+        }
+        memcpy(base + pos, in + i, len);
+        pos += len;
+        i += len;
+    }
+    return true;
+}
+
+// Replaces the object with the frame to send, and returns its size without
+// the id, or 0 if nothing needs to be sent
+static uint16_t encode_delta_frame(delta_object_t* delta, uint8_t* data, uint16_t object_size) {
+    bool keyframe = delta->counter == 0;
+    delta->counter = keyframe ? SERIAL_LINK_KEYFRAME_INTERVAL - 1 : delta->counter - 1;
+    uint16_t size = object_size;
+    if (!keyframe) {
+        uint16_t max_size = object_size - 1;
+        if (max_size > SERIAL_LINK_DELTA_BUFFER_SIZE) {
+            max_size = SERIAL_LINK_DELTA_BUFFER_SIZE;
+        }
+        keyframe = !delta_encode(data, delta->data, object_size, delta_buffer, max_size, &size);
+        if (!keyframe && size == 0) {
+            return 0;
+        }
+    }
+    memcpy(delta->data, data, object_size);
+    if (keyframe) {
+        size = object_size;
+    }
+    else {
+        memcpy(data, delta_buffer, size);
+    }
+    delta->sequence = (delta->sequence + 1) & SEQUENCE_MASK;
+    data[size] = delta->sequence | (keyframe ? KEYFRAME_FLAG : 0);
+    return size + 1;
+}
+
+// Applies the frame without the id to the last received object
+static bool decode_delta_frame(delta_object_t* delta, const uint8_t* data, uint16_t size, uint16_t object_size) {
+    if (size == 0) {
+        return false;
+    }
+    uint8_t header = data[size - 1];
+    uint8_t sequence = header & SEQUENCE_MASK;
+    size--;
+    if (header & KEYFRAME_FLAG) {
+        if (size != object_size) {
+            return false;
+        }
+        memcpy(delta->data, data, size);
+    }
+    else {
+        // A delta can only be applied to the object it was based on
+        if (!delta->counter || sequence != ((delta->sequence + 1) & SEQUENCE_MASK)) {
+            delta->counter = 0;
+            return false;
+        }
+        if (!delta_decode(data, size, delta->data, object_size)) {
+            delta->counter = 0;
+            return false;
+        }
+    }
+    delta->sequence = sequence;
+    delta->counter = 1;
+    return true;
+}
+#endif
+
+static void init_object_slot(uint8_t* start, uint16_t slot_size, uint16_t object_size) {
+    triple_buffer_init((triple_buffer_object_t*)start);
+#ifdef SERIAL_LINK_DELTA_OBJECTS
+    delta_object_t* delta = get_delta_object(start, slot_size, object_size);
+    delta->sequence = 0;
+    delta->counter = 0;
+#else
+    (void)slot_size;
+    (void)object_size;
+#endif
+}
+
 void reinitialize_serial_link_transport(void) {
     num_remote_objects = 0;
 }
@@ -40,34 +176,29 @@ void add_remote_objects(remote_object_t** _remote_objects, uint32_t _num_remote_
     for(i=0;i<_num_remote_objects;i++) {
         remote_object_t* obj = _remote_objects[i];
         remote_objects[num_remote_objects++] = obj;
+        uint16_t local_size = LOCAL_OBJECT_SIZE(obj->object_size);
+        uint16_t remote_size = REMOTE_OBJECT_SIZE(obj->object_size);
         if (obj->object_type == MASTER_TO_ALL_SLAVES) {
-            triple_buffer_object_t* tb = (triple_buffer_object_t*)obj->buffer;
-            triple_buffer_init(tb);
-            uint8_t* start = obj->buffer + LOCAL_OBJECT_SIZE(obj->object_size);
-            tb = (triple_buffer_object_t*)start;
-            triple_buffer_init(tb);
+            init_object_slot(obj->buffer, local_size, obj->object_size);
+            init_object_slot(obj->buffer + local_size, remote_size, obj->object_size);
         }
         else if(obj->object_type == MASTER_TO_SINGLE_SLAVE) {
             uint8_t* start = obj->buffer;
             unsigned int j;
             for (j=0;j<NUM_SLAVES;j++) {
-                triple_buffer_object_t* tb = (triple_buffer_object_t*)start;
-                triple_buffer_init(tb);
-                start += LOCAL_OBJECT_SIZE(obj->object_size);
+                init_object_slot(start, local_size, obj->object_size);
+                start += local_size;
             }
-            triple_buffer_object_t* tb = (triple_buffer_object_t*)start;
-            triple_buffer_init(tb);
+            init_object_slot(start, remote_size, obj->object_size);
         }
         else {
             uint8_t* start = obj->buffer;
-            triple_buffer_object_t* tb = (triple_buffer_object_t*)start;
-            triple_buffer_init(tb);
-            start += LOCAL_OBJECT_SIZE(obj->object_size);
+            init_object_slot(start, local_size, obj->object_size);
+            start += local_size;
             unsigned int j;
             for (j=0;j<NUM_SLAVES;j++) {
-                tb = (triple_buffer_object_t*)start;
-                triple_buffer_init(tb);
-                start += REMOTE_OBJECT_SIZE(obj->object_size);
+                init_object_slot(start, remote_size, obj->object_size);
+                start += remote_size;
             }
         }
     }
@@ -77,23 +208,50 @@ void transport_recv_frame(uint8_t from, uint8_t* data, uint16_t size) {
     uint8_t id = data[size-1];
     if (id < num_remote_objects) {
         remote_object_t* obj = remote_objects[id];
-        if (obj->object_size == size - 1) {
-            uint8_t* start;
-            if (obj->object_type == MASTER_TO_ALL_SLAVES) {
-                start = obj->buffer + LOCAL_OBJECT_SIZE(obj->object_size);
-            }
-            else if(obj->object_type == SLAVE_TO_MASTER) {
-                start = obj->buffer + LOCAL_OBJECT_SIZE(obj->object_size);
-                start += (from - 1) * REMOTE_OBJECT_SIZE(obj->object_size);
-            }
-            else {
-                start = obj->buffer + NUM_SLAVES * LOCAL_OBJECT_SIZE(obj->object_size);
-            }
-            triple_buffer_object_t* tb = (triple_buffer_object_t*)start;
-            void* ptr = triple_buffer_begin_write_internal(obj->object_size, tb);
-            memcpy(ptr, data, size - 1);
-            triple_buffer_end_write_internal(tb);
+        uint8_t* start;
+        if (obj->object_type == MASTER_TO_ALL_SLAVES) {
+            start = obj->buffer + LOCAL_OBJECT_SIZE(obj->object_size);
+        }
+        else if(obj->object_type == SLAVE_TO_MASTER) {
+            start = obj->buffer + LOCAL_OBJECT_SIZE(obj->object_size);
+            start += (from - 1) * REMOTE_OBJECT_SIZE(obj->object_size);
+        }
+        else {
+            start = obj->buffer + NUM_SLAVES * LOCAL_OBJECT_SIZE(obj->object_size);
+        }
+#ifdef SERIAL_LINK_DELTA_OBJECTS
+        delta_object_t* delta = get_delta_object(start, REMOTE_OBJECT_SIZE(obj->object_size), obj->object_size);
+        if (!decode_delta_frame(delta, data, size - 1, obj->object_size)) {
+            return;
         }
+        data = delta->data;
+#else
+        if (obj->object_size != size - 1) {
+            return;
+        }
+#endif
+        triple_buffer_object_t* tb = (triple_buffer_object_t*)start;
+        void* ptr = triple_buffer_begin_write_internal(obj->object_size, tb);
+        memcpy(ptr, data, obj->object_size);
+        triple_buffer_end_write_internal(tb);
+    }
+}
+
+static void send_object(remote_object_t* obj, uint8_t id, uint8_t* start, uint8_t dest) {
+    triple_buffer_object_t* tb = (triple_buffer_object_t*)start;
+    uint8_t* ptr = (uint8_t*)triple_buffer_read_internal(obj->object_size + LOCAL_OBJECT_EXTRA, tb);
+    if (ptr) {
+#ifdef SERIAL_LINK_DELTA_OBJECTS
+        delta_object_t* delta = get_delta_object(start, LOCAL_OBJECT_SIZE(obj->object_size), obj->object_size);
+        uint16_t size = encode_delta_frame(delta, ptr, obj->object_size);
+        if (size == 0) {
+            return;
+        }
+#else
+        uint16_t size = obj->object_size;
+#endif
+        ptr[size] = id;
+        router_send_frame(dest, ptr, size + 1);
     }
 }
 
@@ -102,25 +260,14 @@ void update_transport(void) {
     for(i=0;i<num_remote_objects;i++) {
         remote_object_t* obj = remote_objects[i];
         if (obj->object_type == MASTER_TO_ALL_SLAVES || obj->object_type == SLAVE_TO_MASTER) {
-            triple_buffer_object_t* tb = (triple_buffer_object_t*)obj->buffer;
-            uint8_t* ptr = (uint8_t*)triple_buffer_read_internal(obj->object_size + LOCAL_OBJECT_EXTRA, tb);
-            if (ptr) {
-                ptr[obj->object_size] = i;
-                uint8_t dest = obj->object_type == MASTER_TO_ALL_SLAVES ? 0xFF : 0;
-                router_send_frame(dest, ptr, obj->object_size + 1);
-            }
+            uint8_t dest = obj->object_type == MASTER_TO_ALL_SLAVES ? 0xFF : 0;
+            send_object(obj, i, obj->buffer, dest);
         }
         else {
             uint8_t* start = obj->buffer;
             unsigned int j;
             for (j=0;j<NUM_SLAVES;j++) {
-                triple_buffer_object_t* tb = (triple_buffer_object_t*)start;
-                uint8_t* ptr = (uint8_t*)triple_buffer_read_internal(obj->object_size + LOCAL_OBJECT_EXTRA, tb);
-                if (ptr) {
-                    ptr[obj->object_size] = i;
-                    uint8_t dest = j + 1;
-                    router_send_frame(dest, ptr, obj->object_size + 1);
-                }
+                send_object(obj, i, start, j + 1);
                 start += LOCAL_OBJECT_SIZE(obj->object_size);
             }
         }
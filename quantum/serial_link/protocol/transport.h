@@ -46,26 +46,56 @@ typedef struct {
     uint8_t buffer[] __attribute__((aligned(4)));
 } remote_object_t;
 
+#ifdef SERIAL_LINK_DELTA_OBJECTS
+// Only the bytes that changed since the previous frame are sent, and writes
+// that don't change anything are not sent at all. Every
+// SERIAL_LINK_KEYFRAME_INTERVAL writes the whole object is sent, so that the
+// receivers can recover from lost frames.
+#ifndef SERIAL_LINK_KEYFRAME_INTERVAL
+#define SERIAL_LINK_KEYFRAME_INTERVAL 32
+#endif
+// The maximum size of an encoded delta, bigger changes are sent as keyframes
+#ifndef SERIAL_LINK_DELTA_BUFFER_SIZE
+#define SERIAL_LINK_DELTA_BUFFER_SIZE 64
+#endif
+
+// The last object sent or received, which the deltas are based on
+typedef struct {
+    uint8_t sequence;
+    // The writes left until the next keyframe when sending, and non-zero
+    // when the data is valid when receiving
+    uint8_t counter;
+    uint8_t data[];
+} delta_object_t;
+
+#define DELTA_OBJECT_SIZE(objectsize) \
+    ((sizeof(delta_object_t) + (objectsize) + 3) & ~3)
+#else
+#define DELTA_OBJECT_SIZE(objectsize) 0
+#endif
+
 #define REMOTE_OBJECT_SIZE(objectsize) \
-    (sizeof(triple_buffer_object_t) + objectsize * 3)
+    (sizeof(triple_buffer_object_t) + (objectsize) * 3 + DELTA_OBJECT_SIZE(objectsize))
 #define LOCAL_OBJECT_SIZE(objectsize) \
-    (sizeof(triple_buffer_object_t) + (objectsize + LOCAL_OBJECT_EXTRA) * 3)
+    (sizeof(triple_buffer_object_t) + ((objectsize) + LOCAL_OBJECT_EXTRA) * 3 + \
+     DELTA_OBJECT_SIZE(objectsize))
 
+// Has the same layout as remote_object_t, but with a sized buffer, since a
+// struct ending in a flexible array can't be a member of another one in C++
 #define REMOTE_OBJECT_HELPER(name, type, num_local, num_remote) \
 typedef struct { \
-    remote_object_t object; \
+    remote_object_type object_type; \
+    uint16_t object_size; \
     uint8_t buffer[ \
         num_remote * REMOTE_OBJECT_SIZE(sizeof(type)) + \
-        num_local * LOCAL_OBJECT_SIZE(sizeof(type))]; \
+        num_local * LOCAL_OBJECT_SIZE(sizeof(type))] __attribute__((aligned(4))); \
 } remote_object_##name##_t;
 
 #define MASTER_TO_ALL_SLAVES_OBJECT(name, type) \
     REMOTE_OBJECT_HELPER(name, type, 1, 1) \
     remote_object_##name##_t remote_object_##name = { \
-        .object = { \
-            .object_type = MASTER_TO_ALL_SLAVES, \
-            .object_size = sizeof(type), \
-        } \
+        .object_type = MASTER_TO_ALL_SLAVES, \
+        .object_size = sizeof(type), \
     }; \
     type* begin_write_##name(void) { \
         remote_object_t* obj = (remote_object_t*)&remote_object_##name; \
@@ -88,10 +118,8 @@ typedef struct { \
 #define MASTER_TO_SINGLE_SLAVE_OBJECT(name, type) \
     REMOTE_OBJECT_HELPER(name, type, NUM_SLAVES, 1) \
     remote_object_##name##_t remote_object_##name = { \
-        .object = { \
-            .object_type = MASTER_TO_SINGLE_SLAVE, \
-            .object_size = sizeof(type), \
-        } \
+        .object_type = MASTER_TO_SINGLE_SLAVE, \
+        .object_size = sizeof(type), \
     }; \
     type* begin_write_##name(uint8_t slave) { \
         remote_object_t* obj = (remote_object_t*)&remote_object_##name; \
@@ -118,10 +146,8 @@ typedef struct { \
 #define SLAVE_TO_MASTER_OBJECT(name, type) \
     REMOTE_OBJECT_HELPER(name, type, 1, NUM_SLAVES) \
     remote_object_##name##_t remote_object_##name = { \
-        .object = { \
-            .object_type = SLAVE_TO_MASTER, \
-            .object_size = sizeof(type), \
-        } \
+        .object_type = SLAVE_TO_MASTER, \
+        .object_size = sizeof(type), \
     }; \
     type* begin_write_##name(void) { \
         remote_object_t* obj = (remote_object_t*)&remote_object_##name; \
@@ -28,6 +28,7 @@ SOFTWARE.
 #include "serial_link/protocol/byte_stuffer.h"
 #include "serial_link/protocol/transport.h"
 #include "serial_link/protocol/frame_router.h"
+#include "serial_link/protocol/frame_queue.h"
 #include "matrix.h"
 #include <stdbool.h>
 #include "print.h"
@@ -79,6 +80,25 @@ static uint32_t read_from_serial(SerialDriver* driver, uint8_t link) {
     return bytes_read;
 }
 
+// How much of the oldest queued frame of each link is already written
+static uint16_t write_pos[NUM_LINKS];
+
+// Writes as much of the queued frames as fits in the output queue of the
+// driver without waiting, the rest is written when it signals that it's
+// empty again
+static void write_to_serial(SerialDriver* driver, uint8_t link) {
+    uint16_t size;
+    const uint8_t* frame;
+    while ((frame = frame_queue_peek(link, &size))) {
+        write_pos[link] += sdAsynchronousWrite(driver, frame + write_pos[link], size - write_pos[link]);
+        if (write_pos[link] < size) {
+            return;
+        }
+        write_pos[link] = 0;
+        frame_queue_pop(link);
+    }
+}
+
 static void print_error(char* str, eventflags_t flags, SerialDriver* driver) {
 #ifdef DEBUG_LINK_ERRORS
     if (flags & SD_PARITY_ERROR) {
@@ -122,7 +142,7 @@ static THD_FUNCTION(serialThread, arg) {
     event_listener_t sd1_listener;
     event_listener_t sd2_listener;
     chEvtRegister(&new_data_event, &new_data_listener, 0);
-    eventflags_t events = CHN_INPUT_AVAILABLE
+    eventflags_t events = CHN_INPUT_AVAILABLE | CHN_OUTPUT_EMPTY
             | SD_PARITY_ERROR | SD_FRAMING_ERROR | SD_OVERRUN_ERROR | SD_NOISE_ERROR | SD_BREAK_DETECTED;
     chEvtRegisterMaskWithFlags(chnGetEventSource(&SD1),
         &sd1_listener,
@@ -156,9 +176,17 @@ static THD_FUNCTION(serialThread, arg) {
         need_wait &= read_from_serial(&SD2, UP_LINK) == 0;
         need_wait &= read_from_serial(&SD1, DOWN_LINK) == 0;
         update_transport();
+        write_to_serial(&SD2, UP_LINK);
+        write_to_serial(&SD1, DOWN_LINK);
     }
 }
 
+void signal_frame_queued(uint8_t link) {
+    (void)link;
+    // The frames are written by the serial thread
+    chEvtBroadcast(&new_data_event);
+}
+
 void send_data(uint8_t link, const uint8_t* data, uint16_t size) {
     if (link == DOWN_LINK) {
         sdWrite(&SD1, data, size);
@@ -30,6 +30,7 @@ extern "C" {
 #include "serial_link/protocol/byte_stuffer.h"
 #include "serial_link/protocol/frame_validator.h"
 #include "serial_link/protocol/physical.h"
+#include "serial_link/protocol/frame_queue.h"
 }
 
 using testing::_;
@@ -60,13 +61,17 @@ public:
 ByteStuffer* ByteStuffer::Instance = nullptr;
 
 extern "C" {
-    void validator_recv_frame(uint8_t link, uint8_t* data, uint16_t size) {
+    void validator_recv_frame_crc(uint8_t link, uint8_t* data, uint16_t size, uint32_t crc) {
         ByteStuffer::Instance->validator_recv_frame(link, data, size);
     }
 
     void send_data(uint8_t link, const uint8_t* data, uint16_t size) {
         ByteStuffer::Instance->send_data(link, data, size);
     }
+
+    void signal_frame_queued(uint8_t link) {
+        frame_queue_drain(link);
+    }
 }
 
 TEST_F(ByteStuffer, receives_no_frame_for_a_single_zero_byte) {
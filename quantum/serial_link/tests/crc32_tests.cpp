@@ -0,0 +1,113 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2017 QMK contributors
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include "gtest/gtest.h"
+extern "C" {
+#include "serial_link/protocol/crc32.h"
+}
+
+typedef uint32_t (*crc32_update_func)(uint32_t crc, const uint8_t* data, uint16_t size);
+
+static std::vector<uint8_t> make_data(size_t size) {
+    std::vector<uint8_t> data(size);
+    uint32_t x = 0x12345678;
+    for (size_t i = 0; i < size; i++) {
+        x = x * 1103515245 + 12345;
+        data[i] = x >> 16;
+    }
+    return data;
+}
+
+TEST(CRC32, calculates_check_value) {
+    const uint8_t data[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    EXPECT_EQ(crc32(data, sizeof(data)), 0xCBF43926);
+}
+
+TEST(CRC32, calculates_empty_buffer) {
+    EXPECT_EQ(crc32(nullptr, 0), 0);
+}
+
+TEST(CRC32, sliced_versions_match_bytewise_for_all_sizes_and_alignments) {
+    std::vector<uint8_t> data = make_data(64);
+    for (int offset = 0; offset < 8; offset++) {
+        for (int size = 0; size <= 64 - offset; size++) {
+            uint32_t expected = crc32_update_bytewise(CRC32_INIT, &data[offset], size);
+            EXPECT_EQ(crc32_update_slicing4(CRC32_INIT, &data[offset], size), expected);
+            EXPECT_EQ(crc32_update_slicing8(CRC32_INIT, &data[offset], size), expected);
+            EXPECT_EQ(crc32_update(CRC32_INIT, &data[offset], size), expected);
+        }
+    }
+}
+
+TEST(CRC32, incremental_update_matches_whole_buffer) {
+    std::vector<uint8_t> data = make_data(100);
+    uint32_t crc = CRC32_INIT;
+    crc = crc32_update(crc, &data[0], 13);
+    for (int i = 13; i < 50; i++) {
+        crc = crc32_update_byte(crc, data[i]);
+    }
+    crc = crc32_update(crc, &data[50], 50);
+    EXPECT_EQ(crc32_final(crc), crc32(&data[0], 100));
+}
+
+TEST(CRC32, data_followed_by_its_crc_gives_the_residue) {
+    std::vector<uint8_t> data = make_data(37);
+    uint32_t crc = crc32(&data[0], 37);
+    for (int i = 0; i < 4; i++) {
+        data.push_back(crc >> (8 * i));
+    }
+    EXPECT_EQ(crc32_update(CRC32_INIT, &data[0], data.size()), CRC32_RESIDUE);
+    data[5] ^= 1;
+    EXPECT_NE(crc32_update(CRC32_INIT, &data[0], data.size()), CRC32_RESIDUE);
+}
+
+#ifdef BENCHMARK
+static double bench(crc32_update_func func, const std::vector<uint8_t>& data, uint32_t* result) {
+    const int rounds = 2000;
+    uint32_t crc = CRC32_INIT;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        crc = func(crc, &data[0], data.size());
+    }
+    auto end = std::chrono::steady_clock::now();
+    *result = crc;
+    return std::chrono::duration<double, std::nano>(end - start).count() / ((double)rounds * data.size());
+}
+
+TEST(CRC32, benchmark) {
+    std::vector<uint8_t> data = make_data(4096);
+    uint32_t bytewise, slicing4, slicing8;
+    double bytewise_ns = bench(crc32_update_bytewise, data, &bytewise);
+    double slicing4_ns = bench(crc32_update_slicing4, data, &slicing4);
+    double slicing8_ns = bench(crc32_update_slicing8, data, &slicing8);
+    EXPECT_EQ(slicing4, bytewise);
+    EXPECT_EQ(slicing8, bytewise);
+    std::cout << "[ BENCH    ] ns per byte: bytewise " << bytewise_ns
+        << ", slicing-by-4 " << slicing4_ns
+        << ", slicing-by-8 " << slicing8_ns << std::endl;
+}
+#endif
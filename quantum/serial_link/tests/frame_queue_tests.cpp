@@ -0,0 +1,224 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2017 QMK contributors
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <vector>
+#include <thread>
+extern "C" {
+#include "serial_link/protocol/frame_queue.h"
+#include "serial_link/protocol/byte_stuffer.h"
+#include "serial_link/protocol/physical.h"
+}
+
+using testing::ElementsAre;
+using testing::ElementsAreArray;
+
+class FrameQueue : public testing::Test {
+public:
+    FrameQueue() {
+        Instance = this;
+        frame_queue_init();
+    }
+
+    ~FrameQueue() {
+        Instance = nullptr;
+    }
+
+    bool queue_frame(uint8_t link, const std::vector<uint8_t>& frame) {
+        uint8_t* buffer = frame_queue_begin_write(link, frame.size());
+        if (!buffer) {
+            return false;
+        }
+        std::copy(frame.begin(), frame.end(), buffer);
+        frame_queue_end_write(link, frame.size());
+        return true;
+    }
+
+    std::vector<uint8_t> pop_frame(uint8_t link) {
+        uint16_t size;
+        const uint8_t* frame = frame_queue_peek(link, &size);
+        if (!frame) {
+            return std::vector<uint8_t>();
+        }
+        std::vector<uint8_t> result(frame, frame + size);
+        frame_queue_pop(link);
+        return result;
+    }
+
+    void send_data(uint8_t link, const uint8_t* data, uint16_t size) {
+        sent_data[link].insert(sent_data[link].end(), data, data + size);
+    }
+
+    std::vector<uint8_t> sent_data[NUM_LINKS];
+    static FrameQueue* Instance;
+};
+
+FrameQueue* FrameQueue::Instance = nullptr;
+
+extern "C" {
+    void send_data(uint8_t link, const uint8_t* data, uint16_t size) {
+        FrameQueue::Instance->send_data(link, data, size);
+    }
+
+    void signal_frame_queued(uint8_t link) {
+    }
+
+    void validator_recv_frame_crc(uint8_t link, uint8_t* data, uint16_t size, uint32_t crc) {
+    }
+}
+
+TEST_F(FrameQueue, is_empty_after_init) {
+    uint16_t size;
+    EXPECT_TRUE(frame_queue_empty(0));
+    EXPECT_EQ(frame_queue_peek(0, &size), nullptr);
+}
+
+TEST_F(FrameQueue, returns_the_queued_frame) {
+    EXPECT_TRUE(queue_frame(0, {1, 2, 3}));
+    EXPECT_FALSE(frame_queue_empty(0));
+    EXPECT_TRUE(frame_queue_empty(1));
+    EXPECT_THAT(pop_frame(0), ElementsAre(1, 2, 3));
+    EXPECT_TRUE(frame_queue_empty(0));
+}
+
+TEST_F(FrameQueue, frames_are_aligned) {
+    queue_frame(0, {1});
+    queue_frame(0, {2, 3});
+    uint16_t size;
+    const uint8_t* frame = frame_queue_peek(0, &size);
+    EXPECT_EQ((uintptr_t)frame % 4, 0);
+    frame_queue_pop(0);
+    frame = frame_queue_peek(0, &size);
+    EXPECT_EQ((uintptr_t)frame % 4, 0);
+}
+
+TEST_F(FrameQueue, returns_frames_in_order) {
+    queue_frame(0, {1});
+    queue_frame(0, {2, 2});
+    queue_frame(0, {3, 3, 3});
+    EXPECT_THAT(pop_frame(0), ElementsAre(1));
+    EXPECT_THAT(pop_frame(0), ElementsAre(2, 2));
+    EXPECT_THAT(pop_frame(0), ElementsAre(3, 3, 3));
+    EXPECT_TRUE(frame_queue_empty(0));
+}
+
+TEST_F(FrameQueue, drops_frames_when_full) {
+    std::vector<uint8_t> frame(SERIAL_LINK_TX_QUEUE_SIZE / 4, 7);
+    int queued = 0;
+    while (queue_frame(0, frame)) {
+        queued++;
+    }
+    EXPECT_EQ(queued, 3);
+    EXPECT_EQ(frame_queue_dropped(0), 1);
+    EXPECT_EQ(frame_queue_dropped(1), 0);
+    pop_frame(0);
+    // The head can't catch up with the tail
+    EXPECT_FALSE(queue_frame(0, frame));
+    pop_frame(0);
+    EXPECT_TRUE(queue_frame(0, frame));
+}
+
+TEST_F(FrameQueue, drops_frames_that_never_fit) {
+    std::vector<uint8_t> frame(SERIAL_LINK_TX_QUEUE_SIZE, 7);
+    EXPECT_FALSE(queue_frame(0, frame));
+    EXPECT_EQ(frame_queue_dropped(0), 1);
+}
+
+TEST_F(FrameQueue, wraps_frames_to_the_start) {
+    std::vector<uint8_t> big(SERIAL_LINK_TX_QUEUE_SIZE / 2, 1);
+    std::vector<uint8_t> small(SERIAL_LINK_TX_QUEUE_SIZE / 8, 2);
+    std::vector<uint8_t> medium(SERIAL_LINK_TX_QUEUE_SIZE / 2 - 16, 3);
+    ASSERT_TRUE(queue_frame(0, big));
+    ASSERT_TRUE(queue_frame(0, small));
+    EXPECT_EQ(pop_frame(0), big);
+    // Doesn't fit at the end anymore, but at the start
+    ASSERT_TRUE(queue_frame(0, medium));
+    uint16_t size;
+    const uint8_t* first = frame_queue_peek(0, &size);
+    EXPECT_EQ(pop_frame(0), small);
+    const uint8_t* second = frame_queue_peek(0, &size);
+    EXPECT_LT(second, first);
+    EXPECT_EQ(pop_frame(0), medium);
+    EXPECT_TRUE(frame_queue_empty(0));
+}
+
+TEST_F(FrameQueue, drain_sends_all_frames) {
+    queue_frame(1, {1, 2});
+    queue_frame(1, {3});
+    frame_queue_drain(1);
+    EXPECT_THAT(sent_data[1], ElementsAre(1, 2, 3));
+    EXPECT_TRUE(sent_data[0].empty());
+    EXPECT_TRUE(frame_queue_empty(1));
+}
+
+TEST_F(FrameQueue, byte_stuffer_encodes_into_the_queue) {
+    init_byte_stuffer();
+    uint8_t data[] = {5, 0, 6};
+    byte_stuffer_send_frame(1, data, sizeof(data));
+    EXPECT_THAT(pop_frame(1), ElementsAre(2, 5, 2, 6, 0));
+}
+
+TEST_F(FrameQueue, producer_and_consumer_threads) {
+    const uint32_t num_frames = 100000;
+    std::thread producer([num_frames]() {
+        uint32_t i = 0;
+        while (i < num_frames) {
+            uint16_t size = 1 + i % 61;
+            uint8_t* buffer = frame_queue_begin_write(0, size);
+            if (!buffer) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (uint16_t j = 0; j < size; j++) {
+                buffer[j] = (uint8_t)(i + j);
+            }
+            frame_queue_end_write(0, size);
+            i++;
+        }
+    });
+    uint32_t received = 0;
+    uint32_t errors = 0;
+    while (received < num_frames) {
+        uint16_t size;
+        const uint8_t* frame = frame_queue_peek(0, &size);
+        if (!frame) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (size != 1 + received % 61) {
+            errors++;
+        }
+        for (uint16_t j = 0; j < size; j++) {
+            if (frame[j] != (uint8_t)(received + j)) {
+                errors++;
+            }
+        }
+        frame_queue_pop(0);
+        received++;
+    }
+    producer.join();
+    EXPECT_EQ(errors, 0);
+    EXPECT_TRUE(frame_queue_empty(0));
+}
@@ -29,6 +29,7 @@ extern "C" {
     #include "serial_link/protocol/transport.h"
     #include "serial_link/protocol/byte_stuffer.h"
     #include "serial_link/protocol/frame_router.h"
+    #include "serial_link/protocol/frame_queue.h"
 }
 
 using testing::_;
@@ -107,6 +108,10 @@ extern "C" {
         FrameRouter::Instance->send_data(link, data, size);
     }
 
+    void signal_frame_queued(uint8_t link) {
+        frame_queue_drain(link);
+    }
+
 
     void transport_recv_frame(uint8_t from, uint8_t* data, uint16_t size) {
         FrameRouter::Instance->transport_recv_frame(from, data, size);
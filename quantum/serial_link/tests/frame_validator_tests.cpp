@@ -26,6 +26,7 @@ SOFTWARE.
 #include "gmock/gmock.h"
 extern "C" {
 #include "serial_link/protocol/frame_validator.h"
+#include "serial_link/protocol/crc32.h"
 }
 
 using testing::_;
@@ -98,6 +99,25 @@ TEST_F(FrameValidator, validates_five_byte_frame_with_correct_crc) {
     validator_recv_frame(0, data, 9);
 }
 
+TEST_F(FrameValidator, validates_five_byte_frame_with_incremental_crc) {
+    uint8_t data[] = {1, 2, 3, 4, 5, 0xF4, 0x99, 0x0B, 0x47};
+    uint32_t crc = CRC32_INIT;
+    for (int i = 0; i < 9; i++) {
+        crc = crc32_update_byte(crc, data[i]);
+    }
+    EXPECT_CALL(*this, route_incoming_frame(_, _, _))
+        .With(Args<1, 2>(ElementsAreArray(data, 5)));
+    validator_recv_frame_crc(0, data, 9, crc);
+}
+
+TEST_F(FrameValidator, does_not_validate_frame_with_incorrect_incremental_crc) {
+    uint8_t data[] = {1, 2, 3, 4, 5, 0xF4, 0x99, 0x0B, 0x48};
+    uint32_t crc = crc32_update(CRC32_INIT, data, 9);
+    EXPECT_CALL(*this, route_incoming_frame(_, _, _))
+        .Times(0);
+    validator_recv_frame_crc(0, data, 9, crc);
+}
+
 TEST_F(FrameValidator, sends_one_byte_with_correct_crc) {
     uint8_t original[] = {0x44, 0, 0, 0, 0};
     uint8_t expected[] = {0x44, 0x04, 0x6A, 0xB3, 0xA3};
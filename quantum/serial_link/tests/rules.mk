@@ -1,16 +1,31 @@
 serial_link_byte_stuffer_SRC :=\
 	$(SERIAL_PATH)/tests/byte_stuffer_tests.cpp \
-	$(SERIAL_PATH)/protocol/byte_stuffer.c
+	$(SERIAL_PATH)/protocol/byte_stuffer.c \
+	$(SERIAL_PATH)/protocol/frame_queue.c \
+	$(SERIAL_PATH)/protocol/crc32.c
+
+serial_link_frame_queue_SRC :=\
+	$(SERIAL_PATH)/tests/frame_queue_tests.cpp \
+	$(SERIAL_PATH)/protocol/byte_stuffer.c \
+	$(SERIAL_PATH)/protocol/frame_queue.c \
+	$(SERIAL_PATH)/protocol/crc32.c
 
 serial_link_frame_validator_SRC := \
 	$(SERIAL_PATH)/tests/frame_validator_tests.cpp \
-	$(SERIAL_PATH)/protocol/frame_validator.c 
+	$(SERIAL_PATH)/protocol/frame_validator.c \
+	$(SERIAL_PATH)/protocol/crc32.c
+
+serial_link_crc32_SRC := \
+	$(SERIAL_PATH)/tests/crc32_tests.cpp \
+	$(SERIAL_PATH)/protocol/crc32.c
 
 serial_link_frame_router_SRC := \
 	$(SERIAL_PATH)/tests/frame_router_tests.cpp \
 	$(SERIAL_PATH)/protocol/byte_stuffer.c \
 	$(SERIAL_PATH)/protocol/frame_validator.c \
-	$(SERIAL_PATH)/protocol/frame_router.c
+	$(SERIAL_PATH)/protocol/frame_router.c \
+	$(SERIAL_PATH)/protocol/frame_queue.c \
+	$(SERIAL_PATH)/protocol/crc32.c
 
 serial_link_triple_buffered_object_SRC := \
 	$(SERIAL_PATH)/tests/triple_buffered_object_tests.cpp \
@@ -20,3 +35,16 @@ serial_link_transport_SRC := \
 	$(SERIAL_PATH)/tests/transport_tests.cpp \
 	$(SERIAL_PATH)/protocol/transport.c \
 	$(SERIAL_PATH)/protocol/triple_buffered_object.c 
+
+serial_link_transport_stack_SRC := \
+	$(SERIAL_PATH)/tests/transport_stack_tests.cpp \
+	$(SERIAL_PATH)/protocol/transport.c \
+	$(SERIAL_PATH)/protocol/triple_buffered_object.c \
+	$(SERIAL_PATH)/protocol/frame_router.c \
+	$(SERIAL_PATH)/protocol/frame_validator.c \
+	$(SERIAL_PATH)/protocol/byte_stuffer.c \
+	$(SERIAL_PATH)/protocol/frame_queue.c \
+	$(SERIAL_PATH)/protocol/crc32.c
+
+serial_link_transport_delta_SRC := $(serial_link_transport_stack_SRC)
+serial_link_transport_delta_DEFS := -DSERIAL_LINK_DELTA_OBJECTS
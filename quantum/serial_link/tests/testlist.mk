@@ -1,6 +1,16 @@
 TEST_LIST +=\
 	serial_link_byte_stuffer\
+	serial_link_frame_queue\
 	serial_link_frame_validator\
+	serial_link_crc32\
 	serial_link_frame_router\
 	serial_link_triple_buffered_object\
-	serial_link_transport
\ No newline at end of file
+	serial_link_transport\
+	serial_link_transport_stack\
+	serial_link_transport_delta
+
+# Opt-in, the same tests with the benchmarks, which print their measurements
+BENCH_LIST +=\
+	serial_link_crc32_bench\
+	serial_link_transport_stack_bench\
+	serial_link_transport_delta_bench
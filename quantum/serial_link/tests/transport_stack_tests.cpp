@@ -0,0 +1,290 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2017 QMK contributors
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+extern "C" {
+#include "serial_link/protocol/transport.h"
+#include "serial_link/protocol/byte_stuffer.h"
+#include "serial_link/protocol/frame_router.h"
+#include "serial_link/protocol/frame_queue.h"
+}
+
+// Runs the objects through the whole transport, router, validator and byte
+// stuffer stack, between a master and a single slave
+
+struct matrix_object {
+    uint16_t rows[16];
+};
+
+struct status_object {
+    uint8_t data[100];
+};
+
+SLAVE_TO_MASTER_OBJECT(matrix, matrix_object);
+MASTER_TO_ALL_SLAVES_OBJECT(status, status_object);
+
+static remote_object_t* test_remote_objects[] = {
+    REMOTE_OBJECT(matrix),
+    REMOTE_OBJECT(status),
+};
+
+class TransportStack : public testing::Test {
+public:
+    TransportStack() :
+        random(1234),
+        current_buffers(nullptr)
+    {
+        Instance = this;
+        add_remote_objects(test_remote_objects, sizeof(test_remote_objects) / sizeof(remote_object_t*));
+        init_byte_stuffer();
+    }
+
+    ~TransportStack() {
+        Instance = nullptr;
+        reinitialize_serial_link_transport();
+    }
+
+    void send_data(uint8_t link, const uint8_t* data, uint16_t size) {
+        auto& buffer = current_buffers[link];
+        std::copy(data, data + size, std::back_inserter(buffer));
+    }
+
+    // Sends everything written by the board to the other one, loses the whole
+    // transfer with drop_chance and corrupts one byte with corrupt_chance
+    void transfer(bool from_master, double drop_chance = 0, double corrupt_chance = 0) {
+        current_buffers = from_master ? master_buffers : slave_buffers;
+        router_set_master(from_master);
+        update_transport();
+        uint8_t link = from_master ? DOWN_LINK : UP_LINK;
+        std::vector<uint8_t> data;
+        data.swap(current_buffers[link]);
+        current_buffers[DOWN_LINK].clear();
+        current_buffers[UP_LINK].clear();
+        bytes_sent += data.size();
+        std::uniform_real_distribution<double> chance(0, 1);
+        if (chance(random) < drop_chance) {
+            return;
+        }
+        if (!data.empty() && chance(random) < corrupt_chance) {
+            data[random() % data.size()] ^= 1 << (random() % 8);
+        }
+        current_buffers = from_master ? slave_buffers : master_buffers;
+        router_set_master(!from_master);
+        uint8_t recv_link = from_master ? UP_LINK : DOWN_LINK;
+        for (uint8_t byte : data) {
+            byte_stuffer_recv_byte(recv_link, byte);
+        }
+        // The slave forwards the frames to the next slave, but there's none
+        current_buffers[DOWN_LINK].clear();
+    }
+
+    // Changes a few bytes of the object, the way a matrix usually changes
+    template<typename T>
+    void mutate(T& object) {
+        uint8_t* bytes = (uint8_t*)&object;
+        int changes = random() % 4;
+        for (int i = 0; i < changes; i++) {
+            bytes[random() % sizeof(T)] = random();
+        }
+    }
+
+    std::mt19937 random;
+    std::vector<uint8_t> master_buffers[2];
+    std::vector<uint8_t> slave_buffers[2];
+    std::vector<uint8_t>* current_buffers;
+    size_t bytes_sent = 0;
+
+    static TransportStack* Instance;
+};
+
+TransportStack* TransportStack::Instance = nullptr;
+
+extern "C" {
+    void send_data(uint8_t link, const uint8_t* data, uint16_t size) {
+        TransportStack::Instance->send_data(link, data, size);
+    }
+
+    void signal_frame_queued(uint8_t link) {
+        frame_queue_drain(link);
+    }
+
+    void signal_data_written(void) {
+    }
+}
+
+static bool operator==(const matrix_object& a, const matrix_object& b) {
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+static bool operator==(const status_object& a, const status_object& b) {
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+TEST_F(TransportStack, matrix_updates_arrive_unchanged) {
+    matrix_object written = {};
+    matrix_object received = {};
+    for (int i = 0; i < 2000; i++) {
+        if (i % 3) {
+            mutate(written);
+        }
+        *begin_write_matrix() = written;
+        end_write_matrix();
+        transfer(false);
+        matrix_object* m = read_matrix(0);
+        if (m) {
+            received = *m;
+        }
+        ASSERT_TRUE(received == written) << "at write " << i;
+    }
+}
+
+TEST_F(TransportStack, large_status_updates_arrive_unchanged) {
+    status_object written = {};
+    status_object received = {};
+    for (int i = 0; i < 2000; i++) {
+        mutate(written);
+        if (i % 100 == 0) {
+            // A change too big to fit in a delta
+            for (auto& byte : written.data) {
+                byte = random();
+            }
+        }
+        *begin_write_status() = written;
+        end_write_status();
+        transfer(true);
+        status_object* s = read_status();
+        if (s) {
+            received = *s;
+        }
+        ASSERT_TRUE(received == written) << "at write " << i;
+    }
+}
+
+TEST_F(TransportStack, lost_and_corrupted_frames_are_recovered) {
+    std::vector<matrix_object> history;
+    matrix_object written = {};
+    matrix_object received = {};
+    history.push_back(written);
+    for (int i = 0; i < 5000; i++) {
+        mutate(written);
+        history.push_back(written);
+        *begin_write_matrix() = written;
+        end_write_matrix();
+        transfer(false, 0.1, 0.1);
+        matrix_object* m = read_matrix(0);
+        if (m) {
+            received = *m;
+        }
+        // Only objects that were actually written can ever be received
+        ASSERT_NE(std::find(history.begin(), history.end(), received), history.end())
+            << "at write " << i;
+    }
+    // And everything is in sync again after enough lossless writes
+    for (int i = 0; i < 64; i++) {
+        *begin_write_matrix() = written;
+        end_write_matrix();
+        transfer(false);
+        matrix_object* m = read_matrix(0);
+        if (m) {
+            received = *m;
+        }
+    }
+    EXPECT_TRUE(received == written);
+}
+
+#ifdef SERIAL_LINK_DELTA_OBJECTS
+TEST_F(TransportStack, unchanged_writes_are_only_sent_as_keyframes) {
+    matrix_object written = {};
+    written.rows[3] = 0x55;
+    int frames = 0;
+    for (int i = 0; i < SERIAL_LINK_KEYFRAME_INTERVAL * 4; i++) {
+        *begin_write_matrix() = written;
+        end_write_matrix();
+        size_t before = bytes_sent;
+        transfer(false);
+        if (bytes_sent != before) {
+            frames++;
+        }
+    }
+    EXPECT_EQ(frames, 4);
+}
+
+TEST_F(TransportStack, delta_after_lost_frame_is_ignored_until_keyframe) {
+    matrix_object written = {};
+    *begin_write_matrix() = written;
+    end_write_matrix();
+    transfer(false);
+    EXPECT_NE(read_matrix(0), nullptr);
+
+    written.rows[0] = 1;
+    *begin_write_matrix() = written;
+    end_write_matrix();
+    transfer(false, 1.0);
+    written.rows[1] = 2;
+    *begin_write_matrix() = written;
+    end_write_matrix();
+    transfer(false);
+    EXPECT_EQ(read_matrix(0), nullptr);
+
+    for (int i = 3; i < SERIAL_LINK_KEYFRAME_INTERVAL; i++) {
+        *begin_write_matrix() = written;
+        end_write_matrix();
+        transfer(false);
+        EXPECT_EQ(read_matrix(0), nullptr);
+    }
+    *begin_write_matrix() = written;
+    end_write_matrix();
+    transfer(false);
+    matrix_object* m = read_matrix(0);
+    ASSERT_NE(m, nullptr);
+    EXPECT_TRUE(*m == written);
+}
+#endif
+
+#ifdef BENCHMARK
+TEST_F(TransportStack, benchmark_bytes_sent) {
+    matrix_object written = {};
+    const int writes = 10000;
+    for (int i = 0; i < writes; i++) {
+        // Most of the writes are the periodic refresh of an unchanged matrix
+        if (i % 10 == 0) {
+            written.rows[random() % 16] ^= 1 << (random() % 16);
+        }
+        *begin_write_matrix() = written;
+        end_write_matrix();
+        transfer(false);
+    }
+#ifdef SERIAL_LINK_DELTA_OBJECTS
+    const char* mode = "delta";
+#else
+    const char* mode = "full";
+#endif
+    std::cout << "[ BENCH    ] " << mode << " objects: " << (double)bytes_sent / writes
+        << " bytes per matrix write" << std::endl;
+}
+#endif
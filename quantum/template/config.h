@@ -57,6 +57,60 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 /* Debounce reduces chatter (unintended double-presses) - set 0 if debouncing is not needed */
 #define DEBOUNCING_DELAY 5
 
+/* Process up to this many key changes per matrix scan instead of just one.
+ * Useful for chords and steno, where many keys change in the same scan */
+//#define QMK_KEYS_PER_SCAN 4
+
+/* Remember the resolved layer of each key until the layer state changes,
+ * costs MATRIX_ROWS * MATRIX_COLS bytes of RAM. Worth it with many layers */
+//#define LAYER_RESOLUTION_CACHE
+
+/* Merge keyboard report changes into one report per USB poll where the host
+ * still sees the same sequence, e.g. a release and the next press */
+//#define COALESCE_KEYBOARD_REPORTS
+
+/* Queue up to this many reports per endpoint on LUFA instead of waiting for
+ * the host to read the previous one. ChibiOS always queues, 8 by default */
+//#define USB_REPORT_QUEUE_SIZE 4
+
+/* ChibiOS only: scan the matrix in its own thread every MATRIX_SCAN_INTERVAL_US
+ * and queue the changes, so slow work in the main loop doesn't delay the scan.
+ * matrix_scan_user and matrix_scan_kb still run from the main loop, which
+ * sleeps up to MAIN_LOOP_IDLE_US when no key changes and no deadline is due */
+//#define MATRIX_SCAN_THREAD
+//#define MAIN_LOOP_IDLE_US 1000
+
+/* Play macros and SEND_STRING from the main loop, one key change every
+ * ASYNC_MACRO_STEP_MS, instead of blocking the scan until they're done.
+ * action_macro_cancel() stops them. Keys registered right after, like
+ * SEND_STRING("x"); register_code(KC_ENT);, now go out before the string:
+ * call action_macro_flush() in between to keep the order. When more than
+ * ASYNC_MACRO_QUEUE_SIZE are queued, the queue is played out blocking */
+//#define ASYNC_MACRO
+
+/* Queue unicode input and type it one key change every UNICODE_STEP_MS,
+ * instead of stalling the keyboard for each codepoint. Keymaps that override
+ * unicode_input_start or unicode_input_finish fail to link with it. Input
+ * beyond UNICODE_QUEUE_SIZE codepoints is typed the blocking way */
+//#define UNICODE_ASYNC
+
+/* Settle a held mod-tap/layer-tap key as a hold before TAPPING_TERM is up:
+ * PERMISSIVE_HOLD once another key is pressed and released under it,
+ * HOLD_ON_OTHER_KEY_PRESS as soon as another key is pressed */
+//#define PERMISSIVE_HOLD
+//#define HOLD_ON_OTHER_KEY_PRESS
+
+/* With DYNAMIC_KEYMAP_ENABLE, the layers copied to EEPROM, where they start,
+ * and how many of them are kept in RAM, 2 * MATRIX_ROWS * MATRIX_COLS bytes each */
+//#define DYNAMIC_KEYMAP_LAYER_COUNT 4
+//#define DYNAMIC_KEYMAP_EEPROM_ADDR 32
+//#define DYNAMIC_KEYMAP_CACHED_LAYERS 2
+
+/* Keep the eeconfig settings (backlight, RGB, unicode mode...) in RAM and
+ * write the changed ones this many ms after the last change, on suspend and
+ * before jumping to the bootloader. Changes are lost if unplugged earlier */
+//#define EECONFIG_WRITE_DELAY 3000
+
 /* define if matrix has ghost (lacks anti-ghosting diodes) */
 //#define MATRIX_HAS_GHOST
 
@@ -66,3 +66,11 @@ UNICODE_ENABLE ?= no         # Unicode
 BLUETOOTH_ENABLE ?= no       # Enable Bluetooth with the Adafruit EZ-Key HID
 AUDIO_ENABLE ?= no           # Audio output on port C6
 FAUXCLICKY_ENABLE ?= no      # Use buzzer to emulate clicky switches
+PROFILE_ENABLE ?= no         # Scan rate and key latency statistics, printed with magic P
+SOF_SYNC_ENABLE ?= no        # Scan once per USB frame, finishing just before the host polls
+TRACE_ENABLE ?= no           # Binary event trace, dumped with magic T or over raw HID
+COMPILED_KEYMAP_ENABLE ?= no # Pre-translated keymap tables, see quantum/keymap_compiled.h
+DYNAMIC_KEYMAP_ENABLE ?= no  # Keymap kept in EEPROM, changed over raw HID or the API
+# Debounce algorithm: sym_g (default, whole matrix), sym_pk (per key),
+# eager_pk (eager press, deferred release, per key) or eager_pr (eager, per row)
+# DEBOUNCE_TYPE ?= eager_pk
@@ -1,4 +1,6 @@
 include $(ROOT_DIR)/quantum/serial_link/tests/testlist.mk
+include $(ROOT_DIR)/keyboards/lets_split/tests/testlist.mk
+include $(ROOT_DIR)/tests/testlist.mk
 
 define VALIDATE_TEST_LIST
     ifneq ($1,)
@@ -10,4 +12,5 @@ define VALIDATE_TEST_LIST
     endif
 endef
 
-$(eval $(call VALIDATE_TEST_LIST,$(firstword $(TEST_LIST)),$(wordlist 2,9999,$(TEST_LIST))))
\ No newline at end of file
+$(eval $(call VALIDATE_TEST_LIST,$(firstword $(TEST_LIST)),$(wordlist 2,9999,$(TEST_LIST))))
+$(eval $(call VALIDATE_TEST_LIST,$(firstword $(BENCH_LIST)),$(wordlist 2,9999,$(BENCH_LIST))))
\ No newline at end of file
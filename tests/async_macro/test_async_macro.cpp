@@ -0,0 +1,197 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <string>
+#include "test_fixture.h"
+#include "keyboard_report_util.h"
+
+extern "C" {
+#include "quantum.h"
+#include "test_matrix.h"
+}
+
+using testing::ElementsAre;
+
+static const char long_string[] PROGMEM =
+    "The quick brown fox jumps over the lazy dog. THE QUICK BROWN FOX!";
+
+class AsyncMacro : public TestFixture {
+protected:
+    /* keep scanning until the queued macros have been played */
+    void play_out() {
+#ifdef ASYNC_MACRO
+        while (action_macro_playing()) {
+            run_one_scan_loop();
+        }
+#endif
+        run_one_scan_loop();
+    }
+
+    /* the text the host sees typed, upper case for shifted letters */
+    std::string typed_text() {
+        std::string result;
+        report_keyboard_t previous = {};
+        for (auto& r : driver.keyboard_reports()) {
+            std::vector<uint8_t> before = get_keys(previous);
+            for (uint8_t key : get_keys(r.report)) {
+                if (IS_MOD(key) || std::find(before.begin(), before.end(), key) != before.end()) continue;
+                bool shifted = r.report.mods & MOD_BIT(KC_LSFT);
+                if (key >= KC_A && key <= KC_Z) {
+                    result += (shifted ? 'A' : 'a') + (key - KC_A);
+                } else if (key == KC_SPC) {
+                    result += ' ';
+                } else if (key == KC_DOT) {
+                    result += '.';
+                } else if (key == KC_COMM) {
+                    result += ',';
+                } else if (key == KC_1 && shifted) {
+                    result += '!';
+                } else {
+                    result += '?';
+                }
+            }
+            previous = r.report;
+        }
+        return result;
+    }
+};
+
+TEST_F(AsyncMacro, SendStringTypesEveryCharacter) {
+    SEND_STRING("Hello, World!");
+    play_out();
+    EXPECT_EQ(typed_text(), "Hello, World!");
+    EXPECT_EQ(driver.keyboard_reports().back().report, make_report({}));
+}
+
+TEST_F(AsyncMacro, StringsAreTypedInOrder) {
+    SEND_STRING("abc");
+    SEND_STRING("def");
+    play_out();
+    EXPECT_EQ(typed_text(), "abcdef");
+}
+
+TEST_F(AsyncMacro, KeyIsHeldForTheMacroWait) {
+    action_macro_play(MACRO(D(A), W(100), U(A), END));
+    play_out();
+    auto& reports = driver.keyboard_reports();
+    ASSERT_EQ(reports.size(), 2u);
+    EXPECT_EQ(reports[0].report, make_report({KC_A}));
+    EXPECT_EQ(reports[1].report, make_report({}));
+    EXPECT_GE(reports[1].time - reports[0].time, 100u);
+}
+
+TEST_F(AsyncMacro, MacroIntervalSpacesTheKeys) {
+    action_macro_play(MACRO(I(20), T(A), T(B), END));
+    play_out();
+    auto& reports = driver.keyboard_reports();
+    ASSERT_EQ(reports.size(), 4u);
+    for (size_t i = 1; i < reports.size(); i++) {
+        EXPECT_GE(reports[i].time - reports[i - 1].time, 20u);
+    }
+    EXPECT_EQ(typed_text(), "ab");
+}
+
+#ifdef ASYNC_MACRO
+TEST_F(AsyncMacro, KeysAreScannedDuringPlayback) {
+    send_string(long_string);
+    idle_for(20);
+    ASSERT_TRUE(action_macro_playing());
+    // the 'J' key, which the string never types
+    press_key(9, 0);
+    run_one_scan_loop();
+    release_key(9, 0);
+    play_out();
+    std::string text = typed_text();
+    size_t j = text.find('j');
+    ASSERT_NE(j, std::string::npos);
+    EXPECT_GT(text.size() - j, 1u) << text;
+    EXPECT_EQ(text.size(), sizeof(long_string));
+}
+
+TEST_F(AsyncMacro, FullQueueIsPlayedOut) {
+    static const char *const words[] = {"one ", "two ", "three ", "four ", "five ", "six"};
+    for (auto word : words) {
+        send_string(word);
+    }
+    play_out();
+    EXPECT_EQ(typed_text(), "one two three four five six");
+}
+
+TEST_F(AsyncMacro, FlushKeepsTheOrder) {
+    SEND_STRING("ab");
+    action_macro_flush();
+    register_code(KC_C);
+    unregister_code(KC_C);
+    play_out();
+    EXPECT_EQ(typed_text(), "abc");
+}
+
+TEST_F(AsyncMacro, CancelStopsTyping) {
+    send_string(long_string);
+    SEND_STRING("never typed");
+    idle_for(20);
+    action_macro_cancel();
+    EXPECT_FALSE(action_macro_playing());
+    idle_for(100);
+    std::string text = typed_text();
+    EXPECT_GT(text.size(), 0u);
+    EXPECT_LT(text.size(), sizeof(long_string) - 1);
+    EXPECT_EQ(driver.keyboard_reports().back().report, make_report({}));
+}
+
+TEST_F(AsyncMacro, CancelReleasesTheHeldKeys) {
+    action_macro_play(MACRO(D(LSFT), D(A), W(200), U(A), U(LSFT), END));
+    idle_for(20);
+    EXPECT_EQ(driver.keyboard_reports().back().report, make_report({KC_LSFT, KC_A}));
+    action_macro_cancel();
+    EXPECT_EQ(driver.keyboard_reports().back().report, make_report({}));
+    idle_for(300);
+    EXPECT_EQ(driver.keyboard_reports().back().report, make_report({}));
+}
+#endif
+
+TEST_F(AsyncMacro, LongSendStringThroughput) {
+    uint32_t start = timer_read32();
+    uint32_t loops = 0;
+    send_string(long_string);
+#ifdef ASYNC_MACRO
+    while (action_macro_playing()) {
+        run_one_scan_loop();
+        loops++;
+    }
+#else
+    run_one_scan_loop();
+    loops++;
+#endif
+    EXPECT_EQ(typed_text(), long_string);
+    uint32_t ms = timer_read32() - start;
+#ifdef ASYNC_MACRO
+    // at most four key changes per character, the shift and the key down and up
+    const uint32_t step_ms = ASYNC_MACRO_STEP_MS > scan_interval ? ASYNC_MACRO_STEP_MS : scan_interval;
+    EXPECT_LE(ms, (sizeof(long_string) - 1) * 4 * step_ms);
+#endif
+#ifdef BENCHMARK
+    std::cout << "[ BENCH    ] " << (sizeof(long_string) - 1) << " character SEND_STRING: "
+        << loops << " keyboard_task calls, " << ms << " ms";
+    if (loops > 1) {
+        std::cout << ", " << (sizeof(long_string) - 1) * 1000 / ms << " characters per second";
+    } else {
+        std::cout << ", all in one call";
+    }
+    std::cout << std::endl;
+#endif
+}
@@ -0,0 +1,123 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_fixture.h"
+#include "keyboard_report_util.h"
+
+extern "C" {
+#include "keycode.h"
+#include "action.h"
+#include "action_tapping.h"
+#include "test_matrix.h"
+}
+
+using testing::ElementsAre;
+
+class KeyPress : public TestFixture {
+protected:
+    std::vector<std::vector<uint8_t>> sent_keys() {
+        std::vector<std::vector<uint8_t>> result;
+        for (auto& r : driver.keyboard_reports()) {
+            result.push_back(get_keys(r.report));
+        }
+        return result;
+    }
+};
+
+TEST_F(KeyPress, SendKeyboardIsNotCalledWhenNoKeyIsPressed) {
+    idle_for(100);
+    EXPECT_TRUE(driver.keyboard_reports().empty());
+}
+
+TEST_F(KeyPress, CorrectKeyIsReportedWhenPressed) {
+    press_key(0, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    run_one_scan_loop();
+    EXPECT_THAT(sent_keys(), ElementsAre(
+        std::vector<uint8_t>{KC_A},
+        std::vector<uint8_t>{}));
+}
+
+TEST_F(KeyPress, ModifiedKeyIsReportedWithTheModifier) {
+    press_key(9, 3);
+    run_one_scan_loop();
+    release_key(9, 3);
+    run_one_scan_loop();
+    ASSERT_FALSE(driver.keyboard_reports().empty());
+    EXPECT_EQ(get_keys(driver.keyboard_reports().front().report), (std::vector<uint8_t>{KC_LSFT}));
+    EXPECT_THAT(get_keys(driver.keyboard_reports()[1].report), ElementsAre(KC_0, KC_LSFT));
+    EXPECT_TRUE(get_keys(driver.keyboard_reports().back().report).empty());
+}
+
+TEST_F(KeyPress, MomentaryLayerSelectsTheLayerKey) {
+    replay(MatrixTrace::parse(
+        "0  2 8 down\n"
+        "10 0 0 down\n"
+        "20 0 0 up\n"
+        "30 2 8 up\n"
+        "40 0 0 down\n"
+        "50 0 0 up\n"));
+    // Layer changes send an empty report too
+    EXPECT_THAT(sent_keys(), ElementsAre(
+        std::vector<uint8_t>{},
+        std::vector<uint8_t>{KC_F1},
+        std::vector<uint8_t>{},
+        std::vector<uint8_t>{},
+        std::vector<uint8_t>{KC_A},
+        std::vector<uint8_t>{}));
+}
+
+TEST_F(KeyPress, ModTapIsTapWhenReleasedWithinTappingTerm) {
+    replay(MatrixTrace{
+        {0, 2, 2, true},
+        {50, 2, 2, false},
+    });
+    EXPECT_THAT(sent_keys(), ElementsAre(
+        std::vector<uint8_t>{KC_U},
+        std::vector<uint8_t>{}));
+    // A tap is only known once the key is released
+    EXPECT_EQ(driver.keyboard_reports().front().time, 50u);
+}
+
+TEST_F(KeyPress, ModTapIsHoldAfterTappingTerm) {
+    replay(MatrixTrace{
+        {0, 2, 2, true},
+        {TAPPING_TERM + 50, 0, 0, true},
+        {TAPPING_TERM + 60, 0, 0, false},
+        {TAPPING_TERM + 70, 2, 2, false},
+    });
+    EXPECT_THAT(sent_keys(), ElementsAre(
+        std::vector<uint8_t>{KC_LSFT},
+        std::vector<uint8_t>{KC_A, KC_LSFT},
+        std::vector<uint8_t>{KC_LSFT},
+        std::vector<uint8_t>{}));
+}
+
+TEST_F(KeyPress, ReportLatencyOfAPlainKeyIsOneScan) {
+    scan_interval = 2;
+    replay(MatrixTrace::parse(
+        "# a few plain keys typed in a row\n"
+        "0   0 1 down\n"
+        "30  0 1 up\n"
+        "40  1 4 down   # o\n"
+        "60  1 4 up\n"));
+    ASSERT_EQ(driver.keyboard_reports().size(), 4u);
+    const uint32_t event_times[] = {0, 30, 40, 60};
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(driver.keyboard_reports()[i].time, event_times[i]);
+    }
+}
@@ -0,0 +1,202 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <utility>
+#include "test_fixture.h"
+#include "keyboard_report_util.h"
+
+extern "C" {
+#include "quantum.h"
+#include "test_matrix.h"
+#include "test_timer.h"
+}
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+using testing::Contains;
+using testing::Not;
+
+/* Combo 0 is 1 + 2 and the only one with those keys, the rest are pairs and
+ * then triples of the letters A to T, so that each letter is part of a few
+ * dozen combos like in a steno layout */
+static uint16_t combo_keys[COMBO_COUNT][4];
+extern "C" combo_t key_combos[COMBO_COUNT];
+combo_t key_combos[COMBO_COUNT];
+
+static const uint8_t letters = 20;
+
+static bool init_combos() {
+    uint16_t n = 0;
+    auto add = [&n](std::initializer_list<uint16_t> keys) {
+        if (n == COMBO_COUNT) return;
+        uint8_t i = 0;
+        for (uint16_t k : keys) combo_keys[n][i++] = k;
+        combo_keys[n][i] = COMBO_END;
+        key_combos[n] = COMBO_ACTION(combo_keys[n]);
+        n++;
+    };
+    add({KC_1, KC_2});
+    for (uint8_t a = 0; a < letters; a++)
+        for (uint8_t b = a + 1; b < letters; b++)
+            add({(uint16_t)(KC_A + a), (uint16_t)(KC_A + b)});
+    for (uint8_t a = 0; a < letters; a++)
+        for (uint8_t b = a + 1; b < letters; b++)
+            for (uint8_t c = b + 1; c < letters; c++)
+                add({(uint16_t)(KC_A + a), (uint16_t)(KC_A + b), (uint16_t)(KC_A + c)});
+    return true;
+}
+static bool combos_initialized = init_combos();
+
+static std::vector<std::pair<uint8_t, bool>> combo_events;
+
+extern "C" void process_combo_event(uint8_t combo_index, bool pressed) {
+    combo_events.push_back(std::make_pair(combo_index, pressed));
+}
+
+class Combo : public TestFixture {
+protected:
+    Combo() {
+        // timer_read() is 0 at first, stay clear of that
+        idle_for(10);
+        combo_events.clear();
+    }
+    std::vector<std::vector<uint8_t>> sent_keys() {
+        std::vector<std::vector<uint8_t>> result;
+        for (auto& r : driver.keyboard_reports()) {
+            result.push_back(get_keys(r.report));
+        }
+        return result;
+    }
+};
+
+TEST_F(Combo, FiresWhenAllKeysArePressed) {
+    press_key(0, 3);
+    run_one_scan_loop();
+    press_key(1, 3);
+    run_one_scan_loop();
+    EXPECT_THAT(combo_events, ElementsAre(std::make_pair(0, true)));
+    release_key(0, 3);
+    run_one_scan_loop();
+    release_key(1, 3);
+    run_one_scan_loop();
+    EXPECT_THAT(combo_events, ElementsAre(std::make_pair(0, true), std::make_pair(0, false)));
+    for (auto& keys : sent_keys()) {
+        EXPECT_THAT(keys, IsEmpty());
+    }
+}
+
+TEST_F(Combo, FiresWhenTheTimerWrapsAtTheFirstKey) {
+    // the first key sees timer_read() == COMBO_TIMER_ELAPSED
+    set_time(UINT16_MAX);
+    press_key(0, 3);
+    run_one_scan_loop();
+    press_key(1, 3);
+    run_one_scan_loop();
+    EXPECT_THAT(combo_events, ElementsAre(std::make_pair(0, true)));
+    release_key(0, 3);
+    release_key(1, 3);
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, TappedKeyIsSentOnRelease) {
+    press_key(0, 3);
+    run_one_scan_loop();
+    EXPECT_THAT(sent_keys(), IsEmpty());
+    release_key(0, 3);
+    run_one_scan_loop();
+    EXPECT_THAT(combo_events, IsEmpty());
+    auto keys = sent_keys();
+    ASSERT_FALSE(keys.empty());
+    EXPECT_THAT(keys.front(), ElementsAre(KC_1));
+    EXPECT_THAT(keys.back(), IsEmpty());
+}
+
+TEST_F(Combo, HeldKeyIsSentAfterTheTerm) {
+    press_key(0, 3);
+    idle_for(COMBO_TERM);
+    EXPECT_THAT(sent_keys(), IsEmpty());
+    idle_for(2);
+    EXPECT_THAT(sent_keys(), ElementsAre(
+        std::vector<uint8_t>{},
+        std::vector<uint8_t>{KC_1}));
+    release_key(0, 3);
+    run_one_scan_loop();
+    EXPECT_THAT(sent_keys().back(), IsEmpty());
+    EXPECT_THAT(combo_events, IsEmpty());
+}
+
+TEST_F(Combo, LateKeyDoesNotFire) {
+    press_key(0, 3);
+    idle_for(COMBO_TERM + 2);
+    press_key(1, 3);
+    run_one_scan_loop();
+    release_key(0, 3);
+    release_key(1, 3);
+    idle_for(10);
+    EXPECT_THAT(combo_events, Not(Contains(std::make_pair(0, true))));
+}
+
+TEST_F(Combo, OverlappingCombosFireByTheirKeys) {
+    // C + E is one of the pairs, pressing both fires it and no other
+    press_key(2, 0);
+    run_one_scan_loop();
+    press_key(4, 0);
+    run_one_scan_loop();
+    ASSERT_EQ(combo_events.size(), 1);
+    uint8_t fired = combo_events[0].first;
+    EXPECT_EQ(pgm_read_word(&key_combos[fired].keys[0]), KC_C);
+    EXPECT_EQ(pgm_read_word(&key_combos[fired].keys[1]), KC_E);
+    EXPECT_EQ(pgm_read_word(&key_combos[fired].keys[2]), COMBO_END);
+    release_key(2, 0);
+    release_key(4, 0);
+    idle_for(COMBO_TERM * 2);
+}
+
+#ifdef BENCHMARK
+TEST_F(Combo, EventCost) {
+    const int rounds = 20000;
+    keyrecord_t record = {};
+    auto time_key = [&](uint16_t keycode) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++) {
+            record.event.pressed = true;
+            process_combo(keycode, &record);
+            record.event.pressed = false;
+            process_combo(keycode, &record);
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / (2 * rounds);
+    };
+    double other_key = time_key(KC_5);
+    double combo_key = time_key(KC_J);
+
+    press_key(9, 0);
+    run_one_scan_loop();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        matrix_scan_combo();
+    }
+    auto end = std::chrono::steady_clock::now();
+    double scan = std::chrono::duration<double, std::nano>(end - start).count() / rounds;
+    release_key(9, 0);
+    run_one_scan_loop();
+
+    std::cout << "[ BENCH    ] " << COMBO_COUNT << " combos: " << other_key << " ns per other key event, "
+        << combo_key << " ns per combo key event, " << scan << " ns per matrix_scan_combo" << std::endl;
+}
+#endif
@@ -0,0 +1,144 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <vector>
+
+extern "C" {
+#include "deadline.h"
+#include "test_timer.h"
+}
+
+static std::vector<deadline_t*> called;
+
+static void record_call(deadline_t *deadline) {
+    called.push_back(deadline);
+}
+
+static void rearm_now(deadline_t *deadline) {
+    called.push_back(deadline);
+    deadline_in(deadline, 0);
+}
+
+class Deadline : public testing::Test {
+public:
+    Deadline() {
+        set_time(0);
+        called.clear();
+    }
+
+    ~Deadline() {
+        for (deadline_t* deadline : {&a, &b, &c}) {
+            deadline_cancel(deadline);
+        }
+    }
+
+    deadline_t a = DEADLINE(record_call);
+    deadline_t b = DEADLINE(record_call);
+    deadline_t c = DEADLINE(record_call);
+};
+
+TEST_F(Deadline, CalledBackAtItsTime) {
+    deadline_in(&a, 10);
+    EXPECT_TRUE(deadline_pending(&a));
+    advance_time(9);
+    deadline_task();
+    EXPECT_TRUE(called.empty());
+    advance_time(1);
+    deadline_task();
+    ASSERT_EQ(called.size(), 1u);
+    EXPECT_EQ(called[0], &a);
+    EXPECT_FALSE(deadline_pending(&a));
+    advance_time(10);
+    deadline_task();
+    EXPECT_EQ(called.size(), 1u);
+}
+
+TEST_F(Deadline, CalledBackInTimeOrder) {
+    deadline_in(&a, 30);
+    deadline_in(&b, 10);
+    deadline_in(&c, 30);
+    advance_time(100);
+    deadline_task();
+    std::vector<deadline_t*> expected = {&b, &a, &c};
+    EXPECT_EQ(called, expected);
+}
+
+TEST_F(Deadline, ArmingAgainMovesIt) {
+    deadline_in(&a, 10);
+    deadline_in(&b, 20);
+    deadline_in(&a, 30);
+    advance_time(20);
+    deadline_task();
+    std::vector<deadline_t*> expected = {&b};
+    EXPECT_EQ(called, expected);
+    advance_time(10);
+    deadline_task();
+    expected.push_back(&a);
+    EXPECT_EQ(called, expected);
+}
+
+TEST_F(Deadline, CancelledIsNotCalledBack) {
+    deadline_in(&a, 10);
+    deadline_in(&b, 10);
+    deadline_cancel(&a);
+    deadline_cancel(&c);
+    EXPECT_FALSE(deadline_pending(&a));
+    advance_time(10);
+    deadline_task();
+    std::vector<deadline_t*> expected = {&b};
+    EXPECT_EQ(called, expected);
+}
+
+TEST_F(Deadline, CallbackArmingForNowWaitsForTheNextMillisecond) {
+    deadline_t again = DEADLINE(rearm_now);
+    deadline_in(&again, 5);
+    advance_time(5);
+    deadline_task();
+    deadline_task();
+    EXPECT_EQ(called.size(), 1u);
+    EXPECT_TRUE(deadline_pending(&again));
+    advance_time(1);
+    deadline_task();
+    EXPECT_EQ(called.size(), 2u);
+    deadline_cancel(&again);
+}
+
+TEST_F(Deadline, AcrossTheTimerWraparound) {
+    set_time(UINT32_MAX - 5);
+    deadline_in(&a, 10);
+    deadline_in(&b, 2);
+    advance_time(5);
+    deadline_task();
+    std::vector<deadline_t*> expected = {&b};
+    EXPECT_EQ(called, expected);
+    EXPECT_EQ(deadline_next(), 5u);
+    advance_time(5);
+    deadline_task();
+    expected.push_back(&a);
+    EXPECT_EQ(called, expected);
+}
+
+TEST_F(Deadline, TimeUntilTheNext) {
+    EXPECT_EQ(deadline_next(), DEADLINE_NONE);
+    deadline_in(&a, 40);
+    deadline_in(&b, 25);
+    EXPECT_EQ(deadline_next(), 25u);
+    advance_time(30);
+    EXPECT_EQ(deadline_next(), 0u);
+    deadline_task();
+    EXPECT_EQ(deadline_next(), 10u);
+}
@@ -0,0 +1,154 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_fixture.h"
+#include "keyboard_report_util.h"
+
+extern "C" {
+#include "quantum.h"
+#include "action_tapping.h"
+#include "deadline.h"
+#include "mousekey.h"
+#include "test_matrix.h"
+}
+
+/* The features that wait for a while after a key event, run by their
+ * deadlines with no key events in between. */
+class Timeouts : public TestFixture {
+public:
+    Timeouts() {
+        driver.clear();
+    }
+
+protected:
+    void tap_key(uint8_t col) {
+        press_key(col, 0);
+        run_one_scan_loop();
+        release_key(col, 0);
+        run_one_scan_loop();
+    }
+
+    bool has_report(const report_keyboard_t& report) {
+        for (auto& sent : driver.keyboard_reports()) {
+            if (sent.report == report) return true;
+        }
+        return false;
+    }
+};
+
+TEST_F(Timeouts, OneshotModTimesOut) {
+    tap_key(0);
+    idle_for(ONESHOT_TIMEOUT);
+    EXPECT_EQ(get_oneshot_mods(), 0);
+    EXPECT_TRUE(driver.keyboard_reports().empty());
+}
+
+TEST_F(Timeouts, ReportedOneshotModIsTakenOutOfTheReport) {
+    tap_key(0);
+    press_key(4, 0);
+    run_one_scan_loop();
+    ASSERT_FALSE(driver.keyboard_reports().empty());
+    EXPECT_EQ(driver.keyboard_reports().back().report, make_report({KC_LCTL, KC_LSFT}));
+    driver.clear();
+    idle_for(ONESHOT_TIMEOUT);
+    auto& reports = driver.keyboard_reports();
+    ASSERT_EQ(reports.size(), 1u);
+    EXPECT_EQ(reports[0].report, make_report({KC_LCTL}));
+    release_key(4, 0);
+    run_one_scan_loop();
+}
+
+TEST_F(Timeouts, OneshotModBeforeItTimesOut) {
+    tap_key(0);
+    idle_for(ONESHOT_TIMEOUT / 2);
+    driver.clear();
+    tap_key(3);
+    auto& reports = driver.keyboard_reports();
+    ASSERT_FALSE(reports.empty());
+    EXPECT_EQ(reports[0].report, make_report({KC_LSFT, KC_A}));
+    EXPECT_EQ(reports.back().report, make_report({}));
+    idle_for(ONESHOT_TIMEOUT);
+    EXPECT_EQ(reports.back().report, make_report({}));
+}
+
+TEST_F(Timeouts, OneshotLayerIsTurnedOff) {
+    tap_key(1);
+    EXPECT_TRUE(layer_state & (1UL << 1));
+    idle_for(ONESHOT_TIMEOUT);
+    EXPECT_FALSE(layer_state & (1UL << 1));
+}
+
+TEST_F(Timeouts, TapDanceIsDoneAfterTheTappingTerm) {
+    tap_key(2);
+    idle_for(TAPPING_TERM - 5);
+    EXPECT_TRUE(driver.keyboard_reports().empty());
+    idle_for(10);
+    auto& reports = driver.keyboard_reports();
+    ASSERT_FALSE(reports.empty());
+    EXPECT_TRUE(has_report(make_report({KC_X})));
+    EXPECT_EQ(reports.back().report, make_report({}));
+}
+
+TEST_F(Timeouts, DoubleTapDance) {
+    tap_key(2);
+    tap_key(2);
+    idle_for(TAPPING_TERM + 5);
+    auto& reports = driver.keyboard_reports();
+    ASSERT_FALSE(reports.empty());
+    EXPECT_TRUE(has_report(make_report({KC_Y})));
+    EXPECT_FALSE(has_report(make_report({KC_X})));
+    EXPECT_EQ(reports.back().report, make_report({}));
+}
+
+TEST_F(Timeouts, HeldTapDanceIsResetOnRelease) {
+    press_key(2, 0);
+    idle_for(TAPPING_TERM + 5);
+    auto& reports = driver.keyboard_reports();
+    ASSERT_FALSE(reports.empty());
+    EXPECT_EQ(reports.back().report, make_report({KC_X}));
+    release_key(2, 0);
+    run_one_scan_loop();
+    run_one_scan_loop();
+    EXPECT_EQ(reports.back().report, make_report({}));
+}
+
+TEST_F(Timeouts, MousekeyRepeatsAtItsDeadlines) {
+    press_key(5, 0);
+    run_one_scan_loop();
+    auto& reports = driver.mouse_reports();
+    EXPECT_EQ(reports.size(), 1u);
+    idle_for(MOUSEKEY_DELAY - 5);
+    EXPECT_EQ(reports.size(), 1u);
+    idle_for(10);
+    EXPECT_EQ(reports.size(), 2u);
+    idle_for(3 * MOUSEKEY_INTERVAL);
+    EXPECT_EQ(reports.size(), 5u);
+    release_key(5, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(reports.back().x, 0);
+    size_t sent = reports.size();
+    idle_for(MOUSEKEY_DELAY);
+    EXPECT_EQ(reports.size(), sent);
+}
+
+TEST_F(Timeouts, NothingIsLeftArmed) {
+    tap_key(0);
+    tap_key(1);
+    tap_key(2);
+    tap_key(5);
+    idle_for(ONESHOT_TIMEOUT + TAPPING_TERM);
+    EXPECT_EQ(deadline_next(), DEADLINE_NONE);
+}
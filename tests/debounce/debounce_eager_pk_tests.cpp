@@ -0,0 +1,75 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "debounce_test_common.h"
+
+TEST_F(DebounceTest, OneKeyShort1) {
+    addEvents({ /* Time, Inputs, Outputs */
+        {0, {{0, 1, true}}, {{0, 1, true}}},
+        {57, {{0, 1, false}}, {}},
+        {62, {}, {{0, 1, false}}},
+    });
+    runEvents();
+}
+
+TEST_F(DebounceTest, PressBounceIsHidden) {
+    addEvents({ /* Time, Inputs, Outputs */
+        {0, {{0, 1, true}}, {{0, 1, true}}},
+        {1, {{0, 1, false}}, {}},
+        {2, {{0, 1, true}}, {}},
+        {3, {{0, 1, false}}, {}},
+        {4, {{0, 1, true}}, {}},
+        {50, {{0, 1, false}}, {}},
+        {55, {}, {{0, 1, false}}},
+    });
+    runEvents();
+}
+
+TEST_F(DebounceTest, ReleaseBounceRestartsTheDelay) {
+    addEvents({ /* Time, Inputs, Outputs */
+        {0, {{0, 1, true}}, {{0, 1, true}}},
+        {40, {{0, 1, false}}, {}},
+        {41, {{0, 1, true}}, {}},
+        {42, {{0, 1, false}}, {}},
+        {47, {}, {{0, 1, false}}},
+    });
+    runEvents();
+}
+
+TEST_F(DebounceTest, PressInTheScanTheReleaseIsAccepted) {
+    addEvents({ /* Time, Inputs, Outputs */
+        {0, {{0, 1, true}}, {{0, 1, true}}},
+        {10, {{0, 1, false}}, {}},
+        {15, {{0, 1, true}}, {{0, 1, false}}},
+        {16, {}, {{0, 1, true}}},
+        {30, {{0, 1, false}}, {}},
+        {35, {}, {{0, 1, false}}},
+    });
+    runEvents();
+}
+
+TEST_F(DebounceTest, BouncingKeyDoesNotDelayOtherKeys) {
+    addEvents({ /* Time, Inputs, Outputs */
+        {0, {{0, 1, true}}, {{0, 1, true}}},
+        {1, {{0, 1, false}}, {}},
+        {2, {{0, 2, true}}, {{0, 2, true}}},
+        {3, {{0, 1, true}}, {}},
+        {20, {{0, 1, false}, {0, 2, false}}, {}},
+        {25, {}, {{0, 1, false}, {0, 2, false}}},
+    });
+    runEvents();
+}
@@ -0,0 +1,56 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "debounce_test_common.h"
+
+TEST_F(DebounceTest, OneKeyShort1) {
+    addEvents({ /* Time, Inputs, Outputs */
+        {0, {{0, 1, true}}, {{0, 1, true}}},
+        {57, {{0, 1, false}}, {{0, 1, false}}},
+    });
+    runEvents();
+}
+
+TEST_F(DebounceTest, OneKeyBouncing1) {
+    addEvents({ /* Time, Inputs, Outputs */
+        {0, {{0, 1, true}}, {{0, 1, true}}},
+        {1, {{0, 1, false}}, {}},
+        {2, {{0, 1, true}}, {}},
+        {50, {{0, 1, false}}, {{0, 1, false}}},
+        {52, {{0, 1, true}}, {}},
+        {53, {{0, 1, false}}, {}},
+    });
+    runEvents();
+}
+
+TEST_F(DebounceTest, ChangeDuringLockoutIsAppliedAfterwards) {
+    addEvents({ /* Time, Inputs, Outputs */
+        {0, {{0, 1, true}}, {{0, 1, true}}},
+        {2, {{0, 1, false}}, {}},
+        {5, {}, {{0, 1, false}}},
+    });
+    runEvents();
+}
+
+TEST_F(DebounceTest, OnlyTheSameRowIsDelayed) {
+    addEvents({ /* Time, Inputs, Outputs */
+        {0, {{0, 1, true}}, {{0, 1, true}}},
+        {2, {{0, 2, true}, {1, 2, true}}, {{1, 2, true}}},
+        {5, {}, {{0, 2, true}}},
+    });
+    runEvents();
+}
@@ -0,0 +1,71 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "debounce_test_common.h"
+
+TEST_F(DebounceTest, OneKeyShort1) {
+    addEvents({ /* Time, Inputs, Outputs */
+        {0, {{0, 1, true}}, {}},
+        {5, {}, {{0, 1, true}}},
+        {57, {{0, 1, false}}, {}},
+        {62, {}, {{0, 1, false}}},
+    });
+    runEvents();
+}
+
+TEST_F(DebounceTest, OneKeyBouncing1) {
+    addEvents({ /* Time, Inputs, Outputs */
+        {0, {{0, 1, true}}, {}},
+        {1, {{0, 1, false}}, {}},
+        {3, {{0, 1, true}}, {}},
+        {8, {}, {{0, 1, true}}},
+        {50, {{0, 1, false}}, {}},
+        {51, {{0, 1, true}}, {}},
+        {52, {{0, 1, false}}, {}},
+        {57, {}, {{0, 1, false}}},
+    });
+    runEvents();
+}
+
+TEST_F(DebounceTest, OneKeyBounceCancelled) {
+    addEvents({ /* Time, Inputs, Outputs */
+        {0, {{0, 1, true}}, {}},
+        {2, {{0, 1, false}}, {}},
+    });
+    runEvents();
+}
+
+TEST_F(DebounceTest, BouncingKeyDoesNotDelayOtherKeys) {
+    addEvents({ /* Time, Inputs, Outputs */
+        {0, {{0, 1, true}}, {}},
+        {2, {{0, 1, false}, {0, 2, true}}, {}},
+        {4, {{0, 1, true}}, {}},
+        {7, {}, {{0, 2, true}}},
+        {9, {}, {{0, 1, true}}},
+    });
+    runEvents();
+}
+
+TEST_F(DebounceTest, SlowScanRate) {
+    addEvents({ /* Time, Inputs, Outputs */
+        {0, {{1, 9, true}}, {}},
+        {6, {}, {{1, 9, true}}},
+        {30, {{1, 9, false}}, {}},
+        {36, {}, {{1, 9, false}}},
+    });
+    runEvents(3);
+}
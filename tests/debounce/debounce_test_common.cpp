@@ -0,0 +1,99 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "debounce_test_common.h"
+#include <algorithm>
+#include <sstream>
+
+extern "C" {
+#include "debounce.h"
+#include "test_timer.h"
+}
+
+MatrixTestEvent::MatrixTestEvent(uint8_t row, uint8_t col, bool pressed)
+    : row(row), col(col), pressed(pressed) {
+}
+
+DebounceTestEvent::DebounceTestEvent(uint32_t time,
+    std::initializer_list<MatrixTestEvent> inputs,
+    std::initializer_list<MatrixTestEvent> outputs)
+    : time(time), inputs(inputs), outputs(outputs) {
+}
+
+void DebounceTest::addEvents(std::initializer_list<DebounceTestEvent> events) {
+    events_.insert(events_.end(), events.begin(), events.end());
+}
+
+static void apply(matrix_row_t matrix[], const std::vector<MatrixTestEvent>& changes) {
+    for (auto& change : changes) {
+        if (change.pressed) {
+            matrix[change.row] |= (matrix_row_t)1 << change.col;
+        } else {
+            matrix[change.row] &= ~((matrix_row_t)1 << change.col);
+        }
+    }
+}
+
+void DebounceTest::runEvents(uint32_t scan_interval) {
+    std::fill(std::begin(raw_), std::end(raw_), 0);
+    std::fill(std::begin(cooked_), std::end(cooked_), 0);
+    std::fill(std::begin(expected_), std::end(expected_), 0);
+    set_time(0);
+    debounce_init(MATRIX_ROWS);
+
+    uint32_t end_time = 0;
+    for (auto& event : events_) {
+        ASSERT_EQ(event.time % scan_interval, 0u) << "events have to happen on a scan";
+        end_time = std::max(end_time, event.time);
+    }
+    end_time += 100;
+
+    auto next = events_.begin();
+    for (uint32_t time = 0; time <= end_time; time += scan_interval) {
+        set_time(time);
+        bool changed = false;
+        if (next != events_.end() && next->time == time) {
+            matrix_row_t before[MATRIX_ROWS];
+            std::copy(std::begin(raw_), std::end(raw_), before);
+            apply(raw_, next->inputs);
+            changed = !std::equal(std::begin(raw_), std::end(raw_), before);
+            apply(expected_, next->outputs);
+            ++next;
+        }
+        debounce(raw_, cooked_, MATRIX_ROWS, changed);
+        checkCooked(time);
+        if (HasFatalFailure()) {
+            return;
+        }
+    }
+    ASSERT_FALSE(debounce_active()) << "debouncing didn't settle";
+}
+
+void DebounceTest::checkCooked(uint32_t time) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        if (cooked_[row] != expected_[row]) {
+            std::stringstream ss;
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                matrix_row_t mask = (matrix_row_t)1 << col;
+                if ((cooked_[row] ^ expected_[row]) & mask) {
+                    ss << " (" << (int)row << ", " << (int)col << ") is "
+                        << ((cooked_[row] & mask) ? "pressed" : "released");
+                }
+            }
+            FAIL() << "Unexpected debounced matrix at time " << time << ":" << ss.str();
+        }
+    }
+}
@@ -0,0 +1,66 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEBOUNCE_TEST_COMMON_H
+#define DEBOUNCE_TEST_COMMON_H
+
+#include "gtest/gtest.h"
+#include <initializer_list>
+#include <vector>
+
+extern "C" {
+#include "matrix.h"
+}
+
+class MatrixTestEvent {
+public:
+    MatrixTestEvent(uint8_t row, uint8_t col, bool pressed);
+
+    uint8_t row;
+    uint8_t col;
+    bool pressed;
+};
+
+class DebounceTestEvent {
+public:
+    // Inputs are the raw switch changes at the given time, outputs the
+    // changes the debounced matrix must show after the scan at that time
+    DebounceTestEvent(uint32_t time,
+        std::initializer_list<MatrixTestEvent> inputs,
+        std::initializer_list<MatrixTestEvent> outputs);
+
+    uint32_t time;
+    std::vector<MatrixTestEvent> inputs;
+    std::vector<MatrixTestEvent> outputs;
+};
+
+class DebounceTest : public ::testing::Test {
+protected:
+    void addEvents(std::initializer_list<DebounceTestEvent> events);
+    // Scans the matrix every scan_interval ms from time 0 until a while
+    // after the last event, checking the debounced output after every scan
+    void runEvents(uint32_t scan_interval = 1);
+
+private:
+    void checkCooked(uint32_t time);
+
+    std::vector<DebounceTestEvent> events_;
+    matrix_row_t raw_[MATRIX_ROWS];
+    matrix_row_t cooked_[MATRIX_ROWS];
+    matrix_row_t expected_[MATRIX_ROWS];
+};
+
+#endif
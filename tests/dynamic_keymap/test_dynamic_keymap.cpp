@@ -0,0 +1,214 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <iostream>
+#include "test_fixture.h"
+#include "keyboard_report_util.h"
+
+extern "C" {
+#include "keymap.h"
+#include "action_layer.h"
+#include "eeconfig.h"
+#include "eeprom.h"
+#include "dynamic_keymap.h"
+#include "test_matrix.h"
+#include "test_eeprom.h"
+}
+
+using testing::ElementsAre;
+
+static const uint8_t PACKET = 32;
+
+class DynamicKeymap : public TestFixture {
+protected:
+    DynamicKeymap() {
+        // as matrix_init_quantum does
+        dynamic_keymap_init();
+    }
+    ~DynamicKeymap() {
+        dynamic_keymap_reset();
+    }
+    static uint16_t stored(uint8_t layer, uint8_t row, uint8_t col) {
+        return pgm_read_word(&keymaps[layer][row][col]);
+    }
+    static uint16_t keycode(uint8_t layer, uint8_t row, uint8_t col) {
+        return keymap_key_to_keycode(layer, (keypos_t){ .col = col, .row = row });
+    }
+    std::vector<std::vector<uint8_t>> tap(uint8_t col, uint8_t row) {
+        driver.clear();
+        press_key(col, row);
+        run_one_scan_loop();
+        release_key(col, row);
+        run_one_scan_loop();
+        std::vector<std::vector<uint8_t>> result;
+        for (auto& r : driver.keyboard_reports()) {
+            result.push_back(get_keys(r.report));
+        }
+        return result;
+    }
+    static std::vector<uint8_t> request(uint8_t command, uint16_t offset, uint8_t count,
+                                        const std::vector<uint16_t>& keycodes = {}) {
+        std::vector<uint8_t> data(PACKET, 0);
+        data[0] = DYNAMIC_KEYMAP_RAW_HID_ID;
+        data[1] = command;
+        data[2] = offset & 0xFF;
+        data[3] = offset >> 8;
+        data[4] = count;
+        for (size_t i = 0; i < keycodes.size(); i++) {
+            data[5 + 2 * i] = keycodes[i] & 0xFF;
+            data[6 + 2 * i] = keycodes[i] >> 8;
+        }
+        EXPECT_TRUE(dynamic_keymap_raw_hid_receive(data.data(), data.size()));
+        return data;
+    }
+};
+
+TEST_F(DynamicKeymap, StartsAsTheCompiledKeymap) {
+    for (uint8_t l = 0; l < DYNAMIC_KEYMAP_LAYER_COUNT; l++) {
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+                EXPECT_EQ(keycode(l, r, c), stored(l, r, c)) << "layer " << +l << " key " << +r << "," << +c;
+            }
+        }
+    }
+    EXPECT_EQ(keycode(DYNAMIC_KEYMAP_LAYER_COUNT, 0, 0), KC_TRNS);
+    EXPECT_EQ(keycode(0, 255, 255), KC_NO);
+    EXPECT_THAT(tap(0, 0), ElementsAre(std::vector<uint8_t>{KC_A}, std::vector<uint8_t>{}));
+}
+
+TEST_F(DynamicKeymap, AChangedKeyIsTypedAndKeptAcrossRestarts) {
+    dynamic_keymap_set_keycode(0, 0, 0, KC_Z);
+    EXPECT_THAT(tap(0, 0), ElementsAre(std::vector<uint8_t>{KC_Z}, std::vector<uint8_t>{}));
+    dynamic_keymap_init();
+    EXPECT_EQ(keycode(0, 0, 0), KC_Z);
+    EXPECT_EQ(keycode(0, 0, 1), KC_B);
+}
+
+TEST_F(DynamicKeymap, ChangesShowThroughTheActiveLayers) {
+    layer_on(1);
+    // transparent on layer 1
+    EXPECT_THAT(tap(1, 0), ElementsAre(std::vector<uint8_t>{KC_B}, std::vector<uint8_t>{}));
+    dynamic_keymap_set_keycode(1, 0, 1, KC_F2);
+    EXPECT_THAT(tap(1, 0), ElementsAre(std::vector<uint8_t>{KC_F2}, std::vector<uint8_t>{}));
+    dynamic_keymap_set_keycode(1, 0, 1, KC_TRNS);
+    EXPECT_THAT(tap(1, 0), ElementsAre(std::vector<uint8_t>{KC_B}, std::vector<uint8_t>{}));
+}
+
+TEST_F(DynamicKeymap, ClearingTheEepromRestoresTheKeymap) {
+    dynamic_keymap_set_keycode(0, 0, 0, KC_Z);
+    eeconfig_init();
+    EXPECT_EQ(keycode(0, 0, 0), KC_A);
+}
+
+TEST_F(DynamicKeymap, AnotherLayoutIsReplacedByTheKeymap) {
+    dynamic_keymap_set_keycode(0, 0, 0, KC_Z);
+    // stored by a firmware with another layer count
+    eeprom_update_byte((uint8_t *)DYNAMIC_KEYMAP_EEPROM_ADDR + 2, DYNAMIC_KEYMAP_LAYER_COUNT + 1);
+    dynamic_keymap_init();
+    EXPECT_EQ(keycode(0, 0, 0), KC_A);
+}
+
+TEST_F(DynamicKeymap, BulkReadAndWrite) {
+    std::vector<uint16_t> keymap(DYNAMIC_KEYMAP_KEYCODES);
+    EXPECT_EQ(dynamic_keymap_read(0, keymap.size(), keymap.data()), DYNAMIC_KEYMAP_KEYCODES);
+    EXPECT_EQ(keymap[0], KC_A);
+    EXPECT_EQ(keymap[MATRIX_ROWS * MATRIX_COLS], KC_F1);
+
+    std::vector<uint16_t> layer(MATRIX_ROWS * MATRIX_COLS, KC_X);
+    EXPECT_EQ(dynamic_keymap_write(MATRIX_ROWS * MATRIX_COLS, layer.size(), layer.data()), layer.size());
+    EXPECT_EQ(keycode(1, 3, 9), KC_X);
+    EXPECT_EQ(keycode(0, 3, 9), LSFT(KC_0));
+
+    // clipped at the end
+    uint16_t end[4];
+    EXPECT_EQ(dynamic_keymap_read(DYNAMIC_KEYMAP_KEYCODES - 2, 4, end), 2);
+    EXPECT_EQ(dynamic_keymap_write(DYNAMIC_KEYMAP_KEYCODES, 4, end), 0);
+}
+
+TEST_F(DynamicKeymap, RawHidTransfersTheKeymapInFewPackets) {
+    auto info = request(DYNAMIC_KEYMAP_RAW_HID_INFO, 0, 0);
+    EXPECT_EQ(info[2], DYNAMIC_KEYMAP_LAYER_COUNT);
+    EXPECT_EQ(info[3], MATRIX_ROWS);
+    EXPECT_EQ(info[4], MATRIX_COLS);
+
+    // every keycode of every layer, reversed, written and read back
+    const uint8_t per_packet = (PACKET - 5) / 2;
+    std::vector<uint16_t> keymap;
+    for (uint16_t i = 0; i < DYNAMIC_KEYMAP_KEYCODES; i++) {
+        keymap.push_back(KC_A + (DYNAMIC_KEYMAP_KEYCODES - 1 - i) % 26);
+    }
+    int packets = 0;
+    for (uint16_t offset = 0; offset < keymap.size(); offset += per_packet, packets++) {
+        std::vector<uint16_t> chunk(keymap.begin() + offset,
+                                    keymap.begin() + std::min<size_t>(offset + per_packet, keymap.size()));
+        auto reply = request(DYNAMIC_KEYMAP_RAW_HID_WRITE, offset, chunk.size(), chunk);
+        EXPECT_EQ(reply[4], chunk.size());
+    }
+    std::vector<uint16_t> read;
+    for (uint16_t offset = 0; offset < keymap.size(); offset += per_packet) {
+        auto reply = request(DYNAMIC_KEYMAP_RAW_HID_READ, offset, per_packet);
+        for (uint8_t i = 0; i < reply[4]; i++) {
+            read.push_back(reply[5 + 2 * i] | (reply[6 + 2 * i] << 8));
+        }
+    }
+    EXPECT_EQ(read, keymap);
+    EXPECT_EQ(packets, (DYNAMIC_KEYMAP_KEYCODES + per_packet - 1) / per_packet);
+    EXPECT_EQ(keycode(0, 0, 0), keymap[0]);
+
+    // nothing past the end
+    EXPECT_EQ(request(DYNAMIC_KEYMAP_RAW_HID_READ, DYNAMIC_KEYMAP_KEYCODES, per_packet)[4], 0);
+    EXPECT_EQ(request(DYNAMIC_KEYMAP_RAW_HID_WRITE, 0xFFFF, 2, {KC_Z, KC_Z})[4], 0);
+    EXPECT_EQ(keycode(0, 0, 0), keymap[0]);
+
+    request(DYNAMIC_KEYMAP_RAW_HID_RESET, 0, 0);
+    EXPECT_EQ(keycode(0, 0, 0), KC_A);
+
+    // other requests are left to raw_hid_receive
+    std::vector<uint8_t> other(PACKET, 0);
+    EXPECT_FALSE(dynamic_keymap_raw_hid_receive(other.data(), other.size()));
+}
+
+TEST_F(DynamicKeymap, HotLayersAreReadFromRam) {
+    const int rounds = 1000;
+    keycode(0, 0, 0);
+    keycode(1, 0, 0);
+    uint32_t reads = test_eeprom_reads();
+#ifdef BENCHMARK
+    auto start = std::chrono::steady_clock::now();
+#endif
+    for (int i = 0; i < rounds; i++) {
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+                keycode(i % 2, r, c);
+            }
+        }
+    }
+#ifdef BENCHMARK
+    auto end = std::chrono::steady_clock::now();
+#endif
+    reads = test_eeprom_reads() - reads;
+#if DYNAMIC_KEYMAP_CACHED_LAYERS >= 2
+    EXPECT_EQ(reads, 0u);
+#else
+    EXPECT_GT(reads, 0u);
+#endif
+#ifdef BENCHMARK
+    std::cout << "[ BENCH    ] keymap_key_to_keycode on 2 layers, " << DYNAMIC_KEYMAP_CACHED_LAYERS
+              << " cached: " << std::chrono::duration<double, std::nano>(end - start).count() / (rounds * MATRIX_ROWS * MATRIX_COLS)
+              << " ns, " << reads / rounds << " EEPROM bytes read per matrix" << std::endl;
+#endif
+}
@@ -0,0 +1,125 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include "test_fixture.h"
+
+extern "C" {
+#include "eeconfig.h"
+#include "eeprom.h"
+#include "suspend.h"
+#include "test_eeprom.h"
+}
+
+#ifdef EECONFIG_WRITE_DELAY
+static const bool deferred = true;
+#else
+static const bool deferred = false;
+#define EECONFIG_WRITE_DELAY 0
+#endif
+
+class EEConfig : public TestFixture {
+protected:
+    EEConfig() {
+        // write what magic() set up on the blank EEPROM, and an RGB setting
+        eeconfig_update_dword(EECONFIG_RGBLIGHT, 0);
+        eeconfig_flush();
+        writes = test_eeprom_writes();
+    }
+    // until the write after the last change is due
+    void settle() {
+        idle_for(EECONFIG_WRITE_DELAY + scan_interval);
+    }
+    uint32_t written() {
+        return test_eeprom_writes() - writes;
+    }
+    uint32_t writes;
+};
+
+TEST_F(EEConfig, FirstBootWritesTheDefaults) {
+    EXPECT_TRUE(eeconfig_is_enabled());
+    EXPECT_EQ(eeprom_read_word(EECONFIG_MAGIC), EECONFIG_MAGIC_NUMBER);
+    EXPECT_EQ(eeprom_read_byte(EECONFIG_DEFAULT_LAYER), 0);
+}
+
+TEST_F(EEConfig, ReadsSeeChangesNotWrittenYet) {
+    eeconfig_update_default_layer(2);
+    eeconfig_update_dword(EECONFIG_RGBLIGHT, 0x12345678);
+    EXPECT_EQ(eeconfig_read_default_layer(), 2);
+    EXPECT_EQ(eeconfig_read_dword(EECONFIG_RGBLIGHT), 0x12345678u);
+    EXPECT_EQ(eeprom_read_byte(EECONFIG_DEFAULT_LAYER), deferred ? 0 : 2);
+    settle();
+    EXPECT_EQ(eeprom_read_byte(EECONFIG_DEFAULT_LAYER), 2);
+    EXPECT_EQ(eeprom_read_dword(EECONFIG_RGBLIGHT), 0x12345678u);
+}
+
+TEST_F(EEConfig, HueSweepIsWrittenOnce) {
+    // holding a key that steps the hue, with a 30 ms repeat rate
+    const int steps = 40;
+    for (int i = 1; i <= steps; i++) {
+        eeconfig_update_dword(EECONFIG_RGBLIGHT, i << 1 | 1);
+        idle_for(30);
+    }
+    uint32_t during = written();
+    settle();
+#ifdef BENCHMARK
+    std::cout << "[ BENCH    ] " << steps << " hue steps: " << written() << " bytes written" << std::endl;
+#endif
+    EXPECT_EQ(eeprom_read_dword(EECONFIG_RGBLIGHT), (uint32_t)(steps << 1 | 1));
+    if (deferred) {
+        EXPECT_EQ(during, 0u);
+        EXPECT_EQ(written(), 1u);
+    } else {
+        EXPECT_EQ(written(), (uint32_t)steps);
+    }
+}
+
+TEST_F(EEConfig, RevertedChangeWritesNothing) {
+    eeconfig_update_keymap(0x81);
+    eeconfig_update_keymap(0);
+    settle();
+    EXPECT_EQ(eeconfig_read_keymap(), 0);
+    EXPECT_EQ(written(), deferred ? 0u : 2u);
+}
+
+TEST_F(EEConfig, SuspendWritesChanges) {
+    eeconfig_update_byte(EECONFIG_UNICODEMODE, 3);
+    suspend_power_down();
+    EXPECT_EQ(eeprom_read_byte(EECONFIG_UNICODEMODE), 3);
+    EXPECT_EQ(written(), 1u);
+}
+
+#if EECONFIG_WRITE_DELAY
+TEST_F(EEConfig, ChangesAreNotHeldBackForever) {
+    // a change every half delay keeps pushing the write back, up to the limit
+    uint32_t elapsed = 0;
+    while (written() == 0 && elapsed < 10 * EECONFIG_WRITE_DELAY) {
+        eeconfig_update_debug(elapsed & 0xFF);
+        idle_for(EECONFIG_WRITE_DELAY / 2);
+        elapsed += EECONFIG_WRITE_DELAY / 2;
+    }
+    EXPECT_GT(written(), 0u);
+    EXPECT_LE(elapsed, 5 * EECONFIG_WRITE_DELAY);
+}
+
+TEST_F(EEConfig, LoadDropsChangesNotWrittenYet) {
+    eeconfig_update_default_layer(1);
+    eeconfig_load();
+    settle();
+    EXPECT_EQ(eeconfig_read_default_layer(), 0);
+    EXPECT_EQ(written(), 0u);
+}
+#endif
@@ -0,0 +1,226 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <vector>
+
+extern "C" {
+#include "keyboard.h"
+#include "action.h"
+#include "host.h"
+#include "led.h"
+#include "scheduler.h"
+#include "wait.h"
+#include "test_matrix.h"
+#include "test_timer.h"
+}
+
+static uint32_t scan_us = 0;
+static uint32_t task_runs = 0;
+
+static void count_task(void) {
+    task_runs++;
+}
+
+class KeyboardTask : public testing::Test {
+public:
+    KeyboardTask() {
+        Instance = this;
+        clear_matrix();
+        set_time(0);
+        // Settle the previous matrix state left by other tests
+        drain();
+        events.clear();
+        matrix_scan_count = 0;
+        scan_us = 0;
+        task_runs = 0;
+    }
+
+    ~KeyboardTask() {
+        clear_matrix();
+        drain();
+        Instance = nullptr;
+    }
+
+    // Run the task until no more real key events are reported
+    void drain() {
+        do {
+            ticks_seen = 0;
+            keyboard_task();
+        } while (ticks_seen == 0);
+    }
+
+    // Run the task until the given number of key events has been seen
+    // returns the number of scans it took
+    uint32_t run_until(size_t num_events) {
+        uint32_t scans = 0;
+        while (events.size() < num_events) {
+            keyboard_task();
+            advance_time(1);
+            scans++;
+        }
+        return scans;
+    }
+
+    static KeyboardTask* Instance;
+    std::vector<keyevent_t> events;
+    int ticks_seen;
+};
+
+KeyboardTask* KeyboardTask::Instance = nullptr;
+
+extern "C" {
+void action_exec(keyevent_t event) {
+    if (!KeyboardTask::Instance) {
+        return;
+    }
+    if (IS_NOEVENT(event)) {
+        KeyboardTask::Instance->ticks_seen++;
+    } else {
+        KeyboardTask::Instance->events.push_back(event);
+    }
+}
+
+uint8_t host_keyboard_leds(void) {
+    return 0;
+}
+
+void led_set(uint8_t usb_led) {
+}
+
+void magic(void) {
+}
+
+// a split keyboard reading its other half over I2C
+void matrix_scan_user(void) {
+    wait_us(scan_us);
+}
+}
+
+static void press_chord(uint8_t num_keys) {
+    for (uint8_t i = 0; i < num_keys; i++) {
+        press_key(i % MATRIX_COLS, i / MATRIX_COLS);
+    }
+}
+
+TEST_F(KeyboardTask, a_single_key_press_and_release_is_reported) {
+    press_key(3, 1);
+    run_until(1);
+    release_key(3, 1);
+    run_until(2);
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].key.row, 1);
+    EXPECT_EQ(events[0].key.col, 3);
+    EXPECT_TRUE(events[0].pressed);
+    EXPECT_EQ(events[1].key.row, 1);
+    EXPECT_EQ(events[1].key.col, 3);
+    EXPECT_FALSE(events[1].pressed);
+}
+
+TEST_F(KeyboardTask, no_tick_is_sent_in_the_same_scan_as_a_key) {
+    press_key(0, 0);
+    ticks_seen = 0;
+    keyboard_task();
+    EXPECT_EQ(events.size(), 1u);
+    EXPECT_EQ(ticks_seen, 0);
+}
+
+TEST_F(KeyboardTask, a_tick_is_sent_when_nothing_changes) {
+    ticks_seen = 0;
+    keyboard_task();
+    EXPECT_EQ(events.size(), 0u);
+    EXPECT_EQ(ticks_seen, 1);
+}
+
+TEST_F(KeyboardTask, simultaneous_changes_are_processed_in_row_then_column_order) {
+    press_key(7, 2);
+    press_key(1, 0);
+    press_key(9, 0);
+    press_key(0, 3);
+    press_key(4, 2);
+    run_until(5);
+    ASSERT_EQ(events.size(), 5u);
+    const uint8_t expected[][2] = {{0, 1}, {0, 9}, {2, 4}, {2, 7}, {3, 0}};
+    for (int i = 0; i < 5; i++) {
+        EXPECT_EQ(events[i].key.row, expected[i][0]);
+        EXPECT_EQ(events[i].key.col, expected[i][1]);
+        EXPECT_TRUE(events[i].pressed);
+    }
+}
+
+TEST_F(KeyboardTask, mixed_presses_and_releases_keep_their_order) {
+    press_key(2, 0);
+    press_key(5, 1);
+    run_until(2);
+    events.clear();
+    release_key(2, 0);
+    press_key(3, 0);
+    release_key(5, 1);
+    run_until(3);
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[0].key.col, 2);
+    EXPECT_FALSE(events[0].pressed);
+    EXPECT_EQ(events[1].key.col, 3);
+    EXPECT_TRUE(events[1].pressed);
+    EXPECT_EQ(events[2].key.col, 5);
+    EXPECT_FALSE(events[2].pressed);
+}
+
+TEST_F(KeyboardTask, events_are_timestamped_and_never_zero) {
+    set_time(0x10000);
+    press_key(0, 0);
+    press_key(1, 0);
+    run_until(2);
+    for (auto& e : events) {
+        EXPECT_NE(e.time, 0);
+    }
+    EXPECT_LE(events[0].time, events[1].time);
+}
+
+TEST_F(KeyboardTask, chord_latency) {
+    const uint8_t chord_size = 8;
+    press_chord(chord_size);
+    uint32_t scans = run_until(chord_size);
+    ASSERT_EQ(events.size(), chord_size);
+#ifdef BENCHMARK
+    uint16_t latency = events.back().time - events.front().time;
+    std::cout << "[ BENCH    ] " << (int)chord_size << "-key chord delivered in " << scans
+        << " scans, " << latency << " ms between first and last event" << std::endl;
+#endif
+#ifdef QMK_KEYS_PER_SCAN
+    const uint32_t expected_scans = (chord_size + QMK_KEYS_PER_SCAN - 1) / QMK_KEYS_PER_SCAN;
+#else
+    const uint32_t expected_scans = chord_size;
+#endif
+    EXPECT_EQ(scans, expected_scans);
+    EXPECT_EQ(matrix_scan_count, expected_scans);
+}
+
+TEST_F(KeyboardTask, tasks_still_run_when_the_scan_takes_the_whole_budget) {
+    scheduled_task_t normal = SCHEDULED_TASK(count_task, 0, TASK_PRIORITY_NORMAL);
+    scheduled_task_t low = SCHEDULED_TASK(count_task, 0, TASK_PRIORITY_LOW);
+    scheduler_add(&normal);
+    scheduler_add(&low);
+    scan_us = SCHEDULER_BUDGET_US * 3 / 2;
+    for (int i = 0; i < 10; i++) {
+        keyboard_task();
+    }
+    scheduler_remove(&normal);
+    scheduler_remove(&low);
+    EXPECT_EQ(normal.runs, 10u);
+    EXPECT_EQ(low.runs, 10u);
+    EXPECT_EQ(task_runs, 20u);
+}
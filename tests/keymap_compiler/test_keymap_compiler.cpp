@@ -0,0 +1,171 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <iostream>
+#include "test_fixture.h"
+
+extern "C" {
+#include "keymap.h"
+#include "keymap_compiled.h"
+#include "action_layer.h"
+}
+
+/* Compares the tables of util/compile_keymap.py with the lookups they
+ * replace, for every key on every layer of the keymap the test is built with */
+class KeymapCompiler : public TestFixture {
+protected:
+    KeymapCompiler() {
+        keymap_config.raw = 0;
+    }
+    ~KeymapCompiler() {
+        keymap_config.raw = 0;
+        layer_clear();
+        default_layer_set(0);
+    }
+    static uint8_t layers() {
+        return keymap_compiled_layer_count();
+    }
+    static keypos_t key(uint8_t row, uint8_t col) {
+        return (keypos_t){ .col = col, .row = row };
+    }
+    static uint16_t keycode(uint8_t layer, uint8_t row, uint8_t col) {
+        return pgm_read_word(&keymaps[layer][row][col]);
+    }
+    /* action_for_key as it is without the compiled keymap */
+    static uint16_t action(uint8_t layer, uint8_t row, uint8_t col) {
+        return action_for_keycode(keycode_config(keycode(layer, row, col))).code;
+    }
+    static int8_t find_layer(uint32_t state, uint8_t row, uint8_t col) {
+        for (int8_t i = 31; i >= 0; i--) {
+            if ((state & (1UL << i)) && action(i, row, col) != ACTION_TRANSPARENT) {
+                return i;
+            }
+        }
+        return 0;
+    }
+};
+
+TEST_F(KeymapCompiler, EveryKeyHasItsKeycode) {
+    ASSERT_GT(layers(), 0);
+    for (uint8_t l = 0; l < layers(); l++) {
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+                EXPECT_EQ(keymap_compiled_keycode(l, key(r, c)), keycode(l, r, c)) << "layer " << +l << " key " << +r << "," << +c;
+                EXPECT_EQ(keymap_key_to_keycode(l, key(r, c)), keycode(l, r, c));
+            }
+        }
+    }
+}
+
+TEST_F(KeymapCompiler, EveryKeyHasItsAction) {
+    for (uint8_t l = 0; l < layers(); l++) {
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+                EXPECT_EQ(keymap_compiled_action(l, key(r, c)), action(l, r, c)) << "layer " << +l << " key " << +r << "," << +c;
+                EXPECT_EQ(action_for_key(l, key(r, c)).code, action(l, r, c));
+            }
+        }
+    }
+}
+
+TEST_F(KeymapCompiler, EveryKeyKnowsItsTransparentLayers) {
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+            uint32_t expected = 0;
+            for (uint8_t l = 0; l < layers(); l++) {
+                if (action(l, r, c) != ACTION_TRANSPARENT) {
+                    expected |= 1UL << l;
+                }
+            }
+            EXPECT_EQ(keymap_compiled_layers(key(r, c)), expected) << "key " << +r << "," << +c;
+        }
+    }
+}
+
+TEST_F(KeymapCompiler, EveryLayerStateResolvesAsBefore) {
+    ASSERT_LE(layers(), 16);
+    for (uint32_t state = 0; state < (1UL << layers()); state++) {
+        layer_clear();
+        layer_or(state);
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+                ASSERT_EQ(layer_switch_get_layer(key(r, c)), find_layer(state | default_layer_state, r, c))
+                    << "layers " << state << " key " << +r << "," << +c;
+            }
+        }
+    }
+}
+
+TEST_F(KeymapCompiler, MagicRemapsAreStillApplied) {
+    const uint16_t remaps[] = { 1 << 0, 1 << 1, 1 << 2, 1 << 3, 1 << 4, 1 << 5, 1 << 6, (1 << 2) | (1 << 4) };
+    for (uint16_t remap : remaps) {
+        keymap_config.raw = remap;
+        for (uint8_t l = 0; l < layers(); l++) {
+            for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+                for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+                    EXPECT_EQ(action_for_key(l, key(r, c)).code, action(l, r, c))
+                        << "remap " << remap << " layer " << +l << " key " << +r << "," << +c;
+                }
+            }
+        }
+    }
+}
+
+TEST_F(KeymapCompiler, KeysOutsideTheKeymapAreTransparent) {
+    EXPECT_EQ(keymap_compiled_keycode(layers(), key(0, 0)), KC_TRNS);
+    EXPECT_EQ(keymap_compiled_action(layers(), key(0, 0)), ACTION_TRANSPARENT);
+    EXPECT_EQ(keymap_compiled_action(0, key(255, 255)), ACTION_TRANSPARENT);
+    EXPECT_EQ(keymap_compiled_layers(key(255, 255)), 0u);
+    layer_on(layers() - 1);
+    EXPECT_EQ(layer_switch_get_layer(key(255, 255)), 0);
+}
+
+#ifdef BENCHMARK
+TEST_F(KeymapCompiler, LookupCost) {
+    const int rounds = 20000;
+    volatile uint32_t sink = 0;
+    auto time_keys = [&](uint32_t (*lookup)(uint8_t, uint8_t, uint8_t)) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++) {
+            for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+                for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+                    sink = sink + lookup(i % layers(), r, c);
+                }
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / (rounds * MATRIX_ROWS * MATRIX_COLS);
+    };
+    double action_compiled = time_keys([](uint8_t l, uint8_t r, uint8_t c) -> uint32_t {
+        return action_for_key(l, key(r, c)).code;
+    });
+    double action_translated = time_keys([](uint8_t l, uint8_t r, uint8_t c) -> uint32_t {
+        return action(l, r, c);
+    });
+    // with every layer on, from the top
+    layer_or((1UL << layers()) - 1);
+    double layer_compiled = time_keys([](uint8_t l, uint8_t r, uint8_t c) -> uint32_t {
+        return layer_switch_get_layer(key(r, c));
+    });
+    double layer_translated = time_keys([](uint8_t l, uint8_t r, uint8_t c) -> uint32_t {
+        return find_layer(layer_state | default_layer_state, r, c);
+    });
+    std::cout << "[ BENCH    ] " << +layers() << " layers, action_for_key: compiled " << action_compiled
+              << " ns, translated " << action_translated << " ns; layer_switch_get_layer: compiled "
+              << layer_compiled << " ns, translated " << layer_translated << " ns" << std::endl;
+}
+#endif
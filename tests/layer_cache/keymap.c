@@ -0,0 +1,64 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+#include "layer_cache_keymap.h"
+
+#define ROW_TRNS {KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS}
+#define LAYER_TRNS {ROW_TRNS, ROW_TRNS, ROW_TRNS, ROW_TRNS}
+
+/* A base layer under a stack of mostly transparent layers, so that most
+ * keys are only resolved after walking every active layer */
+const uint16_t PROGMEM keymaps[TEST_LAYERS][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {
+        {KC_A,    KC_B,    KC_C,    KC_D,    KC_E,    KC_F,    KC_G,    KC_H,    KC_I,    KC_J},
+        {KC_K,    KC_L,    KC_M,    KC_N,    KC_O,    KC_P,    KC_Q,    KC_R,    KC_S,    KC_T},
+        {KC_LSFT, KC_LCTL, KC_U,    KC_V,    KC_W,    KC_X,    KC_Y,    KC_Z,    KC_NO,   KC_NO},
+        {KC_1,    KC_2,    KC_3,    KC_4,    KC_5,    KC_6,    KC_7,    KC_8,    KC_9,    KC_0},
+    },
+    [1 ... TEST_LAYERS - 1] = LAYER_TRNS,
+    [10] = {
+        ROW_TRNS,
+        {KC_TRNS, KC_F10,  KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS},
+        ROW_TRNS,
+        ROW_TRNS,
+    },
+    [TEST_LAYERS - 1] = {
+        {KC_F19,  KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS},
+        ROW_TRNS,
+        ROW_TRNS,
+        ROW_TRNS,
+    },
+};
+
+const uint16_t fn_actions[] = {
+};
+
+bool test_key_patched = false;
+uint8_t test_patch_layer;
+keypos_t test_patch_key;
+uint16_t test_patch_keycode;
+uint32_t test_keymap_reads = 0;
+
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key)
+{
+    test_keymap_reads++;
+    if (test_key_patched && layer == test_patch_layer &&
+        key.row == test_patch_key.row && key.col == test_patch_key.col) {
+        return test_patch_keycode;
+    }
+    return pgm_read_word(&keymaps[layer][key.row][key.col]);
+}
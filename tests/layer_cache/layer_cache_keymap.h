@@ -0,0 +1,34 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TESTS_LAYER_CACHE_KEYMAP_H_
+#define TESTS_LAYER_CACHE_KEYMAP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "keyboard.h"
+
+#define TEST_LAYERS 20
+
+/* replaces one key of the keymap, the way a keymap editable at runtime would */
+extern bool test_key_patched;
+extern uint8_t test_patch_layer;
+extern keypos_t test_patch_key;
+extern uint16_t test_patch_keycode;
+/* number of keymap_key_to_keycode calls */
+extern uint32_t test_keymap_reads;
+
+#endif
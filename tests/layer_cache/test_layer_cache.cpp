@@ -0,0 +1,152 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <iostream>
+#include "test_fixture.h"
+#include "keyboard_report_util.h"
+
+extern "C" {
+#include "keycode.h"
+#include "action.h"
+#include "action_layer.h"
+#include "test_matrix.h"
+#include "layer_cache_keymap.h"
+}
+
+using testing::ElementsAre;
+
+static const uint32_t all_layers = (1UL << TEST_LAYERS) - 1;
+
+class LayerCache : public TestFixture {
+protected:
+    LayerCache() {
+        test_key_patched = false;
+    }
+    ~LayerCache() {
+        test_key_patched = false;
+        default_layer_set(0);
+        layer_cache_invalidate();
+    }
+    static int8_t layer_of(uint8_t col, uint8_t row) {
+        return layer_switch_get_layer((keypos_t){ .col = col, .row = row });
+    }
+};
+
+TEST_F(LayerCache, ResolvesTheTopmostNonTransparentLayer) {
+    layer_or(all_layers);
+    EXPECT_EQ(layer_of(0, 0), TEST_LAYERS - 1);
+    EXPECT_EQ(layer_of(1, 1), 10);
+    EXPECT_EQ(layer_of(2, 2), 0);
+    // and again from the cache
+    EXPECT_EQ(layer_of(0, 0), TEST_LAYERS - 1);
+    EXPECT_EQ(layer_of(1, 1), 10);
+    EXPECT_EQ(layer_of(2, 2), 0);
+}
+
+TEST_F(LayerCache, FollowsLayerChanges) {
+    layer_or(all_layers);
+    EXPECT_EQ(layer_of(0, 0), TEST_LAYERS - 1);
+    layer_off(TEST_LAYERS - 1);
+    EXPECT_EQ(layer_of(0, 0), 0);
+    layer_off(10);
+    EXPECT_EQ(layer_of(1, 1), 0);
+    layer_on(10);
+    EXPECT_EQ(layer_of(1, 1), 10);
+}
+
+TEST_F(LayerCache, FollowsDirectWritesToTheLayerState) {
+    EXPECT_EQ(layer_of(1, 1), 0);
+    layer_state = 1UL << 10;
+    EXPECT_EQ(layer_of(1, 1), 10);
+    layer_state = 0;
+    EXPECT_EQ(layer_of(1, 1), 0);
+}
+
+TEST_F(LayerCache, FollowsTheDefaultLayer) {
+    EXPECT_EQ(layer_of(0, 0), 0);
+    default_layer_set(1UL << (TEST_LAYERS - 1));
+    EXPECT_EQ(layer_of(0, 0), TEST_LAYERS - 1);
+}
+
+TEST_F(LayerCache, KeymapChangesNeedAnInvalidate) {
+    layer_or(all_layers);
+    EXPECT_EQ(layer_of(3, 3), 0);
+    test_patch_layer = 5;
+    test_patch_key = (keypos_t){ .col = 3, .row = 3 };
+    test_patch_keycode = KC_F5;
+    test_key_patched = true;
+    layer_cache_invalidate();
+    EXPECT_EQ(layer_of(3, 3), 5);
+}
+
+TEST_F(LayerCache, KeysAreReportedFromTheResolvedLayer) {
+    layer_or(all_layers);
+    press_key(0, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    run_one_scan_loop();
+    press_key(1, 1);
+    run_one_scan_loop();
+    release_key(1, 1);
+    run_one_scan_loop();
+    std::vector<std::vector<uint8_t>> keys;
+    for (auto& r : driver.keyboard_reports()) {
+        keys.push_back(get_keys(r.report));
+    }
+    // the first report is sent by the layer change
+    EXPECT_THAT(keys, ElementsAre(
+        std::vector<uint8_t>{},
+        std::vector<uint8_t>{KC_F19},
+        std::vector<uint8_t>{},
+        std::vector<uint8_t>{KC_F10},
+        std::vector<uint8_t>{}));
+}
+
+TEST_F(LayerCache, KeymapReadsPerLookup) {
+    layer_or(all_layers);
+    layer_of(2, 2);
+    uint32_t reads = test_keymap_reads;
+    layer_of(2, 2);
+    reads = test_keymap_reads - reads;
+#ifdef LAYER_RESOLUTION_CACHE
+    EXPECT_EQ(reads, 0);
+#else
+    EXPECT_EQ(reads, TEST_LAYERS);
+#endif
+}
+
+#ifdef BENCHMARK
+TEST_F(LayerCache, LookupCost) {
+    layer_or(all_layers);
+    const int rounds = 20000;
+    uint32_t reads = test_keymap_reads;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                layer_switch_get_action((keypos_t){ .col = col, .row = row });
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    const double lookups = (double)rounds * MATRIX_ROWS * MATRIX_COLS;
+    const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    std::cout << "[ BENCH    ] " << TEST_LAYERS << " active layers: "
+        << ns / lookups << " ns and "
+        << (test_keymap_reads - reads) / lookups << " keymap reads per lookup" << std::endl;
+}
+#endif
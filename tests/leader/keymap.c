@@ -0,0 +1,58 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {
+        {KC_LEAD, KC_A,  KC_B,  KC_C,  KC_D,  KC_E,  KC_F,  KC_NO, KC_NO, KC_NO},
+        {KC_NO,   KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO,   KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO,   KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+    },
+};
+
+const uint16_t fn_actions[] = {
+};
+
+#ifndef LEADER_TEST_UNSORTED
+LEADER_SEQUENCES(
+    LEADER_SEQ(1, KC_A),
+    LEADER_SEQ(2, KC_A, KC_B),
+    LEADER_SEQ(3, KC_B, KC_C, KC_D),
+    LEADER_SEQ(4, KC_C, KC_D, KC_E, KC_A, KC_B, KC_C, KC_D),
+    LEADER_SEQ(5, KC_C, KC_D, KC_E, KC_A, KC_B, KC_C, KC_E),
+);
+#else
+LEADER_SEQUENCES(
+    LEADER_SEQ(4, KC_C, KC_D, KC_E, KC_A, KC_B, KC_C, KC_D),
+    LEADER_SEQ(2, KC_A, KC_B),
+    LEADER_SEQ(3, KC_B, KC_C, KC_D),
+    LEADER_SEQ(5, KC_C, KC_D, KC_E, KC_A, KC_B, KC_C, KC_E),
+    LEADER_SEQ(1, KC_A),
+);
+#endif
+
+uint16_t leader_test_id = 0;
+uint8_t leader_test_ends = 0;
+
+void leader_sequence_user(uint16_t id) {
+    leader_test_id = id;
+}
+
+void leader_end(void) {
+    leader_test_ends++;
+}
@@ -0,0 +1,109 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_fixture.h"
+#include "keyboard_report_util.h"
+
+extern "C" {
+#include "quantum.h"
+#include "test_matrix.h"
+
+extern uint16_t leader_test_id;
+extern uint8_t leader_test_ends;
+extern bool leading;
+}
+
+class Leader : public TestFixture {
+public:
+    Leader() {
+        leader_test_id = 0;
+        leader_test_ends = 0;
+        driver.clear();
+    }
+
+protected:
+    void tap_key(uint8_t col) {
+        press_key(col, 0);
+        run_one_scan_loop();
+        release_key(col, 0);
+        run_one_scan_loop();
+    }
+
+    void lead(std::initializer_list<uint8_t> cols) {
+        tap_key(0);
+        for (uint8_t col : cols) {
+            tap_key(col);
+        }
+    }
+};
+
+TEST_F(Leader, AmbiguousSequenceWaitsForTheTimeout) {
+    lead({1});
+    EXPECT_EQ(leader_test_id, 0);
+    EXPECT_TRUE(leading);
+    idle_for(LEADER_TIMEOUT);
+    EXPECT_EQ(leader_test_id, 1);
+    EXPECT_EQ(leader_test_ends, 1);
+    EXPECT_FALSE(leading);
+}
+
+TEST_F(Leader, UnambiguousSequenceIsDoneRightAway) {
+    lead({1, 2});
+#ifndef LEADER_TEST_UNSORTED
+    EXPECT_EQ(leader_test_id, 2);
+    EXPECT_FALSE(leading);
+#endif
+    idle_for(LEADER_TIMEOUT);
+    EXPECT_EQ(leader_test_id, 2);
+    EXPECT_EQ(leader_test_ends, 1);
+}
+
+TEST_F(Leader, SequenceLongerThanFiveKeys) {
+    lead({3, 4, 5, 1, 2, 3, 5});
+    idle_for(LEADER_TIMEOUT);
+    EXPECT_EQ(leader_test_id, 5);
+    EXPECT_EQ(leader_test_ends, 1);
+}
+
+TEST_F(Leader, NoSequenceStartsWithTheKey) {
+    lead({4});
+#ifndef LEADER_TEST_UNSORTED
+    // no need to wait for the timeout
+    EXPECT_FALSE(leading);
+    EXPECT_EQ(leader_test_ends, 1);
+#endif
+    idle_for(LEADER_TIMEOUT);
+    EXPECT_EQ(leader_test_id, 0);
+    EXPECT_EQ(leader_test_ends, 1);
+}
+
+TEST_F(Leader, IncompleteSequence) {
+    lead({2, 3});
+    idle_for(LEADER_TIMEOUT);
+    EXPECT_EQ(leader_test_id, 0);
+    EXPECT_EQ(leader_test_ends, 1);
+}
+
+TEST_F(Leader, KeysAreTypedAfterTheSequence) {
+    lead({1, 2});
+    idle_for(LEADER_TIMEOUT);
+    driver.clear();
+    tap_key(1);
+    auto& reports = driver.keyboard_reports();
+    ASSERT_EQ(reports.size(), 2u);
+    EXPECT_EQ(reports[0].report, make_report({KC_A}));
+    EXPECT_EQ(reports[1].report, make_report({}));
+}
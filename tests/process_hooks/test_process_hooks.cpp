@@ -0,0 +1,135 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <iostream>
+#include "test_fixture.h"
+#include "keyboard_report_util.h"
+
+extern "C" {
+#include "quantum.h"
+#include "test_matrix.h"
+}
+
+/* A build with every process_* hook that runs on the host: tap dance, leader,
+ * combo, unicode and ucis. */
+
+static int user_events;
+
+extern "C" bool process_record_user(uint16_t keycode, keyrecord_t *record) {
+    user_events++;
+    return true;
+}
+
+class ProcessHooks : public TestFixture {
+protected:
+    ProcessHooks() {
+        user_events = 0;
+    }
+
+    bool sent(std::vector<uint8_t> keys) {
+        for (auto& r : driver.keyboard_reports()) {
+            if (get_keys(r.report) == keys) return true;
+        }
+        return false;
+    }
+
+    static keyrecord_t record_at(uint8_t col, uint8_t row, bool pressed) {
+        keyrecord_t record = {};
+        record.event.key = (keypos_t){ .col = col, .row = row };
+        record.event.pressed = pressed;
+        record.event.time = timer_read() | 1;
+        return record;
+    }
+};
+
+TEST_F(ProcessHooks, EveryHookStillSeesItsKeys) {
+    // a plain key goes past every hook to the report
+    press_key(0, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(get_keys(driver.keyboard_reports().front().report), (std::vector<uint8_t>{KC_A}));
+    // the keymap sees every event first
+    EXPECT_EQ(user_events, 2);
+
+    // tap dance, by its range and as an observer of the next key
+    driver.clear();
+    press_key(4, 0);
+    run_one_scan_loop();
+    release_key(4, 0);
+    run_one_scan_loop();
+    press_key(1, 0);
+    run_one_scan_loop();
+    release_key(1, 0);
+    idle_for(TAPPING_TERM * 2);
+    EXPECT_TRUE(sent({KC_X}));
+
+    // unicode, by its range
+    driver.clear();
+    press_key(5, 0);
+    run_one_scan_loop();
+    release_key(5, 0);
+    idle_for(100);
+    EXPECT_GT(driver.keyboard_reports().size(), 4u);
+
+    // combo, as an observer of its keys
+    driver.clear();
+    press_key(8, 0);
+    run_one_scan_loop();
+    press_key(9, 0);
+    run_one_scan_loop();
+    release_key(8, 0);
+    release_key(9, 0);
+    idle_for(COMBO_TERM * 2);
+    EXPECT_TRUE(sent({KC_ESC}));
+    EXPECT_FALSE(sent({KC_J}));
+}
+
+#ifdef BENCHMARK
+/* The chain as it was before the dispatcher: every enabled hook, for every event */
+static bool process_every_hook(uint16_t keycode, keyrecord_t *record) {
+    return process_record_kb(keycode, record) &&
+        process_tap_dance(keycode, record) &&
+        process_leader(keycode, record) &&
+        process_combo(keycode, record) &&
+        process_unicode(keycode, record) &&
+        process_ucis(keycode, record);
+}
+
+TEST_F(ProcessHooks, EventCost) {
+    const int rounds = 100000;
+    keyrecord_t press = record_at(1, 0, true);
+    keyrecord_t release = record_at(1, 0, false);
+    auto time_events = [&](uint16_t keycode, bool (*process)(uint16_t, keyrecord_t *)) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++) {
+            process(keycode, &press);
+            process(keycode, &release);
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / (2 * rounds);
+    };
+    // a plain key, and one that only the tap dance range takes
+    double plain = time_events(KC_B, process_record_hooks);
+    double plain_chained = time_events(KC_B, process_every_hook);
+    double dance = time_events(TD(0), process_record_hooks);
+    double dance_chained = time_events(TD(0), process_every_hook);
+    std::cout << "[ BENCH    ] hooks of tap dance, leader, combo, unicode and ucis: plain key "
+        << plain << " ns per event dispatched, " << plain_chained << " ns chained; tap dance key "
+        << dance << " ns dispatched, " << dance_chained << " ns chained" << std::endl;
+}
+#endif
@@ -0,0 +1,107 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_fixture.h"
+
+extern "C" {
+#include "profile.h"
+#include "test_matrix.h"
+}
+
+class Profile : public TestFixture {};
+
+TEST_F(Profile, ScanPeriodIsTheScanInterval) {
+    scan_interval = 2;
+    idle_for(100);
+    const profile_stat_t* s = profile_get(PROFILE_SCAN_PERIOD);
+    EXPECT_EQ(s->count, 49);
+    EXPECT_EQ(s->min, 2000);
+    EXPECT_EQ(s->max, 2000);
+    EXPECT_EQ(s->sum, 49 * 2000);
+    EXPECT_EQ(profile_get(PROFILE_MATRIX_SCAN)->count, 50);
+}
+
+TEST_F(Profile, ScanRateIsCountedOverASecond) {
+    idle_for(999);
+    EXPECT_EQ(profile_scan_rate(), 0);
+    idle_for(2);
+    EXPECT_EQ(profile_scan_rate(), 1000);
+}
+
+TEST_F(Profile, ReportLatencyOfAPlainKey) {
+    press_key(0, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    run_one_scan_loop();
+    const profile_stat_t* s = profile_get(PROFILE_MATRIX_TO_REPORT);
+    EXPECT_EQ(s->count, 2);
+    EXPECT_EQ(s->max, 0);
+    EXPECT_EQ(profile_get(PROFILE_MATRIX_TO_ACTION)->count, 2);
+    EXPECT_EQ(profile_get(PROFILE_PROCESS_RECORD)->count, 2);
+}
+
+TEST_F(Profile, TapHoldLatencyIncludesTheTappingDecision) {
+    // SFT_T(KC_U) is only reported when it's released as a tap
+    press_key(2, 2);
+    idle_for(50);
+    release_key(2, 2);
+    run_one_scan_loop();
+    const profile_stat_t* s = profile_get(PROFILE_MATRIX_TO_REPORT);
+    ASSERT_GE(s->count, 1);
+    EXPECT_EQ(s->max, 50000);
+    EXPECT_EQ(s->histogram[PROFILE_HISTOGRAM_BUCKETS - 1], 1);
+}
+
+TEST_F(Profile, ProcessHooksAreTimed) {
+    press_key(0, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(profile_get(PROFILE_PROCESS_KB)->count, 2);
+    // leader only sees a plain key in the middle of a sequence
+    EXPECT_EQ(profile_get(PROFILE_PROCESS_LEADER)->count, 0);
+    EXPECT_EQ(profile_get(PROFILE_PROCESS_COMBO)->count, 0);
+}
+
+TEST_F(Profile, ResetClearsTheStatistics) {
+    idle_for(10);
+    profile_reset();
+    const profile_stat_t* s = profile_get(PROFILE_SCAN_PERIOD);
+    EXPECT_EQ(s->count, 0);
+    EXPECT_EQ(s->max, 0);
+    EXPECT_EQ(s->min, UINT16_MAX);
+    EXPECT_EQ(profile_get(PROFILE_NUM_STATS), nullptr);
+}
+
+TEST_F(Profile, RawHidRequestIsAnswered) {
+    scan_interval = 3;
+    idle_for(30);
+    uint8_t data[32] = { PROFILE_RAW_HID_ID, PROFILE_SCAN_PERIOD };
+    EXPECT_TRUE(profile_raw_hid_receive(data, sizeof(data)));
+    EXPECT_EQ(data[0], PROFILE_RAW_HID_ID);
+    EXPECT_EQ(data[1], PROFILE_SCAN_PERIOD);
+    EXPECT_EQ(data[2], PROFILE_NUM_STATS);
+    EXPECT_EQ(data[3] | data[4] << 8, 9);
+    EXPECT_EQ(data[5] | data[6] << 8, 3000);
+    EXPECT_EQ(data[7] | data[8] << 8, 3000);
+    EXPECT_EQ(data[9] | data[10] << 8, 3000);
+}
+
+TEST_F(Profile, OtherRawHidRequestsAreLeftAlone) {
+    uint8_t data[32] = { 0x01, 0x02 };
+    EXPECT_FALSE(profile_raw_hid_receive(data, sizeof(data)));
+    EXPECT_EQ(data[1], 0x02);
+}
@@ -0,0 +1,157 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <string>
+#include <tuple>
+#include "test_fixture.h"
+#include "keyboard_report_util.h"
+
+extern "C" {
+#include "quantum.h"
+#include "host.h"
+#include "test_matrix.h"
+}
+
+using testing::ElementsAre;
+
+/* A key as the host types it: the key and the modifiers held when it went down */
+typedef std::tuple<uint8_t, uint8_t> TypedKey;
+
+class ReportCoalescing : public TestFixture {
+public:
+    ReportCoalescing() {
+#ifdef COALESCE_KEYBOARD_REPORTS
+        // The previous test can leave its last release staged
+        host_keyboard_flush();
+#endif
+        driver.clear();
+    }
+
+protected:
+    /* replays the reports the way the host interprets them */
+    std::vector<TypedKey> typed_keys() {
+        std::vector<TypedKey> result;
+        report_keyboard_t previous = {};
+        for (auto& r : driver.keyboard_reports()) {
+            // a modifier and a key changing together is ambiguous for the host
+            bool mods_changed = r.report.mods != previous.mods;
+            bool keys_changed = false;
+            std::vector<uint8_t> before = get_keys(previous);
+            std::vector<uint8_t> after = get_keys(r.report);
+            for (uint8_t key : after) {
+                if (IS_MOD(key)) continue;
+                if (std::find(before.begin(), before.end(), key) == before.end()) {
+                    result.push_back(TypedKey(key, r.report.mods));
+                    keys_changed = true;
+                }
+            }
+            for (uint8_t key : before) {
+                if (!IS_MOD(key) && std::find(after.begin(), after.end(), key) == after.end()) {
+                    keys_changed = true;
+                }
+            }
+            EXPECT_FALSE(mods_changed && keys_changed) << "at report " << r.report;
+            previous = r.report;
+        }
+        EXPECT_TRUE(get_keys(previous).empty());
+        return result;
+    }
+
+    void bench(const char* name) {
+#ifdef BENCHMARK
+        std::cout << "[ BENCH    ] " << name << ": "
+            << driver.keyboard_reports().size() << " keyboard reports" << std::endl;
+#endif
+    }
+};
+
+TEST_F(ReportCoalescing, SendStringTypesEveryCharacter) {
+    SEND_STRING("Hello, World!");
+    run_one_scan_loop();
+    EXPECT_THAT(typed_keys(), ElementsAre(
+        TypedKey(KC_H, MOD_BIT(KC_LSFT)),
+        TypedKey(KC_E, 0),
+        TypedKey(KC_L, 0),
+        TypedKey(KC_L, 0),
+        TypedKey(KC_O, 0),
+        TypedKey(KC_COMM, 0),
+        TypedKey(KC_SPC, 0),
+        TypedKey(KC_W, MOD_BIT(KC_LSFT)),
+        TypedKey(KC_O, 0),
+        TypedKey(KC_R, 0),
+        TypedKey(KC_L, 0),
+        TypedKey(KC_D, 0),
+        TypedKey(KC_1, MOD_BIT(KC_LSFT))));
+    bench("SEND_STRING(\"Hello, World!\")");
+}
+
+TEST_F(ReportCoalescing, ModifiedKeycodeHasTheModifiersFirst) {
+    register_code16(LCTL(LSFT(KC_A)));
+    unregister_code16(LCTL(LSFT(KC_A)));
+    run_one_scan_loop();
+    EXPECT_THAT(typed_keys(), ElementsAre(
+        TypedKey(KC_A, MOD_BIT(KC_LCTL) | MOD_BIT(KC_LSFT))));
+    bench("LCTL(LSFT(KC_A)) tap");
+}
+
+TEST_F(ReportCoalescing, ModifiedKeyFromTheKeymap) {
+    press_key(9, 3);
+    run_one_scan_loop();
+    release_key(9, 3);
+    run_one_scan_loop();
+    press_key(0, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    run_one_scan_loop();
+    EXPECT_THAT(typed_keys(), ElementsAre(
+        TypedKey(KC_0, MOD_BIT(KC_LSFT)),
+        TypedKey(KC_A, 0)));
+}
+
+TEST_F(ReportCoalescing, KeyIsHeldForTheMacroWait) {
+    action_macro_play(MACRO(D(A), W(100), U(A), END));
+    run_one_scan_loop();
+    auto& reports = driver.keyboard_reports();
+    ASSERT_EQ(reports.size(), 2u);
+    EXPECT_EQ(reports[0].report, make_report({KC_A}));
+    EXPECT_EQ(reports[1].report, make_report({}));
+    EXPECT_GE(reports[1].time - reports[0].time, 100u);
+}
+
+TEST_F(ReportCoalescing, HeldKeysAreNotRepeated) {
+    press_key(0, 2);
+    run_one_scan_loop();
+    for (int i = 0; i < 3; i++) {
+        press_key(1, 0);
+        run_one_scan_loop();
+        release_key(1, 0);
+        run_one_scan_loop();
+    }
+    release_key(0, 2);
+    run_one_scan_loop();
+    EXPECT_THAT(typed_keys(), ElementsAre(
+        TypedKey(KC_B, MOD_BIT(KC_LSFT)),
+        TypedKey(KC_B, MOD_BIT(KC_LSFT)),
+        TypedKey(KC_B, MOD_BIT(KC_LSFT))));
+}
+
+TEST_F(ReportCoalescing, LongSendString) {
+    SEND_STRING("The quick brown fox jumps over the lazy dog. THE QUICK BROWN FOX!");
+    run_one_scan_loop();
+    EXPECT_EQ(typed_keys().size(), 65u);
+    bench("65 character SEND_STRING");
+}
@@ -0,0 +1,169 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <vector>
+
+extern "C" {
+#include "report.h"
+#include "report_queue.h"
+}
+
+class ReportQueue : public testing::Test {
+public:
+    ReportQueue() {
+        report_queue_init(&keys, key_buffer, 1, 4, &key_last, NULL);
+        report_queue_init(&mouse, mouse_buffer, sizeof(report_mouse_t), 4, &mouse_last,
+                          report_queue_collapse_mouse);
+    }
+
+protected:
+    std::vector<uint8_t> pop_keys() {
+        std::vector<uint8_t> result;
+        uint8_t key;
+        while (report_queue_pop(&keys, &key)) {
+            result.push_back(key);
+        }
+        return result;
+    }
+
+    std::vector<report_mouse_t> pop_mouse() {
+        std::vector<report_mouse_t> result;
+        report_mouse_t report;
+        while (report_queue_pop(&mouse, &report)) {
+            result.push_back(report);
+        }
+        return result;
+    }
+
+    bool push_key(uint8_t key) {
+        return report_queue_push(&keys, &key);
+    }
+
+    bool push_mouse(uint8_t buttons, int8_t x, int8_t y) {
+        report_mouse_t report = {};
+        report.buttons = buttons;
+        report.x = x;
+        report.y = y;
+        return report_queue_push(&mouse, &report);
+    }
+
+    report_queue_t keys;
+    uint8_t key_buffer[4];
+    uint8_t key_last;
+    report_queue_t mouse;
+    report_mouse_t mouse_buffer[4];
+    report_mouse_t mouse_last;
+};
+
+TEST_F(ReportQueue, ReportsComeOutInOrder) {
+    EXPECT_TRUE(report_queue_empty(&keys));
+    push_key(1);
+    push_key(2);
+    push_key(3);
+    EXPECT_FALSE(report_queue_empty(&keys));
+    EXPECT_EQ(pop_keys(), (std::vector<uint8_t>{1, 2, 3}));
+    EXPECT_TRUE(report_queue_empty(&keys));
+}
+
+TEST_F(ReportQueue, WrapsAround) {
+    for (uint8_t i = 1; i <= 10; i++) {
+        push_key(i);
+        push_key(i + 100);
+        EXPECT_EQ(pop_keys(), (std::vector<uint8_t>{i, (uint8_t)(i + 100)}));
+    }
+}
+
+TEST_F(ReportQueue, RepeatedStateIsDropped) {
+    push_key(1);
+    push_key(1);
+    push_key(2);
+    EXPECT_EQ(pop_keys(), (std::vector<uint8_t>{1, 2}));
+    // also when the previous one was already sent
+    push_key(2);
+    EXPECT_TRUE(report_queue_empty(&keys));
+}
+
+TEST_F(ReportQueue, FullQueueReplacesNothing) {
+    for (uint8_t i = 1; i <= 4; i++) {
+        EXPECT_TRUE(push_key(i));
+    }
+    // a press and its release, neither may take the place of the other
+    EXPECT_FALSE(push_key(5));
+    EXPECT_FALSE(push_key(4 + 2));
+    EXPECT_EQ(pop_keys(), (std::vector<uint8_t>{1, 2, 3, 4}));
+    // the refused one isn't taken for a repeat
+    EXPECT_TRUE(push_key(5));
+    EXPECT_EQ(pop_keys(), (std::vector<uint8_t>{5}));
+}
+
+TEST_F(ReportQueue, PeekShowsTheOldest) {
+    EXPECT_EQ(report_queue_peek(&keys), nullptr);
+    push_key(1);
+    push_key(2);
+    EXPECT_EQ(*(uint8_t *)report_queue_peek(&keys), 1);
+    EXPECT_TRUE(report_queue_pop(&keys, NULL));
+    EXPECT_EQ(*(uint8_t *)report_queue_peek(&keys), 2);
+}
+
+TEST_F(ReportQueue, ClearDropsEverything) {
+    push_key(1);
+    push_key(2);
+    report_queue_clear(&keys);
+    EXPECT_TRUE(report_queue_empty(&keys));
+    push_key(2);
+    EXPECT_EQ(pop_keys(), (std::vector<uint8_t>{2}));
+}
+
+TEST_F(ReportQueue, MouseMotionIsAddedUp) {
+    push_mouse(0, 10, -5);
+    push_mouse(0, 20, -5);
+    push_mouse(0, 1, 2);
+    auto reports = pop_mouse();
+    ASSERT_EQ(reports.size(), 1u);
+    EXPECT_EQ(reports[0].x, 31);
+    EXPECT_EQ(reports[0].y, -8);
+}
+
+TEST_F(ReportQueue, MouseButtonsAreNotMerged) {
+    push_mouse(0, 10, 0);
+    push_mouse(1, 0, 0);
+    push_mouse(0, 0, 0);
+    auto reports = pop_mouse();
+    ASSERT_EQ(reports.size(), 3u);
+    EXPECT_EQ(reports[0].buttons, 0);
+    EXPECT_EQ(reports[1].buttons, 1);
+    EXPECT_EQ(reports[2].buttons, 0);
+}
+
+TEST_F(ReportQueue, MouseMotionIsNotClipped) {
+    push_mouse(0, 100, 0);
+    push_mouse(0, 100, 0);
+    auto reports = pop_mouse();
+    ASSERT_EQ(reports.size(), 2u);
+    EXPECT_EQ(reports[0].x + reports[1].x, 200);
+}
+
+TEST_F(ReportQueue, MouseReportIsDroppedOnlyWhenFull) {
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(push_mouse(i & 1, 0, 0));
+    }
+    EXPECT_TRUE(push_mouse(1, 5, 0));
+    EXPECT_FALSE(push_mouse(0, 0, 0));
+    auto reports = pop_mouse();
+    ASSERT_EQ(reports.size(), 4u);
+    EXPECT_EQ(reports[3].x, 5);
+}
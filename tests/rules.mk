@@ -0,0 +1,379 @@
+# The fakes the simulated keyboard runs on
+TEST_COMMON_SRC :=\
+	$(TEST_PATH)/test_common/matrix.c \
+	$(TEST_PATH)/test_common/timer.c \
+	$(TEST_PATH)/test_common/eeprom.c \
+	$(TEST_PATH)/test_common/platform.c \
+	$(TEST_PATH)/test_common/test_driver.cpp \
+	$(TEST_PATH)/test_common/test_fixture.cpp \
+	$(TEST_PATH)/test_common/keyboard_report_util.cpp \
+	$(TEST_PATH)/test_common/matrix_trace.cpp
+
+# The real keyboard core, from the matrix to the host driver
+TEST_CORE_SRC :=\
+	$(TMK_PATH)/common/host.c \
+	$(TMK_PATH)/common/keyboard.c \
+	$(TMK_PATH)/common/action.c \
+	$(TMK_PATH)/common/action_tapping.c \
+	$(TMK_PATH)/common/action_macro.c \
+	$(TMK_PATH)/common/action_layer.c \
+	$(TMK_PATH)/common/action_util.c \
+	$(TMK_PATH)/common/debug.c \
+	$(TMK_PATH)/common/util.c \
+	$(TMK_PATH)/common/eeconfig.c \
+	$(TMK_PATH)/common/magic.c \
+	$(TMK_PATH)/common/deadline.c \
+	$(TMK_PATH)/common/scheduler.c \
+	$(QUANTUM_PATH)/quantum.c \
+	$(QUANTUM_PATH)/keymap_common.c \
+	$(QUANTUM_PATH)/keycode_config.c \
+	$(QUANTUM_PATH)/process_keycode/process_leader.c \
+	$(QUANTUM_PATH)/sequence_trie.c
+
+TEST_CORE_DEFS := -DNO_PRINT -DNO_DEBUG -DMAGIC_ENABLE
+
+basic_SRC :=\
+	$(TEST_PATH)/basic/keymap.c \
+	$(TEST_PATH)/basic/test_keypress.cpp \
+	$(TEST_COMMON_SRC) \
+	$(TEST_CORE_SRC)
+basic_DEFS := $(TEST_CORE_DEFS)
+basic_INC := $(TEST_PATH)/test_common
+basic_CONFIG := $(TEST_PATH)/test_common/config.h
+
+profile_SRC :=\
+	$(TEST_PATH)/basic/keymap.c \
+	$(TEST_PATH)/profile/test_profile.cpp \
+	$(TMK_PATH)/common/profile.c \
+	$(TEST_COMMON_SRC) \
+	$(TEST_CORE_SRC)
+profile_DEFS := $(TEST_CORE_DEFS) -DPROFILE_ENABLE -DPROFILE_PROCESS_HOOKS
+profile_INC := $(TEST_PATH)/test_common
+profile_CONFIG := $(TEST_PATH)/test_common/config.h
+
+layer_cache_SRC :=\
+	$(TEST_PATH)/layer_cache/keymap.c \
+	$(TEST_PATH)/layer_cache/test_layer_cache.cpp \
+	$(TEST_COMMON_SRC) \
+	$(TEST_CORE_SRC)
+layer_cache_DEFS := $(TEST_CORE_DEFS) -DLAYER_RESOLUTION_CACHE
+layer_cache_INC := $(TEST_PATH)/test_common
+layer_cache_CONFIG := $(TEST_PATH)/test_common/config.h
+
+# The same tests without the cache, to compare the lookup cost
+layer_cache_uncached_SRC := $(layer_cache_SRC)
+layer_cache_uncached_DEFS := $(TEST_CORE_DEFS)
+layer_cache_uncached_INC := $(layer_cache_INC)
+layer_cache_uncached_CONFIG := $(layer_cache_CONFIG)
+
+report_coalescing_SRC :=\
+	$(TEST_PATH)/basic/keymap.c \
+	$(TEST_PATH)/report_coalescing/test_report_coalescing.cpp \
+	$(TEST_COMMON_SRC) \
+	$(TEST_CORE_SRC)
+report_coalescing_DEFS := $(TEST_CORE_DEFS) -DCOALESCE_KEYBOARD_REPORTS
+report_coalescing_INC := $(TEST_PATH)/test_common
+report_coalescing_CONFIG := $(TEST_PATH)/test_common/config.h
+
+# The same tests with one report per change, to compare the report count
+report_coalescing_off_SRC := $(report_coalescing_SRC)
+report_coalescing_off_DEFS := $(TEST_CORE_DEFS)
+report_coalescing_off_INC := $(report_coalescing_INC)
+report_coalescing_off_CONFIG := $(report_coalescing_CONFIG)
+
+combo_SRC :=\
+	$(TEST_PATH)/basic/keymap.c \
+	$(TEST_PATH)/combo/test_combo.cpp \
+	$(QUANTUM_PATH)/process_keycode/process_combo.c \
+	$(TEST_COMMON_SRC) \
+	$(TEST_CORE_SRC)
+# 559 keys in the 250 combos
+combo_DEFS := $(TEST_CORE_DEFS) -DCOMBO_ENABLE -DCOMBO_COUNT=250 -DCOMBO_INDEX_SIZE=600
+combo_INC := $(TEST_PATH)/test_common
+combo_CONFIG := $(TEST_PATH)/test_common/config.h
+
+# The same tests with the linear search over all combos
+combo_linear_SRC := $(combo_SRC)
+combo_linear_DEFS := $(TEST_CORE_DEFS) -DCOMBO_ENABLE -DCOMBO_COUNT=250 -DCOMBO_INDEX_SIZE=0
+combo_linear_INC := $(combo_INC)
+combo_linear_CONFIG := $(combo_CONFIG)
+
+# And with the default index size, which is too small for them
+combo_overflow_SRC := $(combo_SRC)
+combo_overflow_DEFS := $(TEST_CORE_DEFS) -DCOMBO_ENABLE -DCOMBO_COUNT=250
+combo_overflow_INC := $(combo_INC)
+combo_overflow_CONFIG := $(combo_CONFIG)
+
+# The basic tests again, with the matrix scanned by keyboard_scan_task
+basic_scan_thread_SRC := $(basic_SRC) $(TMK_PATH)/common/key_event_queue.c
+basic_scan_thread_DEFS := $(TEST_CORE_DEFS) -DMATRIX_SCAN_THREAD
+basic_scan_thread_INC := $(basic_INC)
+basic_scan_thread_CONFIG := $(basic_CONFIG)
+
+scan_thread_SRC :=\
+	$(TEST_PATH)/basic/keymap.c \
+	$(TEST_PATH)/scan_thread/test_scan_thread.cpp \
+	$(TEST_PATH)/scan_thread/key_event_queue_tests.cpp \
+	$(TMK_PATH)/common/key_event_queue.c \
+	$(TEST_COMMON_SRC) \
+	$(TEST_CORE_SRC)
+# A small queue, to see it fill up
+scan_thread_DEFS := $(TEST_CORE_DEFS) -DMATRIX_SCAN_THREAD -DKEY_EVENT_QUEUE_SIZE=4
+scan_thread_INC := $(TEST_PATH)/test_common
+scan_thread_CONFIG := $(TEST_PATH)/test_common/config.h
+
+async_macro_SRC :=\
+	$(TEST_PATH)/basic/keymap.c \
+	$(TEST_PATH)/async_macro/test_async_macro.cpp \
+	$(TEST_COMMON_SRC) \
+	$(TEST_CORE_SRC)
+async_macro_DEFS := $(TEST_CORE_DEFS) -DASYNC_MACRO
+async_macro_INC := $(TEST_PATH)/test_common
+async_macro_CONFIG := $(TEST_PATH)/test_common/config.h
+
+# The same tests with the blocking macro player and send_string
+async_macro_blocking_SRC := $(async_macro_SRC)
+async_macro_blocking_DEFS := $(TEST_CORE_DEFS)
+async_macro_blocking_INC := $(async_macro_INC)
+async_macro_blocking_CONFIG := $(async_macro_CONFIG)
+
+UNICODE_TEST_SRC :=\
+	$(TEST_PATH)/unicode/keymap.c \
+	$(TEST_PATH)/unicode/test_unicode.cpp \
+	$(QUANTUM_PATH)/process_keycode/process_unicode_common.c \
+	$(TEST_COMMON_SRC) \
+	$(TEST_CORE_SRC)
+
+unicode_SRC :=\
+	$(UNICODE_TEST_SRC) \
+	$(QUANTUM_PATH)/process_keycode/process_unicode.c \
+	$(QUANTUM_PATH)/process_keycode/process_ucis.c
+unicode_DEFS := $(TEST_CORE_DEFS) -DUNICODE_ENABLE -DUCIS_ENABLE -DUNICODE_COMMON_ENABLE -DUNICODE_ASYNC
+unicode_INC := $(TEST_PATH)/test_common
+unicode_CONFIG := $(TEST_PATH)/test_common/config.h
+
+# The same tests typing each codepoint in one go
+unicode_blocking_SRC := $(unicode_SRC)
+unicode_blocking_DEFS := $(TEST_CORE_DEFS) -DUNICODE_ENABLE -DUCIS_ENABLE -DUNICODE_COMMON_ENABLE
+unicode_blocking_INC := $(unicode_INC)
+unicode_blocking_CONFIG := $(unicode_CONFIG)
+
+unicodemap_SRC :=\
+	$(UNICODE_TEST_SRC) \
+	$(QUANTUM_PATH)/process_keycode/process_unicodemap.c
+unicodemap_DEFS := $(TEST_CORE_DEFS) -DUNICODEMAP_ENABLE -DUNICODE_COMMON_ENABLE -DUNICODE_ASYNC
+unicodemap_INC := $(TEST_PATH)/test_common
+unicodemap_CONFIG := $(TEST_PATH)/test_common/config.h
+
+unicodemap_blocking_SRC := $(unicodemap_SRC)
+unicodemap_blocking_DEFS := $(TEST_CORE_DEFS) -DUNICODEMAP_ENABLE -DUNICODE_COMMON_ENABLE
+unicodemap_blocking_INC := $(unicodemap_INC)
+unicodemap_blocking_CONFIG := $(unicodemap_CONFIG)
+
+leader_SRC :=\
+	$(TEST_PATH)/leader/keymap.c \
+	$(TEST_PATH)/leader/test_leader.cpp \
+	$(TEST_COMMON_SRC) \
+	$(TEST_CORE_SRC)
+leader_DEFS := $(TEST_CORE_DEFS) -DLEADER_SEQUENCE_TABLE -DLEADER_MAX_LENGTH=8
+leader_INC := $(TEST_PATH)/test_common
+leader_CONFIG := $(TEST_PATH)/test_common/config.h
+
+# The same tests with the table out of order, searched linearly
+leader_unsorted_SRC := $(leader_SRC)
+leader_unsorted_DEFS := $(leader_DEFS) -DLEADER_TEST_UNSORTED
+leader_unsorted_INC := $(leader_INC)
+leader_unsorted_CONFIG := $(leader_CONFIG)
+
+sequence_trie_SRC :=\
+	$(TEST_PATH)/sequence_trie/sequence_trie_tests.cpp \
+	$(QUANTUM_PATH)/sequence_trie.c
+sequence_trie_INC := $(TEST_PATH)/test_common
+sequence_trie_CONFIG := $(TEST_PATH)/test_common/config.h
+
+deadline_SRC :=\
+	$(TEST_PATH)/deadline/keymap.c \
+	$(TEST_PATH)/deadline/deadline_tests.cpp \
+	$(TEST_PATH)/deadline/test_timeouts.cpp \
+	$(QUANTUM_PATH)/process_keycode/process_tap_dance.c \
+	$(TMK_PATH)/common/mousekey.c \
+	$(TEST_COMMON_SRC) \
+	$(TEST_CORE_SRC)
+deadline_DEFS := $(TEST_CORE_DEFS) -DTAP_DANCE_ENABLE -DONESHOT_TIMEOUT=500 -DMOUSEKEY_ENABLE
+deadline_INC := $(TEST_PATH)/test_common
+deadline_CONFIG := $(TEST_PATH)/test_common/config.h
+
+scheduler_SRC :=\
+	$(TEST_PATH)/scheduler/scheduler_tests.cpp \
+	$(TMK_PATH)/common/scheduler.c \
+	$(TEST_PATH)/test_common/timer.c
+scheduler_DEFS := -DNO_PRINT -DNO_DEBUG
+scheduler_INC := $(TEST_PATH)/test_common
+scheduler_CONFIG := $(TEST_PATH)/test_common/config.h
+
+trace_SRC :=\
+	$(TEST_PATH)/basic/keymap.c \
+	$(TEST_PATH)/trace/test_trace.cpp \
+	$(TMK_PATH)/common/trace.c \
+	$(TEST_COMMON_SRC) \
+	$(TEST_CORE_SRC)
+trace_DEFS := $(TEST_CORE_DEFS) -DTRACE_ENABLE -DRAW_ENABLE
+trace_INC := $(TEST_PATH)/test_common
+trace_CONFIG := $(TEST_PATH)/test_common/config.h
+
+TAPPING_TEST_SRC :=\
+	$(TEST_PATH)/basic/keymap.c \
+	$(TEST_PATH)/tapping/test_tapping.cpp \
+	$(TEST_COMMON_SRC) \
+	$(TEST_CORE_SRC)
+
+tapping_SRC := $(TAPPING_TEST_SRC)
+tapping_DEFS := $(TEST_CORE_DEFS)
+tapping_INC := $(TEST_PATH)/test_common
+tapping_CONFIG := $(TEST_PATH)/test_common/config.h
+
+tapping_permissive_hold_SRC := $(TAPPING_TEST_SRC)
+tapping_permissive_hold_DEFS := $(TEST_CORE_DEFS) -DPERMISSIVE_HOLD
+tapping_permissive_hold_INC := $(TEST_PATH)/test_common
+tapping_permissive_hold_CONFIG := $(TEST_PATH)/test_common/config.h
+
+tapping_hold_on_other_key_SRC := $(TAPPING_TEST_SRC)
+tapping_hold_on_other_key_DEFS := $(TEST_CORE_DEFS) -DHOLD_ON_OTHER_KEY_PRESS
+tapping_hold_on_other_key_INC := $(TEST_PATH)/test_common
+tapping_hold_on_other_key_CONFIG := $(TEST_PATH)/test_common/config.h
+
+process_hooks_SRC :=\
+	$(TEST_PATH)/process_hooks/keymap.c \
+	$(TEST_PATH)/process_hooks/test_process_hooks.cpp \
+	$(QUANTUM_PATH)/process_keycode/process_tap_dance.c \
+	$(QUANTUM_PATH)/process_keycode/process_combo.c \
+	$(QUANTUM_PATH)/process_keycode/process_unicode_common.c \
+	$(QUANTUM_PATH)/process_keycode/process_unicode.c \
+	$(QUANTUM_PATH)/process_keycode/process_ucis.c \
+	$(TEST_COMMON_SRC) \
+	$(TEST_CORE_SRC)
+process_hooks_DEFS := $(TEST_CORE_DEFS) -DTAP_DANCE_ENABLE -DCOMBO_ENABLE -DCOMBO_COUNT=1 \
+	-DUNICODE_ENABLE -DUCIS_ENABLE -DUNICODE_COMMON_ENABLE
+process_hooks_INC := $(TEST_PATH)/test_common
+process_hooks_CONFIG := $(TEST_PATH)/test_common/config.h
+
+# util/compile_keymap.py against the keymap lookups it replaces, on a keymap
+# with every kind of keycode, on test keymaps and on an in-tree keyboard
+KEYMAP_COMPILER_SRC :=\
+	$(TEST_PATH)/keymap_compiler/test_keymap_compiler.cpp \
+	$(TEST_COMMON_SRC) \
+	$(TEST_CORE_SRC)
+
+keymap_compiler_SRC := $(TEST_PATH)/keymap_compiler/keymap.c $(KEYMAP_COMPILER_SRC)
+keymap_compiler_DEFS := $(TEST_CORE_DEFS) -DCOMPILED_KEYMAP
+keymap_compiler_INC := $(TEST_PATH)/test_common
+keymap_compiler_CONFIG := $(TEST_PATH)/test_common/config.h
+
+keymap_compiler_basic_SRC := $(TEST_PATH)/basic/keymap.c $(KEYMAP_COMPILER_SRC)
+keymap_compiler_basic_DEFS := $(keymap_compiler_DEFS)
+keymap_compiler_basic_INC := $(keymap_compiler_INC)
+keymap_compiler_basic_CONFIG := $(keymap_compiler_CONFIG)
+
+keymap_compiler_leader_SRC := $(TEST_PATH)/leader/keymap.c $(KEYMAP_COMPILER_SRC)
+keymap_compiler_leader_DEFS := $(leader_DEFS) -DCOMPILED_KEYMAP
+keymap_compiler_leader_INC := $(keymap_compiler_INC)
+keymap_compiler_leader_CONFIG := $(keymap_compiler_CONFIG)
+
+keymap_compiler_planck_SRC := $(TOP_DIR)/keyboards/planck/keymaps/default/keymap.c $(KEYMAP_COMPILER_SRC)
+keymap_compiler_planck_DEFS := $(keymap_compiler_DEFS)
+keymap_compiler_planck_INC := $(TEST_PATH)/test_common $(TOP_DIR)/keyboards/planck
+keymap_compiler_planck_CONFIG := $(TOP_DIR)/keyboards/planck/config.h
+
+dynamic_keymap_SRC :=\
+	$(TEST_PATH)/basic/keymap.c \
+	$(TEST_PATH)/dynamic_keymap/test_dynamic_keymap.cpp \
+	$(QUANTUM_PATH)/dynamic_keymap.c \
+	$(TEST_COMMON_SRC) \
+	$(TEST_CORE_SRC)
+dynamic_keymap_DEFS := $(TEST_CORE_DEFS) -DDYNAMIC_KEYMAP_ENABLE -DDYNAMIC_KEYMAP_LAYER_COUNT=2 -DLAYER_RESOLUTION_CACHE
+dynamic_keymap_INC := $(TEST_PATH)/test_common
+dynamic_keymap_CONFIG := $(TEST_PATH)/test_common/config.h
+
+# The same tests reading every keycode from EEPROM
+dynamic_keymap_uncached_SRC := $(dynamic_keymap_SRC)
+dynamic_keymap_uncached_DEFS := $(dynamic_keymap_DEFS) -DDYNAMIC_KEYMAP_CACHED_LAYERS=0
+dynamic_keymap_uncached_INC := $(dynamic_keymap_INC)
+dynamic_keymap_uncached_CONFIG := $(dynamic_keymap_CONFIG)
+
+eeconfig_SRC :=\
+	$(TEST_PATH)/basic/keymap.c \
+	$(TEST_PATH)/eeconfig/test_eeconfig.cpp \
+	$(TEST_COMMON_SRC) \
+	$(TEST_CORE_SRC)
+eeconfig_DEFS := $(TEST_CORE_DEFS) -DEECONFIG_WRITE_DELAY=500
+eeconfig_INC := $(TEST_PATH)/test_common
+eeconfig_CONFIG := $(TEST_PATH)/test_common/config.h
+
+# The same tests writing every change right away
+eeconfig_immediate_SRC := $(eeconfig_SRC)
+eeconfig_immediate_DEFS := $(TEST_CORE_DEFS)
+eeconfig_immediate_INC := $(eeconfig_INC)
+eeconfig_immediate_CONFIG := $(eeconfig_CONFIG)
+
+keyboard_task_SRC :=\
+	$(TEST_PATH)/keyboard_task/keyboard_task_tests.cpp \
+	$(TEST_PATH)/test_common/matrix.c \
+	$(TEST_PATH)/test_common/timer.c \
+	$(TMK_PATH)/common/keyboard.c \
+	$(TMK_PATH)/common/deadline.c \
+	$(TMK_PATH)/common/scheduler.c \
+	$(TMK_PATH)/common/debug.c
+keyboard_task_DEFS := -DNO_PRINT -DNO_DEBUG
+keyboard_task_INC := $(TEST_PATH)/test_common
+keyboard_task_CONFIG := $(TEST_PATH)/test_common/config.h
+
+keyboard_task_batched_SRC := $(keyboard_task_SRC)
+# Process every key of the 4x10 test matrix in a single scan
+keyboard_task_batched_DEFS := $(keyboard_task_DEFS) -DQMK_KEYS_PER_SCAN=40
+keyboard_task_batched_INC := $(keyboard_task_INC)
+keyboard_task_batched_CONFIG := $(keyboard_task_CONFIG)
+
+report_queue_SRC :=\
+	$(TEST_PATH)/report_queue/report_queue_tests.cpp \
+	$(TMK_PATH)/common/report_queue.c
+report_queue_INC := $(TEST_PATH)/test_common
+report_queue_CONFIG := $(TEST_PATH)/test_common/config.h
+
+sof_sync_SRC :=\
+	$(TEST_PATH)/sof_sync/sof_sync_tests.cpp \
+	$(TMK_PATH)/common/sof_sync.c
+sof_sync_DEFS := -DNO_PRINT -DNO_DEBUG
+sof_sync_INC := $(TEST_PATH)/test_common
+sof_sync_CONFIG := $(TEST_PATH)/test_common/config.h
+
+DEBOUNCE_TEST_SRC :=\
+	$(TEST_PATH)/debounce/debounce_test_common.cpp \
+	$(TEST_PATH)/test_common/timer.c
+
+debounce_sym_g_SRC :=\
+	$(TEST_PATH)/debounce/debounce_sym_g_tests.cpp \
+	$(QUANTUM_PATH)/debounce/sym_g.c \
+	$(DEBOUNCE_TEST_SRC)
+debounce_sym_g_INC := $(TEST_PATH)/test_common
+debounce_sym_g_CONFIG := $(TEST_PATH)/test_common/config.h
+
+debounce_sym_pk_SRC :=\
+	$(TEST_PATH)/debounce/debounce_sym_pk_tests.cpp \
+	$(QUANTUM_PATH)/debounce/sym_pk.c \
+	$(DEBOUNCE_TEST_SRC)
+debounce_sym_pk_INC := $(TEST_PATH)/test_common
+debounce_sym_pk_CONFIG := $(TEST_PATH)/test_common/config.h
+
+debounce_eager_pk_SRC :=\
+	$(TEST_PATH)/debounce/debounce_eager_pk_tests.cpp \
+	$(QUANTUM_PATH)/debounce/eager_pk.c \
+	$(DEBOUNCE_TEST_SRC)
+debounce_eager_pk_INC := $(TEST_PATH)/test_common
+debounce_eager_pk_CONFIG := $(TEST_PATH)/test_common/config.h
+
+debounce_eager_pr_SRC :=\
+	$(TEST_PATH)/debounce/debounce_eager_pr_tests.cpp \
+	$(QUANTUM_PATH)/debounce/eager_pr.c \
+	$(DEBOUNCE_TEST_SRC)
+debounce_eager_pr_INC := $(TEST_PATH)/test_common
+debounce_eager_pr_CONFIG := $(TEST_PATH)/test_common/config.h
@@ -0,0 +1,101 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <thread>
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "key_event_queue.h"
+}
+
+static keyevent_t make_event(uint8_t row, uint8_t col, uint16_t time) {
+    keyevent_t event = {};
+    event.key.row = row;
+    event.key.col = col;
+    event.pressed = true;
+    event.time = time;
+    return event;
+}
+
+class KeyEventQueue : public testing::Test {
+public:
+    KeyEventQueue() {
+        key_event_queue_init(&queue);
+    }
+
+protected:
+    key_event_queue_t queue;
+};
+
+TEST_F(KeyEventQueue, EventsComeOutInOrder) {
+    keyevent_t event;
+    EXPECT_FALSE(key_event_queue_pop(&queue, &event));
+    EXPECT_TRUE(key_event_queue_push(&queue, make_event(1, 2, 10)));
+    EXPECT_TRUE(key_event_queue_push(&queue, make_event(3, 4, 20)));
+    ASSERT_TRUE(key_event_queue_pop(&queue, &event));
+    EXPECT_EQ(event.key.row, 1);
+    EXPECT_EQ(event.key.col, 2);
+    EXPECT_EQ(event.time, 10);
+    ASSERT_TRUE(key_event_queue_pop(&queue, &event));
+    EXPECT_EQ(event.time, 20);
+    EXPECT_FALSE(key_event_queue_pop(&queue, &event));
+}
+
+TEST_F(KeyEventQueue, FullQueueRefusesEvents) {
+    for (uint16_t i = 1; i <= KEY_EVENT_QUEUE_SIZE; i++) {
+        EXPECT_TRUE(key_event_queue_push(&queue, make_event(0, 0, i)));
+    }
+    EXPECT_FALSE(key_event_queue_push(&queue, make_event(0, 0, 100)));
+    keyevent_t event;
+    ASSERT_TRUE(key_event_queue_pop(&queue, &event));
+    EXPECT_EQ(event.time, 1);
+    EXPECT_TRUE(key_event_queue_push(&queue, make_event(0, 0, 100)));
+}
+
+TEST_F(KeyEventQueue, IndicesWrapAround) {
+    keyevent_t event;
+    for (uint16_t i = 1; i < 1000; i++) {
+        ASSERT_TRUE(key_event_queue_push(&queue, make_event(0, 0, i)));
+        ASSERT_TRUE(key_event_queue_pop(&queue, &event));
+        EXPECT_EQ(event.time, i);
+    }
+}
+
+TEST_F(KeyEventQueue, ProducerAndConsumerThreads) {
+    const uint16_t count = 20000;
+    std::thread producer([&]() {
+        for (uint16_t i = 1; i <= count;) {
+            if (key_event_queue_push(&queue, make_event(i & 0xFF, i >> 8, i))) {
+                i++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    uint16_t expected = 1;
+    keyevent_t event;
+    while (expected <= count) {
+        if (!key_event_queue_pop(&queue, &event)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(event.time, expected);
+        ASSERT_EQ(event.key.row, expected & 0xFF);
+        ASSERT_EQ(event.key.col, expected >> 8);
+        expected++;
+    }
+    producer.join();
+}
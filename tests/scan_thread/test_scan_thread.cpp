@@ -0,0 +1,131 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_fixture.h"
+#include "keyboard_report_util.h"
+
+extern "C" {
+#include "keyboard.h"
+#include "key_event_queue.h"
+#include "keycode.h"
+#include "action.h"
+#include "action_tapping.h"
+#include "test_matrix.h"
+#include "test_timer.h"
+}
+
+static uint32_t scan_user_calls = 0;
+
+extern "C" void matrix_scan_user(void) {
+    scan_user_calls++;
+}
+
+class ScanThread : public TestFixture {
+protected:
+    /* The scan thread keeps scanning while keyboard_task is busy */
+    void busy_for(uint32_t ms) {
+        for (uint32_t i = 0; i < ms; i++) {
+            keyboard_scan_task();
+            advance_time(1);
+        }
+    }
+
+    std::vector<std::vector<uint8_t>> sent_keys() {
+        std::vector<std::vector<uint8_t>> result;
+        for (auto& r : driver.keyboard_reports()) {
+            result.push_back(get_keys(r.report));
+        }
+        return result;
+    }
+};
+
+TEST_F(ScanThread, KeysAreStampedWhenTheyAreFound) {
+    // SFT_T(KC_U) held longer than the tapping term, while keyboard_task is
+    // busy for even longer. Stamped at dispatch it would look like a tap.
+    press_key(2, 2);
+    busy_for(TAPPING_TERM + 50);
+    release_key(2, 2);
+    busy_for(100);
+    EXPECT_TRUE(driver.keyboard_reports().empty());
+    idle_for(10);
+    EXPECT_EQ(sent_keys(), (std::vector<std::vector<uint8_t>>{
+        {KC_LSFT},
+        {}}));
+}
+
+TEST_F(ScanThread, TapIsStillATap) {
+    press_key(2, 2);
+    busy_for(50);
+    release_key(2, 2);
+    busy_for(TAPPING_TERM + 100);
+    idle_for(10);
+    EXPECT_EQ(sent_keys(), (std::vector<std::vector<uint8_t>>{
+        {KC_U},
+        {}}));
+}
+
+TEST_F(ScanThread, EventsAreKeptInOrder) {
+    press_key(0, 0);
+    busy_for(1);
+    press_key(1, 0);
+    busy_for(1);
+    release_key(0, 0);
+    busy_for(1);
+    release_key(1, 0);
+    busy_for(1);
+    idle_for(10);
+    EXPECT_EQ(sent_keys(), (std::vector<std::vector<uint8_t>>{
+        {KC_A},
+        {KC_A, KC_B},
+        {KC_B},
+        {}}));
+}
+
+TEST_F(ScanThread, FullQueueDelaysTheRestOfTheChanges) {
+    // More changes than the queue holds, in a single scan
+    static_assert(KEY_EVENT_QUEUE_SIZE == 4, "the test queue holds 4 events");
+    for (uint8_t c = 0; c < 5; c++) {
+        press_key(c, 0);
+    }
+    busy_for(2);
+    idle_for(10);
+    EXPECT_EQ(sent_keys(), (std::vector<std::vector<uint8_t>>{
+        {KC_A},
+        {KC_A, KC_B},
+        {KC_A, KC_B, KC_C},
+        {KC_A, KC_B, KC_C, KC_D},
+        {KC_A, KC_B, KC_C, KC_D, KC_E}}));
+}
+
+TEST_F(ScanThread, ScanHooksRunOnTheMainLoop) {
+    scan_user_calls = 0;
+    busy_for(10);
+    EXPECT_EQ(scan_user_calls, 0u);
+    run_one_scan_loop();
+    EXPECT_EQ(scan_user_calls, 1u);
+}
+
+TEST_F(ScanThread, MainLoopIsIdleUntilAKeyChanges) {
+    run_one_scan_loop();
+    EXPECT_EQ(keyboard_idle_time(), UINT32_MAX);
+    press_key(0, 0);
+    EXPECT_EQ(keyboard_scan_task(), 1);
+    EXPECT_EQ(keyboard_idle_time(), 0u);
+    keyboard_task();
+    EXPECT_EQ(keyboard_idle_time(), UINT32_MAX);
+    release_key(0, 0);
+    run_one_scan_loop();
+}
@@ -0,0 +1,211 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <vector>
+
+extern "C" {
+#include "scheduler.h"
+#include "timer.h"
+#include "wait.h"
+#include "test_timer.h"
+}
+
+static std::vector<char> ran;
+static uint32_t slow_us = 0;
+
+static void task_a(void) { ran.push_back('a'); }
+static void task_b(void) { ran.push_back('b'); }
+static void task_c(void) { ran.push_back('c'); }
+static void task_slow(void) {
+    ran.push_back('s');
+    wait_us(slow_us);
+}
+#ifdef BENCHMARK
+static void task_nothing(void) {}
+#endif
+
+class Scheduler : public testing::Test {
+public:
+    Scheduler() {
+        set_time(0);
+        ran.clear();
+        slow_us = 0;
+    }
+
+    ~Scheduler() {
+        for (auto& task : tasks) {
+            scheduler_remove(&task);
+        }
+    }
+
+    // kept by the fixture, so that they outlive the test
+    scheduled_task_t& add(void (*run)(void), uint16_t period, task_priority_t priority) {
+        tasks.push_back(SCHEDULED_TASK(run, period, priority));
+        scheduler_add(&tasks.back());
+        return tasks.back();
+    }
+
+    // one keyboard_task loop, then the rest of the millisecond
+    void loop() {
+        scheduler_run(timer_read_us32());
+        advance_time(1);
+    }
+
+    std::deque<scheduled_task_t> tasks;
+};
+
+TEST_F(Scheduler, RunsByPriorityThenInTheOrderAdded) {
+    add(task_a, 0, TASK_PRIORITY_LOW);
+    add(task_b, 0, TASK_PRIORITY_HIGH);
+    add(task_c, 0, TASK_PRIORITY_NORMAL);
+    add(task_a, 0, TASK_PRIORITY_HIGH);
+    loop();
+    std::vector<char> expected = {'b', 'a', 'c', 'a'};
+    EXPECT_EQ(ran, expected);
+}
+
+TEST_F(Scheduler, AddingAgainDoesNothing) {
+    scheduled_task_t& task = add(task_a, 0, TASK_PRIORITY_NORMAL);
+    scheduler_add(&task);
+    loop();
+    EXPECT_EQ(ran.size(), 1u);
+}
+
+TEST_F(Scheduler, RemovedTaskDoesNotRun) {
+    scheduled_task_t& a = add(task_a, 0, TASK_PRIORITY_NORMAL);
+    add(task_b, 0, TASK_PRIORITY_NORMAL);
+    scheduler_remove(&a);
+    loop();
+    std::vector<char> expected = {'b'};
+    EXPECT_EQ(ran, expected);
+}
+
+TEST_F(Scheduler, PeriodicTaskRunsOncePerPeriod) {
+    scheduled_task_t& every = add(task_a, 0, TASK_PRIORITY_NORMAL);
+    scheduled_task_t& periodic = add(task_b, 10, TASK_PRIORITY_NORMAL);
+    for (int i = 0; i < 30; i++) {
+        loop();
+    }
+    EXPECT_EQ(every.runs, 30u);
+    EXPECT_EQ(periodic.runs, 3u);
+}
+
+TEST_F(Scheduler, LowPriorityIsShedWhenTheLoopIsOverBudget) {
+    add(task_slow, 0, TASK_PRIORITY_HIGH);
+    add(task_a, 0, TASK_PRIORITY_HIGH);
+    scheduled_task_t& normal = add(task_b, 0, TASK_PRIORITY_NORMAL);
+    scheduled_task_t& low = add(task_c, 20, TASK_PRIORITY_LOW);
+
+    slow_us = SCHEDULER_BUDGET_US;
+    loop();
+    std::vector<char> expected = {'s', 'a'};
+    EXPECT_EQ(ran, expected);
+    EXPECT_EQ(normal.shed, 1u);
+    EXPECT_EQ(low.shed, 1u);
+
+    // the shed periodic task is still due
+    slow_us = 0;
+    ran.clear();
+    loop();
+    expected = {'s', 'a', 'b', 'c'};
+    EXPECT_EQ(ran, expected);
+}
+
+TEST_F(Scheduler, OnlyTheTasksThatDontFitAreShed) {
+    scheduled_task_t& normal = add(task_a, 0, TASK_PRIORITY_NORMAL);
+    add(task_slow, 0, TASK_PRIORITY_NORMAL);
+    scheduled_task_t& low = add(task_c, 0, TASK_PRIORITY_LOW);
+    slow_us = SCHEDULER_BUDGET_US * 3 / 4;
+    // a scan that took most of the budget
+    uint32_t loop_start = timer_read_us32();
+    wait_us(SCHEDULER_BUDGET_US / 4);
+    scheduler_run(loop_start);
+    std::vector<char> expected = {'a', 's'};
+    EXPECT_EQ(ran, expected);
+    EXPECT_EQ(low.shed, 1u);
+    EXPECT_EQ(normal.shed, 0u);
+}
+
+TEST_F(Scheduler, TasksShedTooOftenRunAnyway) {
+    add(task_slow, 0, TASK_PRIORITY_HIGH);
+    scheduled_task_t& normal = add(task_b, 0, TASK_PRIORITY_NORMAL);
+    scheduled_task_t& low = add(task_c, 0, TASK_PRIORITY_LOW);
+    // every loop over budget
+    slow_us = SCHEDULER_BUDGET_US * 2;
+    for (int i = 0; i < SCHEDULER_MAX_SHED; i++) {
+        loop();
+    }
+    EXPECT_EQ(normal.runs, 0u);
+    EXPECT_EQ(low.runs, 0u);
+    loop();
+    EXPECT_EQ(normal.runs, 1u);
+    EXPECT_EQ(low.runs, 1u);
+    EXPECT_EQ(normal.shed, (uint16_t)SCHEDULER_MAX_SHED);
+    // and are shed again from there
+    loop();
+    EXPECT_EQ(normal.runs, 1u);
+    EXPECT_EQ(normal.shed_in_a_row, 1u);
+}
+
+TEST_F(Scheduler, KeepsTheRuntimeOfEachTask) {
+    scheduled_task_t& slow = add(task_slow, 0, TASK_PRIORITY_HIGH);
+    slow_us = 100;
+    loop();
+    slow_us = 300;
+    loop();
+    EXPECT_EQ(slow.runs, 2u);
+    EXPECT_EQ(slow.total_us, 400u);
+    EXPECT_EQ(slow.max_us, 300u);
+    scheduler_reset_stats();
+    EXPECT_EQ(slow.runs, 0u);
+    EXPECT_EQ(slow.max_us, 0u);
+}
+
+#ifdef BENCHMARK
+TEST_F(Scheduler, Benchmark) {
+    const int num_tasks = 8;
+    const int rounds = 100000;
+
+    auto time_loop = [&]() {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++) {
+            scheduler_run(timer_read_us32());
+            wait_us(100);
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / rounds;
+    };
+
+    for (int i = 0; i < num_tasks; i++) {
+        add(task_nothing, 0, TASK_PRIORITY_NORMAL);
+    }
+    double every_loop = time_loop();
+    for (auto& task : tasks) {
+        scheduler_remove(&task);
+    }
+    for (int i = 0; i < num_tasks; i++) {
+        add(task_nothing, 50, TASK_PRIORITY_LOW);
+    }
+    double periodic_loop = time_loop();
+
+    std::cout << "[ BENCH    ] " << num_tasks << " tasks: " << every_loop << " ns per loop running all, "
+        << periodic_loop << " ns per loop with a 50 ms period" << std::endl;
+}
+#endif
@@ -0,0 +1,188 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+extern "C" {
+#include "sequence_trie.h"
+}
+
+typedef std::vector<uint16_t> Sequence;
+
+static std::vector<Sequence>* table;
+static uint32_t key_reads;
+
+static uint16_t table_key(uint16_t index, uint8_t depth) {
+    key_reads++;
+    const Sequence& sequence = (*table)[index];
+    return depth < sequence.size() ? sequence[depth] : 0;
+}
+
+class SequenceTrie : public testing::Test {
+protected:
+    void use(const std::vector<Sequence>& entries) {
+        sequences = entries;
+        table = &sequences;
+        trie.key = table_key;
+        trie.size = sequences.size();
+        seq_cursor_init(&trie, &cursor);
+    }
+
+    bool type(std::initializer_list<uint16_t> keys) {
+        bool result = true;
+        for (uint16_t key : keys) {
+            result = seq_cursor_next(&trie, &cursor, key);
+        }
+        return result;
+    }
+
+    /* the entry that is all of keys, by searching the table from the start */
+    uint16_t find_linear(const Sequence& keys) {
+        for (uint16_t i = 0; i < trie.size; i++) {
+            uint8_t depth = 0;
+            while (depth < keys.size() && trie.key(i, depth) == keys[depth]) depth++;
+            if (depth == keys.size() && !trie.key(i, depth)) return i;
+        }
+        return SEQ_NO_MATCH;
+    }
+
+    std::vector<Sequence> sequences;
+    seq_trie_t trie;
+    seq_cursor_t cursor;
+};
+
+TEST_F(SequenceTrie, SortedTables) {
+    use({{1}, {1, 2}, {1, 2, 3}, {1, 3}, {2}});
+    EXPECT_TRUE(seq_trie_sorted(&trie));
+    use({{1}, {1}, {2}});
+    EXPECT_TRUE(seq_trie_sorted(&trie));
+    use({});
+    EXPECT_TRUE(seq_trie_sorted(&trie));
+    // a sequence goes before the ones it starts
+    use({{1, 2}, {1}});
+    EXPECT_FALSE(seq_trie_sorted(&trie));
+    use({{1, 3}, {1, 2, 3}});
+    EXPECT_FALSE(seq_trie_sorted(&trie));
+}
+
+TEST_F(SequenceTrie, EachKeyNarrowsTheRange) {
+    use({{1}, {1, 2}, {1, 2, 3}, {1, 3}, {2}});
+    EXPECT_TRUE(type({1}));
+    EXPECT_EQ(cursor.lo, 0);
+    EXPECT_EQ(cursor.hi, 4);
+    EXPECT_EQ(seq_cursor_match(&trie, &cursor), 0);
+    EXPECT_FALSE(seq_cursor_complete(&trie, &cursor));
+    EXPECT_TRUE(type({2}));
+    EXPECT_EQ(cursor.lo, 1);
+    EXPECT_EQ(cursor.hi, 3);
+    EXPECT_EQ(seq_cursor_match(&trie, &cursor), 1);
+    EXPECT_TRUE(type({3}));
+    EXPECT_EQ(seq_cursor_match(&trie, &cursor), 2);
+    EXPECT_TRUE(seq_cursor_complete(&trie, &cursor));
+}
+
+TEST_F(SequenceTrie, PrefixWithoutAnEntry) {
+    use({{1, 2}, {1, 3}});
+    EXPECT_TRUE(type({1}));
+    EXPECT_EQ(seq_cursor_match(&trie, &cursor), SEQ_NO_MATCH);
+    EXPECT_FALSE(seq_cursor_complete(&trie, &cursor));
+}
+
+TEST_F(SequenceTrie, NoEntryLeft) {
+    use({{1, 2}, {3}});
+    EXPECT_FALSE(type({2}));
+    EXPECT_EQ(seq_cursor_match(&trie, &cursor), SEQ_NO_MATCH);
+    // and it stays that way
+    EXPECT_FALSE(type({3}));
+    EXPECT_EQ(seq_cursor_match(&trie, &cursor), SEQ_NO_MATCH);
+}
+
+TEST_F(SequenceTrie, LongerThanAnyEntry) {
+    use({{1, 2}});
+    EXPECT_FALSE(type({1, 2, 2}));
+}
+
+TEST_F(SequenceTrie, DuplicateEntriesMatchTheFirst) {
+    use({{1}, {1}, {2}});
+    EXPECT_TRUE(type({1}));
+    EXPECT_EQ(seq_cursor_match(&trie, &cursor), 0);
+    EXPECT_FALSE(seq_cursor_complete(&trie, &cursor));
+}
+
+TEST_F(SequenceTrie, EmptyTable) {
+    use({});
+    EXPECT_FALSE(type({1}));
+}
+
+TEST_F(SequenceTrie, LargeTable) {
+    // every sequence of 1 to 6 keys out of 26, 4096 of them, sorted
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> length(1, 6);
+    std::uniform_int_distribution<uint16_t> key(4, 29);
+    std::vector<Sequence> entries;
+    while (entries.size() < 4096) {
+        Sequence sequence(length(random));
+        for (auto& k : sequence) k = key(random);
+        if (std::find(entries.begin(), entries.end(), sequence) == entries.end()) {
+            entries.push_back(sequence);
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+    use(entries);
+    ASSERT_TRUE(seq_trie_sorted(&trie));
+
+    std::vector<Sequence> lookups = entries;
+    std::shuffle(lookups.begin(), lookups.end(), random);
+    uint32_t keys_typed = 0;
+
+    key_reads = 0;
+#ifdef BENCHMARK
+    auto start = std::chrono::steady_clock::now();
+#endif
+    for (auto& sequence : lookups) {
+        seq_cursor_init(&trie, &cursor);
+        for (uint16_t k : sequence) {
+            seq_cursor_next(&trie, &cursor, k);
+        }
+        keys_typed += sequence.size();
+        ASSERT_EQ(sequences[seq_cursor_match(&trie, &cursor)], sequence);
+    }
+    const double trie_reads = (double)key_reads / keys_typed;
+    // a key only searches the children of one node, so it doesn't grow with the table
+    EXPECT_LE(trie_reads, 26);
+#ifdef BENCHMARK
+    auto end = std::chrono::steady_clock::now();
+    const double trie_ns = std::chrono::duration<double, std::nano>(end - start).count() / keys_typed;
+
+    key_reads = 0;
+    start = std::chrono::steady_clock::now();
+    for (auto& sequence : lookups) {
+        ASSERT_EQ(sequences[find_linear(sequence)], sequence);
+    }
+    end = std::chrono::steady_clock::now();
+    const double linear_ns = std::chrono::duration<double, std::nano>(end - start).count() / lookups.size();
+    const double linear_reads = (double)key_reads / lookups.size();
+
+    std::cout << "[ BENCH    ] " << entries.size() << " sequences: trie " << trie_ns << " ns and "
+        << trie_reads << " key reads per key typed, linear search " << linear_ns << " ns and "
+        << linear_reads << " key reads per sequence" << std::endl;
+#endif
+}
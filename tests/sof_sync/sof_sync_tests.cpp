@@ -0,0 +1,230 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+extern "C" {
+#include "sof_sync.h"
+}
+
+/* A model of the USB host and the keyboard main loop, in microseconds.
+ *
+ * The host starts a frame every frame_us and polls the endpoint poll_us
+ * after the SOF. The keyboard loop takes loop_us when it doesn't scan; a
+ * scan samples the keys when it starts and submits the report when it ends,
+ * scan_us later. A report goes to the host with the first poll after it was
+ * submitted.
+ */
+class SofModel {
+public:
+    uint32_t frame_us = 1000;
+    uint32_t poll_us = 10;
+    uint32_t loop_us = 10;
+    uint32_t scan_us = 300;
+    uint32_t event_interval_us = 777;
+    bool sof = true;
+    bool sync = true;
+
+    uint32_t scans = 0;
+    std::vector<uint32_t> latencies;
+
+    void run_frames(uint32_t frames) {
+        uint32_t end = now + frames * frame_us;
+        while (now < end) {
+            deliver_sofs(now);
+            if (sync && !sof_sync_scan_due(now)) {
+                now += loop_us;
+                continue;
+            }
+            scan();
+        }
+    }
+
+    uint32_t max_latency() const {
+        return *std::max_element(latencies.begin(), latencies.end());
+    }
+
+    uint32_t average_latency() const {
+        uint64_t sum = 0;
+        for (auto l : latencies) sum += l;
+        return sum / latencies.size();
+    }
+
+private:
+    void deliver_sofs(uint32_t t) {
+        while (next_sof <= t) {
+            if (sof && sync) sof_sync_frame(next_sof);
+            last_sof = next_sof;
+            next_sof += frame_us;
+        }
+    }
+
+    void scan() {
+        uint32_t start = now;
+        if (sync) sof_sync_scan_start(start);
+        scans++;
+        std::vector<uint32_t> sampled;
+        while (next_event <= start) {
+            sampled.push_back(next_event);
+            next_event += event_interval_us;
+        }
+        now += scan_us;
+        deliver_sofs(now);
+        if (sync) sof_sync_scan_end(now);
+
+        uint32_t poll = last_sof + poll_us;
+        if (poll < now) poll += frame_us;
+        for (auto event : sampled) {
+            latencies.push_back(poll - event);
+        }
+    }
+
+    uint32_t now = 5;
+    uint32_t next_sof = 0;
+    uint32_t last_sof = 0;
+    uint32_t next_event = 0;
+};
+
+class SofSync : public testing::Test {
+public:
+    SofSync() {
+        sof_sync_init();
+    }
+};
+
+TEST_F(SofSync, ScansOncePerFrame) {
+    SofModel model;
+    model.run_frames(100);
+    EXPECT_NEAR(model.scans, 100, 2);
+}
+
+TEST_F(SofSync, ReportsAreSubmittedBeforeTheNextFrame) {
+    SofModel model;
+    model.run_frames(20);
+    sof_sync_reset_stats();
+    model.run_frames(1000);
+    const sof_sync_stats_t *stats = sof_sync_get_stats();
+    EXPECT_NEAR(stats->scans, 1000, 2);
+    EXPECT_EQ(stats->late, 0);
+    EXPECT_EQ(stats->scan_us, model.scan_us);
+    // The scan starts within one loop iteration of its phase
+    EXPECT_GE(stats->margin_min, SOF_SYNC_GUARD_US - model.loop_us);
+    EXPECT_LE(stats->margin_min, SOF_SYNC_GUARD_US);
+}
+
+TEST_F(SofSync, LatencyIsBoundedByOneFrame) {
+    SofModel model;
+    model.run_frames(20);
+    model.latencies.clear();
+    model.run_frames(1000);
+    EXPECT_LE(model.max_latency(),
+              model.frame_us + model.scan_us + SOF_SYNC_GUARD_US + model.loop_us + model.poll_us);
+}
+
+TEST_F(SofSync, PhaseFollowsLongerScans) {
+    SofModel model;
+    model.scan_us = 100;
+    model.run_frames(20);
+    model.scan_us = 600;
+    model.run_frames(2);
+    sof_sync_reset_stats();
+    model.run_frames(100);
+    EXPECT_EQ(sof_sync_get_stats()->late, 0);
+    EXPECT_EQ(sof_sync_get_stats()->scan_us, 600);
+}
+
+TEST_F(SofSync, ScanEstimateDecaysAfterASlowScan) {
+    SofModel model;
+    model.scan_us = 800;
+    model.run_frames(5);
+    model.scan_us = 200;
+    model.run_frames(200);
+    EXPECT_LT(sof_sync_get_stats()->scan_us, 250);
+    sof_sync_reset_stats();
+    model.run_frames(100);
+    EXPECT_EQ(sof_sync_get_stats()->late, 0);
+}
+
+TEST_F(SofSync, FollowsTheHostFrameClock) {
+    SofModel model;
+    model.frame_us = 990;
+    model.run_frames(200);
+    EXPECT_NEAR(sof_sync_get_stats()->frame_us, 990, 8);
+    sof_sync_reset_stats();
+    model.run_frames(100);
+    EXPECT_EQ(sof_sync_get_stats()->late, 0);
+}
+
+TEST_F(SofSync, ScanIsFreeRunningWithoutSof) {
+    SofModel model;
+    model.sof = false;
+    model.run_frames(100);
+    EXPECT_NEAR(model.scans, 100 * model.frame_us / model.scan_us, 2);
+    EXPECT_EQ(sof_sync_get_stats()->scans, 0);
+}
+
+TEST_F(SofSync, ScanIsFreeRunningWhenSofStops) {
+    SofModel model;
+    model.run_frames(20);
+    model.sof = false;
+    model.scans = 0;
+    model.run_frames(100);
+    EXPECT_GT(model.scans, 100u + 100 * model.frame_us / model.scan_us / 2);
+}
+
+TEST_F(SofSync, ScanLongerThanAFrameIsLate) {
+    SofModel model;
+    model.scan_us = 1500;
+    model.run_frames(50);
+    const sof_sync_stats_t *stats = sof_sync_get_stats();
+    EXPECT_GT(stats->scans, 0);
+    EXPECT_EQ(stats->late, stats->scans);
+}
+
+/* Sampling once per frame costs up to a frame of latency, which the
+ * free running scan only pays for by waiting for the poll; the sync wins
+ * once the scan is longer than about twice the guard time. */
+TEST_F(SofSync, LatencyComparedToFreeRunning) {
+    for (uint32_t scan_us : {100, 300, 600}) {
+        SofModel free_running;
+        free_running.sync = false;
+        free_running.scan_us = scan_us;
+        free_running.run_frames(2000);
+
+        sof_sync_init();
+        SofModel synced;
+        synced.scan_us = scan_us;
+        synced.run_frames(20);
+        synced.latencies.clear();
+        synced.scans = 0;
+        synced.run_frames(2000);
+
+        if (scan_us >= 3 * SOF_SYNC_GUARD_US) {
+            EXPECT_LT(synced.average_latency(), free_running.average_latency());
+            EXPECT_LT(synced.max_latency(), free_running.max_latency());
+        }
+#ifdef BENCHMARK
+        std::cout << "[ BENCH    ] " << scan_us << " us scan, key to host latency: free running avg "
+            << free_running.average_latency() << " max " << free_running.max_latency()
+            << " us, SOF synchronized avg " << synced.average_latency() << " max " << synced.max_latency()
+            << " us, " << free_running.scans / 2000.0 << " vs " << synced.scans / 2000.0
+            << " scans per frame" << std::endl;
+#endif
+    }
+}
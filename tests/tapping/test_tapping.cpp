@@ -0,0 +1,183 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <string>
+#include "test_fixture.h"
+#include "keyboard_report_util.h"
+
+extern "C" {
+#include "keycode.h"
+#include "action.h"
+#include "action_layer.h"
+#include "action_tapping.h"
+}
+
+/* Fast typing over the dual-role keys of the basic keymap, SFT_T(KC_U) at
+ * row 2 col 2 and LT(1, KC_V) at row 2 col 3. Built as is, with
+ * PERMISSIVE_HOLD and with HOLD_ON_OTHER_KEY_PRESS. */
+class Tapping : public TestFixture {
+protected:
+    Tapping() {
+        action_tapping_reset_stats();
+    }
+
+    /* time of the first report with exactly the given keys, or UINT32_MAX */
+    uint32_t first_report_time(std::vector<uint8_t> keys) {
+        std::sort(keys.begin(), keys.end());
+        for (auto& r : driver.keyboard_reports()) {
+            std::vector<uint8_t> sent = get_keys(r.report);
+            std::sort(sent.begin(), sent.end());
+            if (sent == keys) return r.time;
+        }
+        return UINT32_MAX;
+    }
+
+    bool has_report(std::vector<uint8_t> keys) {
+        return first_report_time(keys) != UINT32_MAX;
+    }
+
+    bool ever_sent(uint8_t key) {
+        for (auto& r : driver.keyboard_reports()) {
+            std::vector<uint8_t> sent = get_keys(r.report);
+            if (std::find(sent.begin(), sent.end(), key) != sent.end()) return true;
+        }
+        return false;
+    }
+
+    /* the ten keys of row 0 typed one after the other while row/col is held */
+    static MatrixTrace roll_under(uint8_t row, uint8_t col, uint32_t interval) {
+        std::string held = " " + std::to_string(row) + " " + std::to_string(col);
+        std::string text = "0" + held + " down\n";
+        for (uint32_t c = 0; c < 10; c++) {
+            uint32_t t = 10 + c * interval;
+            text += std::to_string(t) + " 0 " + std::to_string(c) + " down\n";
+            text += std::to_string(t + interval / 2) + " 0 " + std::to_string(c) + " up\n";
+        }
+        text += std::to_string(TAPPING_TERM + 50) + held + " up\n";
+        return MatrixTrace::parse(text);
+    }
+};
+
+TEST_F(Tapping, FastRollUnderModTapLosesNoKeys) {
+    // 20 events under the mod-tap, more than the waiting buffer holds
+    replay(roll_under(2, 2, 10));
+    for (uint8_t c = 0; c < 10; c++) {
+        EXPECT_TRUE(has_report({KC_LSFT, (uint8_t)(KC_A + c)})) << "key " << (int)c;
+    }
+    EXPECT_FALSE(ever_sent(KC_U));
+    ASSERT_FALSE(driver.keyboard_reports().empty());
+    EXPECT_TRUE(get_keys(driver.keyboard_reports().back().report).empty());
+    EXPECT_LT(action_tapping_stats()->max_waiting, WAITING_BUFFER_SIZE);
+#if defined(PERMISSIVE_HOLD) || defined(HOLD_ON_OTHER_KEY_PRESS)
+    EXPECT_EQ(action_tapping_stats()->overflows, 0u);
+#else
+    EXPECT_GT(action_tapping_stats()->overflows, 0u);
+#endif
+}
+
+TEST_F(Tapping, FastRollUnderLayerTapLosesNoKeys) {
+    replay(roll_under(2, 3, 10));
+    // layer 1 has F1, F3 and F5 on row 0, the rest falls through
+    const uint8_t layer1[] = {KC_F1, KC_B, KC_F3, KC_D, KC_F5, KC_F, KC_G, KC_H, KC_I, KC_J};
+    for (uint8_t key : layer1) {
+        EXPECT_TRUE(ever_sent(key)) << "key " << (int)key;
+    }
+    EXPECT_FALSE(ever_sent(KC_V));
+    EXPECT_EQ(layer_state, 0u);
+    EXPECT_TRUE(get_keys(driver.keyboard_reports().back().report).empty());
+}
+
+TEST_F(Tapping, NestedKeySettlesTheHold) {
+    replay(MatrixTrace{
+        {0, 2, 2, true},
+        {10, 0, 0, true},
+        {30, 0, 0, false},
+        {TAPPING_TERM + 50, 2, 2, false},
+    });
+#if defined(HOLD_ON_OTHER_KEY_PRESS)
+    EXPECT_EQ(first_report_time({KC_LSFT, KC_A}), 10u);
+#elif defined(PERMISSIVE_HOLD)
+    EXPECT_EQ(first_report_time({KC_LSFT, KC_A}), 30u);
+#else
+    EXPECT_EQ(first_report_time({KC_LSFT, KC_A}), (uint32_t)TAPPING_TERM);
+#endif
+    EXPECT_TRUE(get_keys(driver.keyboard_reports().back().report).empty());
+}
+
+TEST_F(Tapping, LayerTapRolledIntoAnotherKey) {
+    // released before the other key: a tap, unless any other press is a hold
+    replay(MatrixTrace{
+        {0, 2, 3, true},
+        {10, 0, 0, true},
+        {20, 2, 3, false},
+        {30, 0, 0, false},
+    });
+#ifdef HOLD_ON_OTHER_KEY_PRESS
+    EXPECT_TRUE(ever_sent(KC_F1));
+    EXPECT_FALSE(ever_sent(KC_V));
+#else
+    EXPECT_EQ(first_report_time({KC_V}), 20u);
+    EXPECT_TRUE(ever_sent(KC_A));
+    EXPECT_FALSE(ever_sent(KC_F1));
+#endif
+    EXPECT_EQ(layer_state, 0u);
+}
+
+TEST_F(Tapping, TapIsResolvedOnRelease) {
+    replay(MatrixTrace{
+        {0, 2, 2, true},
+        {40, 2, 2, false},
+        {60, 0, 0, true},
+        {80, 0, 0, false},
+    });
+    EXPECT_EQ(first_report_time({KC_U}), 40u);
+    EXPECT_EQ(first_report_time({KC_A}), 60u);
+    EXPECT_FALSE(ever_sent(KC_LSFT));
+    EXPECT_EQ(action_tapping_stats()->early_holds, 0u);
+}
+
+TEST_F(Tapping, NoKeyIsLostInARecordedTypingBurst) {
+    // "vault" and "quiz" at about 120 wpm, with the usual overlaps
+    replay(MatrixTrace::parse(
+        "0    2 3 down   # v\n"
+        "45   0 0 down   # a\n"
+        "70   2 3 up\n"
+        "95   2 2 down   # u\n"
+        "110  0 0 up\n"
+        "140  1 1 down   # l\n"
+        "150  2 2 up\n"
+        "190  1 9 down   # t\n"
+        "205  1 1 up\n"
+        "230  1 9 up\n"
+        "300  1 6 down   # q\n"
+        "330  2 2 down   # u\n"
+        "340  1 6 up\n"
+        "370  0 8 down   # i\n"
+        "385  2 2 up\n"
+        "410  2 7 down   # z\n"
+        "420  0 8 up\n"
+        "455  2 7 up\n"), 300);
+    EXPECT_TRUE(ever_sent(KC_L));
+    EXPECT_TRUE(ever_sent(KC_T));
+    EXPECT_TRUE(ever_sent(KC_Q));
+    EXPECT_TRUE(ever_sent(KC_I));
+    EXPECT_TRUE(ever_sent(KC_Z));
+    EXPECT_TRUE(ever_sent(KC_A) || ever_sent(KC_F1));
+    EXPECT_EQ(layer_state, 0u);
+    EXPECT_TRUE(get_keys(driver.keyboard_reports().back().report).empty());
+    EXPECT_EQ(action_tapping_stats()->overflows, 0u);
+}
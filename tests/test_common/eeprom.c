@@ -0,0 +1,119 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* EEPROM emulated in RAM for native builds */
+
+#include <stdint.h>
+#include <string.h>
+#include "eeprom.h"
+#include "test_eeprom.h"
+
+static uint8_t buffer[TEST_EEPROM_SIZE];
+static uint32_t reads;
+static uint32_t writes;
+
+void test_eeprom_reset(void) {
+    memset(buffer, 0xFF, sizeof(buffer));
+    reads = 0;
+    writes = 0;
+}
+
+uint32_t test_eeprom_reads(void) {
+    return reads;
+}
+
+uint32_t test_eeprom_writes(void) {
+    return writes;
+}
+
+uint8_t eeprom_read_byte(const uint8_t *addr) {
+    reads++;
+    return buffer[(uintptr_t)addr];
+}
+
+uint16_t eeprom_read_word(const uint16_t *addr) {
+    const uint8_t *p = (const uint8_t *)addr;
+    return eeprom_read_byte(p) | (eeprom_read_byte(p + 1) << 8);
+}
+
+uint32_t eeprom_read_dword(const uint32_t *addr) {
+    const uint8_t *p = (const uint8_t *)addr;
+    return eeprom_read_byte(p) | (eeprom_read_byte(p + 1) << 8)
+        | ((uint32_t)eeprom_read_byte(p + 2) << 16) | ((uint32_t)eeprom_read_byte(p + 3) << 24);
+}
+
+void eeprom_read_block(void *buf, const void *addr, uint32_t len) {
+    const uint8_t *p = (const uint8_t *)addr;
+    uint8_t *dest = (uint8_t *)buf;
+    while (len--) {
+        *dest++ = eeprom_read_byte(p++);
+    }
+}
+
+void eeprom_write_byte(uint8_t *addr, uint8_t value) {
+    writes++;
+    buffer[(uintptr_t)addr] = value;
+}
+
+void eeprom_write_word(uint16_t *addr, uint16_t value) {
+    uint8_t *p = (uint8_t *)addr;
+    eeprom_write_byte(p++, value);
+    eeprom_write_byte(p, value >> 8);
+}
+
+void eeprom_write_dword(uint32_t *addr, uint32_t value) {
+    uint8_t *p = (uint8_t *)addr;
+    eeprom_write_byte(p++, value);
+    eeprom_write_byte(p++, value >> 8);
+    eeprom_write_byte(p++, value >> 16);
+    eeprom_write_byte(p, value >> 24);
+}
+
+void eeprom_write_block(const void *buf, void *addr, uint32_t len) {
+    uint8_t *p = (uint8_t *)addr;
+    const uint8_t *src = (const uint8_t *)buf;
+    while (len--) {
+        eeprom_write_byte(p++, *src++);
+    }
+}
+
+void eeprom_update_byte(uint8_t *addr, uint8_t value) {
+    if (eeprom_read_byte(addr) != value) {
+        eeprom_write_byte(addr, value);
+    }
+}
+
+void eeprom_update_word(uint16_t *addr, uint16_t value) {
+    uint8_t *p = (uint8_t *)addr;
+    eeprom_update_byte(p++, value);
+    eeprom_update_byte(p, value >> 8);
+}
+
+void eeprom_update_dword(uint32_t *addr, uint32_t value) {
+    uint8_t *p = (uint8_t *)addr;
+    eeprom_update_byte(p++, value);
+    eeprom_update_byte(p++, value >> 8);
+    eeprom_update_byte(p++, value >> 16);
+    eeprom_update_byte(p, value >> 24);
+}
+
+void eeprom_update_block(const void *buf, void *addr, uint32_t len) {
+    uint8_t *p = (uint8_t *)addr;
+    const uint8_t *src = (const uint8_t *)buf;
+    while (len--) {
+        eeprom_update_byte(p++, *src++);
+    }
+}
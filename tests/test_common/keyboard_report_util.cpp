@@ -0,0 +1,76 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keyboard_report_util.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+extern "C" {
+#include "keycode.h"
+}
+
+std::vector<uint8_t> get_keys(const report_keyboard_t& report) {
+    std::vector<uint8_t> result;
+    for (uint8_t i = 0; i < 8; i++) {
+        if (report.mods & (1 << i)) {
+            result.push_back(KC_LCTRL + i);
+        }
+    }
+#if defined(NKRO_ENABLE)
+#error "NKRO is not supported by the test report utilities"
+#endif
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (report.keys[i]) {
+            result.push_back(report.keys[i]);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+report_keyboard_t make_report(std::initializer_list<uint8_t> keys) {
+    report_keyboard_t report;
+    memset(&report, 0, sizeof(report));
+    uint8_t index = 0;
+    for (auto key : keys) {
+        if (IS_MOD(key)) {
+            report.mods |= MOD_BIT(key);
+        } else if (index < KEYBOARD_REPORT_KEYS) {
+            report.keys[index++] = key;
+        }
+    }
+    return report;
+}
+
+bool operator==(const report_keyboard_t& lhs, const report_keyboard_t& rhs) {
+    return get_keys(lhs) == get_keys(rhs);
+}
+
+std::ostream& operator<<(std::ostream& os, const report_keyboard_t& report) {
+    auto keys = get_keys(report);
+    os << "(";
+    bool first = true;
+    for (auto key : keys) {
+        if (!first) {
+            os << ", ";
+        }
+        os << "0x" << std::hex << std::setw(2) << std::setfill('0') << (int)key << std::dec;
+        first = false;
+    }
+    os << ")";
+    return os;
+}
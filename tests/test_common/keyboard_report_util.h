@@ -0,0 +1,38 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TESTS_TEST_COMMON_KEYBOARD_REPORT_UTIL_H_
+#define TESTS_TEST_COMMON_KEYBOARD_REPORT_UTIL_H_
+
+#include <initializer_list>
+#include <ostream>
+#include <vector>
+
+extern "C" {
+#include "report.h"
+}
+
+bool operator==(const report_keyboard_t& lhs, const report_keyboard_t& rhs);
+std::ostream& operator<<(std::ostream& os, const report_keyboard_t& report);
+
+/* The pressed keys and modifiers of a report, in a form that doesn't depend
+ * on the report format or key order, e.g. {KC_LSFT, KC_A} */
+std::vector<uint8_t> get_keys(const report_keyboard_t& report);
+
+/* Build a report with the given keys and modifiers pressed */
+report_keyboard_t make_report(std::initializer_list<uint8_t> keys);
+
+#endif
@@ -0,0 +1,94 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "matrix.h"
+#include "test_matrix.h"
+#include <string.h>
+
+static matrix_row_t matrix[MATRIX_ROWS] = {};
+uint32_t matrix_scan_count = 0;
+
+__attribute__ ((weak))
+void matrix_init_quantum(void) {
+    matrix_init_kb();
+}
+
+__attribute__ ((weak))
+void matrix_scan_quantum(void) {
+#ifndef MATRIX_SCAN_THREAD
+    matrix_scan_kb();
+#endif
+}
+
+#ifdef MATRIX_SCAN_THREAD
+__attribute__ ((weak))
+void matrix_scan_hooks(void) {
+    matrix_scan_kb();
+}
+#endif
+
+__attribute__ ((weak))
+void matrix_init_kb(void) {
+    matrix_init_user();
+}
+
+__attribute__ ((weak))
+void matrix_scan_kb(void) {
+    matrix_scan_user();
+}
+
+__attribute__ ((weak))
+void matrix_init_user(void) {
+}
+
+__attribute__ ((weak))
+void matrix_scan_user(void) {
+}
+
+void matrix_init(void) {
+    clear_matrix();
+    matrix_init_quantum();
+}
+
+uint8_t matrix_scan(void) {
+    matrix_scan_count++;
+    matrix_scan_quantum();
+    return 1;
+}
+
+matrix_row_t matrix_get_row(uint8_t row) {
+    return matrix[row];
+}
+
+bool matrix_is_on(uint8_t row, uint8_t col) {
+    return (matrix[row] & ((matrix_row_t)1 << col)) != 0;
+}
+
+void matrix_print(void) {
+}
+
+void press_key(uint8_t col, uint8_t row) {
+    matrix[row] |= (matrix_row_t)1 << col;
+}
+
+void release_key(uint8_t col, uint8_t row) {
+    matrix[row] &= ~((matrix_row_t)1 << col);
+}
+
+void clear_matrix(void) {
+    memset(matrix, 0, sizeof(matrix));
+    matrix_scan_count = 0;
+}
@@ -0,0 +1,62 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "matrix_trace.h"
+#include <fstream>
+#include <sstream>
+#include "gtest/gtest.h"
+
+MatrixTrace::MatrixTrace(std::initializer_list<MatrixTraceEvent> events)
+    : m_events(events) {
+}
+
+MatrixTrace MatrixTrace::parse(const std::string& text) {
+    MatrixTrace trace;
+    std::istringstream input(text);
+    std::string line;
+    unsigned line_number = 0;
+    while (std::getline(input, line)) {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        unsigned time, row, col;
+        std::string state;
+        if (!(fields >> time)) {
+            continue;
+        }
+        if (!(fields >> row >> col >> state) || (state != "down" && state != "up")) {
+            ADD_FAILURE() << "malformed trace line " << line_number << ": " << line;
+            continue;
+        }
+        if (!trace.m_events.empty() && time < trace.m_events.back().time) {
+            ADD_FAILURE() << "trace not sorted at line " << line_number;
+            continue;
+        }
+        trace.m_events.push_back(MatrixTraceEvent{time, (uint8_t)row, (uint8_t)col, state == "down"});
+    }
+    return trace;
+}
+
+MatrixTrace MatrixTrace::load(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file) {
+        ADD_FAILURE() << "can't open " << filename;
+        return MatrixTrace();
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return parse(buffer.str());
+}
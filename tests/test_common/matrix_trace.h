@@ -0,0 +1,54 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TESTS_TEST_COMMON_MATRIX_TRACE_H_
+#define TESTS_TEST_COMMON_MATRIX_TRACE_H_
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+/* A switch changing state at a given time, in milliseconds */
+struct MatrixTraceEvent {
+    uint32_t time;
+    uint8_t row;
+    uint8_t col;
+    bool pressed;
+};
+
+/* A timestamped recording of matrix changes.
+ *
+ * The text format has one event per line, "<time> <row> <col> down|up", and
+ * everything after a '#' is a comment. Events must be sorted by time.
+ * Malformed lines are reported as test failures.
+ */
+class MatrixTrace {
+public:
+    MatrixTrace() {}
+    MatrixTrace(std::initializer_list<MatrixTraceEvent> events);
+
+    static MatrixTrace parse(const std::string& text);
+    static MatrixTrace load(const std::string& filename);
+
+    const std::vector<MatrixTraceEvent>& events() const { return m_events; }
+    uint32_t end_time() const { return m_events.empty() ? 0 : m_events.back().time; }
+
+private:
+    std::vector<MatrixTraceEvent> m_events;
+};
+
+#endif
@@ -0,0 +1,38 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Stubs for the platform specific parts of tmk_core in native builds */
+
+#include "bootloader.h"
+#include "suspend.h"
+#include "eeconfig.h"
+
+void bootloader_jump(void) {
+}
+
+void suspend_idle(uint8_t timeout) {
+}
+
+void suspend_power_down(void) {
+    eeconfig_flush();
+}
+
+bool suspend_wakeup_condition(void) {
+    return true;
+}
+
+void suspend_wakeup_init(void) {
+}
@@ -0,0 +1,76 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_driver.h"
+#include "keyboard_report_util.h"
+
+extern "C" {
+#include "timer.h"
+}
+
+TestDriver* TestDriver::m_this = nullptr;
+
+TestDriver::TestDriver()
+    : m_driver{
+        &TestDriver::keyboard_leds,
+        &TestDriver::send_keyboard,
+        &TestDriver::send_mouse,
+        &TestDriver::send_system,
+        &TestDriver::send_consumer
+    },
+    m_leds(0)
+{
+    host_set_driver(&m_driver);
+    m_this = this;
+}
+
+TestDriver::~TestDriver() {
+    host_set_driver(nullptr);
+    m_this = nullptr;
+}
+
+void TestDriver::clear() {
+    m_keyboard_reports.clear();
+    m_mouse_reports.clear();
+    m_system_reports.clear();
+    m_consumer_reports.clear();
+}
+
+void TestDriver::dump(std::ostream& os) const {
+    for (auto& r : m_keyboard_reports) {
+        os << r.time << " " << r.report << std::endl;
+    }
+}
+
+uint8_t TestDriver::keyboard_leds(void) {
+    return m_this->m_leds;
+}
+
+void TestDriver::send_keyboard(report_keyboard_t* report) {
+    m_this->m_keyboard_reports.push_back(TimedKeyboardReport{timer_read32(), *report});
+}
+
+void TestDriver::send_mouse(report_mouse_t* report) {
+    m_this->m_mouse_reports.push_back(*report);
+}
+
+void TestDriver::send_system(uint16_t data) {
+    m_this->m_system_reports.push_back(data);
+}
+
+void TestDriver::send_consumer(uint16_t data) {
+    m_this->m_consumer_reports.push_back(data);
+}
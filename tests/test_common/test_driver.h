@@ -0,0 +1,66 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TESTS_TEST_COMMON_TEST_DRIVER_H_
+#define TESTS_TEST_COMMON_TEST_DRIVER_H_
+
+#include <cstdint>
+#include <vector>
+#include <ostream>
+
+extern "C" {
+#include "host.h"
+}
+
+/* A report as seen by the host, with the simulated time it was sent at */
+struct TimedKeyboardReport {
+    uint32_t time;
+    report_keyboard_t report;
+};
+
+/* host_driver_t that records everything that is sent to the host */
+class TestDriver {
+public:
+    TestDriver();
+    ~TestDriver();
+
+    const std::vector<TimedKeyboardReport>& keyboard_reports() const { return m_keyboard_reports; }
+    const std::vector<report_mouse_t>& mouse_reports() const { return m_mouse_reports; }
+    const std::vector<uint16_t>& system_reports() const { return m_system_reports; }
+    const std::vector<uint16_t>& consumer_reports() const { return m_consumer_reports; }
+    void clear();
+    void set_leds(uint8_t leds) { m_leds = leds; }
+
+    /* print the keyboard report stream, one report per line */
+    void dump(std::ostream& os) const;
+
+private:
+    static uint8_t keyboard_leds(void);
+    static void send_keyboard(report_keyboard_t* report);
+    static void send_mouse(report_mouse_t* report);
+    static void send_system(uint16_t data);
+    static void send_consumer(uint16_t data);
+
+    host_driver_t m_driver;
+    uint8_t m_leds;
+    std::vector<TimedKeyboardReport> m_keyboard_reports;
+    std::vector<report_mouse_t> m_mouse_reports;
+    std::vector<uint16_t> m_system_reports;
+    std::vector<uint16_t> m_consumer_reports;
+    static TestDriver* m_this;
+};
+
+#endif
@@ -0,0 +1,41 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEST_EEPROM_H
+#define TEST_EEPROM_H
+
+#include <stdint.h>
+
+#ifndef TEST_EEPROM_SIZE
+#   define TEST_EEPROM_SIZE 1024
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* erase the whole emulated EEPROM to 0xFF */
+void test_eeprom_reset(void);
+/* bytes read since the last reset */
+uint32_t test_eeprom_reads(void);
+/* bytes written since the last reset */
+uint32_t test_eeprom_writes(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,74 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_fixture.h"
+
+extern "C" {
+#include "keyboard.h"
+#include "action.h"
+#include "action_layer.h"
+#include "action_util.h"
+#include "timer.h"
+#include "test_matrix.h"
+#include "test_timer.h"
+#include "test_eeprom.h"
+}
+
+TestFixture::TestFixture()
+    : scan_interval(1)
+{
+    test_eeprom_reset();
+    keyboard_init();
+    driver.clear();
+}
+
+TestFixture::~TestFixture() {
+    // Release everything and let the tapping state time out, so that the
+    // next test starts with a clean keyboard state
+    clear_matrix();
+    idle_for(1000);
+    clear_keyboard();
+    layer_clear();
+}
+
+void TestFixture::run_one_scan_loop() {
+#ifdef MATRIX_SCAN_THREAD
+    keyboard_scan_task();
+#endif
+    keyboard_task();
+    advance_time(scan_interval);
+}
+
+void TestFixture::idle_for(uint32_t ms) {
+    for (uint32_t i = 0; i < ms; i += scan_interval) {
+        run_one_scan_loop();
+    }
+}
+
+void TestFixture::replay(const MatrixTrace& trace, uint32_t settle_time) {
+    uint32_t start = timer_read32();
+    for (auto& event : trace.events()) {
+        while (timer_read32() - start < event.time) {
+            run_one_scan_loop();
+        }
+        if (event.pressed) {
+            press_key(event.col, event.row);
+        } else {
+            release_key(event.col, event.row);
+        }
+    }
+    idle_for(settle_time);
+}
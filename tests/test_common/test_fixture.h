@@ -0,0 +1,44 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TESTS_TEST_COMMON_TEST_FIXTURE_H_
+#define TESTS_TEST_COMMON_TEST_FIXTURE_H_
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "test_driver.h"
+#include "matrix_trace.h"
+
+/* Runs the real keyboard core against the fake matrix, timer and host driver.
+ * Every test starts from a freshly initialized keyboard at time 0. */
+class TestFixture : public testing::Test {
+public:
+    TestFixture();
+    ~TestFixture();
+
+    /* run keyboard_task once and advance the time by scan_interval */
+    void run_one_scan_loop();
+    /* keep scanning for the given number of milliseconds */
+    void idle_for(uint32_t ms);
+    /* apply the events of the trace to the matrix at their time, scanning in
+     * between, and keep scanning for settle_time ms after the last event */
+    void replay(const MatrixTrace& trace, uint32_t settle_time = 500);
+
+    TestDriver driver;
+    uint32_t scan_interval;
+};
+
+#endif
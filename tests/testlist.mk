@@ -0,0 +1,71 @@
+TEST_LIST +=\
+	basic\
+	profile\
+	layer_cache\
+	layer_cache_uncached\
+	report_coalescing\
+	report_coalescing_off\
+	combo\
+	combo_linear\
+	combo_overflow\
+	basic_scan_thread\
+	scan_thread\
+	async_macro\
+	async_macro_blocking\
+	unicode\
+	unicode_blocking\
+	unicodemap\
+	unicodemap_blocking\
+	leader\
+	leader_unsorted\
+	sequence_trie\
+	deadline\
+	scheduler\
+	trace\
+	tapping\
+	tapping_permissive_hold\
+	tapping_hold_on_other_key\
+	process_hooks\
+	keymap_compiler\
+	keymap_compiler_basic\
+	keymap_compiler_leader\
+	keymap_compiler_planck\
+	dynamic_keymap\
+	dynamic_keymap_uncached\
+	eeconfig\
+	eeconfig_immediate\
+	keyboard_task\
+	keyboard_task_batched\
+	report_queue\
+	sof_sync\
+	debounce_sym_g\
+	debounce_sym_pk\
+	debounce_eager_pk\
+	debounce_eager_pr
+
+# Opt-in, the same tests with the benchmarks, which print their measurements
+BENCH_LIST +=\
+	keyboard_task_bench\
+	keyboard_task_batched_bench\
+	layer_cache_bench\
+	layer_cache_uncached_bench\
+	combo_bench\
+	combo_linear_bench\
+	report_coalescing_bench\
+	report_coalescing_off_bench\
+	sof_sync_bench\
+	async_macro_bench\
+	async_macro_blocking_bench\
+	unicode_bench\
+	unicode_blocking_bench\
+	unicodemap_bench\
+	unicodemap_blocking_bench\
+	sequence_trie_bench\
+	scheduler_bench\
+	process_hooks_bench\
+	keymap_compiler_bench\
+	keymap_compiler_planck_bench\
+	dynamic_keymap_bench\
+	dynamic_keymap_uncached_bench\
+	eeconfig_bench\
+	eeconfig_immediate_bench
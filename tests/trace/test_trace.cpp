@@ -0,0 +1,173 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_fixture.h"
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include "quantum.h"
+#include "action_tapping.h"
+#include "trace.h"
+#include "raw_hid.h"
+#include "test_matrix.h"
+#include "test_timer.h"
+}
+
+static std::vector<uint8_t> raw_hid_reply;
+
+extern "C" void raw_hid_send(uint8_t *data, uint8_t length) {
+    raw_hid_reply.assign(data, data + length);
+}
+
+class Trace : public TestFixture {
+public:
+    Trace() {
+        trace_clear();
+    }
+
+protected:
+    std::vector<trace_record_t> read_all() {
+        std::vector<trace_record_t> records;
+        trace_record_t record;
+        while (trace_read(&record)) {
+            records.push_back(record);
+        }
+        return records;
+    }
+
+    std::vector<trace_record_t> of_type(uint8_t type) {
+        std::vector<trace_record_t> records;
+        for (auto& record : read_all()) {
+            if (record.type == type) records.push_back(record);
+        }
+        return records;
+    }
+};
+
+TEST_F(Trace, KeyPressFromMatrixToReport) {
+    press_key(0, 0);
+    run_one_scan_loop();
+    auto records = read_all();
+    ASSERT_EQ(records.size(), 3u);
+    EXPECT_EQ(records[0].type, TRACE_MATRIX);
+    EXPECT_EQ(records[0].arg, 1);
+    EXPECT_EQ(records[0].data, 0x0000);
+    EXPECT_EQ(records[1].type, TRACE_RECORD);
+    EXPECT_EQ(records[1].arg, 0x80);
+    EXPECT_EQ(records[2].type, TRACE_REPORT);
+    EXPECT_EQ(records[2].arg, 0);
+    EXPECT_EQ(records[2].data, 1);
+
+    release_key(0, 0);
+    run_one_scan_loop();
+    records = of_type(TRACE_REPORT);
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(records[0].data, 0);
+}
+
+TEST_F(Trace, TimesAreInMicroseconds) {
+    set_time(100);
+    press_key(1, 1);
+    run_one_scan_loop();
+    release_key(1, 1);
+    idle_for(10);
+    auto records = of_type(TRACE_MATRIX);
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[0].time, 100000u);
+    EXPECT_EQ(records[0].data, 0x0101);
+    EXPECT_EQ(records[1].time, 101000u);
+}
+
+TEST_F(Trace, TappingDecisions) {
+    // SFT_T(KC_U)
+    press_key(2, 2);
+    run_one_scan_loop();
+    release_key(2, 2);
+    run_one_scan_loop();
+    auto records = of_type(TRACE_TAPPING);
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[0].arg, TRACE_TAPPING_START << 4 | 0);
+    EXPECT_EQ(records[0].data, 0x0202);
+    EXPECT_EQ(records[1].arg, TRACE_TAPPING_TAP << 4 | 1);
+
+    idle_for(TAPPING_TERM);
+    trace_clear();
+    press_key(2, 2);
+    idle_for(TAPPING_TERM + 1);
+    records = of_type(TRACE_TAPPING);
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[0].arg, TRACE_TAPPING_START << 4 | 0);
+    EXPECT_EQ(records[1].arg, TRACE_TAPPING_HOLD << 4 | 0);
+}
+
+TEST_F(Trace, LayerChanges) {
+    // MO(1)
+    press_key(8, 2);
+    run_one_scan_loop();
+    release_key(8, 2);
+    run_one_scan_loop();
+    auto records = of_type(TRACE_LAYER);
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[0].data, 0x0002);
+    EXPECT_EQ(records[1].data, 0x0000);
+}
+
+TEST_F(Trace, OldestRecordsAreOverwritten) {
+    for (uint16_t i = 0; i < TRACE_BUFFER_SIZE + 5; i++) {
+        trace_record(TRACE_USER, 0, i);
+    }
+    EXPECT_EQ(trace_lost(), 5u);
+    EXPECT_EQ(trace_lost(), 0u);
+    auto records = read_all();
+    ASSERT_EQ(records.size(), (size_t)TRACE_BUFFER_SIZE);
+    EXPECT_EQ(records.front().data, 5);
+    EXPECT_EQ(records.back().data, TRACE_BUFFER_SIZE + 4);
+}
+
+TEST_F(Trace, ReadOverRawHid) {
+    set_time(0x12345);
+    for (uint16_t i = 0; i < 4; i++) {
+        trace_record(TRACE_USER, 0xA0 + i, 0x1000 + i);
+    }
+    uint8_t packet[32] = { TRACE_RAW_HID_ID, TRACE_RAW_HID_READ };
+    ASSERT_TRUE(trace_raw_hid_receive(packet, sizeof(packet)));
+    ASSERT_EQ(raw_hid_reply.size(), 32u);
+    EXPECT_EQ(raw_hid_reply[0], TRACE_RAW_HID_ID);
+    EXPECT_EQ(raw_hid_reply[1], 3);
+    // lost
+    EXPECT_EQ(raw_hid_reply[2], 0);
+    EXPECT_EQ(raw_hid_reply[3], 0);
+    uint32_t us = 0x12345 * 1000;
+    const uint8_t first[8] = { (uint8_t)us, (uint8_t)(us >> 8), (uint8_t)(us >> 16), (uint8_t)(us >> 24),
+                               TRACE_USER, 0xA0, 0x00, 0x10 };
+    EXPECT_EQ(0, memcmp(&raw_hid_reply[4], first, 8));
+    EXPECT_EQ(raw_hid_reply[4 + 2 * 8 + 5], 0xA2);
+
+    uint8_t again[32] = { TRACE_RAW_HID_ID, TRACE_RAW_HID_READ };
+    trace_raw_hid_receive(again, sizeof(again));
+    EXPECT_EQ(raw_hid_reply[1], 1);
+    EXPECT_EQ(raw_hid_reply[4 + 5], 0xA3);
+
+    uint8_t empty[32] = { TRACE_RAW_HID_ID, TRACE_RAW_HID_READ };
+    trace_raw_hid_receive(empty, sizeof(empty));
+    EXPECT_EQ(raw_hid_reply[1], 0);
+}
+
+TEST_F(Trace, OtherRawHidPacketsAreLeftAlone) {
+    uint8_t packet[32] = { 0x42, TRACE_RAW_HID_READ };
+    EXPECT_FALSE(trace_raw_hid_receive(packet, sizeof(packet)));
+}
@@ -0,0 +1,54 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+
+#ifdef UNICODE_ENABLE
+#   define UC_EACUTE UC(0x00E9)
+#   define UC_SMILE  UC(0x263A)
+#   define UC_EMOJI  KC_NO
+#   define UC_TOOBIG KC_NO
+#else
+#   define UC_EACUTE X(0)
+#   define UC_SMILE  X(1)
+#   define UC_EMOJI  X(2)
+#   define UC_TOOBIG X(3)
+#endif
+
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {
+        {UC_EACUTE, UC_SMILE, UC_EMOJI, UC_TOOBIG, KC_LSFT, KC_A,  KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_P,      KC_O,     KC_ENT,   KC_NO,     KC_NO,   KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO,     KC_NO,    KC_NO,    KC_NO,     KC_NO,   KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO,     KC_NO,    KC_NO,    KC_NO,     KC_NO,   KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+    },
+};
+
+#ifdef UNICODEMAP_ENABLE
+const uint32_t PROGMEM unicode_map[] = {
+    0x00E9, 0x263A, 0x1F600, 0x110000
+};
+#endif
+
+#ifdef UCIS_ENABLE
+const qk_ucis_symbol_t ucis_symbol_table[] = UCIS_TABLE(
+    UCIS_SYM("poo", 0x1F4A8),
+    UCIS_SYM("poop", 0x1F4A9)
+);
+#endif
+
+const uint16_t fn_actions[] = {
+};
@@ -0,0 +1,283 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "test_fixture.h"
+#include "keyboard_report_util.h"
+
+extern "C" {
+#include "quantum.h"
+#include "test_matrix.h"
+#include "test_timer.h"
+}
+
+/* The reports a sequence of key changes produces */
+class Reports {
+public:
+    Reports& down(uint8_t key) {
+        keys.push_back(key);
+        add();
+        return *this;
+    }
+    Reports& up(uint8_t key) {
+        keys.erase(std::find(keys.begin(), keys.end(), key));
+        add();
+        return *this;
+    }
+    Reports& tap(uint8_t key) {
+        return down(key).up(key);
+    }
+    /* the keys typing the hex digits */
+    Reports& hex(const std::string& digits) {
+        for (char c : digits) {
+            tap(c == '0' ? KC_0 : c <= '9' ? KC_1 + (c - '1') : KC_A + (c - 'A'));
+        }
+        return *this;
+    }
+    /* the start and end of a codepoint in each mode */
+    Reports& start(uint8_t mode) {
+        switch (mode) {
+            case UC_OSX: return down(KC_LALT);
+            case UC_LNX: return down(KC_LCTL).down(KC_LSFT).tap(KC_U).up(KC_LSFT).up(KC_LCTL);
+            case UC_WIN: return down(KC_LALT).tap(KC_PPLS);
+            case UC_WINC: return tap(KC_RALT).tap(KC_U);
+        }
+        return *this;
+    }
+    Reports& finish(uint8_t mode) {
+        switch (mode) {
+            case UC_OSX:
+            case UC_WIN: return up(KC_LALT);
+            case UC_LNX: return tap(KC_SPC);
+        }
+        return *this;
+    }
+    Reports& codepoint(uint8_t mode, const std::string& digits) {
+        return start(mode).hex(digits).finish(mode);
+    }
+
+    std::vector<report_keyboard_t> reports;
+
+private:
+    void add() {
+        report_keyboard_t report = {};
+        uint8_t index = 0;
+        for (uint8_t key : keys) {
+            if (IS_MOD(key)) {
+                report.mods |= MOD_BIT(key);
+            } else {
+                report.keys[index++] = key;
+            }
+        }
+        reports.push_back(report);
+    }
+
+    std::vector<uint8_t> keys;
+};
+
+class Unicode : public TestFixture {
+public:
+    Unicode() {
+        driver.clear();
+    }
+
+protected:
+    void tap_key(uint8_t col, uint8_t row) {
+        press_key(col, row);
+        run_one_scan_loop();
+        release_key(col, row);
+        run_one_scan_loop();
+    }
+
+    /* keep scanning until everything queued has been typed */
+    void settle() {
+#ifdef UNICODE_ASYNC
+        while (unicode_busy()) {
+            run_one_scan_loop();
+        }
+#endif
+        run_one_scan_loop();
+    }
+
+    std::vector<report_keyboard_t> reports() {
+        std::vector<report_keyboard_t> result;
+        for (auto& r : driver.keyboard_reports()) {
+            result.push_back(r.report);
+        }
+        return result;
+    }
+
+    void expect_codepoint(uint8_t mode, const std::string& digits) {
+        set_unicode_input_mode(mode);
+        tap_key(0, 0);
+        settle();
+        EXPECT_EQ(reports(), Reports().codepoint(mode, digits).reports);
+    }
+};
+
+TEST_F(Unicode, OsxReports) {
+    expect_codepoint(UC_OSX, "00E9");
+}
+
+TEST_F(Unicode, LinuxReports) {
+    expect_codepoint(UC_LNX, "00E9");
+}
+
+TEST_F(Unicode, WindowsHexNumpadReports) {
+    expect_codepoint(UC_WIN, "00E9");
+}
+
+TEST_F(Unicode, WinComposeReports) {
+    expect_codepoint(UC_WINC, "00E9");
+}
+
+TEST_F(Unicode, HeldModifiersAreReleasedAndRestored) {
+    set_unicode_input_mode(UC_LNX);
+    press_key(4, 0);
+    run_one_scan_loop();
+    tap_key(0, 0);
+    settle();
+    release_key(4, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(reports(), Reports().down(KC_LSFT).up(KC_LSFT)
+        .codepoint(UC_LNX, "00E9").down(KC_LSFT).up(KC_LSFT).reports);
+}
+
+TEST_F(Unicode, ConsecutiveCodepoints) {
+    set_unicode_input_mode(UC_OSX);
+    tap_key(0, 0);
+    tap_key(1, 0);
+    settle();
+#ifdef UNICODE_ASYNC
+    // one batch, with alt held for both
+    EXPECT_EQ(reports(), Reports().start(UC_OSX).hex("00E9").hex("263A").finish(UC_OSX).reports);
+#else
+    EXPECT_EQ(reports(), Reports().codepoint(UC_OSX, "00E9").codepoint(UC_OSX, "263A").reports);
+#endif
+}
+
+#ifdef UNICODEMAP_ENABLE
+TEST_F(Unicode, OsxSurrogatePair) {
+    set_unicode_input_mode(UC_OSX);
+    tap_key(2, 0);
+    settle();
+    EXPECT_EQ(reports(), Reports().start(UC_OSX).hex("D83D").hex("DE00").finish(UC_OSX).reports);
+}
+
+TEST_F(Unicode, LinuxFiveDigits) {
+    set_unicode_input_mode(UC_LNX);
+    tap_key(2, 0);
+    settle();
+    EXPECT_EQ(reports(), Reports().codepoint(UC_LNX, "1F600").reports);
+}
+
+TEST_F(Unicode, OutOfRangeIsNotTyped) {
+    set_unicode_input_mode(UC_OSX);
+    tap_key(3, 0);
+    settle();
+    EXPECT_TRUE(reports().empty());
+}
+#endif
+
+#ifdef UCIS_ENABLE
+TEST_F(Unicode, UcisSymbol) {
+    set_unicode_input_mode(UC_LNX);
+    qk_ucis_start();
+    settle();
+    tap_key(0, 1);
+    tap_key(1, 1);
+    tap_key(1, 1);
+    tap_key(0, 1);
+    // enter is held until the symbol is typed, its release sends the report
+    // again, which would repeat a backspace if it came in the middle
+    press_key(2, 1);
+    run_one_scan_loop();
+    settle();
+    release_key(2, 1);
+    run_one_scan_loop();
+    Reports expected;
+    expected.codepoint(UC_LNX, "2328").tap(KC_P).tap(KC_O).tap(KC_O).tap(KC_P);
+    for (int i = 0; i < 5; i++) {
+        expected.tap(KC_BSPC);
+    }
+    expected.codepoint(UC_LNX, "1F4A9");
+    expected.reports.push_back(report_keyboard_t{});
+    EXPECT_EQ(reports(), expected.reports);
+}
+#endif
+
+#ifdef UNICODE_ASYNC
+TEST_F(Unicode, ScanningIsNotBlocked) {
+    set_unicode_input_mode(UC_LNX);
+    uint32_t start = timer_read32();
+    press_key(0, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(timer_read32() - start, scan_interval);
+    EXPECT_LE(driver.keyboard_reports().size(), 1u);
+    release_key(0, 0);
+    // a key pressed while the codepoint is typed is seen right away
+    press_key(5, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(timer_read32() - start, 2 * scan_interval);
+    EXPECT_TRUE(unicode_busy());
+    release_key(5, 0);
+    settle();
+}
+
+TEST_F(Unicode, FullQueueTypesInOrder) {
+    // more codepoints than the queue holds, faster than they are typed
+    set_unicode_input_mode(UC_LNX);
+    Reports expected;
+    for (int i = 0; i < UNICODE_QUEUE_SIZE + 4; i++) {
+        tap_key(i % 2, 0);
+        expected.codepoint(UC_LNX, i % 2 ? "263A" : "00E9");
+    }
+    settle();
+    EXPECT_EQ(reports(), expected.reports);
+}
+#endif
+
+TEST_F(Unicode, TypingStall) {
+    set_unicode_input_mode(UC_LNX);
+    uint32_t start = timer_read32();
+    uint32_t longest = 0;
+    uint8_t codepoints = 0;
+    for (; codepoints < 8; codepoints++) {
+        press_key(codepoints % 2, 0);
+        uint32_t before = timer_read32();
+        run_one_scan_loop();
+        longest = std::max(longest, timer_read32() - before - scan_interval);
+        release_key(codepoints % 2, 0);
+        run_one_scan_loop();
+    }
+#ifdef UNICODE_ASYNC
+    while (unicode_busy()) {
+        uint32_t before = timer_read32();
+        run_one_scan_loop();
+        longest = std::max(longest, timer_read32() - before - scan_interval);
+    }
+    // the input sequence is spread over the scans, none of them waits for the host
+    EXPECT_EQ(longest, 0);
+#endif
+#ifdef BENCHMARK
+    std::cout << "[ BENCH    ] " << (int)codepoints << " codepoints in UC_LNX: "
+        << driver.keyboard_reports().size() << " reports in " << timer_read32() - start
+        << " ms, longest stall of the scan loop " << longest << " ms" << std::endl;
+#endif
+}
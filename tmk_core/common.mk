@@ -16,6 +16,10 @@ TMK_COMMON_SRC +=	$(COMMON_DIR)/host.c \
 	$(COMMON_DIR)/debug.c \
 	$(COMMON_DIR)/util.c \
 	$(COMMON_DIR)/eeconfig.c \
+	$(COMMON_DIR)/report_queue.c \
+	$(COMMON_DIR)/key_event_queue.c \
+	$(COMMON_DIR)/deadline.c \
+	$(COMMON_DIR)/scheduler.c \
 	$(PLATFORM_COMMON_DIR)/suspend.c \
 	$(PLATFORM_COMMON_DIR)/timer.c \
 	$(PLATFORM_COMMON_DIR)/bootloader.c \
@@ -112,6 +116,21 @@ ifeq ($(strip $(BLUETOOTH)), RN42)
 		TMK_COMMON_DEFS += -DMODULE_RN42
 endif
 
+ifeq ($(strip $(PROFILE_ENABLE)), yes)
+    TMK_COMMON_SRC += $(COMMON_DIR)/profile.c
+    TMK_COMMON_DEFS += -DPROFILE_ENABLE
+endif
+
+ifeq ($(strip $(TRACE_ENABLE)), yes)
+    TMK_COMMON_SRC += $(COMMON_DIR)/trace.c
+    TMK_COMMON_DEFS += -DTRACE_ENABLE
+endif
+
+ifeq ($(strip $(SOF_SYNC_ENABLE)), yes)
+    TMK_COMMON_SRC += $(COMMON_DIR)/sof_sync.c
+    TMK_COMMON_DEFS += -DSOF_SYNC_ENABLE
+endif
+
 ifeq ($(strip $(ONEHAND_ENABLE)), yes)
     TMK_COMMON_DEFS += -DONEHAND_ENABLE
 endif
@@ -26,6 +26,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action_macro.h"
 #include "action_util.h"
 #include "action.h"
+#include "trace.h"
 
 #ifdef DEBUG_ACTION
 #include "debug.h"
@@ -37,9 +38,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <fauxclicky.h>
 #endif
 
+#ifdef PROFILE_ENABLE
+#include "profile.h"
+#endif
+
 void action_exec(keyevent_t event)
 {
     if (!IS_NOEVENT(event)) {
+#ifdef PROFILE_ENABLE
+        profile_action_exec();
+#endif
         dprint("\n---- action_exec: start -----\n");
         dprint("EVENT: "); debug_event(event); dprintln();
     }
@@ -124,8 +132,16 @@ void process_record(keyrecord_t *record)
 {
     if (IS_NOEVENT(record->event)) { return; }
 
+    TRACE(TRACE_RECORD, record->event.pressed << 7 | record->tap.interrupted << 4 | record->tap.count,
+          TRACE_KEY(record->event.key));
+
+#ifdef PROFILE_ENABLE
+    if (!PROFILE_CALL(PROFILE_PROCESS_RECORD, process_record_quantum(record)))
+        return;
+#else
     if(!process_record_quantum(record))
         return;
+#endif
 
     action_t action = store_or_get_action(record->event.pressed, record->event.key);
     dprint("ACTION: "); debug_action(action);
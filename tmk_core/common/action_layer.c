@@ -1,8 +1,10 @@
 #include <stdint.h>
+#include <string.h>
 #include "keyboard.h"
 #include "action.h"
 #include "util.h"
 #include "action_layer.h"
+#include "trace.h"
 
 #ifdef DEBUG_ACTION
 #include "debug.h"
@@ -28,6 +30,7 @@ static void default_layer_state_set(uint32_t state)
     default_layer_debug(); debug(" to ");
     default_layer_state = state;
     default_layer_debug(); debug("\n");
+    TRACE(TRACE_DEFAULT_LAYER, 0, state);
     clear_keyboard_but_mods(); // To avoid stuck keys
 }
 
@@ -75,6 +78,7 @@ static void layer_state_set(uint32_t state)
     layer_debug(); dprint(" to ");
     layer_state = state;
     layer_debug(); dprintln();
+    TRACE(TRACE_LAYER, 0, state);
     clear_keyboard_but_mods(); // To avoid stuck keys
 }
 
@@ -186,17 +190,18 @@ action_t store_or_get_action(bool pressed, keypos_t key)
 }
 
 
-int8_t layer_switch_get_layer(keypos_t key)
-{
-    action_t action;
-    action.code = ACTION_TRANSPARENT;
-
 #ifndef NO_ACTION_LAYER
-    uint32_t layers = layer_state | default_layer_state;
+static int8_t layer_switch_find_layer(uint32_t layers, keypos_t key)
+{
+#ifdef COMPILED_KEYMAP
+    /* the keymap compiler already knows where the key is transparent */
+    layers &= keymap_compiled_layers(key);
+    return layers ? biton32(layers) : 0;
+#else
     /* check top layer first */
     for (int8_t i = 31; i >= 0; i--) {
         if (layers & (1UL<<i)) {
-            action = action_for_key(i, key);
+            action_t action = action_for_key(i, key);
             if (action.code != ACTION_TRANSPARENT) {
                 return i;
             }
@@ -204,10 +209,53 @@ int8_t layer_switch_get_layer(keypos_t key)
     }
     /* fall back to layer 0 */
     return 0;
+#endif
+}
+#endif
+
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_RESOLUTION_CACHE)
+/*
+ * Resolved layer of every key for the layer state it was resolved in. The
+ * whole cache is dropped whenever layer_state or default_layer_state differ
+ * from that state, so direct writes to them are picked up as well.
+ */
+#define LAYER_CACHE_UNKNOWN 0xFF
+static uint8_t layer_cache[MATRIX_ROWS][MATRIX_COLS];
+static uint32_t layer_cache_state;
+static bool layer_cache_valid = false;
+
+void layer_cache_invalidate(void)
+{
+    layer_cache_valid = false;
+}
+
+int8_t layer_switch_get_layer(keypos_t key)
+{
+    uint32_t layers = layer_state | default_layer_state;
+    if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) {
+        return layer_switch_find_layer(layers, key);
+    }
+    if (!layer_cache_valid || layer_cache_state != layers) {
+        memset(layer_cache, LAYER_CACHE_UNKNOWN, sizeof(layer_cache));
+        layer_cache_state = layers;
+        layer_cache_valid = true;
+    }
+    uint8_t *layer = &layer_cache[key.row][key.col];
+    if (*layer == LAYER_CACHE_UNKNOWN) {
+        *layer = layer_switch_find_layer(layers, key);
+    }
+    return *layer;
+}
+#else
+int8_t layer_switch_get_layer(keypos_t key)
+{
+#ifndef NO_ACTION_LAYER
+    return layer_switch_find_layer(layer_state | default_layer_state, key);
 #else
     return biton32(default_layer_state);
 #endif
 }
+#endif
 
 action_t layer_switch_get_action(keypos_t key)
 {
@@ -88,6 +88,21 @@ action_t store_or_get_action(bool pressed, keypos_t key);
 /* return the topmost non-transparent layer currently associated with key */
 int8_t layer_switch_get_layer(keypos_t key);
 
+/* With LAYER_RESOLUTION_CACHE the result of layer_switch_get_layer is kept
+ * per key until the layer state changes. Code that changes the keymap itself
+ * at runtime must call layer_cache_invalidate. */
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_RESOLUTION_CACHE)
+void layer_cache_invalidate(void);
+#else
+#define layer_cache_invalidate()
+#endif
+
+/* With COMPILED_KEYMAP the keymap compiler provides the layers each key is
+ * not transparent on, bit n for layer n. */
+#ifdef COMPILED_KEYMAP
+uint32_t keymap_compiled_layers(keypos_t key);
+#endif
+
 /* return action depending on current layer status */
 action_t layer_switch_get_action(keypos_t key);
 
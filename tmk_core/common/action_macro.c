@@ -18,6 +18,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action_util.h"
 #include "action_macro.h"
 #include "wait.h"
+#ifdef ASYNC_MACRO
+#   include <stddef.h>
+#   include "timer.h"
+#endif
 
 #ifdef DEBUG_ACTION
 #include "debug.h"
@@ -26,60 +30,289 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #endif
 
 
-#ifndef NO_ACTION_MACRO
+#ifdef ASYNC_MACRO
+#ifndef ASYNC_MACRO_QUEUE_SIZE
+#   define ASYNC_MACRO_QUEUE_SIZE 4
+#endif
 
-#define MACRO_READ()  (macro = MACRO_GET(macro_p++))
-void action_macro_play(const macro_t *macro_p)
+/* keys a macro has down, released again by action_macro_cancel */
+static uint8_t held_keys[6];
+
+static void held_key_add(uint8_t code)
+{
+    for (uint8_t i = 0; i < sizeof(held_keys); i++) {
+        if (!held_keys[i]) {
+            held_keys[i] = code;
+            return;
+        }
+    }
+}
+
+static void held_key_del(uint8_t code)
+{
+    for (uint8_t i = 0; i < sizeof(held_keys); i++) {
+        if (held_keys[i] == code) held_keys[i] = KC_NO;
+    }
+}
+#endif
+
+#if !defined(NO_ACTION_MACRO) || defined(ASYNC_MACRO)
+static void macro_key_down(uint8_t code)
+{
+    if (IS_MOD(code)) {
+        add_macro_mods(MOD_BIT(code));
+        send_keyboard_report();
+    } else {
+        register_code(code);
+#ifdef ASYNC_MACRO
+        held_key_add(code);
+#endif
+    }
+}
+
+static void macro_key_up(uint8_t code)
+{
+    if (IS_MOD(code)) {
+        del_macro_mods(MOD_BIT(code));
+        send_keyboard_report();
+    } else {
+        unregister_code(code);
+#ifdef ASYNC_MACRO
+        held_key_del(code);
+#endif
+    }
+}
+
+#define MACRO_READ()  (macro = MACRO_GET((*macro_p)++))
+/* Run the command at *macro_p and move past it. Returns false at the end of
+ * the macro, otherwise wait is set to the milliseconds a WAIT asks for.
+ */
+static bool macro_exec(const macro_t **macro_p, uint8_t *interval, uint8_t *wait)
 {
     macro_t macro = END;
+
+    *wait = 0;
+    switch (MACRO_READ()) {
+        case KEY_DOWN:
+            MACRO_READ();
+            dprintf("KEY_DOWN(%02X)\n", macro);
+            macro_key_down(macro);
+            break;
+        case KEY_UP:
+            MACRO_READ();
+            dprintf("KEY_UP(%02X)\n", macro);
+            macro_key_up(macro);
+            break;
+        case WAIT:
+            MACRO_READ();
+            dprintf("WAIT(%u)\n", macro);
+            *wait = macro;
+            break;
+        case INTERVAL:
+            *interval = MACRO_READ();
+            dprintf("INTERVAL(%u)\n", *interval);
+            break;
+        case 0x04 ... 0x73:
+            dprintf("DOWN(%02X)\n", macro);
+            register_code(macro);
+#ifdef ASYNC_MACRO
+            held_key_add(macro);
+#endif
+            break;
+        case 0x84 ... 0xF3:
+            dprintf("UP(%02X)\n", macro);
+            unregister_code(macro&0x7F);
+#ifdef ASYNC_MACRO
+            held_key_del(macro&0x7F);
+#endif
+            break;
+        case END:
+        default:
+            return false;
+    }
+    return true;
+}
+#endif
+
+#ifdef ASYNC_MACRO
+/* A queued macro or PROGMEM string, only one of them is set */
+typedef struct {
+    const macro_t *macro;
+    const char *text;
+} macro_job_t;
+
+static macro_job_t jobs[ASYNC_MACRO_QUEUE_SIZE];
+static uint8_t jobs_head = 0;
+static uint8_t jobs_count = 0;
+
+static macro_job_t playing = { 0 };
+static uint8_t interval = 0;
+static uint16_t step_timer = 0;
+static uint16_t step_delay = 0;
+
+/* the key changes typing the current character of the string */
+static struct {
+    uint8_t code;
+    bool pressed;
+} char_steps[4];
+static uint8_t char_step = 0;
+static uint8_t char_step_count = 0;
+
+static bool macro_queue(const macro_t *macro, const char *text)
+{
+    if (jobs_count == ASYNC_MACRO_QUEUE_SIZE) {
+        // play the queue out right away rather than lose this one
+        dprint("macro queue full\n");
+        action_macro_flush();
+    }
+    macro_job_t *job = &jobs[(jobs_head + jobs_count++) % ASYNC_MACRO_QUEUE_SIZE];
+    job->macro = macro;
+    job->text = text;
+    return true;
+}
+
+bool action_macro_type(const char *str)
+{
+    if (!str) return true;
+    return macro_queue(NULL, str);
+}
+
+bool action_macro_playing(void)
+{
+    return playing.macro || playing.text || jobs_count;
+}
+
+__attribute__ ((weak))
+uint8_t action_macro_ascii_keycode(uint8_t ascii)
+{
+    return KC_NO;
+}
+
+/* Break the next character of the string into key changes. Returns false at
+ * the end of the string.
+ */
+static bool macro_next_char(void)
+{
+    uint8_t ascii;
+    uint8_t keycode = KC_NO;
+
+    while (keycode == KC_NO) {
+        ascii = pgm_read_byte(playing.text);
+        if (!ascii) return false;
+        playing.text++;
+        keycode = action_macro_ascii_keycode(ascii);
+    }
+    char_step = 0;
+    char_step_count = 0;
+    if (keycode & MACRO_ASCII_SHIFT) {
+        char_steps[char_step_count].code = KC_LSFT;
+        char_steps[char_step_count++].pressed = true;
+    }
+    char_steps[char_step_count].code = keycode & ~MACRO_ASCII_SHIFT;
+    char_steps[char_step_count++].pressed = true;
+    char_steps[char_step_count].code = keycode & ~MACRO_ASCII_SHIFT;
+    char_steps[char_step_count++].pressed = false;
+    if (keycode & MACRO_ASCII_SHIFT) {
+        char_steps[char_step_count].code = KC_LSFT;
+        char_steps[char_step_count++].pressed = false;
+    }
+    return true;
+}
+
+/* Send the next key change of the current job. Returns false when the job
+ * has finished.
+ */
+static bool macro_step(void)
+{
+    uint8_t wait;
+
+    if (playing.text) {
+        if (char_step == char_step_count && !macro_next_char()) return false;
+        if (char_steps[char_step].pressed) {
+            macro_key_down(char_steps[char_step].code);
+        } else {
+            macro_key_up(char_steps[char_step].code);
+        }
+        char_step++;
+        step_delay = ASYNC_MACRO_STEP_MS;
+        return true;
+    }
+    // INTERVAL sends nothing, go on to the command after it
+    while (MACRO_GET(playing.macro) == INTERVAL) {
+        macro_exec(&playing.macro, &interval, &wait);
+    }
+    if (!macro_exec(&playing.macro, &interval, &wait)) return false;
+    step_delay = wait + interval;
+    if (step_delay < ASYNC_MACRO_STEP_MS) step_delay = ASYNC_MACRO_STEP_MS;
+    return true;
+}
+
+void action_macro_task(void)
+{
+    if (!playing.macro && !playing.text) {
+        if (!jobs_count) return;
+        playing = jobs[jobs_head];
+        jobs_head = (jobs_head + 1) % ASYNC_MACRO_QUEUE_SIZE;
+        jobs_count--;
+        interval = 0;
+        char_step = char_step_count = 0;
+        step_delay = 0;
+    }
+    if (timer_elapsed(step_timer) < step_delay) return;
+
+    if (macro_step()) {
+        step_timer = timer_read();
+    } else {
+        playing.macro = NULL;
+        playing.text = NULL;
+        step_delay = 0;
+    }
+}
+
+void action_macro_flush(void)
+{
+    while (action_macro_playing()) {
+        wait_ms(1);
+        action_macro_task();
+    }
+}
+
+void action_macro_cancel(void)
+{
+    jobs_count = 0;
+    playing.macro = NULL;
+    playing.text = NULL;
+    step_delay = 0;
+    char_step = char_step_count = 0;
+    for (uint8_t i = 0; i < sizeof(held_keys); i++) {
+        if (held_keys[i]) {
+            unregister_code(held_keys[i]);
+            held_keys[i] = KC_NO;
+        }
+    }
+    if (get_macro_mods()) {
+        clear_macro_mods();
+        send_keyboard_report();
+    }
+}
+#endif
+
+#ifndef NO_ACTION_MACRO
+void action_macro_play(const macro_t *macro_p)
+{
+#ifdef ASYNC_MACRO
+    // played by action_macro_task
+    if (macro_p) macro_queue(macro_p, NULL);
+#else
     uint8_t interval = 0;
+    uint8_t wait;
 
     if (!macro_p) return;
-    while (true) {
-        switch (MACRO_READ()) {
-            case KEY_DOWN:
-                MACRO_READ();
-                dprintf("KEY_DOWN(%02X)\n", macro);
-                if (IS_MOD(macro)) {
-                    add_macro_mods(MOD_BIT(macro));
-                    send_keyboard_report();
-                } else {
-                    register_code(macro);
-                }
-                break;
-            case KEY_UP:
-                MACRO_READ();
-                dprintf("KEY_UP(%02X)\n", macro);
-                if (IS_MOD(macro)) {
-                    del_macro_mods(MOD_BIT(macro));
-                    send_keyboard_report();
-                } else {
-                    unregister_code(macro);
-                }
-                break;
-            case WAIT:
-                MACRO_READ();
-                dprintf("WAIT(%u)\n", macro);
-                { uint8_t ms = macro; while (ms--) wait_ms(1); }
-                break;
-            case INTERVAL:
-                interval = MACRO_READ();
-                dprintf("INTERVAL(%u)\n", interval);
-                break;
-            case 0x04 ... 0x73:
-                dprintf("DOWN(%02X)\n", macro);
-                register_code(macro);
-                break;
-            case 0x84 ... 0xF3:
-                dprintf("UP(%02X)\n", macro);
-                unregister_code(macro&0x7F);
-                break;
-            case END:
-            default:
-                return;
-        }
+    while (macro_exec(&macro_p, &interval, &wait)) {
+        while (wait--) wait_ms(1);
         // interval
         { uint8_t ms = interval; while (ms--) wait_ms(1); }
     }
+#endif
 }
 #endif
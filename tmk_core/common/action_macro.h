@@ -17,6 +17,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef ACTION_MACRO_H
 #define ACTION_MACRO_H
 #include <stdint.h>
+#include <stdbool.h>
 #include "progmem.h"
 
 
@@ -55,6 +56,32 @@ void action_macro_play(const macro_t *macro_p);
 #define action_macro_play(macro)
 #endif
 
+#ifdef ASYNC_MACRO
+#ifndef ASYNC_MACRO_STEP_MS
+#   define ASYNC_MACRO_STEP_MS 1
+#endif
+
+/* Macros and strings are queued and played back by action_macro_task, one key
+ * change every ASYNC_MACRO_STEP_MS, while the matrix keeps being scanned.
+ * Queued strings are read from PROGMEM until they are typed, so they have to
+ * outlive the call. When the queue is full it is played out first, blocking.
+ * Keys registered directly go out before what is still queued, call
+ * action_macro_flush first where that order matters.
+ */
+bool action_macro_type(const char *str);
+void action_macro_task(void);
+/* play everything queued right away, blocking */
+void action_macro_flush(void);
+/* stop playing, drop the queue and release the keys the macro has down */
+void action_macro_cancel(void);
+bool action_macro_playing(void);
+
+/* keycode typing the ASCII character, or'ed with MACRO_ASCII_SHIFT when it
+ * needs shift, KC_NO to skip it */
+#define MACRO_ASCII_SHIFT 0x80
+uint8_t action_macro_ascii_keycode(uint8_t ascii);
+#endif
+
 
 
 /* Macro commands
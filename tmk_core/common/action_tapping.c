@@ -5,6 +5,8 @@
 #include "action_tapping.h"
 #include "keycode.h"
 #include "timer.h"
+#include "trace.h"
+#include "print.h"
 
 #ifdef DEBUG_ACTION
 #include "debug.h"
@@ -19,15 +21,21 @@
 #define IS_TAPPING_RELEASED()   (IS_TAPPING() && !tapping_key.event.pressed)
 #define IS_TAPPING_KEY(k)       (IS_TAPPING() && KEYEQ(tapping_key.event.key, (k)))
 #define WITHIN_TAPPING_TERM(e)  (TIMER_DIFF_16(e.time, tapping_key.event.time) < TAPPING_TERM)
+#define TRACE_TAPPING_KEY(decision) \
+    TRACE(TRACE_TAPPING, (decision) << 4 | tapping_key.tap.count, TRACE_KEY(tapping_key.event.key))
 
 
 static keyrecord_t tapping_key = {};
 static keyrecord_t waiting_buffer[WAITING_BUFFER_SIZE] = {};
 static uint8_t waiting_buffer_head = 0;
 static uint8_t waiting_buffer_tail = 0;
+static tapping_stats_t stats = {};
 
 static bool process_tapping(keyrecord_t *record);
+static void settle_hold(void);
 static bool waiting_buffer_enq(keyrecord_t record);
+static void waiting_buffer_process(void);
+static void waiting_buffer_spill(void);
 static void waiting_buffer_clear(void);
 static bool waiting_buffer_typed(keyevent_t event);
 static bool waiting_buffer_has_anykey_pressed(void);
@@ -43,12 +51,16 @@ void action_tapping_process(keyrecord_t record)
             debug("processed: "); debug_record(record); debug("\n");
         }
     } else {
-        if (!waiting_buffer_enq(record)) {
-            // clear all in case of overflow.
-            debug("OVERFLOW: CLEAR ALL STATES\n");
-            clear_keyboard();
-            waiting_buffer_clear();
-            tapping_key = (keyrecord_t){};
+        for (uint8_t tries = 0; !waiting_buffer_enq(record); tries++) {
+            if (tries == WAITING_BUFFER_SIZE) {
+                // spilling made no room, which the states below never do
+                debug("OVERFLOW: CLEAR ALL STATES\n");
+                clear_keyboard();
+                waiting_buffer_clear();
+                tapping_key = (keyrecord_t){};
+                break;
+            }
+            waiting_buffer_spill();
         }
     }
 
@@ -56,19 +68,28 @@ void action_tapping_process(keyrecord_t record)
     if (!IS_NOEVENT(record.event) && waiting_buffer_head != waiting_buffer_tail) {
         debug("---- action_exec: process waiting_buffer -----\n");
     }
-    for (; waiting_buffer_tail != waiting_buffer_head; waiting_buffer_tail = (waiting_buffer_tail + 1) % WAITING_BUFFER_SIZE) {
-        if (process_tapping(&waiting_buffer[waiting_buffer_tail])) {
-            debug("processed: waiting_buffer["); debug_dec(waiting_buffer_tail); debug("] = ");
-            debug_record(waiting_buffer[waiting_buffer_tail]); debug("\n\n");
-        } else {
-            break;
-        }
-    }
+    waiting_buffer_process();
     if (!IS_NOEVENT(record.event)) {
         debug("\n");
     }
 }
 
+const tapping_stats_t *action_tapping_stats(void)
+{
+    return &stats;
+}
+
+void action_tapping_reset_stats(void)
+{
+    stats = (tapping_stats_t){};
+}
+
+void action_tapping_print_stats(void)
+{
+    xprintf("tapping: overflows=%u early holds=%u max waiting=%u\n",
+            stats.overflows, stats.early_holds, stats.max_waiting);
+}
+
 
 /* Tapping
  *
@@ -88,6 +109,7 @@ bool process_tapping(keyrecord_t *keyp)
                     // first tap!
                     debug("Tapping: First tap(0->1).\n");
                     tapping_key.tap.count = 1;
+                    TRACE_TAPPING_KEY(TRACE_TAPPING_TAP);
                     debug_tapping_key();
                     process_record(&tapping_key);
 
@@ -96,16 +118,15 @@ bool process_tapping(keyrecord_t *keyp)
                     // enqueue
                     return false;
                 }
-#if TAPPING_TERM >= 500
+#if TAPPING_TERM >= 500 || defined(PERMISSIVE_HOLD)
                 /* Process a key typed within TAPPING_TERM
                  * This can register the key before settlement of tapping,
                  * useful for long TAPPING_TERM but may prevent fast typing.
                  */
                 else if (IS_RELEASED(event) && waiting_buffer_typed(event)) {
                     debug("Tapping: End. No tap. Interfered by typing key\n");
-                    process_record(&tapping_key);
-                    tapping_key = (keyrecord_t){};
-                    debug_tapping_key();
+                    stats.early_holds++;
+                    settle_hold();
                     // enqueue
                     return false;
                 }
@@ -134,10 +155,23 @@ bool process_tapping(keyrecord_t *keyp)
                     process_record(keyp);
                     return true;
                 }
+#ifdef HOLD_ON_OTHER_KEY_PRESS
+                /* Any other key pressed while the tap key is held makes it a hold,
+                 * without waiting for either key to be released.
+                 */
+                else if (event.pressed) {
+                    debug("Tapping: End. No tap. Other key pressed\n");
+                    stats.early_holds++;
+                    settle_hold();
+                    // enqueue
+                    return false;
+                }
+#endif
                 else {
                     // set interrupted flag when other key preesed during tapping
                     if (event.pressed) {
                         tapping_key.tap.interrupted = true;
+                        TRACE_TAPPING_KEY(TRACE_TAPPING_INTERRUPT);
                     }
                     // enqueue
                     return false;
@@ -167,6 +201,7 @@ bool process_tapping(keyrecord_t *keyp)
                         debug("Tapping: Start while last tap(1).\n");
                     }
                     tapping_key = *keyp;
+                    TRACE_TAPPING_KEY(TRACE_TAPPING_START);
                     waiting_buffer_scan_tap();
                     debug_tapping_key();
                     return true;
@@ -185,9 +220,7 @@ bool process_tapping(keyrecord_t *keyp)
             if (tapping_key.tap.count == 0) {
                 debug("Tapping: End. Timeout. Not tap(0): ");
                 debug_event(event); debug("\n");
-                process_record(&tapping_key);
-                tapping_key = (keyrecord_t){};
-                debug_tapping_key();
+                settle_hold();
                 return false;
             }  else {
                 if (IS_TAPPING_KEY(event.key) && !event.pressed) {
@@ -211,6 +244,7 @@ bool process_tapping(keyrecord_t *keyp)
                         debug("Tapping: Start while last timeout tap(1).\n");
                     }
                     tapping_key = *keyp;
+                    TRACE_TAPPING_KEY(TRACE_TAPPING_START);
                     waiting_buffer_scan_tap();
                     debug_tapping_key();
                     return true;
@@ -236,6 +270,7 @@ bool process_tapping(keyrecord_t *keyp)
                         debug("Tapping: Tap press("); debug_dec(keyp->tap.count); debug(")\n");
                         process_record(keyp);
                         tapping_key = *keyp;
+                        TRACE_TAPPING_KEY(TRACE_TAPPING_TAP);
                         debug_tapping_key();
                         return true;
                     }
@@ -247,6 +282,7 @@ bool process_tapping(keyrecord_t *keyp)
                     // Sequential tap can be interfered with other tap key.
                     debug("Tapping: Start with interfering other tap.\n");
                     tapping_key = *keyp;
+                    TRACE_TAPPING_KEY(TRACE_TAPPING_START);
                     waiting_buffer_scan_tap();
                     debug_tapping_key();
                     return true;
@@ -254,6 +290,7 @@ bool process_tapping(keyrecord_t *keyp)
                     // should none in buffer
                     // FIX: interrupted when other key is pressed
                     tapping_key.tap.interrupted = true;
+                    TRACE_TAPPING_KEY(TRACE_TAPPING_INTERRUPT);
                     process_record(keyp);
                     return true;
                 }
@@ -267,6 +304,7 @@ bool process_tapping(keyrecord_t *keyp)
             // timeout. no sequential tap.
             debug("Tapping: End(Timeout after releasing last tap): ");
             debug_event(event); debug("\n");
+            TRACE_TAPPING_KEY(TRACE_TAPPING_END);
             tapping_key = (keyrecord_t){};
             debug_tapping_key();
             return false;
@@ -277,6 +315,7 @@ bool process_tapping(keyrecord_t *keyp)
         if (event.pressed && is_tap_key(event.key)) {
             debug("Tapping: Start(Press tap key).\n");
             tapping_key = *keyp;
+            TRACE_TAPPING_KEY(TRACE_TAPPING_START);
             waiting_buffer_scan_tap();
             debug_tapping_key();
             return true;
@@ -288,6 +327,16 @@ bool process_tapping(keyrecord_t *keyp)
 }
 
 
+/* the tap key turned out to be held: register it as such and stop tapping */
+void settle_hold(void)
+{
+    TRACE_TAPPING_KEY(TRACE_TAPPING_HOLD);
+    process_record(&tapping_key);
+    tapping_key = (keyrecord_t){};
+    debug_tapping_key();
+}
+
+
 /*
  * Waiting buffer
  */
@@ -305,10 +354,40 @@ bool waiting_buffer_enq(keyrecord_t record)
     waiting_buffer[waiting_buffer_head] = record;
     waiting_buffer_head = (waiting_buffer_head + 1) % WAITING_BUFFER_SIZE;
 
+    uint8_t waiting = (waiting_buffer_head + WAITING_BUFFER_SIZE - waiting_buffer_tail) % WAITING_BUFFER_SIZE;
+    if (waiting > stats.max_waiting) stats.max_waiting = waiting;
+
     debug("waiting_buffer_enq: "); debug_waiting_buffer();
     return true;
 }
 
+/* hand the buffered events to process_tapping until one has to wait again */
+void waiting_buffer_process(void)
+{
+    for (; waiting_buffer_tail != waiting_buffer_head; waiting_buffer_tail = (waiting_buffer_tail + 1) % WAITING_BUFFER_SIZE) {
+        if (process_tapping(&waiting_buffer[waiting_buffer_tail])) {
+            debug("processed: waiting_buffer["); debug_dec(waiting_buffer_tail); debug("] = ");
+            debug_record(waiting_buffer[waiting_buffer_tail]); debug("\n\n");
+        } else {
+            break;
+        }
+    }
+}
+
+/* Make room in a full buffer
+ * Only an undecided tap key holds events back for long, and so many keys
+ * typed under it mean it is being held: settle it and play what it held back.
+ */
+void waiting_buffer_spill(void)
+{
+    debug("waiting_buffer_enq: Over flow. Settle hold.\n");
+    stats.overflows++;
+    if (IS_TAPPING_PRESSED() && tapping_key.tap.count == 0) {
+        settle_hold();
+    }
+    waiting_buffer_process();
+}
+
 void waiting_buffer_clear(void)
 {
     waiting_buffer_head = 0;
@@ -17,6 +17,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef ACTION_TAPPING_H
 #define ACTION_TAPPING_H
 
+#include <stdint.h>
+
 
 
 /* period of tapping(ms) */
@@ -29,11 +31,26 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define TAPPING_TOGGLE  5
 #endif
 
+/* events held back while a tap key is undecided
+ * When it fills up the tap key is settled as a hold and the buffer is played,
+ * so a fast roll over a dual-role key loses no keystrokes.
+ */
+#ifndef WAITING_BUFFER_SIZE
 #define WAITING_BUFFER_SIZE 8
+#endif
 
 
 #ifndef NO_ACTION_TAPPING
+typedef struct {
+    uint16_t overflows;     // holds forced by a full waiting buffer
+    uint16_t early_holds;   // holds settled before TAPPING_TERM by PERMISSIVE_HOLD/HOLD_ON_OTHER_KEY_PRESS
+    uint8_t max_waiting;    // most events ever held back at once
+} tapping_stats_t;
+
 void action_tapping_process(keyrecord_t record);
+const tapping_stats_t *action_tapping_stats(void);
+void action_tapping_reset_stats(void);
+void action_tapping_print_stats(void);
 #endif
 
 #endif
@@ -20,6 +20,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action_util.h"
 #include "action_layer.h"
 #include "timer.h"
+#include "deadline.h"
 #include "keycode_config.h"
 
 extern keymap_config_t keymap_config;
@@ -57,10 +58,21 @@ int8_t get_oneshot_locked_mods(void) { return oneshot_locked_mods; }
 void set_oneshot_locked_mods(int8_t mods) { oneshot_locked_mods = mods; }
 void clear_oneshot_locked_mods(void) { oneshot_locked_mods = 0; }
 #if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
-static int16_t oneshot_time = 0;
+static uint32_t oneshot_time = 0;
 bool has_oneshot_mods_timed_out(void) {
-  return TIMER_DIFF_16(timer_read(), oneshot_time) >= ONESHOT_TIMEOUT;
+  return timer_elapsed32(oneshot_time) >= ONESHOT_TIMEOUT;
 }
+/* If a report went out with the mods, e.g. with another mod pressed, take
+ * them out when they time out rather than with the next report */
+static void oneshot_mods_timeout(deadline_t *deadline) {
+  if (oneshot_mods && has_oneshot_mods_timed_out()) {
+    bool reported = keyboard_report->mods & oneshot_mods & ~(real_mods | weak_mods | macro_mods);
+    dprintf("Oneshot: timeout\n");
+    clear_oneshot_mods();
+    if (reported) send_keyboard_report();
+  }
+}
+static deadline_t oneshot_mods_deadline = DEADLINE(oneshot_mods_timeout);
 #else
 bool has_oneshot_mods_timed_out(void) {
     return false;
@@ -82,11 +94,18 @@ inline uint8_t get_oneshot_layer(void) { return oneshot_layer_data >> 3; }
 inline uint8_t get_oneshot_layer_state(void) { return oneshot_layer_data & 0b111; }
 
 #if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
-static int16_t oneshot_layer_time = 0;
+static uint32_t oneshot_layer_time = 0;
 inline bool has_oneshot_layer_timed_out() {
-    return TIMER_DIFF_16(timer_read(), oneshot_layer_time) >= ONESHOT_TIMEOUT &&
+    return timer_elapsed32(oneshot_layer_time) >= ONESHOT_TIMEOUT &&
         !(get_oneshot_layer_state() & ONESHOT_TOGGLED);
 }
+static void oneshot_layer_timeout(deadline_t *deadline) {
+    if (get_oneshot_layer_state() && has_oneshot_layer_timed_out()) {
+        dprintf("Oneshot layer: timeout\n");
+        clear_oneshot_layer_state(ONESHOT_OTHER_KEY_PRESSED);
+    }
+}
+static deadline_t oneshot_layer_deadline = DEADLINE(oneshot_layer_timeout);
 #endif
 
 /* Oneshot layer */
@@ -95,13 +114,15 @@ void set_oneshot_layer(uint8_t layer, uint8_t state)
     oneshot_layer_data = layer << 3 | state;
     layer_on(layer);
 #if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
-    oneshot_layer_time = timer_read();
+    oneshot_layer_time = timer_read32();
+    deadline_in(&oneshot_layer_deadline, ONESHOT_TIMEOUT);
 #endif
 }
 void reset_oneshot_layer(void) {
     oneshot_layer_data = 0;
 #if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
     oneshot_layer_time = 0;
+    deadline_cancel(&oneshot_layer_deadline);
 #endif
 }
 void clear_oneshot_layer_state(oneshot_fullfillment_t state)
@@ -112,6 +133,7 @@ void clear_oneshot_layer_state(oneshot_fullfillment_t state)
         layer_off(get_oneshot_layer());
 #if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
     oneshot_layer_time = 0;
+    deadline_cancel(&oneshot_layer_deadline);
 #endif
     }
 }
@@ -202,7 +224,8 @@ void set_oneshot_mods(uint8_t mods)
 {
     oneshot_mods = mods;
 #if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
-    oneshot_time = timer_read();
+    oneshot_time = timer_read32();
+    deadline_in(&oneshot_mods_deadline, ONESHOT_TIMEOUT);
 #endif
 }
 void clear_oneshot_mods(void)
@@ -210,6 +233,7 @@ void clear_oneshot_mods(void)
     oneshot_mods = 0;
 #if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
     oneshot_time = 0;
+    deadline_cancel(&oneshot_mods_deadline);
 #endif
 }
 uint8_t get_oneshot_mods(void)
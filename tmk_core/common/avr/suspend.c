@@ -7,6 +7,7 @@
 #include "backlight.h"
 #include "suspend_avr.h"
 #include "suspend.h"
+#include "eeconfig.h"
 #include "timer.h"
 #include "led.h"
 #include "host.h"
@@ -105,6 +106,7 @@ static void power_down(uint8_t wdto)
 
 void suspend_power_down(void)
 {
+    eeconfig_flush();
 #ifndef NO_SUSPEND_POWER_DOWN
     power_down(WDTO_15MS);
 #endif
@@ -116,6 +116,28 @@ uint32_t timer_elapsed32(uint32_t last)
     return TIMER_DIFF_32(t, last);
 }
 
+#ifndef __AVR_ATmega32A__
+uint32_t timer_read_us32(void)
+{
+    uint32_t ms;
+    uint8_t ticks;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ms = timer_count;
+        ticks = TIMER_RAW;
+        // The compare match happened, but the interrupt hasn't run yet
+        if ((TIFR0 & _BV(OCF0A)) && ticks < TIMER_RAW_TOP / 2) {
+            ms++;
+        }
+    }
+    return ms * 1000 + (uint32_t)ticks * 1000 / TIMER_RAW_TOP;
+}
+#else
+uint32_t timer_read_us32(void)
+{
+    return timer_read32() * 1000;
+}
+#endif
+
 // excecuted once per 1ms.(excess for just timer count?)
 #ifndef __AVR_ATmega32A__
 #define TIMER_INTERRUPT_VECTOR TIMER0_COMPA_vect
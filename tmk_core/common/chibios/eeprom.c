@@ -1,6 +1,7 @@
 #include "ch.h"
 #include "hal.h"
 
+#include "eeprom.h"
 #include "eeconfig.h"
 
 /*************************************/
@@ -51,7 +52,7 @@
 // (aligned to 2 or 4 byte boundaries) has twice the endurance
 // compared to writing 8 bit bytes.
 //
-#define EEPROM_SIZE 32
+// EEPROM_SIZE is in eeprom_size.h, 32 unless config.h sets it.
 
 // Writing unaligned 16 or 32 bit data is handled automatically when
 // this is defined, but at a cost of extra code size.  Without this,
@@ -313,8 +314,6 @@ void do_flash_cmd(volatile uint8_t *fstat)
 extern uint32_t __eeprom_workarea_start__;
 extern uint32_t __eeprom_workarea_end__;
 
-#define EEPROM_SIZE 128
-
 static uint32_t flashend = 0;
 
 void eeprom_initialize(void)
@@ -504,16 +503,17 @@ void eeprom_write_block(const void *buf, void *addr, uint32_t len)
 #else
 // No EEPROM supported, so emulate it
 
-#define EEPROM_SIZE 32
 static uint8_t buffer[EEPROM_SIZE];
 
 uint8_t eeprom_read_byte(const uint8_t *addr) {
 	uint32_t offset = (uint32_t)addr;
+	if (offset >= EEPROM_SIZE) return 0xFF;
 	return buffer[offset];
 }
 
 void eeprom_write_byte(uint8_t *addr, uint8_t value) {
 	uint32_t offset = (uint32_t)addr;
+	if (offset >= EEPROM_SIZE) return;
 	buffer[offset] = value;
 }
 
@@ -559,30 +559,33 @@ void eeprom_write_block(const void *buf, void *addr, uint32_t len) {
 }
 
 #endif /* chip selection */
-// The update functions just calls write for now, but could probably be optimized
+// Writing a byte that didn't change still costs a write cycle, and on the
+// Teensy LC a record in the flash log, so the update functions skip those
 
 void eeprom_update_byte(uint8_t *addr, uint8_t value) {
-	eeprom_write_byte(addr, value);
+	if (eeprom_read_byte(addr) != value) {
+		eeprom_write_byte(addr, value);
+	}
 }
 
 void eeprom_update_word(uint16_t *addr, uint16_t value) {
 	uint8_t *p = (uint8_t *)addr;
-	eeprom_write_byte(p++, value);
-	eeprom_write_byte(p, value >> 8);
+	eeprom_update_byte(p++, value);
+	eeprom_update_byte(p, value >> 8);
 }
 
 void eeprom_update_dword(uint32_t *addr, uint32_t value) {
 	uint8_t *p = (uint8_t *)addr;
-	eeprom_write_byte(p++, value);
-	eeprom_write_byte(p++, value >> 8);
-	eeprom_write_byte(p++, value >> 16);
-	eeprom_write_byte(p, value >> 24);
+	eeprom_update_byte(p++, value);
+	eeprom_update_byte(p++, value >> 8);
+	eeprom_update_byte(p++, value >> 16);
+	eeprom_update_byte(p, value >> 24);
 }
 
 void eeprom_update_block(const void *buf, void *addr, uint32_t len) {
 	uint8_t *p = (uint8_t *)addr;
 	const uint8_t *src = (const uint8_t *)buf;
 	while (len--) {
-		eeprom_write_byte(p++, *src++);
+		eeprom_update_byte(p++, *src++);
 	}
 }
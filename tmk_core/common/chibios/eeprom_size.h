@@ -0,0 +1,40 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EEPROM_SIZE_H
+#define EEPROM_SIZE_H
+
+#include "hal.h"
+
+/* The bytes eeprom.c has for each chip, so that what is stored there can be
+ * checked against them at build time */
+#if defined(K20x)
+/* FlexRAM, a smaller size gives more wear leveling, see eeprom.c */
+#   ifndef EEPROM_SIZE
+#       define EEPROM_SIZE 32
+#   endif
+#elif defined(KL2x)
+/* emulated in flash */
+#   define EEPROM_SIZE 128
+#else
+/* emulated in RAM, not kept across resets */
+#   define EEPROM_SIZE 32
+#endif
+
+/* the last address, as avr-libc has it */
+#define E2END (EEPROM_SIZE - 1)
+
+#endif
@@ -25,3 +25,32 @@ uint32_t timer_elapsed32(uint32_t last)
 {
     return ST2MS(chVTTimeElapsedSinceX(MS2ST(last)));
 }
+
+/* The system time extended to 64 bits across its wraps, a 16 bit systime wraps
+ * after 65536 ticks. It has to be read at least once per wrap, keyboard_task
+ * does that on every loop. Callable from ISRs */
+static uint64_t read_ticks64(void)
+{
+    static systime_t last;
+    static uint64_t high;
+
+    syssts_t sts = chSysGetStatusAndLockX();
+    systime_t now = chVTGetSystemTimeX();
+    if (now < last) {
+        high += (uint64_t)1 << (sizeof(systime_t) * 8);
+    }
+    last = now;
+    uint64_t ticks = high + now;
+    chSysRestoreStatusX(sts);
+    return ticks;
+}
+
+/* Resolution of the system tick, callable from ISRs */
+uint32_t timer_read_us32(void)
+{
+#if CH_CFG_ST_FREQUENCY <= 1000000 && 1000000 % CH_CFG_ST_FREQUENCY == 0
+    return (uint32_t)read_ticks64() * (1000000 / CH_CFG_ST_FREQUENCY);
+#else
+    return (uint32_t)(read_ticks64() * 1000000 / CH_CFG_ST_FREQUENCY);
+#endif
+}
@@ -55,6 +55,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
     #include "audio.h"
 #endif /* AUDIO_ENABLE */
 
+#ifdef PROFILE_ENABLE
+    #include "profile.h"
+#endif
+#ifdef TRACE_ENABLE
+    #include "trace.h"
+#endif
+#ifdef SOF_SYNC_ENABLE
+    #include "sof_sync.h"
+#endif
+
 
 static bool command_common(uint8_t code);
 static void command_common_help(void);
@@ -170,6 +180,14 @@ static void command_common_help(void)
 #ifdef SLEEP_LED_ENABLE
 		STR(MAGIC_KEY_SLEEP_LED   ) ":	Sleep LED Test\n"
 #endif
+
+#ifdef PROFILE_ENABLE
+		STR(MAGIC_KEY_PROFILE     ) ":	Print and Reset Profile\n"
+#endif
+
+#ifdef TRACE_ENABLE
+		STR(MAGIC_KEY_TRACE       ) ":	Print and Clear Trace\n"
+#endif
     );
 }
 
@@ -216,6 +234,12 @@ static void print_version(void)
 #ifdef KEYMAP_SECTION_ENABLE
 	    " KEYMAP_SECTION"
 #endif
+#ifdef PROFILE_ENABLE
+	    " PROFILE"
+#endif
+#ifdef TRACE_ENABLE
+	    " TRACE"
+#endif
 
 	    " " STR(BOOTLOADER_SIZE) "\n");
 
@@ -322,6 +346,27 @@ static bool command_common(uint8_t code)
             break;
 #endif
 
+#ifdef PROFILE_ENABLE
+
+		// print scan and latency statistics, then start over
+        case MAGIC_KC(MAGIC_KEY_PROFILE):
+            profile_print();
+            profile_reset();
+#ifdef SOF_SYNC_ENABLE
+            sof_sync_print();
+            sof_sync_reset_stats();
+#endif
+            break;
+#endif
+
+#ifdef TRACE_ENABLE
+
+		// dump the event trace in hex, for util/trace_decode.py
+        case MAGIC_KC(MAGIC_KEY_TRACE):
+            trace_print();
+            break;
+#endif
+
 #ifdef BOOTMAGIC_ENABLE
 
 		// print stored eeprom config
@@ -374,6 +419,7 @@ static bool command_common(uint8_t code)
             #else
 	            wait_ms(1000);
             #endif
+            eeconfig_flush();
             bootloader_jump(); // not return
             break;
 
@@ -151,6 +151,14 @@ bool command_proc(uint8_t code);
 
 #endif
 
+#ifndef MAGIC_KEY_PROFILE
+#define MAGIC_KEY_PROFILE        P
+#endif
+
+#ifndef MAGIC_KEY_TRACE
+#define MAGIC_KEY_TRACE          T
+#endif
+
 #define XMAGIC_KC(key) KC_##key
 #define MAGIC_KC(key) XMAGIC_KC(key)
 
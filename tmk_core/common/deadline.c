@@ -0,0 +1,96 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "deadline.h"
+#include "timer.h"
+
+/* A keyboard has a handful of deadlines armed at a time, so they are kept
+ * in a list sorted by time rather than a timer wheel: checking for due ones
+ * only looks at the head, and arming walks the few in front of it. */
+static deadline_t *deadlines = NULL;
+
+/* a is before b, across the wraparound */
+#define BEFORE(a, b) ((int32_t)((a) - (b)) < 0)
+
+void deadline_cancel(deadline_t *deadline)
+{
+    if (!deadline->pending) return;
+    for (deadline_t **link = &deadlines; *link; link = &(*link)->next) {
+        if (*link == deadline) {
+            *link = deadline->next;
+            break;
+        }
+    }
+    deadline->next = NULL;
+    deadline->pending = false;
+}
+
+/* set while deadline_task calls back, to when it was called */
+static bool running = false;
+static uint32_t running_time;
+
+void deadline_at(deadline_t *deadline, uint32_t time)
+{
+    deadline_cancel(deadline);
+    // a callback arming a deadline that is already due would be called
+    // again and again, so it waits until the next millisecond
+    if (running && !BEFORE(running_time, time)) {
+        time = running_time + 1;
+    }
+    deadline->time = time;
+    // after the ones with the same time, so that they are called in order
+    deadline_t **link = &deadlines;
+    while (*link && !BEFORE(time, (*link)->time)) {
+        link = &(*link)->next;
+    }
+    deadline->next = *link;
+    *link = deadline;
+    deadline->pending = true;
+}
+
+void deadline_in(deadline_t *deadline, uint32_t ms)
+{
+    deadline_at(deadline, timer_read32() + ms);
+}
+
+bool deadline_pending(const deadline_t *deadline)
+{
+    return deadline->pending;
+}
+
+void deadline_task(void)
+{
+    if (!deadlines) return;
+    uint32_t now = timer_read32();
+    running = true;
+    running_time = now;
+    while (deadlines && !BEFORE(now, deadlines->time)) {
+        deadline_t *deadline = deadlines;
+        deadlines = deadline->next;
+        deadline->next = NULL;
+        deadline->pending = false;
+        deadline->callback(deadline);
+    }
+    running = false;
+}
+
+uint32_t deadline_next(void)
+{
+    if (!deadlines) return DEADLINE_NONE;
+    uint32_t now = timer_read32();
+    if (BEFORE(now, deadlines->time)) return deadlines->time - now;
+    return 0;
+}
@@ -0,0 +1,75 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEADLINE_H
+#define DEADLINE_H
+
+/* Deadlines shared by the features that have to do something a while after
+ * a key event or at an interval (combo and tap dance terms, leader and
+ * oneshot timeouts, mousekey repeat, rgblight effects, music playback), so
+ * that they don't each have to compare a timer on every scan.
+ *
+ * A feature keeps a deadline_t and arms it; keyboard_task calls
+ * deadline_task, which calls it back once the time has come. Times are
+ * timer_read32 milliseconds and compared so that they wrap around safely,
+ * as long as a deadline is less than 24 days away.
+ *
+ *   static void combo_timeout(deadline_t *deadline) { ... }
+ *   static deadline_t combo_deadline = DEADLINE(combo_timeout);
+ *
+ *   deadline_in(&combo_deadline, COMBO_TERM + 1);
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct deadline_t deadline_t;
+typedef void (*deadline_callback_t)(deadline_t *deadline);
+
+struct deadline_t {
+    deadline_t *next;
+    uint32_t time;
+    deadline_callback_t callback;
+    bool pending;
+};
+
+#define DEADLINE(callback) { NULL, 0, (callback), false }
+
+#define DEADLINE_NONE UINT32_MAX
+
+/* (Re)arm a deadline, at a timer_read32 time or in ms from now */
+void deadline_at(deadline_t *deadline, uint32_t time);
+void deadline_in(deadline_t *deadline, uint32_t ms);
+void deadline_cancel(deadline_t *deadline);
+bool deadline_pending(const deadline_t *deadline);
+
+/* Calls back the deadlines that are due, in order. A callback can arm any
+ * deadline, but not for before the next millisecond. */
+void deadline_task(void);
+/* ms until the next deadline, 0 if one is due, DEADLINE_NONE if none is
+ * armed: how long the keyboard can sleep if no key changes */
+uint32_t deadline_next(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -2,55 +2,171 @@
 #include <stdbool.h>
 #include "eeprom.h"
 #include "eeconfig.h"
+#ifdef EECONFIG_WRITE_DELAY
+#include "timer.h"
+#include "deadline.h"
+#endif
+#ifdef DYNAMIC_KEYMAP_ENABLE
+#include "dynamic_keymap.h"
+#endif
+
+#ifdef EECONFIG_WRITE_DELAY
+/* Settings changed from keys, like sweeping the RGB hue while holding a key,
+ * would otherwise write the EEPROM on every repeat.  They are kept in RAM
+ * once eeconfig_load() has run, and only the bytes that changed are written
+ * back, EECONFIG_WRITE_DELAY ms after the last change but at most
+ * EECONFIG_WRITE_DELAY_MAX ms after the first one.
+ */
+#ifndef EECONFIG_WRITE_DELAY_MAX
+#define EECONFIG_WRITE_DELAY_MAX (4 * EECONFIG_WRITE_DELAY)
+#endif
+
+static uint8_t shadow[EECONFIG_SIZE];
+static uint16_t dirty;
+static uint32_t dirty_since;
+static bool loaded;
+
+static void flush_callback(deadline_t *deadline)
+{
+    eeconfig_flush();
+}
+
+static deadline_t flush_deadline = DEADLINE(flush_callback);
+
+void eeconfig_load(void)
+{
+    deadline_cancel(&flush_deadline);
+    eeprom_read_block(shadow, (const void *)0, EECONFIG_SIZE);
+    dirty = 0;
+    loaded = true;
+}
+
+void eeconfig_flush(void)
+{
+    deadline_cancel(&flush_deadline);
+    for (uint8_t i = 0; dirty; i++, dirty >>= 1) {
+        if (dirty & 1) {
+            eeprom_update_byte((uint8_t *)(uintptr_t)i, shadow[i]);
+        }
+    }
+}
+
+uint8_t eeconfig_read_byte(const uint8_t *addr)
+{
+    uintptr_t offset = (uintptr_t)addr;
+
+    if (!loaded || offset >= EECONFIG_SIZE) return eeprom_read_byte(addr);
+    return shadow[offset];
+}
+
+void eeconfig_update_byte(uint8_t *addr, uint8_t val)
+{
+    uintptr_t offset = (uintptr_t)addr;
+
+    if (!loaded || offset >= EECONFIG_SIZE) {
+        eeprom_update_byte(addr, val);
+        return;
+    }
+    if (shadow[offset] == val) return;
+    shadow[offset] = val;
+
+    uint32_t now = timer_read32();
+    if (!dirty) dirty_since = now;
+    dirty |= 1 << offset;
+    uint32_t latest = dirty_since + EECONFIG_WRITE_DELAY_MAX;
+    uint32_t time = now + EECONFIG_WRITE_DELAY;
+    if ((int32_t)(time - latest) > 0) time = latest;
+    deadline_at(&flush_deadline, time);
+}
+
+uint16_t eeconfig_read_word(const uint16_t *addr)
+{
+    const uint8_t *p = (const uint8_t *)addr;
+    return eeconfig_read_byte(p) | (eeconfig_read_byte(p + 1) << 8);
+}
+
+void eeconfig_update_word(uint16_t *addr, uint16_t val)
+{
+    uint8_t *p = (uint8_t *)addr;
+    eeconfig_update_byte(p, val);
+    eeconfig_update_byte(p + 1, val >> 8);
+}
+
+uint32_t eeconfig_read_dword(const uint32_t *addr)
+{
+    const uint8_t *p = (const uint8_t *)addr;
+    return eeconfig_read_word((const uint16_t *)p) | ((uint32_t)eeconfig_read_word((const uint16_t *)(p + 2)) << 16);
+}
+
+void eeconfig_update_dword(uint32_t *addr, uint32_t val)
+{
+    uint8_t *p = (uint8_t *)addr;
+    eeconfig_update_word((uint16_t *)p, val);
+    eeconfig_update_word((uint16_t *)(p + 2), val >> 16);
+}
+#else
+void eeconfig_load(void) {}
+void eeconfig_flush(void) {}
+
+uint8_t eeconfig_read_byte(const uint8_t *addr)          { return eeprom_read_byte(addr); }
+void eeconfig_update_byte(uint8_t *addr, uint8_t val)     { eeprom_update_byte(addr, val); }
+uint16_t eeconfig_read_word(const uint16_t *addr)        { return eeprom_read_word(addr); }
+void eeconfig_update_word(uint16_t *addr, uint16_t val)   { eeprom_update_word(addr, val); }
+uint32_t eeconfig_read_dword(const uint32_t *addr)       { return eeprom_read_dword(addr); }
+void eeconfig_update_dword(uint32_t *addr, uint32_t val)  { eeprom_update_dword(addr, val); }
+#endif
 
 void eeconfig_init(void)
 {
-    eeprom_update_word(EECONFIG_MAGIC,          EECONFIG_MAGIC_NUMBER);
-    eeprom_update_byte(EECONFIG_DEBUG,          0);
-    eeprom_update_byte(EECONFIG_DEFAULT_LAYER,  0);
-    eeprom_update_byte(EECONFIG_KEYMAP,         0);
-    eeprom_update_byte(EECONFIG_MOUSEKEY_ACCEL, 0);
+    eeconfig_update_word(EECONFIG_MAGIC,          EECONFIG_MAGIC_NUMBER);
+    eeconfig_update_byte(EECONFIG_DEBUG,          0);
+    eeconfig_update_byte(EECONFIG_DEFAULT_LAYER,  0);
+    eeconfig_update_byte(EECONFIG_KEYMAP,         0);
+    eeconfig_update_byte(EECONFIG_MOUSEKEY_ACCEL, 0);
 #ifdef BACKLIGHT_ENABLE
-    eeprom_update_byte(EECONFIG_BACKLIGHT,      0);
+    eeconfig_update_byte(EECONFIG_BACKLIGHT,      0);
 #endif
 #ifdef AUDIO_ENABLE
-    eeprom_update_byte(EECONFIG_AUDIO,             0xFF); // On by default
+    eeconfig_update_byte(EECONFIG_AUDIO,             0xFF); // On by default
 #endif
 #ifdef RGBLIGHT_ENABLE
-    eeprom_update_dword(EECONFIG_RGBLIGHT,      0);
+    eeconfig_update_dword(EECONFIG_RGBLIGHT,      0);
+#endif
+#ifdef DYNAMIC_KEYMAP_ENABLE
+    dynamic_keymap_reset();
 #endif
 }
 
 void eeconfig_enable(void)
 {
-    eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER);
+    eeconfig_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER);
 }
 
 void eeconfig_disable(void)
 {
-    eeprom_update_word(EECONFIG_MAGIC, 0xFFFF);
+    eeconfig_update_word(EECONFIG_MAGIC, 0xFFFF);
 }
 
 bool eeconfig_is_enabled(void)
 {
-    return (eeprom_read_word(EECONFIG_MAGIC) == EECONFIG_MAGIC_NUMBER);
+    return (eeconfig_read_word(EECONFIG_MAGIC) == EECONFIG_MAGIC_NUMBER);
 }
 
-uint8_t eeconfig_read_debug(void)      { return eeprom_read_byte(EECONFIG_DEBUG); }
-void eeconfig_update_debug(uint8_t val) { eeprom_update_byte(EECONFIG_DEBUG, val); }
+uint8_t eeconfig_read_debug(void)      { return eeconfig_read_byte(EECONFIG_DEBUG); }
+void eeconfig_update_debug(uint8_t val) { eeconfig_update_byte(EECONFIG_DEBUG, val); }
 
-uint8_t eeconfig_read_default_layer(void)      { return eeprom_read_byte(EECONFIG_DEFAULT_LAYER); }
-void eeconfig_update_default_layer(uint8_t val) { eeprom_update_byte(EECONFIG_DEFAULT_LAYER, val); }
+uint8_t eeconfig_read_default_layer(void)      { return eeconfig_read_byte(EECONFIG_DEFAULT_LAYER); }
+void eeconfig_update_default_layer(uint8_t val) { eeconfig_update_byte(EECONFIG_DEFAULT_LAYER, val); }
 
-uint8_t eeconfig_read_keymap(void)      { return eeprom_read_byte(EECONFIG_KEYMAP); }
-void eeconfig_update_keymap(uint8_t val) { eeprom_update_byte(EECONFIG_KEYMAP, val); }
+uint8_t eeconfig_read_keymap(void)      { return eeconfig_read_byte(EECONFIG_KEYMAP); }
+void eeconfig_update_keymap(uint8_t val) { eeconfig_update_byte(EECONFIG_KEYMAP, val); }
 
 #ifdef BACKLIGHT_ENABLE
-uint8_t eeconfig_read_backlight(void)      { return eeprom_read_byte(EECONFIG_BACKLIGHT); }
-void eeconfig_update_backlight(uint8_t val) { eeprom_update_byte(EECONFIG_BACKLIGHT, val); }
+uint8_t eeconfig_read_backlight(void)      { return eeconfig_read_byte(EECONFIG_BACKLIGHT); }
+void eeconfig_update_backlight(uint8_t val) { eeconfig_update_byte(EECONFIG_BACKLIGHT, val); }
 #endif
 
 #ifdef AUDIO_ENABLE
-uint8_t eeconfig_read_audio(void)      { return eeprom_read_byte(EECONFIG_AUDIO); }
-void eeconfig_update_audio(uint8_t val) { eeprom_update_byte(EECONFIG_AUDIO, val); }
+uint8_t eeconfig_read_audio(void)      { return eeconfig_read_byte(EECONFIG_AUDIO); }
+void eeconfig_update_audio(uint8_t val) { eeconfig_update_byte(EECONFIG_AUDIO, val); }
 #endif
@@ -35,6 +35,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define EECONFIG_RGBLIGHT                           (uint32_t *)8
 #define EECONFIG_UNICODEMODE                        (uint8_t *)12
 
+/* bytes used by the settings above */
+#define EECONFIG_SIZE                               13
+
 
 /* debug bit */
 #define EECONFIG_DEBUG_ENABLE                       (1<<0)
@@ -80,4 +83,22 @@ uint8_t eeconfig_read_audio(void);
 void eeconfig_update_audio(uint8_t val);
 #endif
 
+/* Access to any of the settings above, for features without their own
+ * eeconfig_*() pair.  With EECONFIG_WRITE_DELAY these go through a copy in
+ * RAM, which is written back EECONFIG_WRITE_DELAY ms after the last change,
+ * on suspend and before jumping to the bootloader.  Reading the settings
+ * with eeprom_read_*() directly may then return stale values.
+ */
+uint8_t eeconfig_read_byte(const uint8_t *addr);
+void eeconfig_update_byte(uint8_t *addr, uint8_t val);
+uint16_t eeconfig_read_word(const uint16_t *addr);
+void eeconfig_update_word(uint16_t *addr, uint16_t val);
+uint32_t eeconfig_read_dword(const uint32_t *addr);
+void eeconfig_update_dword(uint32_t *addr, uint32_t val);
+
+/* read the settings into RAM, dropping changes not written yet */
+void eeconfig_load(void);
+/* write the changed settings to EEPROM now */
+void eeconfig_flush(void);
+
 #endif
@@ -21,6 +21,18 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "host.h"
 #include "util.h"
 #include "debug.h"
+#ifdef COALESCE_KEYBOARD_REPORTS
+#   include <string.h>
+#endif
+#if defined(COALESCE_KEYBOARD_REPORTS) || defined(TRACE_ENABLE)
+#   include "keycode_config.h"
+#endif
+#ifdef PROFILE_ENABLE
+#   include "profile.h"
+#endif
+#ifdef TRACE_ENABLE
+#   include "trace.h"
+#endif
 
 static host_driver_t *driver;
 static uint16_t last_system_report = 0;
@@ -42,10 +54,33 @@ uint8_t host_keyboard_leds(void)
     if (!driver) return 0;
     return (*driver->keyboard_leds)();
 }
-/* send report */
-void host_keyboard_send(report_keyboard_t *report)
+#ifdef TRACE_ENABLE
+static uint8_t count_keys(report_keyboard_t *report)
 {
-    if (!driver) return;
+    uint8_t count = 0;
+#ifdef NKRO_ENABLE
+    if (keyboard_protocol && keymap_config.nkro) {
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_BITS; i++) {
+            count += bitpop(report->nkro.bits[i]);
+        }
+        return count;
+    }
+#endif
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (report->keys[i]) count++;
+    }
+    return count;
+}
+#endif
+
+static void send_keyboard(report_keyboard_t *report)
+{
+#ifdef PROFILE_ENABLE
+    profile_keyboard_report();
+#endif
+#ifdef TRACE_ENABLE
+    trace_record(TRACE_REPORT, report->mods, count_keys(report));
+#endif
     (*driver->send_keyboard)(report);
 
     if (debug_keyboard) {
@@ -57,6 +92,140 @@ void host_keyboard_send(report_keyboard_t *report)
     }
 }
 
+#ifdef COALESCE_KEYBOARD_REPORTS
+/* The reports are staged, and later reports merged into the staged one, as
+ * long as the host still sees every key and modifier change in the same order.
+ * The staged report is sent when the driver is ready, at the latest at the end
+ * of the scan.
+ */
+static report_keyboard_t sent_report;
+static report_keyboard_t staged_report;
+static bool report_staged = false;
+
+/* sent_report only tells what the host has seen with the same protocol and
+ * NKRO setting, after a switch the next report is always sent. Without
+ * NKRO_ENABLE the report is the same in both protocols. */
+#ifdef NKRO_ENABLE
+static uint8_t report_format(void)
+{
+    return (keyboard_protocol ? 1 : 0) | (keymap_config.nkro ? 2 : 0);
+}
+#else
+#   define report_format() 0
+#endif
+static uint8_t sent_format = 0;
+static uint8_t staged_format;
+
+/* sets a bit for every key that is only in one of the reports */
+static void get_key_changes(report_keyboard_t *a, report_keyboard_t *b, uint8_t changes[32])
+{
+    memset(changes, 0, 32);
+#ifdef NKRO_ENABLE
+    if (keyboard_protocol && keymap_config.nkro) {
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_BITS && i < 32; i++) {
+            changes[i] = a->nkro.bits[i] ^ b->nkro.bits[i];
+        }
+        return;
+    }
+#endif
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (a->keys[i]) changes[a->keys[i] >> 3] ^= 1 << (a->keys[i] & 7);
+        if (b->keys[i]) changes[b->keys[i] >> 3] ^= 1 << (b->keys[i] & 7);
+    }
+}
+
+static bool has_changes(uint8_t changes[32])
+{
+    for (uint8_t i = 0; i < 32; i++) {
+        if (changes[i]) return true;
+    }
+    return false;
+}
+
+static bool can_merge(report_keyboard_t *report)
+{
+    uint8_t staged_mods = sent_report.mods ^ staged_report.mods;
+    uint8_t new_mods = staged_report.mods ^ report->mods;
+    /* a modifier tap would be lost */
+    if (staged_mods & new_mods) return false;
+
+    uint8_t staged_keys[32];
+    uint8_t new_keys[32];
+    get_key_changes(&sent_report, &staged_report, staged_keys);
+    get_key_changes(&staged_report, report, new_keys);
+    bool staged_has_keys = false;
+    bool new_has_keys = false;
+    for (uint8_t i = 0; i < 32; i++) {
+        /* a key tap would be lost */
+        if (staged_keys[i] & new_keys[i]) return false;
+        staged_has_keys |= staged_keys[i];
+        new_has_keys |= new_keys[i];
+    }
+
+    /* the modifiers have to be pressed before and released after the keys */
+    if ((staged_mods && new_has_keys) || (staged_has_keys && new_mods)) return false;
+    return true;
+}
+
+void host_keyboard_send(report_keyboard_t *report)
+{
+    if (!driver) return;
+    uint8_t format = report_format();
+    /* staged in the old format, this report replaces it */
+    if (report_staged && staged_format != format) {
+        report_staged = false;
+    }
+    if (report_staged) {
+        if (can_merge(report)) {
+            staged_report = *report;
+            return;
+        }
+        host_keyboard_flush();
+    }
+
+    if (format == sent_format) {
+        uint8_t changes[32];
+        get_key_changes(&sent_report, report, changes);
+        if (report->mods == sent_report.mods && !has_changes(changes)) return;
+    }
+
+    staged_report = *report;
+    staged_format = format;
+    report_staged = true;
+}
+
+void host_keyboard_flush(void)
+{
+    if (!report_staged || !driver) return;
+    report_staged = false;
+    /* switched since, the next report goes out in the new format */
+    if (staged_format != report_format()) return;
+    sent_report = staged_report;
+    sent_format = staged_format;
+    send_keyboard(&sent_report);
+}
+
+void host_keyboard_task(void)
+{
+    if (host_keyboard_ready()) {
+        host_keyboard_flush();
+    }
+}
+
+__attribute__ ((weak))
+bool host_keyboard_ready(void)
+{
+    return true;
+}
+#else
+/* send report */
+void host_keyboard_send(report_keyboard_t *report)
+{
+    if (!driver) return;
+    send_keyboard(report);
+}
+#endif
+
 void host_mouse_send(report_mouse_t *report)
 {
     if (!driver) return;
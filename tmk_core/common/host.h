@@ -39,6 +39,14 @@ host_driver_t *host_get_driver(void);
 /* host driver interface */
 uint8_t host_keyboard_leds(void);
 void host_keyboard_send(report_keyboard_t *report);
+#ifdef COALESCE_KEYBOARD_REPORTS
+/* send the staged keyboard report now */
+void host_keyboard_flush(void);
+/* send the staged keyboard report if the driver is ready for it */
+void host_keyboard_task(void);
+/* can the driver send a keyboard report without waiting */
+bool host_keyboard_ready(void);
+#endif
 void host_mouse_send(report_mouse_t *report);
 void host_system_send(uint16_t data);
 void host_consumer_send(uint16_t data);
@@ -0,0 +1,54 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "key_event_queue.h"
+
+#define MASK (KEY_EVENT_QUEUE_SIZE - 1)
+
+/* Keeps the compiler from moving memory accesses across the index updates */
+#define barrier() __asm__ __volatile__("" ::: "memory")
+
+void key_event_queue_init(key_event_queue_t *queue)
+{
+    queue->head = 0;
+    queue->tail = 0;
+}
+
+bool key_event_queue_push(key_event_queue_t *queue, keyevent_t event)
+{
+    uint8_t tail = queue->tail;
+    if ((uint8_t)(tail - queue->head) == KEY_EVENT_QUEUE_SIZE) return false;
+    queue->events[tail & MASK] = event;
+    barrier();
+    queue->tail = tail + 1;
+    return true;
+}
+
+bool key_event_queue_pop(key_event_queue_t *queue, keyevent_t *event)
+{
+    uint8_t head = queue->head;
+    if (head == queue->tail) return false;
+    barrier();
+    *event = queue->events[head & MASK];
+    barrier();
+    queue->head = head + 1;
+    return true;
+}
+
+bool key_event_queue_empty(const key_event_queue_t *queue)
+{
+    return queue->head == queue->tail;
+}
@@ -0,0 +1,62 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEY_EVENT_QUEUE_H
+#define KEY_EVENT_QUEUE_H
+
+/* Lock-free queue of key events from one producer to one consumer, e.g.
+ * from the matrix scan thread to the thread that runs the actions.
+ *
+ * Only the producer writes the tail and only the consumer the head, and an
+ * event is written before the tail moves past it, so neither side has to
+ * lock, as long as the index writes are atomic (single core MCUs).
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "keyboard.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A power of two, up to 128 */
+#ifndef KEY_EVENT_QUEUE_SIZE
+#   define KEY_EVENT_QUEUE_SIZE 32
+#endif
+
+#if (KEY_EVENT_QUEUE_SIZE & (KEY_EVENT_QUEUE_SIZE - 1)) || KEY_EVENT_QUEUE_SIZE > 128
+#   error "KEY_EVENT_QUEUE_SIZE must be a power of two up to 128"
+#endif
+
+typedef struct {
+    keyevent_t events[KEY_EVENT_QUEUE_SIZE];
+    volatile uint8_t head;
+    volatile uint8_t tail;
+} key_event_queue_t;
+
+void key_event_queue_init(key_event_queue_t *queue);
+/* Producer side, false if the queue is full */
+bool key_event_queue_push(key_event_queue_t *queue, keyevent_t event);
+/* Consumer side, false if the queue is empty */
+bool key_event_queue_pop(key_event_queue_t *queue, keyevent_t *event);
+bool key_event_queue_empty(const key_event_queue_t *queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -31,6 +31,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "eeconfig.h"
 #include "backlight.h"
 #include "action_layer.h"
+#include "deadline.h"
+#include "scheduler.h"
+#include "trace.h"
+#ifdef ASYNC_MACRO
+#   include "action_macro.h"
+#endif
 #ifdef BOOTMAGIC_ENABLE
 #   include "bootmagic.h"
 #else
@@ -60,8 +66,25 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef VISUALIZER_ENABLE
 #   include "visualizer/visualizer.h"
 #endif
+#ifdef PROFILE_ENABLE
+#   include "profile.h"
+#endif
+#ifdef SOF_SYNC_ENABLE
+#   include "sof_sync.h"
+#endif
+#ifdef MATRIX_SCAN_THREAD
+#   include "key_event_queue.h"
+#   ifdef SOF_SYNC_ENABLE
+#       error "SOF_SYNC_ENABLE paces the scan in keyboard_task, it can't be used with MATRIX_SCAN_THREAD"
+#   endif
+#endif
+
 
 
+#ifdef MATRIX_SCAN_THREAD
+/* from the scan thread to keyboard_task */
+static key_event_queue_t key_events;
+#endif
 
 #ifdef MATRIX_HAS_GHOST
 static bool has_ghost_in_row(uint8_t row)
@@ -80,6 +103,32 @@ static bool has_ghost_in_row(uint8_t row)
 }
 #endif
 
+/* The jobs of keyboard_task after the keys, see scheduler.h */
+#ifdef ASYNC_MACRO
+// play the queued macros and strings
+static scheduled_task_t action_macro_scheduled = SCHEDULED_TASK(action_macro_task, 0, TASK_PRIORITY_HIGH);
+#endif
+#ifdef SERIAL_LINK_ENABLE
+// the keys of the other half come over the link
+static scheduled_task_t serial_link_scheduled = SCHEDULED_TASK(serial_link_update, 0, TASK_PRIORITY_HIGH);
+#endif
+#ifdef PS2_MOUSE_ENABLE
+static scheduled_task_t ps2_mouse_scheduled = SCHEDULED_TASK(ps2_mouse_task, 0, TASK_PRIORITY_NORMAL);
+#endif
+#ifdef SERIAL_MOUSE_ENABLE
+static scheduled_task_t serial_mouse_scheduled = SCHEDULED_TASK(serial_mouse_task, 0, TASK_PRIORITY_NORMAL);
+#endif
+#ifdef ADB_MOUSE_ENABLE
+static scheduled_task_t adb_mouse_scheduled = SCHEDULED_TASK(adb_mouse_task, 0, TASK_PRIORITY_NORMAL);
+#endif
+#ifdef VISUALIZER_ENABLE
+static void visualizer_task(void)
+{
+    visualizer_update(default_layer_state, layer_state, visualizer_get_mods(), host_keyboard_leds());
+}
+static scheduled_task_t visualizer_scheduled = SCHEDULED_TASK(visualizer_task, 0, TASK_PRIORITY_LOW);
+#endif
+
 __attribute__ ((weak))
 void matrix_setup(void) {
 }
@@ -90,6 +139,21 @@ void keyboard_setup(void) {
 
 void keyboard_init(void) {
     timer_init();
+#ifdef EECONFIG_WRITE_DELAY
+    eeconfig_load();
+#endif
+#ifdef PROFILE_ENABLE
+    profile_init();
+#endif
+#ifdef SOF_SYNC_ENABLE
+    sof_sync_init();
+#endif
+#ifdef TRACE_ENABLE
+    trace_init();
+#endif
+#ifdef MATRIX_SCAN_THREAD
+    key_event_queue_init(&key_events);
+#endif
     matrix_init();
 #ifdef PS2_MOUSE_ENABLE
     ps2_mouse_init();
@@ -117,85 +181,181 @@ void keyboard_init(void) {
 #if defined(NKRO_ENABLE) && defined(FORCE_NKRO)
     keymap_config.nkro = 1;
 #endif
+#ifdef ASYNC_MACRO
+    scheduler_add(&action_macro_scheduled);
+#endif
+#ifdef SERIAL_LINK_ENABLE
+    scheduler_add(&serial_link_scheduled);
+#endif
+#ifdef PS2_MOUSE_ENABLE
+    scheduler_add(&ps2_mouse_scheduled);
+#endif
+#ifdef SERIAL_MOUSE_ENABLE
+    scheduler_add(&serial_mouse_scheduled);
+#endif
+#ifdef ADB_MOUSE_ENABLE
+    scheduler_add(&adb_mouse_scheduled);
+#endif
+#ifdef VISUALIZER_ENABLE
+    scheduler_add(&visualizer_scheduled);
+#endif
 }
 
-/*
- * Do keyboard routine jobs: scan mantrix, light LEDs, ...
- * This is repeatedly called as fast as possible.
- */
-void keyboard_task(void)
-{
-    static matrix_row_t matrix_prev[MATRIX_ROWS];
+#ifdef QMK_KEYS_PER_SCAN
+#   define KEYS_PER_TASK QMK_KEYS_PER_SCAN
+#else
+#   define KEYS_PER_TASK 1
+#endif
+
+static matrix_row_t matrix_prev[MATRIX_ROWS];
+#ifndef MATRIX_SCAN_THREAD
+// the scheduler budget starts here, so that a slow scan doesn't use it up
+static uint32_t scan_end_us;
+#endif
 #ifdef MATRIX_HAS_GHOST
-    static matrix_row_t matrix_ghost[MATRIX_ROWS];
+static matrix_row_t matrix_ghost[MATRIX_ROWS];
 #endif
-    static uint8_t led_status = 0;
+
+/* Scan the matrix and pass up to max changed keys to handle, stamped with the
+ * time they were found. A key only counts as processed when handle accepts
+ * it, the others are found again by the next scan.
+ */
+static uint8_t matrix_scan_changes(bool (*handle)(keyevent_t), uint8_t max)
+{
     matrix_row_t matrix_row = 0;
     matrix_row_t matrix_change = 0;
+    uint8_t keys_processed = 0;
 
+#if defined(PROFILE_ENABLE) && !defined(MATRIX_SCAN_THREAD)
+    profile_scan_start();
+#endif
     matrix_scan();
+#ifndef MATRIX_SCAN_THREAD
+#   ifdef PROFILE_ENABLE
+    profile_scan_end();
+#   endif
+    scan_end_us = timer_read_us32();
+#endif
     for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
         matrix_row = matrix_get_row(r);
         matrix_change = matrix_row ^ matrix_prev[r];
         if (matrix_change) {
+#if defined(PROFILE_ENABLE) && !defined(MATRIX_SCAN_THREAD)
+            profile_matrix_changed();
+#endif
 #ifdef MATRIX_HAS_GHOST
             if (has_ghost_in_row(r)) {
                 /* Keep track of whether ghosted status has changed for
                  * debugging. But don't update matrix_prev until un-ghosted, or
                  * the last key would be lost.
                  */
+#ifndef MATRIX_SCAN_THREAD
                 if (debug_matrix && matrix_ghost[r] != matrix_row) {
                     matrix_print();
                 }
+#endif
                 matrix_ghost[r] = matrix_row;
                 continue;
             }
             matrix_ghost[r] = matrix_row;
 #endif
+#ifndef MATRIX_SCAN_THREAD
             if (debug_matrix) matrix_print();
+#endif
             for (uint8_t c = 0; c < MATRIX_COLS; c++) {
                 if (matrix_change & ((matrix_row_t)1<<c)) {
-                    action_exec((keyevent_t){
+                    keyevent_t event = {
                         .key = (keypos_t){ .row = r, .col = c },
                         .pressed = (matrix_row & ((matrix_row_t)1<<c)),
                         .time = (timer_read() | 1) /* time should not be 0 */
-                    });
+                    };
+                    if (!handle(event)) return keys_processed;
                     // record a processed key
                     matrix_prev[r] ^= ((matrix_row_t)1<<c);
-                    // process a key per task call
-                    goto MATRIX_LOOP_END;
+                    if (++keys_processed >= max) return keys_processed;
                 }
             }
         }
     }
-    // call with pseudo tick event when no real key event.
-    action_exec(TICK);
+    return keys_processed;
+}
 
-MATRIX_LOOP_END:
+#ifdef MATRIX_SCAN_THREAD
+static bool queue_event(keyevent_t event)
+{
+    return key_event_queue_push(&key_events, event);
+}
 
-#ifdef MOUSEKEY_ENABLE
-    // mousekey repeat & acceleration
-    mousekey_task();
-#endif
+uint8_t keyboard_scan_task(void)
+{
+    return matrix_scan_changes(queue_event, UINT8_MAX);
+}
 
-#ifdef PS2_MOUSE_ENABLE
-    ps2_mouse_task();
+uint32_t keyboard_idle_time(void)
+{
+    if (!key_event_queue_empty(&key_events)) return 0;
+    return deadline_next();
+}
+#else
+static bool exec_event(keyevent_t event)
+{
+    TRACE(TRACE_MATRIX, event.pressed, TRACE_KEY(event.key));
+    action_exec(event);
+    return true;
+}
 #endif
 
-#ifdef SERIAL_MOUSE_ENABLE
-    serial_mouse_task();
+/*
+ * Do keyboard routine jobs: scan mantrix, light LEDs, ...
+ * This is repeatedly called as fast as possible.
+ */
+void keyboard_task(void)
+{
+    static uint8_t led_status = 0;
+    uint8_t keys_processed = 0;
+
+#ifdef SOF_SYNC_ENABLE
+    // one scan per USB frame, just in time for the next poll
+    if (!sof_sync_scan_due(timer_read_us32())) return;
+    sof_sync_scan_start(timer_read_us32());
 #endif
 
-#ifdef ADB_MOUSE_ENABLE
-    adb_mouse_task();
+    uint32_t loop_start = timer_read_us32();
+
+    // combo and tap dance terms, leader and oneshot timeouts
+    deadline_task();
+
+#ifdef MATRIX_SCAN_THREAD
+    // the scan thread only reads the matrix, what acts on keys or prints
+    // runs here, on the same thread as action_exec
+    matrix_scan_hooks();
+    // the scan thread has queued the changes
+    keyevent_t event;
+    while (keys_processed < KEYS_PER_TASK && key_event_queue_pop(&key_events, &event)) {
+        TRACE(TRACE_MATRIX, event.pressed, TRACE_KEY(event.key));
+#   ifdef PROFILE_ENABLE
+        profile_matrix_changed();
+#   endif
+        action_exec(event);
+        keys_processed++;
+    }
+    if (debug_matrix && keys_processed) matrix_print();
+#else
+    keys_processed = matrix_scan_changes(exec_event, KEYS_PER_TASK);
+    loop_start = scan_end_us;
 #endif
+    // call with pseudo tick event when no real key event.
+    if (!keys_processed) action_exec(TICK);
 
-#ifdef SERIAL_LINK_ENABLE
-	serial_link_update();
+    // mouse, backlight, visualizer, ...
+    scheduler_run(loop_start);
+
+#ifdef COALESCE_KEYBOARD_REPORTS
+    host_keyboard_task();
 #endif
 
-#ifdef VISUALIZER_ENABLE
-    visualizer_update(default_layer_state, layer_state, visualizer_get_mods(), host_keyboard_leds());
+#ifdef SOF_SYNC_ENABLE
+    sof_sync_scan_end(timer_read_us32());
 #endif
 
     // update LED
@@ -66,6 +66,14 @@ void keyboard_init(void);
 void keyboard_task(void);
 /* it runs when host LED status is updated */
 void keyboard_set_leds(uint8_t leds);
+#ifdef MATRIX_SCAN_THREAD
+/* it scans the matrix and queues the changes for keyboard_task, from the scan thread.
+ * returns the number of changes queued */
+uint8_t keyboard_scan_task(void);
+/* ms keyboard_task has nothing to do for unless a key changes: 0 while changes
+ * are queued, else until the next deadline, UINT32_MAX if there is none */
+uint32_t keyboard_idle_time(void);
+#endif
 
 #ifdef __cplusplus
 }
@@ -65,6 +65,11 @@ void matrix_power_down(void);
 /* executes code for Quantum */
 void matrix_init_quantum(void);
 void matrix_scan_quantum(void);
+#ifdef MATRIX_SCAN_THREAD
+/* With the scan on its own thread, matrix_scan_quantum() does nothing and
+ * keyboard_task calls this on the main thread instead */
+void matrix_scan_hooks(void);
+#endif
 
 void matrix_init_kb(void);
 void matrix_scan_kb(void);
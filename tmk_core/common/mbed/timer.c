@@ -39,3 +39,8 @@ uint32_t timer_elapsed32(uint32_t last)
 {
     return TIMER_DIFF_32(timer_read32(), last);
 }
+
+uint32_t timer_read_us32(void)
+{
+    return timer_count * 1000;
+}
@@ -18,7 +18,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <stdint.h>
 #include "keycode.h"
 #include "host.h"
-#include "timer.h"
+#include "deadline.h"
 #include "print.h"
 #include "debug.h"
 #include "mousekey.h"
@@ -52,8 +52,9 @@ uint8_t mk_time_to_max = MOUSEKEY_TIME_TO_MAX;
 uint8_t mk_wheel_max_speed = MOUSEKEY_WHEEL_MAX_SPEED;
 uint8_t mk_wheel_time_to_max = MOUSEKEY_WHEEL_TIME_TO_MAX;
 
-
-static uint16_t last_timer = 0;
+/* the next repeated motion event, armed by each report sent while moving */
+static void mousekey_repeat_callback(deadline_t *deadline);
+static deadline_t mousekey_deadline = DEADLINE(mousekey_repeat_callback);
 
 
 static uint8_t move_unit(void)
@@ -94,12 +95,14 @@ static uint8_t wheel_unit(void)
     return (unit > MOUSEKEY_WHEEL_MAX ? MOUSEKEY_WHEEL_MAX : (unit == 0 ? 1 : unit));
 }
 
-void mousekey_task(void)
+static bool mousekey_moving(void)
 {
-    if (timer_elapsed(last_timer) < (mousekey_repeat ? mk_interval : mk_delay*10))
-        return;
+    return mouse_report.x || mouse_report.y || mouse_report.v || mouse_report.h;
+}
 
-    if (mouse_report.x == 0 && mouse_report.y == 0 && mouse_report.v == 0 && mouse_report.h == 0)
+static void mousekey_repeat_callback(deadline_t *deadline)
+{
+    if (!mousekey_moving())
         return;
 
     if (mousekey_repeat != UINT8_MAX)
@@ -164,7 +167,7 @@ void mousekey_off(uint8_t code)
     else if (code == KC_MS_ACCEL1) mousekey_accel &= ~(1<<1);
     else if (code == KC_MS_ACCEL2) mousekey_accel &= ~(1<<2);
 
-    if (mouse_report.x == 0 && mouse_report.y == 0 && mouse_report.v == 0 && mouse_report.h == 0)
+    if (!mousekey_moving())
         mousekey_repeat = 0;
 }
 
@@ -172,11 +175,15 @@ void mousekey_send(void)
 {
     mousekey_debug();
     host_mouse_send(&mouse_report);
-    last_timer = timer_read();
+    if (mousekey_moving())
+        deadline_in(&mousekey_deadline, mousekey_repeat ? mk_interval : mk_delay*10);
+    else
+        deadline_cancel(&mousekey_deadline);
 }
 
 void mousekey_clear(void)
 {
+    deadline_cancel(&mousekey_deadline);
     mouse_report = (report_mouse_t){};
     mousekey_repeat = 0;
     mousekey_accel = 0;
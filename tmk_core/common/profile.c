@@ -0,0 +1,226 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "profile.h"
+#include "timer.h"
+#include "scheduler.h"
+#include "action.h"
+#include "action_tapping.h"
+#include "print.h"
+#include "util.h"
+#ifdef RAW_ENABLE
+#   include "raw_hid.h"
+#endif
+
+static profile_stat_t stats[PROFILE_NUM_STATS];
+
+static uint32_t scan_start_time;
+static uint32_t last_scan_start_time;
+static bool first_scan = true;
+
+static uint32_t change_time;
+static bool change_pending = false;
+
+static uint32_t scan_rate_start;
+static uint16_t scan_rate_count;
+static uint16_t scan_rate;
+
+__attribute__ ((weak))
+uint32_t profile_time_us(void)
+{
+    return timer_read_us32();
+}
+
+void profile_init(void)
+{
+    profile_reset();
+    first_scan = true;
+    change_pending = false;
+    scan_rate_start = timer_read32();
+    scan_rate_count = 0;
+    scan_rate = 0;
+}
+
+void profile_reset(void)
+{
+    memset(stats, 0, sizeof(stats));
+    for (uint8_t i = 0; i < PROFILE_NUM_STATS; i++) {
+        stats[i].min = UINT16_MAX;
+    }
+    scheduler_reset_stats();
+#ifndef NO_ACTION_TAPPING
+    action_tapping_reset_stats();
+#endif
+}
+
+void profile_record(uint8_t stat, uint32_t us)
+{
+    if (stat >= PROFILE_NUM_STATS) return;
+    profile_stat_t *s = &stats[stat];
+    uint16_t value = us > UINT16_MAX ? UINT16_MAX : us;
+
+    // Stop counting instead of wrapping, so that the average stays right
+    if (s->count == UINT16_MAX) return;
+    s->count++;
+    s->sum += value;
+    if (value < s->min) s->min = value;
+    if (value > s->max) s->max = value;
+
+    uint8_t bucket = 0;
+    uint32_t limit = 8;
+    while (bucket < PROFILE_HISTOGRAM_BUCKETS - 1 && value >= limit) {
+        bucket++;
+        limit <<= 2;
+    }
+    s->histogram[bucket]++;
+}
+
+const profile_stat_t* profile_get(uint8_t stat)
+{
+    if (stat >= PROFILE_NUM_STATS) return NULL;
+    return &stats[stat];
+}
+
+uint16_t profile_scan_rate(void)
+{
+    return scan_rate;
+}
+
+void profile_scan_start(void)
+{
+    scan_start_time = profile_time_us();
+    if (!first_scan) {
+        profile_record(PROFILE_SCAN_PERIOD, scan_start_time - last_scan_start_time);
+    }
+    first_scan = false;
+    last_scan_start_time = scan_start_time;
+
+    if (timer_elapsed32(scan_rate_start) >= 1000) {
+        scan_rate = scan_rate_count;
+        scan_rate_count = 0;
+        scan_rate_start = timer_read32();
+    }
+    scan_rate_count++;
+}
+
+void profile_scan_end(void)
+{
+    profile_record(PROFILE_MATRIX_SCAN, profile_time_us() - scan_start_time);
+}
+
+void profile_matrix_changed(void)
+{
+    uint32_t now = profile_time_us();
+    // Keep the oldest change that hasn't been reported, unless it's stale
+    if (change_pending && now - change_time < PROFILE_LATENCY_TIMEOUT * 1000UL) return;
+    change_time = now;
+    change_pending = true;
+}
+
+void profile_action_exec(void)
+{
+    if (!change_pending) return;
+    profile_record(PROFILE_MATRIX_TO_ACTION, profile_time_us() - change_time);
+}
+
+void profile_keyboard_report(void)
+{
+    if (!change_pending) return;
+    uint32_t latency = profile_time_us() - change_time;
+    change_pending = false;
+    if (latency < PROFILE_LATENCY_TIMEOUT * 1000UL) {
+        profile_record(PROFILE_MATRIX_TO_REPORT, latency);
+    }
+}
+
+static void print_stat_name(uint8_t stat)
+{
+    switch (stat) {
+        case PROFILE_SCAN_PERIOD:       print("scan period"); break;
+        case PROFILE_MATRIX_SCAN:       print("matrix_scan"); break;
+        case PROFILE_MATRIX_TO_ACTION:  print("matrix to action"); break;
+        case PROFILE_MATRIX_TO_REPORT:  print("matrix to report"); break;
+        case PROFILE_PROCESS_RECORD:    print("process_record"); break;
+#ifdef PROFILE_PROCESS_HOOKS
+        case PROFILE_PROCESS_MIDI:      print("process_midi"); break;
+        case PROFILE_PROCESS_AUDIO:     print("process_audio"); break;
+        case PROFILE_PROCESS_MUSIC:     print("process_music"); break;
+        case PROFILE_PROCESS_TAP_DANCE: print("process_tap_dance"); break;
+        case PROFILE_PROCESS_LEADER:    print("process_leader"); break;
+        case PROFILE_PROCESS_CHORDING:  print("process_chording"); break;
+        case PROFILE_PROCESS_COMBO:     print("process_combo"); break;
+        case PROFILE_PROCESS_UNICODE:   print("process_unicode"); break;
+        case PROFILE_PROCESS_UCIS:      print("process_ucis"); break;
+        case PROFILE_PROCESS_PRINTER:   print("process_printer"); break;
+        case PROFILE_PROCESS_UNICODEMAP:print("process_unicodemap"); break;
+        case PROFILE_PROCESS_KB:        print("process_record_kb"); break;
+#endif
+    }
+}
+
+void profile_print(void)
+{
+    print("\n\t- Profile (us) -\n");
+    xprintf("scan rate: %u/s\n", scan_rate);
+    for (uint8_t i = 0; i < PROFILE_NUM_STATS; i++) {
+        const profile_stat_t *s = &stats[i];
+        print_stat_name(i);
+        if (s->count == 0) {
+            print(": -\n");
+            continue;
+        }
+        xprintf(": n=%u min=%u avg=%u max=%u |", s->count, s->min, (uint16_t)(s->sum / s->count), s->max);
+        for (uint8_t b = 0; b < PROFILE_HISTOGRAM_BUCKETS; b++) {
+            xprintf(" %u", s->histogram[b]);
+        }
+        print("\n");
+    }
+    scheduler_print();
+#ifndef NO_ACTION_TAPPING
+    action_tapping_print_stats();
+#endif
+}
+
+static void put_u16(uint8_t *p, uint16_t value)
+{
+    p[0] = value & 0xFF;
+    p[1] = value >> 8;
+}
+
+bool profile_raw_hid_receive(uint8_t *data, uint8_t length)
+{
+    if (length < 11 + 2 * PROFILE_HISTOGRAM_BUCKETS || data[0] != PROFILE_RAW_HID_ID) {
+        return false;
+    }
+    uint8_t stat = data[1];
+    memset(data + 2, 0, length - 2);
+    data[2] = PROFILE_NUM_STATS;
+    if (stat < PROFILE_NUM_STATS) {
+        const profile_stat_t *s = &stats[stat];
+        put_u16(data + 3, s->count);
+        put_u16(data + 5, s->count ? s->min : 0);
+        put_u16(data + 7, s->max);
+        put_u16(data + 9, s->count ? s->sum / s->count : 0);
+        for (uint8_t b = 0; b < PROFILE_HISTOGRAM_BUCKETS; b++) {
+            put_u16(data + 11 + 2 * b, s->histogram[b]);
+        }
+    }
+#ifdef RAW_ENABLE
+    raw_hid_send(data, length);
+#endif
+    return true;
+}
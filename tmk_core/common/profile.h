@@ -0,0 +1,116 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+/* Scan rate and latency profiling, enabled with PROFILE_ENABLE = yes.
+ *
+ * Every statistic keeps the count, min, max and sum of its samples, plus a
+ * histogram, in microseconds. The RAM used is fixed at compile time; define
+ * PROFILE_PROCESS_HOOKS to also time each process_* hook of quantum.
+ * The statistics are printed with the profile magic command, along with
+ * those of the scheduled tasks, or read over raw HID with
+ * profile_raw_hid_receive().
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum profile_stat {
+    PROFILE_SCAN_PERIOD,        // from one matrix scan to the next
+    PROFILE_MATRIX_SCAN,        // inside matrix_scan()
+    PROFILE_MATRIX_TO_ACTION,   // from detecting a change to action_exec()
+    PROFILE_MATRIX_TO_REPORT,   // from detecting a change to host_keyboard_send()
+    PROFILE_PROCESS_RECORD,     // inside process_record_quantum()
+#ifdef PROFILE_PROCESS_HOOKS
+    PROFILE_PROCESS_MIDI,
+    PROFILE_PROCESS_AUDIO,
+    PROFILE_PROCESS_MUSIC,
+    PROFILE_PROCESS_TAP_DANCE,
+    PROFILE_PROCESS_LEADER,
+    PROFILE_PROCESS_CHORDING,
+    PROFILE_PROCESS_COMBO,
+    PROFILE_PROCESS_UNICODE,
+    PROFILE_PROCESS_UCIS,
+    PROFILE_PROCESS_PRINTER,
+    PROFILE_PROCESS_UNICODEMAP,
+    PROFILE_PROCESS_KB,
+#endif
+    PROFILE_NUM_STATS
+};
+
+/* Histogram bucket n counts the samples below 8 << (2 * n) us,
+ * the last bucket everything above */
+#ifndef PROFILE_HISTOGRAM_BUCKETS
+#   define PROFILE_HISTOGRAM_BUCKETS 8
+#endif
+
+/* A change that hasn't reached the host after this many ms isn't counted */
+#ifndef PROFILE_LATENCY_TIMEOUT
+#   define PROFILE_LATENCY_TIMEOUT 1000
+#endif
+
+typedef struct {
+    uint16_t count;
+    uint16_t min;
+    uint16_t max;
+    uint32_t sum;
+    uint16_t histogram[PROFILE_HISTOGRAM_BUCKETS];
+} profile_stat_t;
+
+/* Free running microsecond clock, timer_read_us32() unless overridden */
+uint32_t profile_time_us(void);
+
+void profile_init(void);
+void profile_reset(void);
+void profile_record(uint8_t stat, uint32_t us);
+const profile_stat_t* profile_get(uint8_t stat);
+/* scans during the last full second */
+uint16_t profile_scan_rate(void);
+void profile_print(void);
+
+/* Hooks for the keyboard core */
+void profile_scan_start(void);
+void profile_scan_end(void);
+void profile_matrix_changed(void);
+void profile_action_exec(void);
+void profile_keyboard_report(void);
+
+/* Answers a raw HID request with the statistic data[1]. The reply has the
+ * same PROFILE_RAW_HID_ID in the first byte, then the statistic index, the
+ * number of statistics, and the little endian count, min, max, average and
+ * histogram buckets. */
+#define PROFILE_RAW_HID_ID 0xF0
+bool profile_raw_hid_receive(uint8_t *data, uint8_t length);
+
+/* Time a statement, when it is a hook that has a statistic */
+#define PROFILE_CALL(stat, expr) ({ \
+    uint32_t profile_start__ = profile_time_us(); \
+    __typeof__(expr) profile_result__ = (expr); \
+    profile_record((stat), profile_time_us() - profile_start__); \
+    profile_result__; \
+})
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
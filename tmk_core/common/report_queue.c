@@ -0,0 +1,99 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "report_queue.h"
+#include "report.h"
+
+void report_queue_init(report_queue_t *queue, void *buffer, uint8_t report_size, uint8_t capacity,
+                       void *last, report_collapse_t collapse)
+{
+    queue->buffer = buffer;
+    queue->report_size = report_size;
+    queue->capacity = capacity;
+    queue->last = last;
+    queue->collapse = collapse;
+    report_queue_clear(queue);
+}
+
+void report_queue_clear(report_queue_t *queue)
+{
+    queue->head = 0;
+    queue->count = 0;
+    queue->has_last = false;
+}
+
+static uint8_t *slot(report_queue_t *queue, uint8_t i)
+{
+    uint8_t index = queue->head + i;
+    if (index >= queue->capacity) index -= queue->capacity;
+    return queue->buffer + index * queue->report_size;
+}
+
+bool report_queue_push(report_queue_t *queue, const void *report)
+{
+    uint8_t *newest = queue->count ? slot(queue, queue->count - 1) : NULL;
+    if (queue->collapse) {
+        if (newest && queue->collapse(newest, report)) return true;
+        if (queue->count == queue->capacity) return false;
+    } else {
+        if (queue->has_last && memcmp(queue->last, report, queue->report_size) == 0) return true;
+        if (queue->count == queue->capacity) return false;
+        memcpy(queue->last, report, queue->report_size);
+        queue->has_last = true;
+    }
+
+    memcpy(slot(queue, queue->count), report, queue->report_size);
+    queue->count++;
+    return true;
+}
+
+bool report_queue_pop(report_queue_t *queue, void *report)
+{
+    if (queue->count == 0) return false;
+    if (report) memcpy(report, slot(queue, 0), queue->report_size);
+    queue->head = queue->head + 1 == queue->capacity ? 0 : queue->head + 1;
+    queue->count--;
+    return true;
+}
+
+void *report_queue_peek(report_queue_t *queue)
+{
+    return queue->count ? slot(queue, 0) : NULL;
+}
+
+static bool add_motion(int8_t *a, int8_t b)
+{
+    int16_t sum = *a + b;
+    if (sum < -127 || sum > 127) return false;
+    *a = sum;
+    return true;
+}
+
+bool report_queue_collapse_mouse(void *newest, const void *report)
+{
+    report_mouse_t *a = newest;
+    const report_mouse_t *b = report;
+    if (a->buttons != b->buttons) return false;
+
+    report_mouse_t sum = *a;
+    if (!add_motion(&sum.x, b->x) || !add_motion(&sum.y, b->y) ||
+        !add_motion(&sum.v, b->v) || !add_motion(&sum.h, b->h)) {
+        return false;
+    }
+    *a = sum;
+    return true;
+}
@@ -0,0 +1,102 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REPORT_QUEUE_H
+#define REPORT_QUEUE_H
+
+/* Fixed size FIFO of HID reports waiting for their IN endpoint.
+ *
+ * The host driver pushes the reports from the main loop and pops them when
+ * the endpoint is free again, e.g. from its IN complete callback, so that
+ * sending a report never waits for the host. The queue only holds reports
+ * that haven't been handed to the hardware yet.
+ *
+ * Reports that describe a state (keyboard, system, consumer) are idempotent:
+ * a report equal to the previous one is dropped. Relative reports like the
+ * mouse give a collapse function instead, which combines the new report into
+ * the newest queued one whenever it can. Nothing queued is ever replaced, a
+ * press could be lost with it, so a push fails on a full queue and the
+ * driver waits for the host as it would without the queue. System and
+ * consumer reports share an endpoint but get a queue each.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "report.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A keyboard report with the format it was made in, boot or NKRO, which
+ * may have changed by the time it is sent */
+typedef struct {
+    report_keyboard_t report;
+    bool nkro;
+} queued_keyboard_report_t;
+
+/* combine report into newest, false if they can't be combined */
+typedef bool (*report_collapse_t)(void *newest, const void *report);
+
+typedef struct {
+    uint8_t *buffer;
+    uint8_t report_size;
+    uint8_t capacity;
+    uint8_t head;
+    uint8_t count;
+    /* NULL for idempotent reports */
+    report_collapse_t collapse;
+    /* the newest report pushed, to drop repeated idempotent reports */
+    bool has_last;
+    uint8_t *last;
+} report_queue_t;
+
+/* buffer has room for capacity reports, last for one */
+void report_queue_init(report_queue_t *queue, void *buffer, uint8_t report_size, uint8_t capacity,
+                       void *last, report_collapse_t collapse);
+void report_queue_clear(report_queue_t *queue);
+/* false if the queue is full */
+bool report_queue_push(report_queue_t *queue, const void *report);
+/* copy the oldest report to report, unless NULL, and remove it, false if
+ * the queue is empty */
+bool report_queue_pop(report_queue_t *queue, void *report);
+/* the oldest report, NULL if the queue is empty */
+void *report_queue_peek(report_queue_t *queue);
+
+/* collapse function for report_mouse_t, adds up the motion while the
+ * buttons stay the same */
+bool report_queue_collapse_mouse(void *newest, const void *report);
+
+static inline bool report_queue_empty(const report_queue_t *queue)
+{
+    return queue->count == 0;
+}
+
+/* Declare a queue with its storage */
+#define REPORT_QUEUE(name, type, capacity) \
+    static type name##_buffer[capacity]; \
+    static type name##_last; \
+    static report_queue_t name
+
+#define REPORT_QUEUE_INIT(name, collapse) \
+    report_queue_init(&name, name##_buffer, sizeof(name##_last), \
+                      sizeof(name##_buffer) / sizeof(name##_last), &name##_last, collapse)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,111 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "scheduler.h"
+#include "timer.h"
+#include "print.h"
+
+/* sorted by priority, then by when they were added */
+static scheduled_task_t *tasks = NULL;
+
+void scheduler_add(scheduled_task_t *task)
+{
+    scheduled_task_t **link = &tasks;
+    for (scheduled_task_t *t = tasks; t; t = t->next) {
+        if (t == task) return;
+    }
+    while (*link && (*link)->priority <= task->priority) {
+        link = &(*link)->next;
+    }
+    // due right away
+    task->last_run = timer_read32() - task->period;
+    task->next = *link;
+    *link = task;
+}
+
+void scheduler_remove(scheduled_task_t *task)
+{
+    for (scheduled_task_t **link = &tasks; *link; link = &(*link)->next) {
+        if (*link == task) {
+            *link = task->next;
+            task->next = NULL;
+            return;
+        }
+    }
+}
+
+static void run_task(scheduled_task_t *task, uint32_t now, uint32_t start)
+{
+    task->last_run = now;
+    task->shed_in_a_row = 0;
+    task->run();
+
+    uint32_t us = timer_read_us32() - start;
+    task->runs++;
+    task->total_us += us;
+    if (us > task->max_us) {
+        task->max_us = us > UINT16_MAX ? UINT16_MAX : us;
+    }
+}
+
+void scheduler_run(uint32_t loop_start_us)
+{
+    uint32_t now = timer_read32();
+    bool over_budget = false;
+    for (scheduled_task_t *task = tasks; task; task = task->next) {
+        if (task->period && now - task->last_run < task->period) continue;
+
+        uint32_t start = timer_read_us32();
+        if (task->priority != TASK_PRIORITY_HIGH) {
+            // the tasks left are no more urgent than this one
+            over_budget = over_budget || start - loop_start_us >= SCHEDULER_BUDGET_US;
+            // but a loop that is always over budget mustn't starve them
+            if (over_budget && task->shed_in_a_row < SCHEDULER_MAX_SHED) {
+                task->shed++;
+                task->shed_in_a_row++;
+                continue;
+            }
+        }
+        run_task(task, now, start);
+    }
+}
+
+scheduled_task_t *scheduler_tasks(void)
+{
+    return tasks;
+}
+
+void scheduler_reset_stats(void)
+{
+    for (scheduled_task_t *task = tasks; task; task = task->next) {
+        task->runs = 0;
+        task->total_us = 0;
+        task->max_us = 0;
+        task->shed = 0;
+        task->shed_in_a_row = 0;
+    }
+}
+
+void scheduler_print(void)
+{
+#ifdef PROFILE_ENABLE
+    print("\n\t- Tasks (us) -\n");
+    for (scheduled_task_t *task = tasks; task; task = task->next) {
+        xprintf("%s: p=%u n=%lu avg=%lu max=%u shed=%u\n", task->name, task->priority, task->runs,
+                task->runs ? task->total_us / task->runs : 0, task->max_us, task->shed);
+    }
+#endif
+}
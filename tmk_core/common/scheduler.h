@@ -0,0 +1,101 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+/* The jobs keyboard_task runs after the keys, e.g. the mouse, backlight and
+ * visualizer tasks, each added once with how often and how urgently it has
+ * to run:
+ *
+ *   static scheduled_task_t battery_task = SCHEDULED_TASK(battery_update, 1000, TASK_PRIORITY_LOW);
+ *
+ *   void matrix_init_user(void) {
+ *     scheduler_add(&battery_task);
+ *   }
+ *
+ * Tasks run by priority, then in the order they were added. Once the loop
+ * has taken SCHEDULER_BUDGET_US, the tasks that aren't TASK_PRIORITY_HIGH
+ * are shed, the lowest first, and run on a later loop, so that the next
+ * scan isn't held up. A task shed SCHEDULER_MAX_SHED times in a row runs
+ * anyway, so that a keyboard whose scan alone takes the budget still gets
+ * its mouse and LEDs. Each task keeps how often and how long it ran.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* One USB frame */
+#ifndef SCHEDULER_BUDGET_US
+#   define SCHEDULER_BUDGET_US 1000
+#endif
+
+#ifndef SCHEDULER_MAX_SHED
+#   define SCHEDULER_MAX_SHED 8
+#endif
+
+typedef enum {
+    TASK_PRIORITY_HIGH,     // never shed, e.g. what sends keys
+    TASK_PRIORITY_NORMAL,
+    TASK_PRIORITY_LOW,      // shed first, e.g. LEDs
+} task_priority_t;
+
+typedef struct scheduled_task_t scheduled_task_t;
+
+struct scheduled_task_t {
+    scheduled_task_t *next;
+    void (*run)(void);
+    uint16_t period;        // ms between runs, 0 for every loop
+    uint8_t priority;
+    uint32_t last_run;      // timer_read32
+    /* accounting */
+    uint32_t runs;
+    uint32_t total_us;
+    uint16_t max_us;
+    uint16_t shed;          // times it was due but didn't fit in the loop
+    uint8_t shed_in_a_row;
+#ifdef PROFILE_ENABLE
+    const char *name;
+#endif
+};
+
+#ifdef PROFILE_ENABLE
+#   define SCHEDULED_TASK(run, period, priority) { NULL, (run), (period), (priority), 0, 0, 0, 0, 0, 0, #run }
+#else
+#   define SCHEDULED_TASK(run, period, priority) { NULL, (run), (period), (priority), 0, 0, 0, 0, 0, 0 }
+#endif
+
+/* Adding a task again does nothing */
+void scheduler_add(scheduled_task_t *task);
+void scheduler_remove(scheduled_task_t *task);
+/* Runs the tasks that are due, in a loop whose budget started at
+ * loop_start_us (timer_read_us32) */
+void scheduler_run(uint32_t loop_start_us);
+/* The first task, the others follow through next */
+scheduled_task_t *scheduler_tasks(void);
+void scheduler_reset_stats(void);
+void scheduler_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
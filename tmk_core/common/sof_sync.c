@@ -0,0 +1,150 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sof_sync.h"
+#include "print.h"
+
+#define NOMINAL_FRAME_US 1000
+
+/* Written by the SOF interrupt, the time first, then the frame number */
+static volatile uint32_t sof_time;
+static volatile uint8_t sof_frame;
+static volatile bool sof_seen;
+
+static uint32_t last_sof;
+static uint8_t last_frame;
+static bool synced;
+
+static uint32_t scan_start;
+static uint8_t scan_frame;
+static bool scan_synced;
+static bool scanned;
+
+static sof_sync_stats_t stats;
+
+void sof_sync_init(void)
+{
+    sof_seen = false;
+    synced = false;
+    scanned = false;
+    stats.frame_us = NOMINAL_FRAME_US;
+    stats.scan_us = 0;
+    sof_sync_reset_stats();
+}
+
+void sof_sync_reset_stats(void)
+{
+    stats.scans = 0;
+    stats.late = 0;
+    stats.margin_min = UINT16_MAX;
+    stats.margin_sum = 0;
+}
+
+void sof_sync_frame(uint32_t now)
+{
+    sof_time = now;
+    sof_frame++;
+    sof_seen = true;
+}
+
+/* Take the latest SOF without locking: the frame number changes last, so
+ * reading it again tells if the interrupt ran in between */
+static void update_frame(void)
+{
+    uint32_t time;
+    uint8_t frame;
+    do {
+        frame = sof_frame;
+        time = sof_time;
+    } while (frame != sof_frame);
+
+    if (!sof_seen || frame == last_frame) return;
+    // Follow the host clock, the period is only measured between two frames
+    if (synced && (uint8_t)(frame - last_frame) == 1) {
+        uint32_t period = time - last_sof;
+        if (period > NOMINAL_FRAME_US / 2 && period < NOMINAL_FRAME_US * 2) {
+            stats.frame_us += ((int32_t)period - stats.frame_us) / 8;
+        }
+    }
+    last_sof = time;
+    last_frame = frame;
+    synced = true;
+}
+
+bool sof_sync_scan_due(uint32_t now)
+{
+    update_frame();
+    if (!synced) return true;
+
+    uint32_t since = now - last_sof;
+    if (since >= (uint32_t)SOF_SYNC_TIMEOUT_FRAMES * stats.frame_us) {
+        synced = false;
+        return true;
+    }
+    if (scanned && scan_frame == last_frame) return false;
+
+    int32_t start = (int32_t)stats.frame_us - stats.scan_us - SOF_SYNC_GUARD_US;
+    return (int32_t)since >= start;
+}
+
+void sof_sync_scan_start(uint32_t now)
+{
+    scan_start = now;
+    scan_frame = last_frame;
+    scan_synced = synced;
+    scanned = true;
+}
+
+void sof_sync_scan_end(uint32_t now)
+{
+    uint32_t duration = now - scan_start;
+    if (duration > UINT16_MAX) duration = UINT16_MAX;
+    // Jump up to a longer scan right away, forget it slowly
+    if (duration >= stats.scan_us) {
+        stats.scan_us = duration;
+    } else {
+        stats.scan_us -= (stats.scan_us - duration + 15) / 16;
+    }
+
+    if (!scan_synced) return;
+    update_frame();
+    if (stats.scans < UINT16_MAX) stats.scans++;
+    if (last_frame != scan_frame) {
+        if (stats.late < UINT16_MAX) stats.late++;
+        return;
+    }
+    uint32_t margin = last_sof + stats.frame_us - now;
+    if (margin > stats.frame_us) margin = 0;
+    if (margin < stats.margin_min) stats.margin_min = margin;
+    stats.margin_sum += margin;
+}
+
+const sof_sync_stats_t *sof_sync_get_stats(void)
+{
+    return &stats;
+}
+
+void sof_sync_print(void)
+{
+    print("\n\t- SOF sync (us) -\n");
+    xprintf("frame: %u scan: %u\n", stats.frame_us, stats.scan_us);
+    uint16_t on_time = stats.scans - stats.late;
+    xprintf("scans: %u late: %u", stats.scans, stats.late);
+    if (on_time) {
+        xprintf(" margin min: %u avg: %lu", stats.margin_min, stats.margin_sum / on_time);
+    }
+    print("\n");
+}
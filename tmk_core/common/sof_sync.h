@@ -0,0 +1,81 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SOF_SYNC_H
+#define SOF_SYNC_H
+
+/* Start of frame synchronized scanning, enabled with SOF_SYNC_ENABLE = yes.
+ *
+ * The host polls the keyboard endpoints once per USB frame, right after the
+ * start of frame. A free running scan finishes at a random point of the
+ * frame, so a report can just miss a poll. Instead keyboard_task scans once
+ * per frame, starting late enough that the scan and its reports are done
+ * SOF_SYNC_GUARD_US before the next frame. The scan time is measured, so the
+ * phase adapts to the keymap. When there are no SOFs (no USB, suspended) the
+ * scan is free running again.
+ *
+ * All times are timer_read_us32() microseconds. On mbed and the ATmega32A
+ * timer_read_us32() only counts whole milliseconds, a frame long, so there
+ * is no phase to adapt: SOF sync doesn't build there.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#if defined(__AVR_ATmega32A__) || defined(__MBED__)
+#   error "SOF_SYNC_ENABLE needs a sub millisecond timer_read_us32()"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Time left between the end of the scan and the next SOF */
+#ifndef SOF_SYNC_GUARD_US
+#   define SOF_SYNC_GUARD_US 50
+#endif
+
+/* Scan free running after this many frames without SOF */
+#ifndef SOF_SYNC_TIMEOUT_FRAMES
+#   define SOF_SYNC_TIMEOUT_FRAMES 3
+#endif
+
+typedef struct {
+    uint16_t frame_us;      // measured frame period
+    uint16_t scan_us;       // scan time estimate
+    uint16_t scans;         // synchronized scans
+    uint16_t late;          // synchronized scans that ran into the next frame
+    uint16_t margin_min;    // least time left before the next SOF
+    uint32_t margin_sum;    // of the scans that weren't late
+} sof_sync_stats_t;
+
+void sof_sync_init(void);
+void sof_sync_reset_stats(void);
+/* Called from the start of frame interrupt */
+void sof_sync_frame(uint32_t now);
+/* Should keyboard_task scan now */
+bool sof_sync_scan_due(uint32_t now);
+void sof_sync_scan_start(uint32_t now);
+/* After the scan and the reports it sent */
+void sof_sync_scan_end(uint32_t now);
+const sof_sync_stats_t *sof_sync_get_stats(void);
+void sof_sync_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,116 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "trace.h"
+#include "timer.h"
+#include "print.h"
+#ifdef RAW_ENABLE
+#   include "raw_hid.h"
+#endif
+
+#define MASK (TRACE_BUFFER_SIZE - 1)
+
+static trace_record_t records[TRACE_BUFFER_SIZE];
+static uint8_t head = 0;
+static uint8_t tail = 0;
+static uint16_t lost = 0;
+
+void trace_init(void)
+{
+    trace_clear();
+}
+
+void trace_record(uint8_t type, uint8_t arg, uint16_t data)
+{
+    if ((uint8_t)(tail - head) == TRACE_BUFFER_SIZE) {
+        // drop the oldest
+        head++;
+        if (lost < UINT16_MAX) lost++;
+    }
+    trace_record_t *record = &records[tail & MASK];
+    record->time = timer_read_us32();
+    record->type = type;
+    record->arg = arg;
+    record->data = data;
+    tail++;
+}
+
+bool trace_read(trace_record_t *record)
+{
+    if (head == tail) return false;
+    *record = records[head & MASK];
+    head++;
+    return true;
+}
+
+uint16_t trace_lost(void)
+{
+    uint16_t count = lost;
+    lost = 0;
+    return count;
+}
+
+void trace_clear(void)
+{
+    head = tail;
+    lost = 0;
+}
+
+void trace_print(void)
+{
+    trace_record_t record;
+    print("\n\t- Trace -\n");
+    xprintf("lost: %u\n", trace_lost());
+    while (trace_read(&record)) {
+        xprintf("%08lX %02X %02X %04X\n", record.time, record.type, record.arg, record.data);
+    }
+}
+
+static void put_u16(uint8_t *p, uint16_t value)
+{
+    p[0] = value & 0xFF;
+    p[1] = value >> 8;
+}
+
+bool trace_raw_hid_receive(uint8_t *data, uint8_t length)
+{
+    if (length < 4 || data[0] != TRACE_RAW_HID_ID) {
+        return false;
+    }
+    uint8_t command = data[1];
+    memset(data + 1, 0, length - 1);
+    if (command == TRACE_RAW_HID_CLEAR) {
+        trace_clear();
+    } else if (command == TRACE_RAW_HID_READ) {
+        put_u16(data + 2, trace_lost());
+        uint8_t *p = data + 4;
+        trace_record_t record;
+        while (p + 8 <= data + length && trace_read(&record)) {
+            put_u16(p, record.time & 0xFFFF);
+            put_u16(p + 2, record.time >> 16);
+            p[4] = record.type;
+            p[5] = record.arg;
+            put_u16(p + 6, record.data);
+            p += 8;
+            data[1]++;
+        }
+    }
+#ifdef RAW_ENABLE
+    raw_hid_send(data, length);
+#endif
+    return true;
+}
@@ -0,0 +1,112 @@
+/* Copyright 2017 QMK contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+/* Binary event trace, enabled with TRACE_ENABLE = yes.
+ *
+ * Matrix changes, the decisions of the tapping code, the records it hands
+ * on, layer changes and keyboard reports are kept with their time in
+ * microseconds in a ring buffer, at a few instructions each, so that timing
+ * can be looked at on a keyboard in use without printing debug messages.
+ * The oldest records are overwritten when nobody reads them. They are read
+ * with the trace magic command, or over raw HID with trace_raw_hid_receive(),
+ * and util/trace_decode.py turns either into a timeline.
+ *
+ * The buffer is written from the thread that runs keyboard_task; with
+ * MATRIX_SCAN_THREAD, matrix changes are traced when they are taken from the
+ * queue.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Records, a power of two up to 128, 8 bytes each */
+#ifndef TRACE_BUFFER_SIZE
+#   define TRACE_BUFFER_SIZE 32
+#endif
+
+#if (TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) || TRACE_BUFFER_SIZE > 128
+#   error "TRACE_BUFFER_SIZE must be a power of two up to 128"
+#endif
+
+enum trace_type {
+    TRACE_NONE,
+    TRACE_MATRIX,       // arg: pressed, data: key
+    TRACE_TAPPING,      // arg: decision << 4 | tap count, data: tapping key
+    TRACE_RECORD,       // arg: pressed << 7 | interrupted << 4 | tap count, data: key
+    TRACE_LAYER,        // arg: 0, data: layer_state, low 16 bits
+    TRACE_DEFAULT_LAYER,// arg: 0, data: default_layer_state, low 16 bits
+    TRACE_REPORT,       // arg: mods, data: number of keys
+    TRACE_USER,         // anything the keymap wants to mark
+};
+
+/* what the tapping code decided */
+enum trace_tapping {
+    TRACE_TAPPING_START,        // a tap key was pressed
+    TRACE_TAPPING_TAP,          // it was tapped (again)
+    TRACE_TAPPING_HOLD,         // it was held past TAPPING_TERM
+    TRACE_TAPPING_INTERRUPT,    // another key was pressed while it was down
+    TRACE_TAPPING_END,          // no more tap followed in TAPPING_TERM
+};
+
+typedef struct {
+    uint32_t time;      // timer_read_us32
+    uint8_t type;
+    uint8_t arg;
+    uint16_t data;
+} trace_record_t;
+
+/* keypos_t as trace data */
+#define TRACE_KEY(key) ((uint16_t)(key).row << 8 | (key).col)
+
+void trace_init(void);
+void trace_record(uint8_t type, uint8_t arg, uint16_t data);
+/* Oldest record, false if there are none */
+bool trace_read(trace_record_t *record);
+/* Records overwritten before they were read, since the last call */
+uint16_t trace_lost(void);
+void trace_clear(void);
+/* Prints and consumes the records, one per line as
+ * "time type arg data" in hex */
+void trace_print(void);
+
+/* Answers a raw HID request. data[1] is TRACE_RAW_HID_READ, which replies
+ * with the same first byte, the number of records that follow, the little
+ * endian number of records lost, and up to (length - 4) / 8 records:
+ * little endian time, type, arg and little endian data. TRACE_RAW_HID_CLEAR
+ * drops the records. */
+#define TRACE_RAW_HID_ID 0xF1
+#define TRACE_RAW_HID_READ 0
+#define TRACE_RAW_HID_CLEAR 1
+bool trace_raw_hid_receive(uint8_t *data, uint8_t length);
+
+#ifdef TRACE_ENABLE
+#   define TRACE(type, arg, data) trace_record((type), (arg), (data))
+#else
+#   define TRACE(type, arg, data) do {} while (0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
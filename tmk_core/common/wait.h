@@ -15,8 +15,27 @@ extern "C" {
 #   define wait_us(us) chThdSleepMicroseconds(us)
 #elif defined(__arm__) /* __AVR__ */
 #   include "wait_api.h"
+#else  /* __AVR__ */
+/* Native builds, the test timer advances the simulated time */
+#   include <stdint.h>
+void wait_ms(uint32_t ms);
+void wait_us(uint32_t us);
 #endif /* __AVR__ */
 
+#ifdef COALESCE_KEYBOARD_REPORTS
+/* the host has to see the staged keyboard report before the time passes */
+#   include "host.h"
+#   if defined(__AVR__)
+#       undef wait_ms
+#       define wait_ms(ms) do { host_keyboard_flush(); _delay_ms(ms); } while (0)
+#   elif defined(PROTOCOL_CHIBIOS)
+#       undef wait_ms
+#       define wait_ms(ms) do { host_keyboard_flush(); chThdSleepMilliseconds(ms); } while (0)
+#   else
+#       define wait_ms(ms) do { host_keyboard_flush(); (wait_ms)(ms); } while (0)
+#   endif
+#endif
+
 #ifdef __cplusplus
 }
 #endif
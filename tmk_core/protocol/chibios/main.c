@@ -88,6 +88,40 @@ host_driver_t chibios_driver = {
 
 
 
+#ifdef MATRIX_SCAN_THREAD
+/* Matrix scan thread
+ * scans at a fixed rate and queues the changes with the time they were
+ * found, so slow work in keyboard_task doesn't delay the scan */
+#ifndef MATRIX_SCAN_INTERVAL_US
+#define MATRIX_SCAN_INTERVAL_US 1000
+#endif
+#ifndef MATRIX_SCAN_THREAD_PRIORITY
+#define MATRIX_SCAN_THREAD_PRIORITY (NORMALPRIO + 1)
+#endif
+/* the longest the main thread sleeps while there is nothing to do, for
+ * what keyboard_task still polls, like matrix_scan_user */
+#ifndef MAIN_LOOP_IDLE_US
+#define MAIN_LOOP_IDLE_US MATRIX_SCAN_INTERVAL_US
+#endif
+/* signalled when the scan thread has queued key changes */
+static BSEMAPHORE_DECL(key_changes_sem, true);
+static THD_WORKING_AREA(waScanThread, 512);
+static THD_FUNCTION(scanThread, arg) {
+  (void)arg;
+  chRegSetThreadName("matrixScan");
+  systime_t next = chVTGetSystemTime();
+  while(true) {
+    /* while suspended the main thread scans for the wakeup condition */
+    if(USB_DRIVER.state != USB_SUSPENDED && keyboard_scan_task()) {
+      chBSemSignal(&key_changes_sem);
+    }
+    systime_t prev = next;
+    next += US2ST(MATRIX_SCAN_INTERVAL_US);
+    chThdSleepUntilWindowed(prev, next);
+  }
+}
+#endif
+
 /* Main thread
  */
 int main(void) {
@@ -144,6 +178,10 @@ int main(void) {
   keyboard_init();
   host_set_driver(driver);
 
+#ifdef MATRIX_SCAN_THREAD
+  chThdCreateStatic(waScanThread, sizeof(waScanThread), MATRIX_SCAN_THREAD_PRIORITY, scanThread, NULL);
+#endif
+
 #ifdef SLEEP_LED_ENABLE
   sleep_led_init();
 #endif
@@ -182,5 +220,18 @@ int main(void) {
     }
 
     keyboard_task();
+
+#ifdef MATRIX_SCAN_THREAD
+    /* sleep until a key changes or the next deadline is due, instead of
+     * spinning through keyboard_task */
+    uint32_t idle_ms = keyboard_idle_time();
+    if(idle_ms) {
+      uint32_t idle_us = MAIN_LOOP_IDLE_US;
+      if(idle_ms < MAIN_LOOP_IDLE_US / 1000) {
+        idle_us = idle_ms * 1000;
+      }
+      chBSemWaitTimeout(&key_changes_sem, US2ST(idle_us));
+    }
+#endif
   }
 }
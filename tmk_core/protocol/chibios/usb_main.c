@@ -23,6 +23,11 @@
 #include "host.h"
 #include "debug.h"
 #include "suspend.h"
+#include "report_queue.h"
+#ifdef SOF_SYNC_ENABLE
+#include "sof_sync.h"
+#include "timer.h"
+#endif
 #ifdef SLEEP_LED_ENABLE
 #include "sleep_led.h"
 #include "led.h"
@@ -54,6 +59,21 @@ report_mouse_t mouse_report_blank = {0};
 uint8_t extra_report_blank[3] = {0};
 #endif /* EXTRAKEY_ENABLE */
 
+/* The reports waiting for their endpoint, and the one being transmitted.
+ * The queues are only touched in locked state. */
+REPORT_QUEUE(kbd_queue, queued_keyboard_report_t, USB_REPORT_QUEUE_SIZE);
+static queued_keyboard_report_t kbd_tx_report;
+#ifdef MOUSE_ENABLE
+REPORT_QUEUE(mouse_queue, report_mouse_t, USB_REPORT_QUEUE_SIZE);
+static report_mouse_t mouse_tx_report;
+#endif /* MOUSE_ENABLE */
+#ifdef EXTRAKEY_ENABLE
+/* one queue per report id, so neither can hold up or replace the other */
+REPORT_QUEUE(system_queue, report_extra_t, USB_REPORT_QUEUE_SIZE);
+REPORT_QUEUE(consumer_queue, report_extra_t, USB_REPORT_QUEUE_SIZE);
+static report_extra_t extra_tx_report;
+#endif /* EXTRAKEY_ENABLE */
+
 #ifdef CONSOLE_ENABLE
 /* The emission buffers queue */
 output_buffers_queue_t console_buf_queue;
@@ -778,6 +798,15 @@ static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
 
   case USB_EVENT_CONFIGURED:
     osalSysLockFromISR();
+    /* Whatever was queued for the previous configuration is stale */
+    report_queue_clear(&kbd_queue);
+#ifdef MOUSE_ENABLE
+    report_queue_clear(&mouse_queue);
+#endif /* MOUSE_ENABLE */
+#ifdef EXTRAKEY_ENABLE
+    report_queue_clear(&system_queue);
+    report_queue_clear(&consumer_queue);
+#endif /* EXTRAKEY_ENABLE */
     /* Enable the endpoints specified into the configuration. */
     usbInitEndpointI(usbp, KBD_ENDPOINT, &kbd_ep_config);
 #ifdef MOUSE_ENABLE
@@ -1022,6 +1051,14 @@ void init_usb_driver(USBDriver *usbp) {
   usbConnectBus(usbp);
 
   chVTObjectInit(&keyboard_idle_timer);
+  REPORT_QUEUE_INIT(kbd_queue, NULL);
+#ifdef MOUSE_ENABLE
+  REPORT_QUEUE_INIT(mouse_queue, report_queue_collapse_mouse);
+#endif
+#ifdef EXTRAKEY_ENABLE
+  REPORT_QUEUE_INIT(system_queue, NULL);
+  REPORT_QUEUE_INIT(consumer_queue, NULL);
+#endif
 #ifdef CONSOLE_ENABLE
   obqObjectInit(&console_buf_queue, console_queue_buffer, CONSOLE_EPSIZE, CONSOLE_QUEUE_CAPACITY, console_queue_onotify, (void*)usbp);
   chVTObjectInit(&console_flush_timer);
@@ -1049,32 +1086,81 @@ void send_remote_wakeup(USBDriver *usbp) {
 #endif /* K20x || KL2x */
 }
 
+/* ---------------------------------------------------------
+ *                  Report queues
+ * ---------------------------------------------------------
+ */
+
+/* queue a report and start sending it, waiting for the host to take one
+ * when the queue is full, false if the driver isn't active (anymore)
+ * called in locked state, unlocks while waiting */
+static bool push_report_S(report_queue_t *queue, const void *report, void (*start_next_I)(USBDriver *)) {
+  while(usbGetDriverStateI(&USB_DRIVER) == USB_ACTIVE) {
+    if(report_queue_push(queue, report)) {
+      start_next_I(&USB_DRIVER);
+      return true;
+    }
+    osalSysUnlock();
+    chThdSleepMilliseconds(1);
+    osalSysLock();
+  }
+  return false;
+}
+
 /* ---------------------------------------------------------
  *                  Keyboard functions
  * ---------------------------------------------------------
  */
 
+/* start transmitting the next queued keyboard report if the endpoints are
+ * free, on the one matching the format it was made in
+ * called in locked state */
+static void kbd_start_next_I(USBDriver *usbp) {
+  if(usbGetTransmitStatusI(usbp, KBD_ENDPOINT)) {
+    return;
+  }
+#ifdef NKRO_ENABLE
+  /* also after a switch, so the host gets the reports in order */
+  if(usbGetTransmitStatusI(usbp, NKRO_ENDPOINT)) {
+    return;
+  }
+#endif /* NKRO_ENABLE */
+  if(!report_queue_pop(&kbd_queue, &kbd_tx_report)) {
+    return;
+  }
+#ifdef NKRO_ENABLE
+  if(kbd_tx_report.nkro) {
+    usbStartTransmitI(usbp, NKRO_ENDPOINT, (uint8_t *)&kbd_tx_report.report, sizeof(report_keyboard_t));
+    return;
+  }
+#endif /* NKRO_ENABLE */
+  usbStartTransmitI(usbp, KBD_ENDPOINT, (uint8_t *)&kbd_tx_report.report, KBD_EPSIZE);
+}
+
 /* keyboard IN callback hander (a kbd report has made it IN) */
 void kbd_in_cb(USBDriver *usbp, usbep_t ep) {
-  /* STUB */
-  (void)usbp;
   (void)ep;
+  osalSysLockFromISR();
+  kbd_start_next_I(usbp);
+  osalSysUnlockFromISR();
 }
 
 #ifdef NKRO_ENABLE
 /* nkro IN callback hander (a nkro report has made it IN) */
 void nkro_in_cb(USBDriver *usbp, usbep_t ep) {
-  /* STUB */
-  (void)usbp;
   (void)ep;
+  osalSysLockFromISR();
+  kbd_start_next_I(usbp);
+  osalSysUnlockFromISR();
 }
 #endif /* NKRO_ENABLE */
 
-/* start-of-frame handler
- * TODO: i guess it would be better to re-implement using timers,
- *  so that this is not going to have to be checked every 1ms */
+/* start-of-frame handler */
 void kbd_sof_cb(USBDriver *usbp) {
   (void)usbp;
+#ifdef SOF_SYNC_ENABLE
+  sof_sync_frame(timer_read_us32());
+#endif
 }
 
 /* Idle requests timer code
@@ -1114,49 +1200,20 @@ uint8_t keyboard_leds(void) {
   return (uint8_t)(keyboard_led_stats & 0xFF);
 }
 
-/* prepare and start sending a report IN
+/* queue a report and start sending it IN if the endpoint is free
  * not callable from ISR or locked state */
 void send_keyboard(report_keyboard_t *report) {
+  queued_keyboard_report_t queued = { .report = *report };
+#ifdef NKRO_ENABLE
+  queued.nkro = keymap_config.nkro;
+#endif /* NKRO_ENABLE */
   osalSysLock();
-  if(usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
+  /* only waits when the queue is full, kbd_in_cb sends the queued ones */
+  if(!push_report_S(&kbd_queue, &queued, kbd_start_next_I)) {
     osalSysUnlock();
     return;
   }
   osalSysUnlock();
-
-#ifdef NKRO_ENABLE
-  if(keymap_config.nkro) {  /* NKRO protocol */
-    /* need to wait until the previous packet has made it through */
-    /* can rewrite this using the synchronous API, then would wait
-     * until *after* the packet has been transmitted. I think
-     * this is more efficient */
-    /* busy wait, should be short and not very common */
-    osalSysLock();
-    if(usbGetTransmitStatusI(&USB_DRIVER, NKRO_ENDPOINT)) {
-      /* Need to either suspend, or loop and call unlock/lock during
-       * every iteration - otherwise the system will remain locked,
-       * no interrupts served, so USB not going through as well.
-       * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
-      osalThreadSuspendS(&(&USB_DRIVER)->epc[NKRO_ENDPOINT]->in_state->thread);
-    }
-    usbStartTransmitI(&USB_DRIVER, NKRO_ENDPOINT, (uint8_t *)report, sizeof(report_keyboard_t));
-    osalSysUnlock();
-  } else
-#endif /* NKRO_ENABLE */
-  { /* boot protocol */
-    /* need to wait until the previous packet has made it through */
-    /* busy wait, should be short and not very common */
-    osalSysLock();
-    if(usbGetTransmitStatusI(&USB_DRIVER, KBD_ENDPOINT)) {
-      /* Need to either suspend, or loop and call unlock/lock during
-       * every iteration - otherwise the system will remain locked,
-       * no interrupts served, so USB not going through as well.
-       * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
-      osalThreadSuspendS(&(&USB_DRIVER)->epc[KBD_ENDPOINT]->in_state->thread);
-    }
-    usbStartTransmitI(&USB_DRIVER, KBD_ENDPOINT, (uint8_t *)report, KBD_EPSIZE);
-    osalSysUnlock();
-  }
   keyboard_report_sent = *report;
 }
 
@@ -1167,27 +1224,29 @@ void send_keyboard(report_keyboard_t *report) {
 
 #ifdef MOUSE_ENABLE
 
+/* start transmitting the next queued mouse report if the endpoint is free
+ * called in locked state */
+static void mouse_start_next_I(USBDriver *usbp) {
+  if(usbGetTransmitStatusI(usbp, MOUSE_ENDPOINT)) {
+    return;
+  }
+  if(report_queue_pop(&mouse_queue, &mouse_tx_report)) {
+    usbStartTransmitI(usbp, MOUSE_ENDPOINT, (uint8_t *)&mouse_tx_report, sizeof(report_mouse_t));
+  }
+}
+
 /* mouse IN callback hander (a mouse report has made it IN) */
 void mouse_in_cb(USBDriver *usbp, usbep_t ep) {
-  (void)usbp;
   (void)ep;
+  osalSysLockFromISR();
+  mouse_start_next_I(usbp);
+  osalSysUnlockFromISR();
 }
 
 void send_mouse(report_mouse_t *report) {
   osalSysLock();
-  if(usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
-    osalSysUnlock();
-    return;
-  }
-  osalSysUnlock();
-
-  /* TODO: LUFA manually waits for the endpoint to become ready
-   * for about 10ms for mouse, kbd, system; 1ms for nkro
-   * is this really needed?
-   */
-
-  osalSysLock();
-  usbStartTransmitI(&USB_DRIVER, MOUSE_ENDPOINT, (uint8_t *)report, sizeof(report_mouse_t));
+  /* the motion of reports that wait for the endpoint is added up */
+  push_report_S(&mouse_queue, report, mouse_start_next_I);
   osalSysUnlock();
 }
 
@@ -1204,35 +1263,43 @@ void send_mouse(report_mouse_t *report) {
 
 #ifdef EXTRAKEY_ENABLE
 
+/* start transmitting the next queued extrakey report if the endpoint is free
+ * called in locked state */
+static void extra_start_next_I(USBDriver *usbp) {
+  if(usbGetTransmitStatusI(usbp, EXTRA_ENDPOINT)) {
+    return;
+  }
+  if(report_queue_pop(&system_queue, &extra_tx_report) ||
+     report_queue_pop(&consumer_queue, &extra_tx_report)) {
+    usbStartTransmitI(usbp, EXTRA_ENDPOINT, (uint8_t *)&extra_tx_report, sizeof(report_extra_t));
+  }
+}
+
 /* extrakey IN callback hander */
 void extra_in_cb(USBDriver *usbp, usbep_t ep) {
-  /* STUB */
-  (void)usbp;
   (void)ep;
+  osalSysLockFromISR();
+  extra_start_next_I(usbp);
+  osalSysUnlockFromISR();
 }
 
-static void send_extra_report(uint8_t report_id, uint16_t data) {
-  osalSysLock();
-  if(usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
-    osalSysUnlock();
-    return;
-  }
-
+static void send_extra_report(report_queue_t *queue, uint8_t report_id, uint16_t data) {
   report_extra_t report = {
     .report_id = report_id,
     .usage = data
   };
 
-  usbStartTransmitI(&USB_DRIVER, EXTRA_ENDPOINT, (uint8_t *)&report, sizeof(report_extra_t));
+  osalSysLock();
+  push_report_S(queue, &report, extra_start_next_I);
   osalSysUnlock();
 }
 
 void send_system(uint16_t data) {
-  send_extra_report(REPORT_ID_SYSTEM, data);
+  send_extra_report(&system_queue, REPORT_ID_SYSTEM, data);
 }
 
 void send_consumer(uint16_t data) {
-  send_extra_report(REPORT_ID_CONSUMER, data);
+  send_extra_report(&consumer_queue, REPORT_ID_CONSUMER, data);
 }
 
 #else /* EXTRAKEY_ENABLE */
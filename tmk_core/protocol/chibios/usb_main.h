@@ -58,6 +58,12 @@ void send_remote_wakeup(USBDriver *usbp);
 #define NKRO_REPORT_KEYS  (NKRO_EPSIZE - 1)
 #endif
 
+/* Number of reports of each kind that can wait for their IN endpoint,
+ * so that sending a report never blocks the main thread */
+#ifndef USB_REPORT_QUEUE_SIZE
+#define USB_REPORT_QUEUE_SIZE 8
+#endif
+
 /* extern report_keyboard_t keyboard_report_sent; */
 
 /* keyboard IN request callback handler */
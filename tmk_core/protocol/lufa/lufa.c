@@ -54,6 +54,13 @@
 #include "quantum.h"
 #include <util/atomic.h>
 #include "outputselect.h"
+#ifdef USB_REPORT_QUEUE_SIZE
+#   include "report_queue.h"
+#endif
+#ifdef SOF_SYNC_ENABLE
+#   include "sof_sync.h"
+#   include "timer.h"
+#endif
 
 #ifdef NKRO_ENABLE
   #include "keycode_config.h"
@@ -90,6 +97,18 @@
 	#include "raw_hid.h"
 #endif
 
+#ifdef PROFILE_ENABLE
+	#include "profile.h"
+#endif
+
+#ifdef TRACE_ENABLE
+	#include "trace.h"
+#endif
+
+#ifdef DYNAMIC_KEYMAP_ENABLE
+	#include "dynamic_keymap.h"
+#endif
+
 uint8_t keyboard_idle = 0;
 /* 0: Boot Protocol, 1: Report Protocol(default) */
 uint8_t keyboard_protocol = 1;
@@ -97,6 +116,20 @@ static uint8_t keyboard_led_stats = 0;
 
 static report_keyboard_t keyboard_report_sent;
 
+#ifdef USB_REPORT_QUEUE_SIZE
+/* The reports waiting for their IN endpoint, written from the main loop as
+ * soon as the host has read the previous one, so sending only waits when a
+ * queue is full. System and consumer reports get a queue each. */
+REPORT_QUEUE(keyboard_queue, queued_keyboard_report_t, USB_REPORT_QUEUE_SIZE);
+#ifdef MOUSE_ENABLE
+REPORT_QUEUE(mouse_queue, report_mouse_t, USB_REPORT_QUEUE_SIZE);
+#endif
+#ifdef EXTRAKEY_ENABLE
+REPORT_QUEUE(system_queue, report_extra_t, USB_REPORT_QUEUE_SIZE);
+REPORT_QUEUE(consumer_queue, report_extra_t, USB_REPORT_QUEUE_SIZE);
+#endif
+#endif
+
 #ifdef MIDI_ENABLE
 static void usb_send_func(MidiDevice * device, uint16_t cnt, uint8_t byte0, uint8_t byte1, uint8_t byte2);
 static void usb_get_midi(MidiDevice * device);
@@ -109,6 +142,9 @@ static void send_keyboard(report_keyboard_t *report);
 static void send_mouse(report_mouse_t *report);
 static void send_system(uint16_t data);
 static void send_consumer(uint16_t data);
+#ifdef USB_REPORT_QUEUE_SIZE
+static bool queue_report(report_queue_t *queue, const void *report);
+#endif
 host_driver_t lufa_driver = {
     keyboard_leds,
     send_keyboard,
@@ -254,6 +290,19 @@ static void raw_hid_task(void)
 
 		if ( data_read )
 		{
+#ifdef PROFILE_ENABLE
+			// Profile requests are answered here, everything else goes to the user
+			if ( profile_raw_hid_receive( data, sizeof(data) ) )
+				return;
+#endif
+#ifdef TRACE_ENABLE
+			if ( trace_raw_hid_receive( data, sizeof(data) ) )
+				return;
+#endif
+#ifdef DYNAMIC_KEYMAP_ENABLE
+			if ( dynamic_keymap_raw_hid_receive( data, sizeof(data) ) )
+				return;
+#endif
 			raw_hid_receive( data, sizeof(data) );
 		}
 	}
@@ -388,9 +437,17 @@ static bool console_flush = false;
   } \
 } while (0)
 
+#endif
+
+#if defined(CONSOLE_ENABLE) || defined(SOF_SYNC_ENABLE)
 // called every 1ms
 void EVENT_USB_Device_StartOfFrame(void)
 {
+#ifdef SOF_SYNC_ENABLE
+    sof_sync_frame(timer_read_us32());
+#endif
+
+#ifdef CONSOLE_ENABLE
     static uint8_t count;
     if (++count % 50) return;
     count = 0;
@@ -398,8 +455,8 @@ void EVENT_USB_Device_StartOfFrame(void)
     if (!console_flush) return;
     Console_Task();
     console_flush = false;
+#endif
 }
-
 #endif
 
 /** Event handler for the USB_ConfigurationChanged event.
@@ -412,6 +469,18 @@ void EVENT_USB_Device_ConfigurationChanged(void)
 {
     bool ConfigSuccess = true;
 
+#ifdef USB_REPORT_QUEUE_SIZE
+    /* Whatever was queued for the previous configuration is stale */
+    report_queue_clear(&keyboard_queue);
+#ifdef MOUSE_ENABLE
+    report_queue_clear(&mouse_queue);
+#endif
+#ifdef EXTRAKEY_ENABLE
+    report_queue_clear(&system_queue);
+    report_queue_clear(&consumer_queue);
+#endif
+#endif
+
     /* Setup Keyboard HID Report Endpoints */
     ConfigSuccess &= ENDPOINT_CONFIG(KEYBOARD_IN_EPNUM, EP_TYPE_INTERRUPT, ENDPOINT_DIR_IN,
                                      KEYBOARD_EPSIZE, ENDPOINT_BANK_SINGLE);
@@ -599,7 +668,6 @@ static uint8_t keyboard_leds(void)
 
 static void send_keyboard(report_keyboard_t *report)
 {
-    uint8_t timeout = 255;
     uint8_t where = where_to_send();
 
 #ifdef BLUETOOTH_ENABLE
@@ -626,6 +694,16 @@ static void send_keyboard(report_keyboard_t *report)
       return;
     }
 
+#ifdef USB_REPORT_QUEUE_SIZE
+    /* the format is kept with the report, it may change while it waits */
+    queued_keyboard_report_t queued = { .report = *report };
+#ifdef NKRO_ENABLE
+    queued.nkro = keyboard_protocol && keymap_config.nkro;
+#endif
+    if (!queue_report(&keyboard_queue, &queued)) return;
+#else
+    uint8_t timeout = 255;
+
     /* Select the Keyboard Report Endpoint */
 #ifdef NKRO_ENABLE
     if (keyboard_protocol && keymap_config.nkro) {
@@ -655,14 +733,40 @@ static void send_keyboard(report_keyboard_t *report)
 
     /* Finalize the stream transfer to send the last packet */
     Endpoint_ClearIN();
+#endif
 
     keyboard_report_sent = *report;
 }
 
+#ifdef COALESCE_KEYBOARD_REPORTS
+/* The staged report waits while the host hasn't read the previous one yet,
+ * so that later changes can still be merged into it.
+ */
+bool host_keyboard_ready(void)
+{
+    uint8_t where = where_to_send();
+    if (where != OUTPUT_USB && where != OUTPUT_USB_AND_BT) return true;
+    if (USB_DeviceState != DEVICE_STATE_Configured) return true;
+#ifdef USB_REPORT_QUEUE_SIZE
+    if (!report_queue_empty(&keyboard_queue)) return false;
+#endif
+
+#ifdef NKRO_ENABLE
+    if (keyboard_protocol && keymap_config.nkro) {
+        Endpoint_SelectEndpoint(NKRO_IN_EPNUM);
+    }
+    else
+#endif
+    {
+        Endpoint_SelectEndpoint(KEYBOARD_IN_EPNUM);
+    }
+    return Endpoint_IsReadWriteAllowed();
+}
+#endif
+
 static void send_mouse(report_mouse_t *report)
 {
 #ifdef MOUSE_ENABLE
-    uint8_t timeout = 255;
     uint8_t where = where_to_send();
 
 #ifdef BLUETOOTH_ENABLE
@@ -688,6 +792,12 @@ static void send_mouse(report_mouse_t *report)
       return;
     }
 
+#ifdef USB_REPORT_QUEUE_SIZE
+    /* the motion of reports that wait for the endpoint is added up */
+    queue_report(&mouse_queue, report);
+#else
+    uint8_t timeout = 255;
+
     /* Select the Mouse Report Endpoint */
     Endpoint_SelectEndpoint(MOUSE_IN_EPNUM);
 
@@ -701,12 +811,11 @@ static void send_mouse(report_mouse_t *report)
     /* Finalize the stream transfer to send the last packet */
     Endpoint_ClearIN();
 #endif
+#endif
 }
 
 static void send_system(uint16_t data)
 {
-    uint8_t timeout = 255;
-
     if (USB_DeviceState != DEVICE_STATE_Configured)
         return;
 
@@ -714,6 +823,11 @@ static void send_system(uint16_t data)
         .report_id = REPORT_ID_SYSTEM,
         .usage = data - SYSTEM_POWER_DOWN + 1
     };
+#ifdef USB_REPORT_QUEUE_SIZE
+    queue_report(&system_queue, &r);
+#else
+    uint8_t timeout = 255;
+
     Endpoint_SelectEndpoint(EXTRAKEY_IN_EPNUM);
 
     /* Check if write ready for a polling interval around 10ms */
@@ -722,11 +836,11 @@ static void send_system(uint16_t data)
 
     Endpoint_Write_Stream_LE(&r, sizeof(report_extra_t), NULL);
     Endpoint_ClearIN();
+#endif
 }
 
 static void send_consumer(uint16_t data)
 {
-    uint8_t timeout = 255;
     uint8_t where = where_to_send();
 
 #ifdef BLUETOOTH_ENABLE
@@ -769,6 +883,11 @@ static void send_consumer(uint16_t data)
         .report_id = REPORT_ID_CONSUMER,
         .usage = data
     };
+#ifdef USB_REPORT_QUEUE_SIZE
+    queue_report(&consumer_queue, &r);
+#else
+    uint8_t timeout = 255;
+
     Endpoint_SelectEndpoint(EXTRAKEY_IN_EPNUM);
 
     /* Check if write ready for a polling interval around 10ms */
@@ -777,8 +896,79 @@ static void send_consumer(uint16_t data)
 
     Endpoint_Write_Stream_LE(&r, sizeof(report_extra_t), NULL);
     Endpoint_ClearIN();
+#endif
 }
 
+#ifdef USB_REPORT_QUEUE_SIZE
+static void write_queued_reports(report_queue_t *queue, uint8_t epnum, uint8_t size)
+{
+    void *report;
+
+    if (report_queue_empty(queue)) return;
+    Endpoint_SelectEndpoint(epnum);
+    while (Endpoint_IsReadWriteAllowed() && (report = report_queue_peek(queue))) {
+        Endpoint_Write_Stream_LE(report, size, NULL);
+        Endpoint_ClearIN();
+        report_queue_pop(queue, NULL);
+    }
+}
+
+/* Keyboard reports go to the endpoint of the format they were made in */
+static void write_queued_keyboard_reports(void)
+{
+    queued_keyboard_report_t *queued;
+
+    while ((queued = report_queue_peek(&keyboard_queue))) {
+#ifdef NKRO_ENABLE
+        if (queued->nkro) {
+            Endpoint_SelectEndpoint(NKRO_IN_EPNUM);
+            if (!Endpoint_IsReadWriteAllowed()) return;
+            Endpoint_Write_Stream_LE(&queued->report, NKRO_EPSIZE, NULL);
+        }
+        else
+#endif
+        {
+            Endpoint_SelectEndpoint(KEYBOARD_IN_EPNUM);
+            if (!Endpoint_IsReadWriteAllowed()) return;
+            Endpoint_Write_Stream_LE(&queued->report, KEYBOARD_EPSIZE, NULL);
+        }
+        Endpoint_ClearIN();
+        report_queue_pop(&keyboard_queue, NULL);
+    }
+}
+
+/* Write the queued reports whose endpoint is free, called from the main loop */
+void usb_report_queue_task(void)
+{
+    if (USB_DeviceState != DEVICE_STATE_Configured) return;
+
+    write_queued_keyboard_reports();
+#ifdef MOUSE_ENABLE
+    write_queued_reports(&mouse_queue, MOUSE_IN_EPNUM, sizeof(report_mouse_t));
+#endif
+#ifdef EXTRAKEY_ENABLE
+    write_queued_reports(&system_queue, EXTRAKEY_IN_EPNUM, sizeof(report_extra_t));
+    write_queued_reports(&consumer_queue, EXTRAKEY_IN_EPNUM, sizeof(report_extra_t));
+#endif
+}
+
+/* Queue a report and write what the endpoints take. A full queue waits for
+ * the host as long as a report would without the queue, so nothing queued
+ * has to be replaced; false if the report was dropped after all */
+static bool queue_report(report_queue_t *queue, const void *report)
+{
+    uint8_t timeout = 255;
+
+    while (!report_queue_push(queue, report)) {
+        if (!timeout--) return false;
+        _delay_us(40);
+        usb_report_queue_task();
+    }
+    usb_report_queue_task();
+    return true;
+}
+#endif
+
 
 /*******************************************************************************
  * sendchar
@@ -1103,6 +1293,17 @@ static void setup_usb(void)
     // for Console_Task
     USB_Device_EnableSOFEvents();
     print_set_sendchar(sendchar);
+
+#ifdef USB_REPORT_QUEUE_SIZE
+    REPORT_QUEUE_INIT(keyboard_queue, NULL);
+#ifdef MOUSE_ENABLE
+    REPORT_QUEUE_INIT(mouse_queue, report_queue_collapse_mouse);
+#endif
+#ifdef EXTRAKEY_ENABLE
+    REPORT_QUEUE_INIT(system_queue, NULL);
+    REPORT_QUEUE_INIT(consumer_queue, NULL);
+#endif
+#endif
 }
 
 
@@ -1192,6 +1393,10 @@ int main(void)
 
         keyboard_task();
 
+#ifdef USB_REPORT_QUEUE_SIZE
+        usb_report_queue_task();
+#endif
+
 #ifdef MIDI_ENABLE
         midi_device_process(&midi_device);
 #ifdef MIDI_ADVANCED
@@ -1199,10 +1404,6 @@ int main(void)
 #endif
 #endif
 
-#if defined(RGBLIGHT_ANIMATIONS) & defined(RGBLIGHT_ENABLE)
-        rgblight_task();
-#endif
-
 #ifdef MODULE_ADAFRUIT_BLE
         adafruit_ble_task();
 #endif
@@ -57,6 +57,11 @@ extern "C" {
 
 extern host_driver_t lufa_driver;
 
+#ifdef USB_REPORT_QUEUE_SIZE
+/* write the queued reports whose IN endpoint is free */
+void usb_report_queue_task(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,249 @@
+#!/usr/bin/env python3
+# Copyright 2017 QMK contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""Compile a keymap into the pre-translated tables of COMPILED_KEYMAP_ENABLE.
+
+The keymap is read from the compiled objects rather than from its source, so
+every macro and enum has already been resolved by the compiler that builds
+the firmware:
+
+    util/compile_keymap.py -o keymap_compiled.c keymap.o keymap_common.o
+
+keymap.o holds keymaps[][MATRIX_ROWS][MATRIX_COLS] and fn_actions[], and
+keymap_common.o the matrix size in keymap_matrix_size[]. The generated C has
+one pool of rows, shared by every layer that has the same keycodes or the same
+actions in a row, and for each key the layers it is not transparent on. The
+actions themselves are written as KEYCODE_ACTION(keycode), for the firmware
+compiler to evaluate, except for the FN keys, which are read from fn_actions.
+"""
+
+import argparse
+import struct
+import sys
+
+KC_NO = 0x0000
+KC_TRNS = 0x0001
+KC_A = 0x0004
+KC_EXSEL = 0x00A4
+KC_FN0 = 0x00C0
+KC_FN31 = 0x00DF
+KC_LCTRL = 0x00E0
+KC_RGUI = 0x00E7
+QK_MODS = 0x0100
+QK_MODS_MAX = 0x1FFF
+QK_FUNCTION = 0x2000
+QK_FUNCTION_MAX = 0x2FFF
+ACTION_NO = 0x0000
+ACTION_TRANSPARENT = 0x0001
+MAX_LAYERS = 32
+
+
+class Object:
+    """The symbols of a relocatable ELF object, little endian, 32 or 64 bit."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        self.path = path
+        if self.data[:4] != b'\x7fELF':
+            raise ValueError('%s: not an ELF object' % path)
+        if self.data[5] != 1:
+            raise ValueError('%s: not little endian' % path)
+        self.is64 = self.data[4] == 2
+        if self.is64:
+            shoff, = struct.unpack_from('<Q', self.data, 0x28)
+            shentsize, shnum = struct.unpack_from('<HH', self.data, 0x3A)
+        else:
+            shoff, = struct.unpack_from('<I', self.data, 0x20)
+            shentsize, shnum = struct.unpack_from('<HH', self.data, 0x2E)
+        self.sections = [self._section(shoff + i * shentsize) for i in range(shnum)]
+
+    def _section(self, offset):
+        if self.is64:
+            name, kind, flags, addr, off, size, link = struct.unpack_from('<IIQQQQI', self.data, offset)
+        else:
+            name, kind, flags, addr, off, size, link = struct.unpack_from('<IIIIIII', self.data, offset)
+        return {'type': kind, 'offset': off, 'size': size, 'link': link}
+
+    def _string(self, section, offset):
+        start = self.sections[section]['offset'] + offset
+        return self.data[start:self.data.index(b'\0', start)].decode()
+
+    def symbol(self, name):
+        """The bytes of a defined data symbol, or None"""
+        for symtab in (s for s in self.sections if s['type'] == 2):
+            entsize = 24 if self.is64 else 16
+            for i in range(symtab['size'] // entsize):
+                offset = symtab['offset'] + i * entsize
+                if self.is64:
+                    st_name, info, other, shndx, value, size = struct.unpack_from('<IBBHQQ', self.data, offset)
+                else:
+                    st_name, value, size, info, other, shndx = struct.unpack_from('<IIIBBH', self.data, offset)
+                if shndx == 0 or shndx >= 0xFF00 or self._string(symtab['link'], st_name) != name:
+                    continue
+                section = self.sections[shndx]
+                if section['type'] == 8:
+                    # .bss
+                    return bytes(size)
+                start = section['offset'] + value
+                return self.data[start:start + size]
+        return None
+
+
+def words(data):
+    return list(struct.unpack('<%dH' % (len(data) // 2), data))
+
+
+def find(objects, name):
+    for obj in objects:
+        data = obj.symbol(name)
+        if data is not None:
+            return data
+    return None
+
+
+def is_identity(keycode):
+    """Keycodes whose action has the same value"""
+    return (keycode in (KC_NO, KC_TRNS) or KC_A <= keycode <= KC_EXSEL or
+            KC_LCTRL <= keycode <= KC_RGUI or QK_MODS <= keycode <= QK_MODS_MAX)
+
+
+def fn_index(keycode):
+    if KC_FN0 <= keycode <= KC_FN31:
+        return keycode - KC_FN0
+    if QK_FUNCTION <= keycode <= QK_FUNCTION_MAX:
+        return keycode & 0xFFF
+    return None
+
+
+class Keymap:
+    def __init__(self, objects):
+        size = find(objects, 'keymap_matrix_size')
+        if size is None:
+            raise ValueError('keymap_matrix_size not found, is keymap_common.c built with COMPILED_KEYMAP?')
+        self.rows, self.cols = size[0], size[1]
+        keymaps = find(objects, 'keymaps')
+        if keymaps is None:
+            raise ValueError('keymaps not found')
+        keys = words(keymaps)
+        per_layer = self.rows * self.cols
+        if not keys or len(keys) % per_layer:
+            raise ValueError('keymaps is %d bytes, not layers of %dx%d keys' % (len(keymaps), self.rows, self.cols))
+        self.layers = [[keys[(l * self.rows + r) * self.cols:(l * self.rows + r + 1) * self.cols]
+                        for r in range(self.rows)] for l in range(len(keys) // per_layer)]
+        if len(self.layers) > MAX_LAYERS:
+            raise ValueError('%d layers, at most %d can be compiled' % (len(self.layers), MAX_LAYERS))
+        fn_actions = find(objects, 'fn_actions')
+        self.fn_actions = words(fn_actions) if fn_actions else []
+
+    def action(self, keycode):
+        """The action as a C expression, and its value if it is known here"""
+        index = fn_index(keycode)
+        if index is not None:
+            # out of fn_actions, the firmware would read past its end
+            if index >= len(self.fn_actions):
+                sys.stderr.write('compile_keymap: FN%d is not in fn_actions, compiled as KC_NO\n' % index)
+                return '0x%04X' % ACTION_NO, ACTION_NO
+            value = self.fn_actions[index]
+            return '0x%04X' % value, value
+        if is_identity(keycode):
+            return '0x%04X' % keycode, keycode
+        return 'KEYCODE_ACTION(0x%04X)' % keycode, None
+
+    def transparent(self, keycode):
+        return self.action(keycode)[1] == ACTION_TRANSPARENT
+
+
+class Pool:
+    """Rows of C expressions, each stored once"""
+
+    def __init__(self):
+        self.rows = []
+        self.index = {}
+
+    def add(self, row):
+        row = tuple(row)
+        if row not in self.index:
+            self.index[row] = len(self.rows)
+            self.rows.append(row)
+        return self.index[row]
+
+
+def c_type(count):
+    if count <= 0xFF:
+        return 'uint8_t', 'pgm_read_byte'
+    if count <= 0xFFFF:
+        return 'uint16_t', 'pgm_read_word'
+    return 'uint32_t', 'pgm_read_dword'
+
+
+def generate(keymap, source, out):
+    pool = Pool()
+    keycode_rows = [[pool.add('0x%04X' % k for k in row) for row in layer] for layer in keymap.layers]
+    action_rows = [[pool.add(keymap.action(k)[0] for k in row) for row in layer] for layer in keymap.layers]
+    masks = [[sum(1 << l for l, layer in enumerate(keymap.layers) if not keymap.transparent(layer[r][c]))
+              for c in range(keymap.cols)] for r in range(keymap.rows)]
+    index_type, index_read = c_type(len(pool.rows) - 1)
+    mask_type, mask_read = c_type((1 << len(keymap.layers)) - 1)
+
+    w = out.write
+    w('/* Generated by util/compile_keymap.py from %s, do not edit */\n\n' % ', '.join(source))
+    w('#include "keymap.h"\n#include "keymap_compiled.h"\n\n')
+    w('#if MATRIX_ROWS != %d || MATRIX_COLS != %d\n' % (keymap.rows, keymap.cols))
+    w('#   error "compiled for another matrix size"\n#endif\n\n')
+    w('#define LAYERS %d\n\n' % len(keymap.layers))
+    w('/* %d rows of keycodes and actions for %d layers of %d rows */\n' % (
+        len(pool.rows), len(keymap.layers), keymap.rows))
+    w('static const uint16_t PROGMEM rows[][MATRIX_COLS] = {\n')
+    for row in pool.rows:
+        w('    {%s},\n' % ', '.join(row))
+    w('};\n\n')
+    for name, table in (('keycode_rows', keycode_rows), ('action_rows', action_rows)):
+        w('static const %s PROGMEM %s[LAYERS][MATRIX_ROWS] = {\n' % (index_type, name))
+        for layer in table:
+            w('    {%s},\n' % ', '.join(str(i) for i in layer))
+        w('};\n\n')
+    w('/* the layers each key is not transparent on */\n')
+    w('static const %s PROGMEM key_layers[MATRIX_ROWS][MATRIX_COLS] = {\n' % mask_type)
+    for row in masks:
+        w('    {%s},\n' % ', '.join('0x%X' % m for m in row))
+    w('};\n\n')
+    for name, table, none in (('keycode', 'keycode_rows', 'KC_TRNS'), ('action', 'action_rows', 'ACTION_TRANSPARENT')):
+        w('uint16_t keymap_compiled_%s(uint8_t layer, keypos_t key)\n{\n' % name)
+        w('    if (layer >= LAYERS || key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) return %s;\n' % none)
+        w('    return pgm_read_word(&rows[%s(&%s[layer][key.row])][key.col]);\n}\n\n' % (index_read, table))
+    w('uint8_t keymap_compiled_layer_count(void)\n{\n    return LAYERS;\n}\n\n')
+    w('uint32_t keymap_compiled_layers(keypos_t key)\n{\n')
+    w('    if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) return 0;\n')
+    w('    return %s(&key_layers[key.row][key.col]);\n}\n' % mask_read)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('objects', nargs='+', help='objects of keymap.c and keymap_common.c')
+    parser.add_argument('-o', '--output', required=True, help='C file to generate')
+    args = parser.parse_args()
+
+    try:
+        keymap = Keymap([Object(path) for path in args.objects])
+    except (OSError, ValueError) as e:
+        sys.exit('compile_keymap: %s' % e)
+    with open(args.output, 'w') as out:
+        generate(keymap, args.objects, out)
+
+
+if __name__ == '__main__':
+    main()
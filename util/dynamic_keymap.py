@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+# Copyright 2017 QMK contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+"""Read or replace the keymap of a keyboard built with DYNAMIC_KEYMAP_ENABLE
+and RAW_ENABLE, over raw HID on Linux:
+
+    util/dynamic_keymap.py --hidraw /dev/hidraw3 dump > keymap.json
+    util/dynamic_keymap.py --hidraw /dev/hidraw3 load keymap.json
+    util/dynamic_keymap.py --hidraw /dev/hidraw3 reset
+
+The file has one list of rows of keycodes per layer, see quantum/dynamic_keymap.h
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+
+RAW_HID_ID = 0xF2
+RAW_HID_INFO = 0
+RAW_HID_READ = 1
+RAW_HID_WRITE = 2
+RAW_HID_RESET = 3
+RAW_EPSIZE = 32
+PER_PACKET = (RAW_EPSIZE - 5) // 2
+
+
+class Keyboard:
+    def __init__(self, path):
+        self.fd = os.open(path, os.O_RDWR)
+
+    def close(self):
+        os.close(self.fd)
+
+    def request(self, command, offset=0, keycodes=(), count=None):
+        data = struct.pack('<BBHB', RAW_HID_ID, command, offset, len(keycodes) if count is None else count)
+        data += struct.pack('<%dH' % len(keycodes), *keycodes)
+        os.write(self.fd, b'\0' + data + bytes(RAW_EPSIZE - len(data)))
+        while True:
+            reply = os.read(self.fd, RAW_EPSIZE)
+            # skip answers to anyone else
+            if reply and reply[0] == RAW_HID_ID:
+                return reply
+
+    def info(self):
+        reply = self.request(RAW_HID_INFO)
+        return reply[2], reply[3], reply[4]
+
+    def read(self, total):
+        keycodes = []
+        while len(keycodes) < total:
+            reply = self.request(RAW_HID_READ, len(keycodes), count=min(PER_PACKET, total - len(keycodes)))
+            if reply[4] == 0:
+                raise IOError('read stopped at keycode %d of %d' % (len(keycodes), total))
+            keycodes.extend(struct.unpack_from('<%dH' % reply[4], reply, 5))
+        return keycodes
+
+    def write(self, keycodes):
+        for offset in range(0, len(keycodes), PER_PACKET):
+            chunk = keycodes[offset:offset + PER_PACKET]
+            if self.request(RAW_HID_WRITE, offset, chunk)[4] != len(chunk):
+                raise IOError('write stopped at keycode %d of %d' % (offset, len(keycodes)))
+
+
+def dump(keyboard, out):
+    layers, rows, cols = keyboard.info()
+    keycodes = keyboard.read(layers * rows * cols)
+    keymap = [[['0x%04X' % keycodes[(l * rows + r) * cols + c] for c in range(cols)]
+               for r in range(rows)] for l in range(layers)]
+    out.write('[\n%s\n]\n' % ',\n'.join(
+        '  [\n%s\n  ]' % ',\n'.join('    [%s]' % ', '.join('"%s"' % k for k in row) for row in layer)
+        for layer in keymap))
+
+
+def load(keyboard, keymap):
+    layers, rows, cols = keyboard.info()
+    if len(keymap) > layers or any(len(layer) != rows or any(len(row) != cols for row in layer) for layer in keymap):
+        sys.exit('dynamic_keymap: the keyboard has %d layers of %dx%d keys' % (layers, rows, cols))
+    keyboard.write([int(k, 0) if isinstance(k, str) else k for layer in keymap for row in layer for k in row])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--hidraw', required=True, help='raw HID device of the keyboard, e.g. /dev/hidraw3')
+    parser.add_argument('command', choices=['dump', 'load', 'reset'])
+    parser.add_argument('file', nargs='?', help='keymap to load, default stdin')
+    args = parser.parse_args()
+
+    keyboard = Keyboard(args.hidraw)
+    try:
+        if args.command == 'dump':
+            dump(keyboard, sys.stdout)
+        elif args.command == 'load':
+            if args.file:
+                with open(args.file) as f:
+                    load(keyboard, json.load(f))
+            else:
+                load(keyboard, json.load(sys.stdin))
+        else:
+            keyboard.request(RAW_HID_RESET)
+    finally:
+        keyboard.close()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,182 @@
+#!/usr/bin/env python3
+# Copyright 2017 QMK contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""Turn the event trace of a keyboard built with TRACE_ENABLE = yes into a
+timeline, with the latency from each key change to the next report.
+
+Read the trace over raw HID (RAW_ENABLE = yes), on Linux:
+
+    util/trace_decode.py --hidraw /dev/hidraw3 [--follow]
+
+or from what the trace magic command printed on the console:
+
+    hid_listen | tee console.log
+    util/trace_decode.py console.log
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import time
+
+RAW_HID_ID = 0xF1
+RAW_HID_READ = 0
+RAW_EPSIZE = 32
+
+TYPES = {
+    1: 'matrix',
+    2: 'tapping',
+    3: 'record',
+    4: 'layer',
+    5: 'default layer',
+    6: 'report',
+    7: 'user',
+}
+
+TAPPING = ['start', 'tap', 'hold', 'interrupt', 'end']
+
+LINE = re.compile(r'^\s*([0-9A-Fa-f]{8}) ([0-9A-Fa-f]{2}) ([0-9A-Fa-f]{2}) ([0-9A-Fa-f]{4})\s*$')
+LOST = re.compile(r'^\s*lost: (\d+)\s*$')
+
+
+def key(data):
+    return '(%d,%d)' % (data >> 8, data & 0xFF)
+
+
+def describe(kind, arg, data):
+    if kind == 1:
+        return 'matrix %s %s' % (key(data), 'down' if arg else 'up')
+    if kind == 2:
+        decision = arg >> 4
+        name = TAPPING[decision] if decision < len(TAPPING) else str(decision)
+        return 'tapping %s %s count=%d' % (name, key(data), arg & 0x0F)
+    if kind == 3:
+        flags = ' interrupted' if arg & 0x10 else ''
+        return 'record %s %s tap=%d%s' % (key(data), 'down' if arg & 0x80 else 'up', arg & 0x0F, flags)
+    if kind in (4, 5):
+        return '%s %04X' % (TYPES[kind], data)
+    if kind == 6:
+        return 'report mods=%02X keys=%d' % (arg, data)
+    if kind == 7:
+        return 'user %02X %04X' % (arg, data)
+    return 'type %02X %02X %04X' % (kind, arg, data)
+
+
+class Timeline:
+    """Prints the records as they come, in ms since the first one, and keeps
+    the latency from a matrix change to the report that followed it."""
+
+    def __init__(self, out):
+        self.out = out
+        self.start = None
+        self.last = None
+        self.wraps = 0
+        self.pending = []
+        self.latencies = []
+
+    def lost(self, count):
+        if count:
+            self.out.write('-- %d records lost --\n' % count)
+            # their reports can't be matched any more
+            self.pending = []
+
+    def add(self, us, kind, arg, data):
+        # the microsecond timer wraps every 71 minutes
+        if self.last is not None and us + self.wraps < self.last - (1 << 31):
+            self.wraps += 1 << 32
+        us += self.wraps
+        if self.start is None:
+            self.start = us
+        delta = us - self.last if self.last is not None else 0
+        self.last = us
+        self.out.write('%12.3f ms %+9.3f  %s\n' % ((us - self.start) / 1000.0, delta / 1000.0,
+                                                   describe(kind, arg, data)))
+        if kind == 1:
+            self.pending.append(us)
+        elif kind == 6 and self.pending:
+            self.latencies.extend(us - t for t in self.pending)
+            self.pending = []
+
+    def summary(self):
+        if not self.latencies:
+            return
+        lat = sorted(self.latencies)
+        self.out.write('\nmatrix to report, %d changes: min %.3f ms, median %.3f ms, max %.3f ms\n' % (
+            len(lat), lat[0] / 1000.0, lat[len(lat) // 2] / 1000.0, lat[-1] / 1000.0))
+
+
+def read_console(lines, timeline):
+    for line in lines:
+        m = LOST.match(line)
+        if m:
+            timeline.lost(int(m.group(1)))
+            continue
+        m = LINE.match(line)
+        if m:
+            timeline.add(int(m.group(1), 16), int(m.group(2), 16), int(m.group(3), 16), int(m.group(4), 16))
+
+
+def read_hidraw(path, follow, interval, timeline):
+    fd = os.open(path, os.O_RDWR)
+    try:
+        while True:
+            request = bytes([0, RAW_HID_ID, RAW_HID_READ]) + bytes(RAW_EPSIZE - 2)
+            os.write(fd, request)
+            while True:
+                reply = os.read(fd, RAW_EPSIZE)
+                # skip answers to anyone else
+                if reply and reply[0] == RAW_HID_ID:
+                    break
+            count = reply[1]
+            timeline.lost(struct.unpack_from('<H', reply, 2)[0])
+            for i in range(count):
+                us, kind, arg, data = struct.unpack_from('<IBBH', reply, 4 + 8 * i)
+                timeline.add(us, kind, arg, data)
+            timeline.out.flush()
+            if count == 0:
+                if not follow:
+                    return
+                time.sleep(interval)
+    finally:
+        os.close(fd)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('file', nargs='?', help='console output with the trace, default stdin')
+    parser.add_argument('--hidraw', help='raw HID device of the keyboard, e.g. /dev/hidraw3')
+    parser.add_argument('--follow', action='store_true', help='keep reading new records from the device')
+    parser.add_argument('--interval', type=float, default=0.05, help='seconds between reads with --follow')
+    args = parser.parse_args()
+
+    timeline = Timeline(sys.stdout)
+    try:
+        if args.hidraw:
+            read_hidraw(args.hidraw, args.follow, args.interval, timeline)
+        elif args.file:
+            with open(args.file) as f:
+                read_console(f, timeline)
+        else:
+            read_console(sys.stdin, timeline)
+    except KeyboardInterrupt:
+        pass
+    timeline.summary()
+
+
+if __name__ == '__main__':
+    main()